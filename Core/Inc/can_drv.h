@@ -19,18 +19,128 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Exported constants --------------------------------------------------------*/
+#define CAN_RX_BUFFER_SIZE      16      /* RX ring buffer size (per priority class) */
+#define CAN_RX_STARVATION_LIMIT 8       /* Frames a waiting class may be passed over */
+#define CAN_TX_QUEUE_SIZE       16      /* Per-controller software TX queue size */
+#define CAN_RX_COALESCE_MAX     8       /* Identifiers with latest-value-wins queuing */
+#define CAN_FILTER_BANK_COUNT   28      /* Filter banks shared by CAN1/CAN2 */
+#define CAN_FILTER_BANK_CAN2    14      /* First bank owned by CAN2 (CAN2SB) */
+#define CAN_FILTER_EXT_BANKS    6       /* Per-controller banks for 29-bit mask filters */
+#define CAN_FMI_MAX             (CAN_FILTER_BANK_CAN2 * 4)  /* 16-bit list: 4 numbers per bank */
+#define CAN_FILTER_ID_ENGINE    0x100   /* Engine RPM CAN ID */
+#define CAN_FILTER_ID_TEMP      0x101   /* Engine temperature CAN ID */
+#define CAN_FILTER_ID_SPEED     0x102   /* Vehicle speed CAN ID */
+#define CAN_FILTER_ID_DIAG_REQ  0x7E0   /* UDS physical request CAN ID */
+
+#define CAN_ID_EXT              0x80000000U /* Identifier flag: 29-bit extended frame */
+#define CAN_ID_STD_MASK         0x7FFU      /* 11-bit identifier bits */
+#define CAN_ID_EXT_MASK         0x1FFFFFFFU /* 29-bit identifier bits */
+#define CAN_RX_ACCEPT_WORDS     ((CAN_ID_STD_MASK + 1) / 32)    /* One bit per 11-bit ID */
+
+#define CAN_SAMPLE_POINT_PERMILLE   875     /* Sample point of the computed bit timing */
+#define CAN_BT_PRESCALER_MAX    1024    /* bxCAN BTR BRP + 1 */
+#define CAN_BT_BS1_MAX          16      /* Time quanta, BTR TS1 + 1 */
+#define CAN_BT_BS2_MAX          8       /* Time quanta, BTR TS2 + 1 */
+#define CAN_BT_SJW_MAX          4       /* Time quanta, BTR SJW + 1 */
+#define CAN_BT_TQ_MIN           8       /* Fewest time quanta per bit considered */
+#define CAN_BT_TQ_MAX           (1 + CAN_BT_BS1_MAX + CAN_BT_BS2_MAX)
+
 /* Exported types ------------------------------------------------------------*/
 
 /**
- * @brief CAN frame structure
+ * @brief CAN controller selection
+ */
+typedef enum {
+    CAN_BUS_1 = 0,          /* bxCAN1 (master, owns filter banks) */
+    CAN_BUS_2,              /* bxCAN2 (slave) */
+    CAN_BUS_COUNT
+} CanBus_t;
+
+/**
+ * @brief Controller operating mode (BTR LBKM/SILM)
+ */
+typedef enum {
+    CAN_MODE_NORMAL = 0,        /* Transmits and receives on the bus */
+    CAN_MODE_LOOPBACK,          /* Own frames received back, still driven onto the bus */
+    CAN_MODE_SILENT,            /* Receives only: no ACK, no frames, bus stays recessive */
+    CAN_MODE_SILENT_LOOPBACK    /* Own frames received back, bus left untouched */
+} CanMode_t;
+
+/**
+ * @brief Bit timing (values in time quanta, not BTR register encoding)
  */
 typedef struct {
-    uint32_t id;            /* CAN identifier */
+    uint16_t prescaler;         /* Peripheral clocks per time quantum */
+    uint8_t bs1;                /* Time segment 1: propagation + phase 1 */
+    uint8_t bs2;                /* Time segment 2: phase 2 */
+    uint8_t sjw;                /* Resynchronization jump width */
+    uint8_t tq;                 /* Time quanta per bit: 1 + bs1 + bs2 */
+    uint16_t sample_point;      /* Achieved sample point in permille */
+} CanBitTiming_t;
+
+/**
+ * @brief CAN frame structure (16 bytes, no padding)
+ * @note  The payload words are laid out like the mailbox RDLR/RDHR and
+ *        TDLR/TDHR registers, so the driver moves them with two word
+ *        copies; data[] gives byte access to the same storage.
+ */
+typedef struct {
+    uint32_t id;            /* CAN identifier (CAN_ID_EXT set for 29-bit) */
     uint8_t dlc;            /* Data length code (0-8) */
-    uint8_t data[8];        /* Data bytes */
-    uint32_t timestamp;     /* Reception timestamp */
+    uint8_t bus;            /* Controller the frame was received on (CanBus_t) */
+    uint16_t time;          /* Reception tick, low 16 bits (see CAN_FRAME_TICK) */
+    union {
+        uint8_t data[8];    /* Data bytes */
+        uint32_t word[2];   /* Data bytes 0-3 and 4-7, little endian */
+    };
 } CanFrame_t;
 
+/**
+ * @brief CAN transmit queue statistics
+ */
+typedef struct {
+    uint32_t frames_sent;           /* Frames loaded into a mailbox */
+    uint32_t frames_queued;         /* Frames that had to wait in the software queue */
+    uint32_t queue_full;            /* Frames rejected because the queue was full */
+    uint32_t latency_max_cycles;    /* Worst request-to-mailbox latency */
+    uint32_t latency_sum_cycles;    /* Sum of request-to-mailbox latencies */
+} CanTxStats_t;
+
+/**
+ * @brief Receive priority class (one RX queue each)
+ */
+typedef enum {
+    CAN_RX_CLASS_NORMAL = 0,    /* Default for every filter */
+    CAN_RX_CLASS_HIGH,          /* Safety relevant, drained first */
+    CAN_RX_CLASS_LOW,           /* Diagnostics and bulk traffic */
+    CAN_RX_CLASS_COUNT
+} CanRxClass_t;
+
+/**
+ * @brief CAN receive queue statistics
+ */
+typedef struct {
+    uint32_t frames_received;       /* Frames read from the hardware FIFO */
+    uint32_t frames_rejected;       /* Unrouted frames discarded by the accept bitmap */
+    uint32_t frames_coalesced;      /* Frames that overwrote a pending frame of the same ID */
+    uint32_t frames_dropped;        /* Frames lost because their class queue was full */
+    uint32_t fifo_overruns;         /* Frames lost in hardware: FIFO 0 overrun */
+    uint32_t starvation_grants;     /* Lower class served ahead of a higher one */
+    uint16_t queue_high_water[CAN_RX_CLASS_COUNT];  /* Largest depth per class queue */
+} CanRxStats_t;
+
+/**
+ * @brief Receive hook, called from RX ISR context for every received frame
+ */
+typedef void (*CanRxHook_t)(const CanFrame_t* frame);
+
+/**
+ * @brief Transmit hook, called from TX ISR context when the software
+ *        queue of a controller has run empty
+ */
+typedef void (*CanTxHook_t)(CanBus_t bus);
+
 /**
  * @brief CAN error types
  */
@@ -43,22 +153,119 @@ typedef enum {
     CAN_ERROR_TIMEOUT
 } CanError_t;
 
-/* Exported constants --------------------------------------------------------*/
-#define CAN_RX_BUFFER_SIZE      16      /* RX ring buffer size */
-#define CAN_FILTER_ID_ENGINE    0x100   /* Engine RPM CAN ID */
-#define CAN_FILTER_ID_TEMP      0x101   /* Engine temperature CAN ID */
-#define CAN_FILTER_ID_SPEED     0x102   /* Vehicle speed CAN ID */
+/**
+ * @brief Software transmit queue (one per controller)
+ */
+typedef struct {
+    CanFrame_t frames[CAN_TX_QUEUE_SIZE];
+    uint32_t stamps[CAN_TX_QUEUE_SIZE];     /* DWT cycle count at request */
+    uint16_t head;
+    uint16_t tail;
+    uint16_t count;
+    CanTxStats_t stats;
+} CanTxQueue_t;
+
+/**
+ * @brief Receive queue (one per priority class)
+ */
+typedef struct {
+    CanFrame_t frames[CAN_RX_BUFFER_SIZE];
+    uint8_t owner[CAN_RX_BUFFER_SIZE];      /* Coalescing entry of each slot */
+    uint16_t head;
+    uint16_t tail;
+    uint16_t count;
+} CanRxQueue_t;
+
+/**
+ * @brief Receive side shared by the controllers of one bxCAN pair
+ * @note  The class queues, statistics, coalescing table and filter bank
+ *        classes are common to CAN1 and CAN2, as are the filter banks
+ *        themselves (registers of the master controller).
+ */
+typedef struct {
+    CAN_TypeDef* filter_regs;               /* Master controller owning the filter banks */
+    CanRxQueue_t rx_queues[CAN_RX_CLASS_COUNT];
+    volatile uint16_t rx_count;             /* Frames in all class queues */
+    volatile CanError_t last_error;
+    CanRxStats_t rx_stats;
+    uint8_t rx_passed_over[CAN_RX_CLASS_COUNT];     /* Pass-over counters per class */
+    uint8_t bank_class[CAN_FILTER_BANK_COUNT];      /* Priority class of every filter bank */
+    uint32_t coalesce_ids[CAN_RX_COALESCE_MAX];     /* Latest-value-wins identifiers */
+    uint8_t coalesce_bus[CAN_RX_COALESCE_MAX];
+    uint8_t coalesce_slot[CAN_RX_COALESCE_MAX];     /* Slot holding the pending frame */
+    uint8_t coalesce_class[CAN_RX_COALESCE_MAX];
+    uint8_t coalesce_count;
+    CanRxHook_t rx_hook;
+} CanDriver_t;
+
+/**
+ * @brief One CAN controller bound to its registers and receive side
+ * @note  The CAN_Xxx() functions use the CAN1/CAN2 channels returned by
+ *        CAN_GetChannel(); the CAN_ChannelXxx() functions take the
+ *        channel explicitly.
+ */
+typedef struct {
+    CAN_TypeDef* regs;                      /* Controller registers */
+    CanDriver_t* driver;                    /* Receive side and filter banks */
+    uint8_t bus;                            /* CanBus_t: half of the filter banks used */
+    uint8_t list_bank_next;                 /* Next free identifier-list bank */
+    uint8_t mode;                           /* CanMode_t */
+    bool rx_accept_enabled;
+    uint8_t fmi_class[CAN_FMI_MAX];         /* Priority class of every filter match index */
+    uint32_t rx_accept[CAN_RX_ACCEPT_WORDS];    /* Routed standard identifiers */
+    CanTxQueue_t tx;
+    CanTxHook_t tx_hook;                    /* Refills the queue from the TX interrupt */
+} CanChannel_t;
 
 /* Exported macro ------------------------------------------------------------*/
+/* Full reception tick of a frame younger than 65 s, given the current tick */
+#define CAN_FRAME_TICK(frame, now)  ((now) - (uint16_t)((uint16_t)(now) - (frame)->time))
+
+#define CAN_ID_IS_VALID(id)     (((id) & CAN_ID_EXT) ? (((id) & ~(CAN_ID_EXT | CAN_ID_EXT_MASK)) == 0) \
+                                                     : ((id) <= CAN_ID_STD_MASK))
 
 /* Exported functions prototypes ---------------------------------------------*/
-bool CAN_Init(uint32_t baudrate);
+bool CAN_Init(uint32_t baudrate, CanMode_t mode);
+bool CAN_InitBus(CanBus_t bus, uint32_t baudrate, CanMode_t mode);
+CanMode_t CAN_GetMode(CanBus_t bus);
+bool CAN_CalcBitTiming(uint32_t clock_hz, uint32_t bitrate, uint16_t sample_point, CanBitTiming_t* timing);
+bool CAN_ConfigureFilterList(CanBus_t bus, const uint32_t* ids, uint8_t count, CanRxClass_t rx_class);
+bool CAN_ConfigureFilterMaskExt(CanBus_t bus, const uint32_t* ids, const uint32_t* masks, uint8_t count);
 bool CAN_Send(uint32_t id, const uint8_t* data, uint8_t dlc);
+bool CAN_Transmit(CanBus_t bus, const CanFrame_t* frame);
 bool CAN_Receive(CanFrame_t* frame);
 uint16_t CAN_GetRxCount(void);
+bool CAN_SetRxCoalescing(CanBus_t bus, const uint32_t* ids, uint8_t count);
+void CAN_AddRxAcceptIds(CanBus_t bus, const uint32_t* ids, uint8_t count);
+void CAN_GetRxStats(CanRxStats_t* stats);
+void CAN_GetTxStats(CanBus_t bus, CanTxStats_t* stats);
+void CAN_SetRxHook(CanRxHook_t hook);
+void CAN_SetTxHook(CanBus_t bus, CanTxHook_t hook);
 CanError_t CAN_GetLastError(void);
 void CAN_ClearError(void);
 void CAN_IRQHandler(void);
+void CAN_RxIRQHandler(CanBus_t bus);
+void CAN_TxIRQHandler(CanBus_t bus);
+void CAN_DriverInit(CanDriver_t* driver, CAN_TypeDef* filter_regs);
+bool CAN_DriverReceive(CanDriver_t* driver, CanFrame_t* frame);
+uint16_t CAN_DriverGetRxCount(const CanDriver_t* driver);
+void CAN_DriverGetRxStats(CanDriver_t* driver, CanRxStats_t* stats);
+void CAN_DriverSetRxHook(CanDriver_t* driver, CanRxHook_t hook);
+CanError_t CAN_DriverGetLastError(const CanDriver_t* driver);
+bool CAN_ChannelInit(CanChannel_t* channel, CanDriver_t* driver, CAN_TypeDef* regs, CanBus_t bus,
+                     uint32_t baudrate, CanMode_t mode);
+bool CAN_ChannelConfigureFilterList(CanChannel_t* channel, const uint32_t* ids, uint8_t count, CanRxClass_t rx_class);
+bool CAN_ChannelConfigureFilterMaskExt(CanChannel_t* channel, const uint32_t* ids, const uint32_t* masks, uint8_t count);
+bool CAN_ChannelTransmit(CanChannel_t* channel, const CanFrame_t* frame);
+bool CAN_ChannelSetRxCoalescing(CanChannel_t* channel, const uint32_t* ids, uint8_t count);
+void CAN_ChannelAddRxAcceptIds(CanChannel_t* channel, const uint32_t* ids, uint8_t count);
+void CAN_ChannelGetTxStats(CanChannel_t* channel, CanTxStats_t* stats);
+void CAN_ChannelSetTxHook(CanChannel_t* channel, CanTxHook_t hook);
+void CAN_ChannelClearError(CanChannel_t* channel);
+void CAN_ChannelRxIRQHandler(CanChannel_t* channel);
+void CAN_ChannelTxIRQHandler(CanChannel_t* channel);
+CanChannel_t* CAN_GetChannel(CanBus_t bus);
+CanDriver_t* CAN_GetDriver(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @file    can_gateway.h
+ * @brief   CAN-to-CAN frame gateway header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef CAN_GATEWAY_H
+#define CAN_GATEWAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Frame forwarding route
+ */
+typedef struct {
+    CanBus_t src_bus;           /* Controller the frame is received on */
+    uint32_t src_id;            /* Received CAN identifier */
+    CanBus_t dst_bus;           /* Controller the frame is forwarded to */
+    uint32_t dst_id;            /* Transmitted identifier (CAN_GW_ID_SAME keeps src_id) */
+    uint16_t min_interval_ms;   /* Rate limit: minimum time between forwards (0 = off) */
+} CanGatewayRoute_t;
+
+/**
+ * @brief Gateway statistics
+ */
+typedef struct {
+    uint32_t frames_forwarded;      /* Frames handed to the destination TX queue */
+    uint32_t frames_rate_limited;   /* Frames suppressed by route rate limit */
+    uint32_t tx_failed;             /* Destination TX queue full */
+    uint32_t isr_cycles_max;        /* Worst RX-ISR-to-TX-request cost */
+    uint32_t isr_cycles_sum;        /* Sum of RX-ISR-to-TX-request costs */
+} CanGatewayStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define CAN_GW_ID_SAME          0xFFFFFFFFU     /* Forward without ID remapping */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool CanGateway_Init(void);
+void CanGateway_ForwardFromIsr(const CanFrame_t* frame);
+void CanGateway_GetStatistics(CanGatewayStats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_GATEWAY_H */
@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file    can_test_generator.h
+ * @brief   CAN traffic generator header for Gateway ECU testing
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef CAN_TEST_GENERATOR_H
+#define CAN_TEST_GENERATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Payload of a generated stream
+ */
+typedef enum {
+    TESTGEN_SIGNAL_NONE = 0,    /* Pseudo-random bytes */
+    TESTGEN_SIGNAL_RPM,         /* Engine RPM, bytes 0-1, raw = rpm * 4 */
+    TESTGEN_SIGNAL_TEMP,        /* Coolant temperature, byte 2, raw = C + 40 */
+    TESTGEN_SIGNAL_SPEED        /* Vehicle speed, bytes 4-5, raw = km/h * 10 */
+} TestGenSignal_t;
+
+/**
+ * @brief One identifier of a traffic mix
+ */
+typedef struct {
+    uint32_t id;                /* CAN identifier (CAN_ID_EXT set for 29-bit) */
+    uint8_t weight;             /* Relative share of the generated frames */
+    uint8_t dlc_min;            /* DLC drawn uniformly from dlc_min..dlc_max */
+    uint8_t dlc_max;
+    uint8_t signal;             /* TestGenSignal_t */
+} TestGenStream_t;
+
+/**
+ * @brief Bus-load profile
+ */
+typedef struct {
+    const char* name;
+    uint8_t load_pct;           /* Target bus load, 100 = as fast as the bus takes */
+    uint8_t burst_frames;       /* Back-to-back frames on top of the load, 0 = none */
+    uint16_t burst_period_ms;
+    const TestGenStream_t* streams;
+    uint8_t stream_count;
+} TestGenProfile_t;
+
+/**
+ * @brief Generator statistics
+ */
+typedef struct {
+    uint32_t frames_sent;       /* Frames accepted by the driver */
+    uint32_t frames_burst;      /* Of which sent as part of a burst */
+    uint32_t tx_rejected;       /* Frames the driver queue refused */
+    uint64_t bits_sent;         /* Estimated bus bits of the frames sent */
+} TestGenStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define TESTGEN_QUEUE_LEVEL     4       /* Frames kept waiting in the driver TX queue */
+#define TESTGEN_CREDIT_MS       2       /* Most pacing credit carried over, in ms of bus time */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool CANTestGenerator_Init(CanBus_t bus, uint32_t bitrate, const TestGenProfile_t* profile, uint32_t seed);
+bool CANTestGenerator_Start(CanBus_t bus, uint32_t bitrate, const TestGenProfile_t* profile, uint32_t seed);
+void CANTestGenerator_Run(void);
+void CANTestGenerator_Stop(void);
+const TestGenProfile_t* CANTestGenerator_GetProfile(uint8_t index);
+const TestGenProfile_t* CANTestGenerator_FindProfile(const char* name);
+void CANTestGenerator_GetStats(TestGenStats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_TEST_GENERATOR_H */
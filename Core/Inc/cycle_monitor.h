@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file    cycle_monitor.h
+ * @brief   Message cycle-time and timeout monitor header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef CYCLE_MONITOR_H
+#define CYCLE_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CYCLE_WHEEL_SLOTS       64      /* Timer wheel slots (power of 2, 1 ms each) */
+#define CYCLE_EWMA_SHIFT        3       /* EWMA weight = 1/8 */
+#define CYCLE_TABLE_SIZE        3       /* Monitored messages */
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Monitored message configuration
+ */
+typedef struct {
+    uint32_t can_id;            /* CAN identifier */
+    uint16_t cycle_ms;          /* Expected cycle time */
+    uint16_t timeout_ms;        /* Reception deadline after last frame */
+} CycleMonitorConfig_t;
+
+/**
+ * @brief Measured cycle-time statistics for one message
+ */
+typedef struct {
+    uint32_t can_id;            /* CAN identifier */
+    uint16_t expected_ms;       /* Configured cycle time */
+    uint16_t min_ms;            /* Shortest measured period */
+    uint16_t max_ms;            /* Longest measured period */
+    uint16_t avg_ms;            /* EWMA of period */
+    uint16_t jitter_ms;         /* EWMA of |period - expected| */
+    uint16_t max_jitter_ms;     /* Largest |period - expected| */
+    uint32_t rx_count;          /* Frames received */
+    uint32_t timeouts;          /* Deadline expirations */
+    bool timed_out;             /* Currently in timeout */
+} CycleStats_t;
+
+/**
+ * @brief Timeout notification callback
+ */
+typedef void (*CycleMonitorCallback_t)(void* context, uint32_t can_id);
+
+/**
+ * @brief Timer wheel node (one per monitored message)
+ */
+typedef struct {
+    uint8_t next;               /* Next node in slot list */
+    uint8_t prev;               /* Previous node in slot list */
+    uint8_t slot;               /* Slot the node is linked into */
+    bool armed;                 /* Node is linked into the wheel */
+    uint16_t rounds;            /* Remaining wheel revolutions */
+} WheelTimer_t;
+
+/**
+ * @brief Runtime state per monitored message
+ */
+typedef struct {
+    uint32_t last_rx;           /* Timestamp of last frame */
+    uint16_t min_ms;
+    uint16_t max_ms;
+    uint32_t avg_scaled;        /* Period EWMA << CYCLE_EWMA_SHIFT */
+    uint32_t jitter_scaled;     /* Jitter EWMA << CYCLE_EWMA_SHIFT */
+    uint16_t max_jitter_ms;
+    uint32_t rx_count;
+    uint32_t timeouts;
+    bool timed_out;
+} CycleState_t;
+
+/**
+ * @brief Cycle monitor with its own timer wheel (one per router)
+ */
+typedef struct {
+    CycleState_t states[CYCLE_TABLE_SIZE];
+    WheelTimer_t timers[CYCLE_TABLE_SIZE];
+    uint8_t slots[CYCLE_WHEEL_SLOTS];   /* Head timer of every slot list */
+    uint32_t tick;                      /* Last tick the wheel was advanced to */
+    bool started;
+    CycleMonitorCallback_t timeout_cb;
+    void* context;                      /* First argument of timeout_cb */
+} CycleMonitor_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void CycleMonitor_Init(CycleMonitor_t* monitor, CycleMonitorCallback_t timeout_callback, void* context);
+void CycleMonitor_OnFrame(CycleMonitor_t* monitor, uint32_t can_id, uint32_t timestamp);
+void CycleMonitor_Process(CycleMonitor_t* monitor, uint32_t now);
+uint16_t CycleMonitor_GetCount(void);
+bool CycleMonitor_GetStats(const CycleMonitor_t* monitor, uint16_t index, CycleStats_t* stats);
+void CycleMonitor_ClearStats(CycleMonitor_t* monitor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYCLE_MONITOR_H */
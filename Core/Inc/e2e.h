@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ * @file    e2e.h
+ * @brief   End-to-end payload protection check header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef E2E_H
+#define E2E_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef E2E_CRC_HW
+#define E2E_CRC_HW              1       /* 1 = CRC peripheral, 0 = software (host build) */
+#endif
+#define E2E_TABLE_SIZE          1       /* Protected identifiers */
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Result of one E2E check
+ */
+typedef enum {
+    E2E_STATUS_OK = 0,          /* Counter incremented by one */
+    E2E_STATUS_OK_SOME_LOST,    /* Counter jumped within max_delta_counter */
+    E2E_STATUS_INITIAL,         /* First frame, no counter reference yet */
+    E2E_STATUS_REPEATED,        /* Same counter as previous frame */
+    E2E_STATUS_WRONG_SEQUENCE,  /* Counter jumped beyond max_delta_counter */
+    E2E_STATUS_CRC_ERROR,       /* CRC mismatch */
+    E2E_STATUS_NOT_PROTECTED    /* Identifier has no E2E configuration */
+} E2eStatus_t;
+
+/**
+ * @brief E2E protected message configuration
+ * @note  Layout: byte 0 = CRC, low nibble of byte 1 = alive counter (0-15).
+ */
+typedef struct {
+    uint32_t can_id;            /* CAN identifier */
+    uint16_t data_id;           /* Data ID folded into the CRC */
+    uint8_t dlc;                /* Expected DLC */
+    uint8_t max_delta_counter;  /* Largest accepted counter jump */
+} E2eConfig_t;
+
+/**
+ * @brief Per-identifier E2E counters
+ */
+typedef struct {
+    uint32_t can_id;
+    uint32_t frames_ok;         /* OK and OK_SOME_LOST */
+    uint32_t crc_errors;        /* CRC mismatch or wrong DLC */
+    uint32_t repeated;          /* Repeated counter value */
+    uint32_t lost;              /* Frames missing according to counter jumps */
+    uint32_t wrong_sequence;    /* Jumps beyond max_delta_counter */
+} E2eStats_t;
+
+/**
+ * @brief Counter state of one protected identifier
+ */
+typedef struct {
+    bool initialized;
+    uint8_t last_counter;
+} E2eState_t;
+
+/**
+ * @brief E2E check state and counters (one per router)
+ */
+typedef struct {
+    E2eState_t state[E2E_TABLE_SIZE];
+    E2eStats_t stats[E2E_TABLE_SIZE];
+} E2eChecker_t;
+
+/**
+ * @brief CRC throughput measurement (DWT cycles per frame check)
+ */
+typedef struct {
+    uint32_t hw_cycles;         /* CRC peripheral (0 if not available) */
+    uint32_t sw_cycles;         /* Table-driven software CRC */
+} E2eBenchmark_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void E2E_Init(E2eChecker_t* checker);
+E2eStatus_t E2E_Check(E2eChecker_t* checker, const CanFrame_t* frame);
+uint8_t E2E_ComputeCrc(const uint8_t* data, uint16_t data_id);
+uint8_t E2E_ComputeCrcSoftware(const uint8_t* data, uint16_t data_id);
+uint16_t E2E_GetCount(void);
+bool E2E_GetStats(const E2eChecker_t* checker, uint16_t index, E2eStats_t* stats);
+void E2E_MeasureThroughput(uint32_t iterations, E2eBenchmark_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E2E_H */
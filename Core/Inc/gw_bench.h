@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @file    gw_bench.h
+ * @brief   Router and driver hot-path microbenchmarks header
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef GW_BENCH_H
+#define GW_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "pdu_router.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Sink for result lines (UART_Write on target, stdout on the host)
+ */
+typedef bool (*BenchPrint_t)(const char* line);
+
+/* Exported constants --------------------------------------------------------*/
+#define BENCH_FORMAT_VERSION    1       /* Bumped when result columns change */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+#if GATEWAY_BENCH
+void Bench_Run(uint32_t iterations, BenchPrint_t print);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GW_BENCH_H */
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @file    gw_selftest.h
+ * @brief   Loopback throughput self-test header
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef GW_SELFTEST_H
+#define GW_SELFTEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Sink for result lines (UART_Write on target)
+ */
+typedef bool (*SelfTestPrint_t)(const char* line);
+
+/**
+ * @brief Self-test results
+ */
+typedef struct {
+    uint32_t duration_ms;
+    uint32_t frames_sent;       /* Frames the generator queued */
+    uint32_t frames_received;   /* Frames read from the receive FIFO */
+    uint32_t frames_processed;  /* Frames through Router_ProcessCanFrame() */
+    uint32_t rx_dropped;        /* Frames lost to a full RX class queue */
+    uint32_t fifo_overruns;     /* Frames lost in the hardware FIFO */
+    uint32_t uart_dropped;      /* Router lines refused by a full UART TX ring */
+    uint32_t frames_per_sec;    /* Processed frames per second */
+    uint16_t cpu_load_permille; /* Main loop busy share, 0 if not calibrated */
+} SelfTestResult_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define SELFTEST_CALIBRATE_MS   200     /* Idle main-loop measurement before the run */
+#define SELFTEST_DRAIN_MS       2000    /* Longest wait for the UART to empty */
+#define SELFTEST_SEED           0x5E1F7E57U
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool SelfTest_RunLoopback(CanBus_t bus, uint32_t bitrate, uint32_t seconds, SelfTestPrint_t print);
+bool SelfTest_Start(CanBus_t bus, uint32_t bitrate, uint32_t seconds);
+bool SelfTest_Poll(void);
+void SelfTest_Finish(SelfTestResult_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GW_SELFTEST_H */
@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ * @file    isotp.h
+ * @brief   ISO 15765-2 (ISO-TP) transport layer header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef ISOTP_H
+#define ISOTP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Frame transmit function (returns false if the frame was not accepted)
+ */
+typedef bool (*IsoTpSendFn_t)(void* context, uint32_t id, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief Complete message reception callback
+ */
+typedef void (*IsoTpReceiveFn_t)(void* context, const uint8_t* data, uint16_t length);
+
+/**
+ * @brief Link state (one direction each)
+ */
+typedef enum {
+    ISOTP_STATE_IDLE = 0,
+    ISOTP_STATE_WAIT_FC,        /* TX: first frame or block sent, waiting for flow control */
+    ISOTP_STATE_SENDING,        /* TX: sending consecutive frames */
+    ISOTP_STATE_RECEIVING       /* RX: collecting consecutive frames */
+} IsoTpState_t;
+
+/**
+ * @brief Link configuration
+ */
+typedef struct {
+    uint32_t tx_id;             /* Identifier of frames sent by this endpoint */
+    uint32_t rx_id;             /* Identifier of frames received by this endpoint */
+    uint8_t block_size;         /* BS announced in our flow control (0 = no limit) */
+    uint8_t st_min;             /* STmin announced in our flow control (ISO encoding) */
+    uint16_t timeout_ms;        /* N_Bs / N_Cr timeout */
+    bool padding;               /* Pad every frame to 8 bytes */
+} IsoTpConfig_t;
+
+/**
+ * @brief Link statistics
+ */
+typedef struct {
+    uint32_t messages_sent;
+    uint32_t messages_received;
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    uint32_t timeouts;
+    uint32_t sequence_errors;
+    uint32_t pool_exhausted;        /* Reassembly refused: no free pool buffer */
+    uint32_t overflow_aborts;       /* Peer reported overflow */
+} IsoTpStats_t;
+
+/**
+ * @brief ISO-TP link (one pair of identifiers, full duplex)
+ */
+typedef struct {
+    IsoTpConfig_t config;
+    IsoTpSendFn_t send;
+    IsoTpReceiveFn_t on_receive;
+    void* context;
+    
+    /* Transmit direction */
+    IsoTpState_t tx_state;
+    const uint8_t* tx_data;     /* Caller buffer, must stay valid until completion */
+    uint16_t tx_length;
+    uint16_t tx_offset;
+    uint8_t tx_sn;
+    uint8_t tx_block_left;      /* CFs left in current block (0 = unlimited) */
+    uint8_t tx_block_size;      /* BS from peer flow control */
+    uint8_t tx_st_min_ms;       /* STmin from peer flow control, in ms */
+    uint32_t tx_timer;          /* Deadline / next CF time */
+    
+    /* Receive direction */
+    IsoTpState_t rx_state;
+    uint8_t* rx_buffer;         /* Pool buffer while receiving */
+    uint16_t rx_length;
+    uint16_t rx_offset;
+    uint8_t rx_sn;
+    uint8_t rx_block_count;
+    uint32_t rx_timer;
+    
+    IsoTpStats_t stats;
+} IsoTpLink_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define ISOTP_MAX_PAYLOAD       4095    /* Max message length (12-bit FF_DL) */
+#define ISOTP_POOL_BUFFERS      2       /* Static reassembly buffers */
+#define ISOTP_DEFAULT_TIMEOUT   1000    /* N_Bs / N_Cr in ms */
+#define ISOTP_PAD_BYTE          0xCC
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void IsoTp_Init(IsoTpLink_t* link, const IsoTpConfig_t* config, IsoTpSendFn_t send,
+                IsoTpReceiveFn_t on_receive, void* context);
+bool IsoTp_Send(IsoTpLink_t* link, const uint8_t* data, uint16_t length, uint32_t now);
+void IsoTp_OnFrame(IsoTpLink_t* link, const CanFrame_t* frame, uint32_t now);
+void IsoTp_Poll(IsoTpLink_t* link, uint32_t now);
+bool IsoTp_IsBusy(const IsoTpLink_t* link);
+bool IsoTp_CanSend(void* context, uint32_t id, const uint8_t* data, uint8_t dlc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ISOTP_H */
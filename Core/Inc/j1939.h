@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * @file    j1939.h
+ * @brief   SAE J1939 PGN routing header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef J1939_H
+#define J1939_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Decoded J1939 message (single frame or reassembled BAM)
+ */
+typedef struct {
+    uint32_t pgn;               /* Parameter group number (DA stripped for PDU1) */
+    uint8_t priority;           /* Priority (0-7) */
+    uint8_t source;             /* Source address */
+    uint8_t destination;        /* Destination address (J1939_ADDR_GLOBAL for PDU2) */
+    uint8_t bus;                /* Controller the message was received on (CanBus_t) */
+    uint16_t length;            /* Payload length (up to J1939_BAM_MAX_SIZE) */
+    const uint8_t* data;        /* Payload */
+    uint32_t timestamp;         /* Reception tick of last frame */
+} J1939Message_t;
+
+/**
+ * @brief PGN handler, called from main loop context
+ */
+typedef void (*J1939Handler_t)(const J1939Message_t* msg);
+
+/**
+ * @brief PGN route
+ */
+typedef struct {
+    uint32_t pgn;               /* Parameter group number */
+    CanBus_t src_bus;           /* Controller the PGN is received on */
+    uint16_t source;            /* Source address filter (J1939_MATCH_ANY = ignore) */
+    uint8_t priority;           /* Priority filter (J1939_PRIORITY_ANY = ignore) */
+    CanBus_t dst_bus;           /* Forward single frames unchanged (CAN_BUS_COUNT = no forward) */
+    J1939Handler_t handler;     /* Handler (NULL = forward only) */
+} J1939Route_t;
+
+/**
+ * @brief J1939 statistics
+ */
+typedef struct {
+    uint32_t frames_received;       /* 29-bit frames processed */
+    uint32_t messages_dispatched;   /* Messages delivered to a handler */
+    uint32_t messages_unrouted;     /* Messages without matching route */
+    uint32_t frames_forwarded;      /* Frames forwarded to another controller */
+    uint32_t forward_failed;        /* Forward rejected by TX queue */
+    uint32_t bam_completed;         /* BAM transfers reassembled */
+    uint32_t bam_aborted;           /* BAM transfers dropped (timeout, sequence) */
+    uint32_t bam_no_session;        /* BAM announcements without free session */
+} J1939Stats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define J1939_ADDR_GLOBAL       0xFF    /* Global destination address */
+#define J1939_MATCH_ANY         0xFFFF  /* Route source address wildcard */
+#define J1939_PRIORITY_ANY      0xFF    /* Route priority wildcard */
+
+#define J1939_PGN_TP_CM         0xEC00  /* Transport protocol connection management */
+#define J1939_PGN_TP_DT         0xEB00  /* Transport protocol data transfer */
+
+#define J1939_BAM_MAX_SIZE      1785    /* 255 packets x 7 bytes */
+#define J1939_BAM_SESSIONS      2       /* Concurrent BAM reassemblies */
+#define J1939_BAM_TIMEOUT_MS    750     /* T1: max gap between data packets */
+#define J1939_HASH_SIZE         32      /* PGN hash buckets (power of two) */
+
+/* Exported macro ------------------------------------------------------------*/
+#define J1939_ID_PRIORITY(id)   (((id) >> 26) & 0x07)
+#define J1939_ID_PF(id)         (((id) >> 16) & 0xFF)
+#define J1939_ID_PS(id)         (((id) >> 8) & 0xFF)
+#define J1939_ID_SA(id)         ((id) & 0xFF)
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool J1939_Init(void);
+void J1939_ProcessCanFrame(const CanFrame_t* frame);
+void J1939_Poll(void);
+void J1939_GetStatistics(J1939Stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* J1939_H */
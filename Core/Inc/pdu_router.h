@@ -17,9 +17,23 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "can_drv.h"
 #include "uart_drv.h"
+#include "signal_store.h"
+#include "e2e.h"
+#include "cycle_monitor.h"
+#include "pdu_tx.h"
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Exported constants --------------------------------------------------------*/
+#define ROUTER_SNAPSHOT_PERIOD_MS   50      /* Default snapshot record period */
+#define ROUTER_MUX_MAX_VALUES       16      /* Jump table size per multiplexed message */
+#define ROUTER_SIGNAL_TABLE_SIZE    8       /* Configured signals */
+#define ROUTER_MUX_TABLE_SIZE       1       /* Multiplexed messages */
+
+#ifndef GATEWAY_BENCH
+#define GATEWAY_BENCH               0       /* 1 = hot-path benchmark build (gw_bench.c) */
+#endif
+
 /* Exported types ------------------------------------------------------------*/
 
 /**
@@ -33,8 +47,29 @@ typedef struct {
     float offset;               /* Offset value */
     const char* format_string;  /* Printf format string for UART output */
     const char* signal_name;    /* Signal name for debugging */
+    const char* snapshot_label; /* Field label in snapshot records */
+    uint8_t snapshot_divisor;   /* Emit every Nth snapshot period (0/1 = every period) */
+    uint8_t mux_value;          /* Selector value carrying this signal (multiplexed IDs only) */
+    uint8_t rx_class;           /* CanRxClass_t queue of the source frame (default normal) */
 } SignalConfig_t;
 
+/**
+ * @brief Multiplexed message: a selector field picks the signal group
+ */
+typedef struct {
+    uint32_t can_id;            /* CAN identifier */
+    uint8_t selector_byte;      /* Byte holding the selector */
+    uint8_t selector_mask;      /* Selector bits, any position (field < ROUTER_MUX_MAX_VALUES) */
+} MuxConfig_t;
+
+/**
+ * @brief Router output mode
+ */
+typedef enum {
+    ROUTER_OUTPUT_EVENT = 0,    /* One UART line per routed frame */
+    ROUTER_OUTPUT_SNAPSHOT      /* One aggregated record per snapshot period */
+} RouterOutputMode_t;
+
 /**
  * @brief Router statistics
  */
@@ -44,9 +79,53 @@ typedef struct {
     uint32_t frames_dropped;
     uint32_t uart_errors;
     uint32_t can_errors;
+    uint32_t snapshots_sent;
+    uint32_t signal_timeouts;
+    uint32_t mux_unknown;       /* Multiplexed frames with unconfigured selector value */
+    uint32_t e2e_rejected;      /* Frames failing the E2E check (CRC, counter) */
 } RouterStats_t;
 
-/* Exported constants --------------------------------------------------------*/
+/**
+ * @brief Signal group of one selector value (slice of Router_t mux_members)
+ */
+typedef struct {
+    uint8_t first;              /* Index of first member in mux_members */
+    uint8_t count;              /* Number of members */
+} MuxGroup_t;
+
+/**
+ * @brief Selector field of a multiplexed message, normalized at init
+ */
+typedef struct {
+    uint8_t shift;              /* Lowest set bit of selector_mask */
+    uint8_t mask;               /* selector_mask >> shift, 0 if the field is rejected */
+} MuxField_t;
+
+/**
+ * @brief Router instance bound to its UART sink and bxCAN pair
+ * @note  Each instance owns its signal store, E2E counters, cycle monitor,
+ *        PDU scheduler and mux jump tables; only the constant signal,
+ *        E2E, cycle and PDU tables are shared. Routers must use different
+ *        controllers: the list filters and RX accept bitmap programmed at
+ *        init belong to the channel. The Router_Xxx() functions use the
+ *        instance returned by Router_GetInstance().
+ */
+typedef struct {
+    UartPort_t* uart;                   /* Output of event lines and snapshot records */
+    CanChannel_t* can;                  /* Controller carrying the routed signals */
+    RouterStats_t stats;
+    RouterOutputMode_t output_mode;
+    uint32_t snapshot_period_ms;
+    uint32_t last_snapshot_time;
+    uint32_t snapshot_counter;
+    SignalStore_t store;                /* Latest value of every routed signal */
+    E2eChecker_t e2e;                   /* Counter state of protected messages */
+    CycleMonitor_t cycle;               /* Reception deadlines of periodic messages */
+    PduTx_t pdu_tx;                     /* Outgoing PDUs packed from the store */
+    MuxGroup_t mux_jump[ROUTER_MUX_TABLE_SIZE][ROUTER_MUX_MAX_VALUES];
+    uint8_t mux_members[ROUTER_SIGNAL_TABLE_SIZE];
+    MuxField_t mux_fields[ROUTER_MUX_TABLE_SIZE];
+} Router_t;
 
 /* Exported macro ------------------------------------------------------------*/
 
@@ -56,6 +135,25 @@ void Router_ProcessCanFrame(const CanFrame_t* frame);
 void Router_Poll(void);
 void Router_GetStatistics(RouterStats_t* stats);
 void Router_ClearStatistics(void);
+void Router_SetOutputMode(RouterOutputMode_t mode, uint32_t period_ms);
+RouterOutputMode_t Router_GetOutputMode(void);
+uint16_t Router_GetSignalCount(void);
+const SignalConfig_t* Router_GetSignalConfig(SignalHandle_t handle);
+void Router_InstanceInit(Router_t* router, UartPort_t* uart, CanChannel_t* const can[CAN_BUS_COUNT]);
+void Router_InstanceProcessCanFrame(Router_t* router, const CanFrame_t* frame);
+void Router_InstancePoll(Router_t* router);
+void Router_InstanceGetStatistics(const Router_t* router, RouterStats_t* stats);
+void Router_InstanceClearStatistics(Router_t* router);
+void Router_InstanceSetOutputMode(Router_t* router, RouterOutputMode_t mode, uint32_t period_ms);
+RouterOutputMode_t Router_InstanceGetOutputMode(const Router_t* router);
+Router_t* Router_GetInstance(void);
+
+#if GATEWAY_BENCH
+/* Access to private router stages, benchmark build only */
+const SignalConfig_t* Router_BenchFindSignalConfig(uint32_t can_id);
+uint32_t Router_BenchExtractSignalValue(const uint8_t* data, const SignalConfig_t* config);
+void Router_BenchFormatAndSendSignal(const SignalConfig_t* config, uint32_t raw_value);
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * @file    pdu_tx.h
+ * @brief   Outgoing PDU packing and transmit scheduler header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef PDU_TX_H
+#define PDU_TX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include "signal_store.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define PDU_TX_ID_POWERTRAIN    0x280   /* Repacked powertrain status on CAN2; kept clear of
+                                           the IDs other CAN2 nodes send (0x200 is routed) */
+#define PDU_TX_TABLE_SIZE       1       /* Outgoing PDUs */
+#define PDU_TX_SIGNAL_COUNT     3       /* Signal placements of all PDUs */
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Signal byte order inside an outgoing PDU
+ */
+typedef enum {
+    PDU_BYTE_ORDER_INTEL = 0,   /* Little-endian, start_bit = LSB */
+    PDU_BYTE_ORDER_MOTOROLA     /* Big-endian, start_bit = MSB (DBC numbering) */
+} PduByteOrder_t;
+
+/**
+ * @brief Outgoing PDU transmission mode
+ */
+typedef enum {
+    PDU_TX_CYCLIC = 0x01,       /* Transmit every cycle_ms */
+    PDU_TX_ON_CHANGE = 0x02,    /* Transmit when packed payload changes */
+    PDU_TX_MIXED = 0x03         /* Both */
+} PduTxMode_t;
+
+/**
+ * @brief Signal placement inside an outgoing PDU
+ */
+typedef struct {
+    SignalHandle_t source;      /* Source signal (router signal handle) */
+    uint8_t start_bit;          /* Start bit (see PduByteOrder_t) */
+    uint8_t bit_length;         /* Field length in bits (1-32) */
+    PduByteOrder_t byte_order;  /* Byte order */
+    float scale;                /* Physical = raw * scale + offset */
+    float offset;
+} PduTxSignal_t;
+
+/**
+ * @brief Outgoing PDU configuration
+ */
+typedef struct {
+    uint32_t can_id;            /* Transmitted CAN identifier */
+    CanBus_t bus;               /* Controller to transmit on */
+    uint8_t dlc;                /* Data length code */
+    PduTxMode_t mode;           /* Transmission mode */
+    uint16_t cycle_ms;          /* Cyclic period */
+    uint16_t min_delay_ms;      /* Minimum gap between on-change transmissions */
+    uint8_t first_signal;       /* Index of first signal in the signal table */
+    uint8_t signal_count;       /* Number of signals packed into this PDU */
+} PduTxConfig_t;
+
+/**
+ * @brief Outgoing PDU statistics
+ */
+typedef struct {
+    uint32_t pdus_sent;
+    uint32_t cyclic_sent;
+    uint32_t change_sent;
+    uint32_t tx_failed;
+} PduTxStats_t;
+
+/**
+ * @brief Precomputed packing parameters per signal
+ */
+typedef struct {
+    uint64_t mask;              /* Field mask in the (possibly reversed) payload word */
+    uint8_t shift;              /* LSB position in that word */
+    bool motorola;              /* Field lives in the byte-reversed word */
+    float inv_scale;            /* 1 / scale */
+} PduTxPackInfo_t;
+
+/**
+ * @brief Runtime state per outgoing PDU
+ */
+typedef struct {
+    uint64_t shadow;            /* Last packed payload (little-endian word) */
+    uint32_t last_cyclic_tx;    /* Tick of last cyclic transmission */
+    uint32_t last_tx;           /* Tick of last transmission (any reason) */
+    bool change_pending;        /* Shadow changed and not yet transmitted */
+} PduTxState_t;
+
+/**
+ * @brief PDU scheduler bound to its signal store and controllers (one per router)
+ */
+typedef struct {
+    const SignalStore_t* store;                 /* Source of the packed values */
+    CanChannel_t* channels[CAN_BUS_COUNT];      /* Controller of every PduTxConfig_t bus */
+    PduTxPackInfo_t pack_info[PDU_TX_SIGNAL_COUNT];
+    uint32_t signal_pdu_mask[SIGNAL_STORE_MAX_SIGNALS];     /* Bit n = PDU n uses signal */
+    PduTxState_t states[PDU_TX_TABLE_SIZE];
+    uint32_t dirty;                             /* Bit n = PDU n needs repacking */
+    PduTxStats_t stats;
+} PduTx_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void PduTx_Init(PduTx_t* pdu_tx, const SignalStore_t* store, CanChannel_t* const channels[CAN_BUS_COUNT]);
+void PduTx_OnSignalUpdate(PduTx_t* pdu_tx, SignalHandle_t handle);
+void PduTx_Process(PduTx_t* pdu_tx, uint32_t now);
+void PduTx_GetStatistics(const PduTx_t* pdu_tx, PduTxStats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PDU_TX_H */
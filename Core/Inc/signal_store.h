@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * @file    signal_store.h
+ * @brief   Latest-value signal store header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef SIGNAL_STORE_H
+#define SIGNAL_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define SIGNAL_STORE_MAX_SIGNALS    16      /* Store capacity (signal handles) */
+#define SIGNAL_STORE_READ_RETRIES   8       /* Seqlock retries before giving up */
+#define SIGNAL_HANDLE_INVALID       0xFFFFU
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Signal handle (index into the router signal table)
+ */
+typedef uint16_t SignalHandle_t;
+
+/**
+ * @brief Signal status
+ */
+typedef enum {
+    SIGNAL_STATUS_NEVER_RECEIVED = 0,
+    SIGNAL_STATUS_VALID,
+    SIGNAL_STATUS_TIMEOUT,
+    SIGNAL_STATUS_INVALID
+} SignalStatus_t;
+
+/**
+ * @brief Latest known state of one signal
+ */
+typedef struct {
+    int32_t value;              /* Engineering value (rounded) */
+    uint32_t timestamp;         /* Tick of last update */
+    uint32_t update_count;      /* Number of updates since init */
+    SignalStatus_t status;      /* Signal status */
+} SignalState_t;
+
+/**
+ * @brief Latest-value store (one per router)
+ */
+typedef struct {
+    SignalState_t states[SIGNAL_STORE_MAX_SIGNALS];
+    volatile uint32_t sequence;     /* Odd while an update is in progress */
+} SignalStore_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void SignalStore_Init(SignalStore_t* store);
+void SignalStore_Write(SignalStore_t* store, SignalHandle_t handle, int32_t value, uint32_t timestamp);
+void SignalStore_SetStatus(SignalStore_t* store, SignalHandle_t handle, SignalStatus_t status);
+bool SignalStore_Read(const SignalStore_t* store, SignalHandle_t handle, SignalState_t* state);
+bool SignalStore_ReadMulti(const SignalStore_t* store, const SignalHandle_t* handles, uint8_t count,
+                           SignalState_t* states);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIGNAL_STORE_H */
@@ -31,6 +31,11 @@ extern "C" {
 #define CAN1_GPIO_PORT          GPIOA
 #define CAN1_GPIO_AF            GPIO_AF9_CAN1
 
+#define CAN2_RX_PIN             GPIO_PIN_12
+#define CAN2_TX_PIN             GPIO_PIN_13
+#define CAN2_GPIO_PORT          GPIOB
+#define CAN2_GPIO_AF            GPIO_AF9_CAN2
+
 /* UART Pin Configuration */
 #define USART3_TX_PIN           GPIO_PIN_10
 #define USART3_RX_PIN           GPIO_PIN_11
@@ -44,6 +49,7 @@ void SystemConfig_Init(void);
 void SystemClock_Config(void);
 void GPIO_Config(void);
 void NVIC_Config(void);
+void DWT_Config(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * @file    uart_cmd.h
+ * @brief   Binary UART command channel header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef UART_CMD_H
+#define UART_CMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include "uart_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Command codes (first byte of a decoded packet)
+ *
+ * Packet layout (before COBS encoding, 0x00 delimited on the wire):
+ *   [cmd][seq][payload...][chk]   chk makes the byte sum of the packet 0
+ *
+ * Payloads (multi-byte fields little-endian, id bit 31 = 29-bit identifier):
+ *   TX_FRAME:  bus, id(4), dlc, data[dlc]
+ *   TX_BURST:  bus, count, count x { id(4), dlc, data[dlc] }
+ *   PERIODIC:  slot, bus, id(4), dlc, data[dlc], period_ms(2)  (period 0 stops slot)
+ *   ACK (out): last_seq, ok(2), failed(2)
+ */
+typedef enum {
+    UART_CMD_TX_FRAME = 0x01,
+    UART_CMD_TX_BURST = 0x02,
+    UART_CMD_PERIODIC = 0x03,
+    UART_CMD_ACK = 0x80
+} UartCmdCode_t;
+
+/**
+ * @brief Command channel statistics
+ */
+typedef struct {
+    uint32_t packets_ok;            /* Valid command packets */
+    uint32_t packets_bad;           /* COBS, checksum or length errors */
+    uint32_t frames_injected;       /* CAN frames accepted by the TX queue */
+    uint32_t frames_rejected;       /* CAN frames rejected (queue full/invalid) */
+    uint32_t acks_sent;             /* Batched acknowledgements sent */
+} UartCmdStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define UART_CMD_MAX_PACKET         128     /* Max decoded packet length */
+#define UART_CMD_PERIODIC_SLOTS     8       /* Periodic transmit slots */
+#define UART_CMD_ACK_INTERVAL_MS    20      /* Max delay of a batched ACK */
+#define UART_CMD_ACK_BATCH          64      /* ACK early after this many commands */
+#define UART_CMD_RX_BUDGET          256     /* Max RX bytes handled per call */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void UartCmd_Init(void);
+void UartCmd_Process(void);
+void UartCmd_GetStatistics(UartCmdStats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_CMD_H */
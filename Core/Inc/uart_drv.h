@@ -19,6 +19,10 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Exported constants --------------------------------------------------------*/
+#define UART_TX_BUFFER_SIZE     1024    /* TX ring buffer size */
+#define UART_RX_BUFFER_SIZE     512     /* RX ring buffer size */
+
 /* Exported types ------------------------------------------------------------*/
 
 /**
@@ -32,13 +36,41 @@ typedef enum {
     UART_ERROR_BUFFER_FULL
 } UartError_t;
 
-/* Exported constants --------------------------------------------------------*/
-#define UART_TX_BUFFER_SIZE     256     /* TX ring buffer size */
-#define UART_RX_BUFFER_SIZE     128     /* RX ring buffer size */
+/**
+ * @brief UART port: one USART and its ring buffers
+ * @note  The UART_Xxx() functions work on the USART3 port of the gateway;
+ *        UART_PortXxx() take the port explicitly, for further USARTs or
+ *        several gateways in one host process.
+ */
+typedef struct {
+    USART_TypeDef* usart;               /* Bound peripheral */
+    uint8_t tx_buffer[UART_TX_BUFFER_SIZE];
+    volatile uint16_t tx_head;
+    volatile uint16_t tx_tail;
+    volatile uint16_t tx_count;
+    volatile bool tx_in_progress;
+    uint32_t tx_rejected;               /* Writes refused because the TX ring was full */
+    uint8_t rx_buffer[UART_RX_BUFFER_SIZE];
+    volatile uint16_t rx_head;
+    volatile uint16_t rx_tail;
+    volatile uint16_t rx_count;
+    volatile UartError_t last_error;
+} UartPort_t;
 
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported functions prototypes ---------------------------------------------*/
+bool UART_PortInit(UartPort_t* port, USART_TypeDef* usart, uint32_t baudrate);
+bool UART_PortWrite(UartPort_t* port, const char* str);
+bool UART_PortWriteData(UartPort_t* port, const uint8_t* data, uint16_t length);
+bool UART_PortRead(UartPort_t* port, char* data, uint16_t* length);
+uint16_t UART_PortGetTxFreeSpace(const UartPort_t* port);
+uint16_t UART_PortGetRxCount(const UartPort_t* port);
+UartError_t UART_PortGetLastError(const UartPort_t* port);
+void UART_PortClearError(UartPort_t* port);
+void UART_PortIRQHandler(UartPort_t* port);
+UartPort_t* UART_GetPort(void);
+
 bool UART_Init(uint32_t baudrate);
 bool UART_Write(const char* str);
 bool UART_WriteData(const uint8_t* data, uint16_t length);
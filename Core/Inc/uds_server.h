@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @file    uds_server.h
+ * @brief   UDS diagnostic server header for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef UDS_SERVER_H
+#define UDS_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_drv.h"
+#include "signal_store.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Data identifier mapped to a router signal
+ */
+typedef struct {
+    uint16_t did;               /* Data identifier (0xF2xx = periodic capable) */
+    uint32_t can_id;            /* Router signal source CAN ID */
+    uint8_t size;               /* Encoded size in bytes (1, 2 or 4, big-endian) */
+} UdsDidConfig_t;
+
+/**
+ * @brief Periodic transmission rate (0x2A transmissionMode)
+ */
+typedef enum {
+    UDS_RATE_SLOW = 0x01,
+    UDS_RATE_MEDIUM = 0x02,
+    UDS_RATE_FAST = 0x03,
+    UDS_RATE_STOP = 0x04
+} UdsRate_t;
+
+/**
+ * @brief UDS server statistics
+ */
+typedef struct {
+    uint32_t requests;              /* Requests received */
+    uint32_t positive_responses;    /* Positive responses sent */
+    uint32_t negative_responses;    /* Negative responses sent */
+    uint32_t responses_dropped;     /* Response not sent, ISO-TP link busy */
+    uint32_t periodic_frames;       /* Periodic frames sent */
+    uint32_t periodic_records;      /* Periodic DID records sent */
+    uint32_t periodic_tx_failed;    /* Periodic frames not accepted by TX queue */
+} UdsStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define UDS_REQUEST_ID          CAN_FILTER_ID_DIAG_REQ  /* Physical request */
+#define UDS_RESPONSE_ID         0x7E8   /* Physical response */
+#define UDS_PERIODIC_ID         0x5E8   /* Periodic data (UUDT, no ISO-TP PCI) */
+#define UDS_BUS                 CAN_BUS_1
+
+#define UDS_RATE_SLOW_MS        1000    /* Periodic slow rate */
+#define UDS_RATE_MEDIUM_MS      200     /* Periodic medium rate */
+#define UDS_RATE_FAST_MS        50      /* Periodic fast rate */
+#define UDS_PERIODIC_MAX        8       /* Concurrently scheduled periodic DIDs */
+#define UDS_MAX_RESPONSE        256     /* Response buffer size */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Uds_Init(void);
+bool Uds_ProcessCanFrame(const CanFrame_t* frame);
+void Uds_Poll(void);
+void Uds_GetStatistics(UdsStats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDS_SERVER_H */
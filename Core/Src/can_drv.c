@@ -10,118 +10,208 @@
 /* Includes ------------------------------------------------------------------*/
 #include "can_drv.h"
 #include "system_config.h"
+#include <string.h>
 
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
-#define CAN_TIMEOUT_MS          100
+#define CAN_FILTER_BANK_CAN1_DIAG   1   /* Bank 0 holds the CAN1 mask filter */
+#define CAN_FILTER_BANK_CAN1_LIST   2   /* Bank 1 holds the diagnostic request ID */
+#define CAN_TSR_TME_ANY         (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)
+#define CAN_TX_MAILBOX_COUNT    3
+#define CAN_FILTER16_IDE        (1U << 3)   /* IDE bit of a 16-bit filter */
+#define CAN_RX_NONE             0xFF    /* No ring slot / no coalescing entry */
 
 /* Private macro -------------------------------------------------------------*/
+/* Accept bitmap lookup straight from RIR: STID[10:5] is the word, STID[4:0] the bit */
+#define CAN_RX_ID_ACCEPTED(channel, rir) \
+    (((channel)->rx_accept[(rir) >> 26] >> (((rir) >> CAN_RI0R_STID_Pos) & 0x1FU)) & 1U)
 
 /* Private variables ---------------------------------------------------------*/
-static CanFrame_t rx_buffer[CAN_RX_BUFFER_SIZE];
-static volatile uint16_t rx_head = 0;
-static volatile uint16_t rx_tail = 0;
-static volatile uint16_t rx_count = 0;
-static volatile CanError_t last_error = CAN_ERROR_NONE;
+static CAN_TypeDef* const can_regs[CAN_BUS_COUNT] = { CAN1, CAN2 };
+
+/* bxCAN pair of the gateway, used by the CAN_Xxx() functions */
+static CanDriver_t can_driver = { .filter_regs = CAN1 };
+static CanChannel_t can_channels[CAN_BUS_COUNT] = {
+    { .regs = CAN1, .driver = &can_driver, .bus = CAN_BUS_1, .list_bank_next = CAN_FILTER_BANK_CAN1_LIST },
+    { .regs = CAN2, .driver = &can_driver, .bus = CAN_BUS_2, .list_bank_next = CAN_FILTER_BANK_CAN2 }
+};
+
+/* Strict priority drain order */
+static const uint8_t rx_class_order[CAN_RX_CLASS_COUNT] = {
+    CAN_RX_CLASS_HIGH, CAN_RX_CLASS_NORMAL, CAN_RX_CLASS_LOW
+};
+
+/* BTR test mode bits per CanMode_t */
+static const uint32_t can_mode_bits[] = {
+    0, CAN_BTR_LBKM, CAN_BTR_SILM, CAN_BTR_LBKM | CAN_BTR_SILM
+};
 
 /* Private function prototypes -----------------------------------------------*/
-static void CAN_ConfigureBitTiming(uint32_t baudrate);
-static void CAN_ConfigureFilters(void);
-static bool CAN_WaitForTxMailbox(void);
+static bool CAN_ConfigureBitTiming(CAN_TypeDef* can, uint32_t baudrate);
+static void CAN_ConfigureFilters(CanChannel_t* channel);
+static void CAN_LoadMailbox(CAN_TypeDef* can, uint32_t mailbox, const CanFrame_t* frame);
+static void CAN_RecordTxLatency(CanTxQueue_t* queue, uint32_t stamp);
+static uint8_t CAN_FindCoalesceEntry(const CanDriver_t* driver, uint8_t bus, uint32_t id);
+static void CAN_RebuildFmiMap(CanChannel_t* channel);
+static bool CAN_IsListed(const CanChannel_t* channel, uint32_t id, CanRxClass_t rx_class);
+__STATIC_FORCEINLINE bool CAN_QueueTx(CanChannel_t* channel, const CanFrame_t* frame);
+__STATIC_FORCEINLINE bool CAN_DequeueRx(CanDriver_t* driver, CanFrame_t* frame);
+__STATIC_FORCEINLINE void CAN_ServiceRx(CanChannel_t* channel, CanDriver_t* driver);
+__STATIC_FORCEINLINE void CAN_ServiceTx(CanChannel_t* channel);
 
 /* Exported functions --------------------------------------------------------*/
 
 /**
- * @brief  Initialize CAN peripheral
+ * @brief  Initialize CAN1 peripheral
  * @param  baudrate: CAN bus baudrate (e.g., 500000 for 500 kbit/s)
+ * @param  mode: Operating mode (CAN_MODE_NORMAL on a vehicle bus)
  * @retval true if successful, false otherwise
  */
-bool CAN_Init(uint32_t baudrate)
+bool CAN_Init(uint32_t baudrate, CanMode_t mode)
 {
-    /* Enable CAN1 clock */
-    RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
-    
-    /* Request initialization mode */
-    CAN1->MCR |= CAN_MCR_INRQ;
-    
-    /* Wait for initialization mode acknowledgment */
-    uint32_t timeout = SystemCoreClock / 1000; /* 1 ms timeout */
-    while (!(CAN1->MSR & CAN_MSR_INAK) && timeout--);
-    if (timeout == 0) return false;
-    
-    /* Configure CAN options */
-    CAN1->MCR = CAN_MCR_INRQ |         /* Initialization request */
-                CAN_MCR_NART |          /* No automatic retransmission */
-                CAN_MCR_AWUM |          /* Automatic wake-up mode */
-                CAN_MCR_ABOM;           /* Automatic bus-off management */
-    
-    /* Configure bit timing */
-    CAN_ConfigureBitTiming(baudrate);
+    return CAN_InitBus(CAN_BUS_1, baudrate, mode);
+}
+
+/**
+ * @brief  Initialize a CAN controller
+ * @note   CAN2 is a slave of CAN1: its filter banks live in CAN1 and its
+ *         registers need the CAN1 clock, so CAN1 must be initialized first.
+ * @param  bus: Controller to initialize
+ * @param  baudrate: CAN bus baudrate (e.g., 500000 for 500 kbit/s)
+ * @param  mode: Operating mode (CAN_MODE_NORMAL on a vehicle bus)
+ * @retval true if successful, false otherwise
+ */
+bool CAN_InitBus(CanBus_t bus, uint32_t baudrate, CanMode_t mode)
+{
+    if (bus >= CAN_BUS_COUNT) return false;
     
-    /* Configure receive filters */
-    CAN_ConfigureFilters();
+    return CAN_ChannelInit(&can_channels[bus], &can_driver, can_regs[bus], bus, baudrate, mode);
+}
+
+/**
+ * @brief  Get the operating mode a controller was initialized in
+ * @param  bus: Controller
+ * @retval Operating mode
+ */
+CanMode_t CAN_GetMode(CanBus_t bus)
+{
+    if (bus >= CAN_BUS_COUNT) return CAN_MODE_NORMAL;
     
-    /* Enable FIFO 0 message pending interrupt */
-    CAN1->IER = CAN_IER_FMPIE0 |        /* FIFO 0 message pending */
-                CAN_IER_FOVIE0 |        /* FIFO 0 overrun */
-                CAN_IER_BOFIE |         /* Bus-off */
-                CAN_IER_EPVIE |         /* Error passive */
-                CAN_IER_EWGIE;          /* Error warning */
+    return (CanMode_t)can_channels[bus].mode;
+}
+
+/**
+ * @brief  Compute bxCAN bit timing for a bitrate
+ * @note   Pure function. Searches from the most time quanta per bit down
+ *         and takes the first exact division of the clock whose sample
+ *         point lands within half a quantum of the request; more quanta
+ *         give finer sample point placement and resynchronization. SJW
+ *         is as wide as BS2 and the hardware allow.
+ * @param  clock_hz: CAN peripheral clock (APB1)
+ * @param  bitrate: Bitrate in bit/s
+ * @param  sample_point: Requested sample point in permille (e.g. 875)
+ * @param  timing: Computed timing
+ * @retval true if an exact timing exists, false otherwise
+ */
+bool CAN_CalcBitTiming(uint32_t clock_hz, uint32_t bitrate, uint16_t sample_point, CanBitTiming_t* timing)
+{
+    if (timing == NULL || bitrate == 0 || sample_point == 0 || sample_point >= 1000) return false;
     
-    /* Leave initialization mode */
-    CAN1->MCR &= ~CAN_MCR_INRQ;
+    for (uint32_t tq = CAN_BT_TQ_MAX; tq >= CAN_BT_TQ_MIN; tq--) {
+        uint64_t bit_clocks = (uint64_t)bitrate * tq;
+        if (bit_clocks > clock_hz || clock_hz % bit_clocks != 0) continue;
+        
+        uint32_t prescaler = (uint32_t)(clock_hz / bit_clocks);
+        if (prescaler > CAN_BT_PRESCALER_MAX) continue;
+        
+        /* Sample after sync segment + BS1: nearest quantum, kept inside the segment limits */
+        uint32_t position = (tq * sample_point + 500U) / 1000U;
+        if (position > 1U + CAN_BT_BS1_MAX) position = 1U + CAN_BT_BS1_MAX;
+        if (position < 2U) position = 2U;
+        if (tq - position > CAN_BT_BS2_MAX) position = tq - CAN_BT_BS2_MAX;
+        if (position > tq - 1U) position = tq - 1U;
+        
+        int32_t error = (int32_t)(position * 1000U) - (int32_t)(tq * sample_point);
+        if (error > 500 || error < -500) continue;
+        
+        timing->prescaler = (uint16_t)prescaler;
+        timing->bs1 = (uint8_t)(position - 1U);
+        timing->bs2 = (uint8_t)(tq - position);
+        timing->sjw = (timing->bs2 < CAN_BT_SJW_MAX) ? timing->bs2 : CAN_BT_SJW_MAX;
+        timing->tq = (uint8_t)tq;
+        timing->sample_point = (uint16_t)((position * 1000U + tq / 2U) / tq);
+        return true;
+    }
     
-    /* Wait for normal mode */
-    timeout = SystemCoreClock / 1000;
-    while ((CAN1->MSR & CAN_MSR_INAK) && timeout--);
-    if (timeout == 0) return false;
+    return false;
+}
+
+/**
+ * @brief  Accept a list of standard identifiers on a controller
+ * @param  bus: Controller receiving the identifiers
+ * @param  ids: Array of 11-bit identifiers
+ * @param  count: Number of identifiers
+ * @param  rx_class: RX queue of frames matching these filters
+ * @retval true if successful, false if not enough filter banks
+ */
+bool CAN_ConfigureFilterList(CanBus_t bus, const uint32_t* ids, uint8_t count, CanRxClass_t rx_class)
+{
+    if (bus >= CAN_BUS_COUNT) return false;
     
-    /* Clear error flags */
-    CAN_ClearError();
+    return CAN_ChannelConfigureFilterList(&can_channels[bus], ids, count, rx_class);
+}
+
+/**
+ * @brief  Accept 29-bit identifiers matching id/mask pairs on a controller
+ * @param  bus: Controller
+ * @param  ids: 29-bit identifiers (CAN_ID_EXT flag optional)
+ * @param  masks: 29-bit masks, 1 = bit must match
+ * @param  count: Number of id/mask pairs
+ * @retval true if successful, false if not enough filter banks
+ */
+bool CAN_ConfigureFilterMaskExt(CanBus_t bus, const uint32_t* ids, const uint32_t* masks, uint8_t count)
+{
+    if (bus >= CAN_BUS_COUNT) return false;
     
-    return true;
+    return CAN_ChannelConfigureFilterMaskExt(&can_channels[bus], ids, masks, count);
 }
 
 /**
- * @brief  Send CAN frame
- * @param  id: CAN identifier
+ * @brief  Send CAN frame on CAN1 through the transmit queue
+ * @note   Goes through CAN_Transmit() so that the mailbox is chosen with
+ *         interrupts masked; the TX-empty ISR refills mailboxes as well.
+ * @param  id: CAN identifier (CAN_ID_EXT set for 29-bit)
  * @param  data: Pointer to data bytes
  * @param  dlc: Data length code (0-8)
- * @retval true if successful, false otherwise
+ * @retval true if the frame was accepted, false if invalid or queue full
  */
 bool CAN_Send(uint32_t id, const uint8_t* data, uint8_t dlc)
 {
     if (dlc > 8 || data == NULL) return false;
     
-    /* Find empty transmit mailbox */
-    if (!CAN_WaitForTxMailbox()) return false;
-    
-    uint8_t mailbox = 0;
-    if (CAN1->TSR & CAN_TSR_TME0) mailbox = 0;
-    else if (CAN1->TSR & CAN_TSR_TME1) mailbox = 1;
-    else if (CAN1->TSR & CAN_TSR_TME2) mailbox = 2;
-    else return false;
+    CanFrame_t frame;
+    frame.id = id;
+    frame.dlc = dlc;
+    frame.bus = CAN_BUS_1;
+    frame.word[0] = 0;
+    frame.word[1] = 0;
+    memcpy(frame.data, data, dlc);
     
-    /* Configure identifier and DLC */
-    CAN1->sTxMailBox[mailbox].TIR = (id << CAN_TI0R_STID_Pos);
-    CAN1->sTxMailBox[mailbox].TDTR = dlc;
-    
-    /* Load data */
-    uint32_t data_low = 0, data_high = 0;
-    for (int i = 0; i < dlc && i < 4; i++) {
-        data_low |= (data[i] << (i * 8));
-    }
-    for (int i = 4; i < dlc && i < 8; i++) {
-        data_high |= (data[i] << ((i - 4) * 8));
-    }
-    CAN1->sTxMailBox[mailbox].TDLR = data_low;
-    CAN1->sTxMailBox[mailbox].TDHR = data_high;
-    
-    /* Request transmission */
-    CAN1->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
+    return CAN_Transmit(CAN_BUS_1, &frame);
+}
+
+/**
+ * @brief  Queue CAN frame for transmission (non-blocking, ISR safe)
+ * @param  bus: Controller to transmit on
+ * @param  frame: Frame to transmit (id, dlc, data)
+ * @retval true if frame was accepted, false if queue full or invalid
+ */
+bool CAN_Transmit(CanBus_t bus, const CanFrame_t* frame)
+{
+    if (bus >= CAN_BUS_COUNT || frame == NULL || frame->dlc > 8) return false;
     
-    return true;
+    return CAN_QueueTx(&can_channels[bus], frame);
 }
 
 /**
@@ -131,19 +221,9 @@ bool CAN_Send(uint32_t id, const uint8_t* data, uint8_t dlc)
  */
 bool CAN_Receive(CanFrame_t* frame)
 {
-    if (frame == NULL || rx_count == 0) return false;
-    
-    /* Disable interrupts for atomic operation */
-    __disable_irq();
+    if (frame == NULL) return false;
     
-    /* Copy frame from buffer */
-    *frame = rx_buffer[rx_tail];
-    rx_tail = (rx_tail + 1) % CAN_RX_BUFFER_SIZE;
-    rx_count--;
-    
-    __enable_irq();
-    
-    return true;
+    return CAN_DequeueRx(&can_driver, frame);
 }
 
 /**
@@ -152,7 +232,77 @@ bool CAN_Receive(CanFrame_t* frame)
  */
 uint16_t CAN_GetRxCount(void)
 {
-    return rx_count;
+    return can_driver.rx_count;
+}
+
+/**
+ * @brief  Enable latest-value-wins queuing for identifiers of a controller
+ * @param  bus: Controller
+ * @param  ids: Identifiers (CAN_ID_EXT flag for 29-bit)
+ * @param  count: Number of identifiers
+ * @retval true if successful, false if the table is full
+ */
+bool CAN_SetRxCoalescing(CanBus_t bus, const uint32_t* ids, uint8_t count)
+{
+    if (bus >= CAN_BUS_COUNT) return false;
+    
+    return CAN_ChannelSetRxCoalescing(&can_channels[bus], ids, count);
+}
+
+/**
+ * @brief  Register routed standard identifiers in the RX accept bitmap
+ * @param  bus: Controller
+ * @param  ids: Identifiers to accept
+ * @param  count: Number of identifiers
+ * @retval None
+ */
+void CAN_AddRxAcceptIds(CanBus_t bus, const uint32_t* ids, uint8_t count)
+{
+    if (bus >= CAN_BUS_COUNT) return;
+    
+    CAN_ChannelAddRxAcceptIds(&can_channels[bus], ids, count);
+}
+
+/**
+ * @brief  Get receive queue statistics
+ * @param  stats: Pointer to statistics structure
+ */
+void CAN_GetRxStats(CanRxStats_t* stats)
+{
+    CAN_DriverGetRxStats(&can_driver, stats);
+}
+
+/**
+ * @brief  Get transmit queue statistics of a controller
+ * @param  bus: Controller
+ * @param  stats: Pointer to statistics structure
+ */
+void CAN_GetTxStats(CanBus_t bus, CanTxStats_t* stats)
+{
+    if (bus >= CAN_BUS_COUNT) return;
+    
+    CAN_ChannelGetTxStats(&can_channels[bus], stats);
+}
+
+/**
+ * @brief  Register hook called from RX ISR for every received frame
+ * @param  hook: Hook function, NULL to remove
+ */
+void CAN_SetRxHook(CanRxHook_t hook)
+{
+    can_driver.rx_hook = hook;
+}
+
+/**
+ * @brief  Register hook called from TX ISR when the queue of a controller runs empty
+ * @param  bus: Controller
+ * @param  hook: Hook function, NULL to remove
+ */
+void CAN_SetTxHook(CanBus_t bus, CanTxHook_t hook)
+{
+    if (bus >= CAN_BUS_COUNT) return;
+    
+    CAN_ChannelSetTxHook(&can_channels[bus], hook);
 }
 
 /**
@@ -161,7 +311,7 @@ uint16_t CAN_GetRxCount(void)
  */
 CanError_t CAN_GetLastError(void)
 {
-    return last_error;
+    return can_driver.last_error;
 }
 
 /**
@@ -169,135 +319,919 @@ CanError_t CAN_GetLastError(void)
  */
 void CAN_ClearError(void)
 {
-    last_error = CAN_ERROR_NONE;
-    CAN1->ESR = 0; /* Clear error flags */
+    CAN_ChannelClearError(&can_channels[CAN_BUS_1]);
+    if (RCC->APB1ENR & RCC_APB1ENR_CAN2EN) {
+        CAN_ChannelClearError(&can_channels[CAN_BUS_2]);
+    }
 }
 
 /**
- * @brief  CAN interrupt handler
+ * @brief  CAN1 RX0 interrupt handler
  */
 void CAN_IRQHandler(void)
 {
-    /* FIFO 0 message pending */
-    if (CAN1->RF0R & CAN_RF0R_FMP0) {
-        /* Check for buffer overflow */
-        if (rx_count >= CAN_RX_BUFFER_SIZE) {
-            last_error = CAN_ERROR_OVERRUN;
-            /* Release FIFO message */
-            CAN1->RF0R |= CAN_RF0R_RFOM0;
-            return;
+    CAN_RxIRQHandler(CAN_BUS_1);
+}
+
+/**
+ * @brief  CAN RX0 interrupt handler
+ * @param  bus: Controller that raised the interrupt
+ */
+void CAN_RxIRQHandler(CanBus_t bus)
+{
+    CAN_ServiceRx(&can_channels[bus], &can_driver);
+}
+
+/**
+ * @brief  CAN TX interrupt handler (mailbox empty)
+ * @param  bus: Controller that raised the interrupt
+ */
+void CAN_TxIRQHandler(CanBus_t bus)
+{
+    CAN_ServiceTx(&can_channels[bus]);
+}
+
+/**
+ * @brief  Reset a receive side and bind it to the filter bank registers
+ * @note   Only needed for instances other than CAN_GetDriver(). Call
+ *         before initializing the channels that use it.
+ * @param  driver: Receive side to reset
+ * @param  filter_regs: Master controller registers (filter banks)
+ */
+void CAN_DriverInit(CanDriver_t* driver, CAN_TypeDef* filter_regs)
+{
+    memset(driver, 0, sizeof(*driver));
+    driver->filter_regs = filter_regs;
+    for (uint8_t i = 0; i < CAN_RX_COALESCE_MAX; i++) {
+        driver->coalesce_slot[i] = CAN_RX_NONE;
+    }
+}
+
+/**
+ * @brief  Receive CAN frame from the class queues of a receive side
+ * @param  driver: Receive side
+ * @param  frame: Pointer to frame structure
+ * @retval true if frame received, false if buffer empty
+ */
+bool CAN_DriverReceive(CanDriver_t* driver, CanFrame_t* frame)
+{
+    if (frame == NULL) return false;
+    
+    return CAN_DequeueRx(driver, frame);
+}
+
+/**
+ * @brief  Get number of frames in the class queues of a receive side
+ * @param  driver: Receive side
+ * @retval Number of frames available
+ */
+uint16_t CAN_DriverGetRxCount(const CanDriver_t* driver)
+{
+    return driver->rx_count;
+}
+
+/**
+ * @brief  Get receive queue statistics of a receive side
+ * @param  driver: Receive side
+ * @param  stats: Pointer to statistics structure
+ */
+void CAN_DriverGetRxStats(CanDriver_t* driver, CanRxStats_t* stats)
+{
+    if (stats == NULL) return;
+    
+    __disable_irq();
+    *stats = driver->rx_stats;
+    __enable_irq();
+}
+
+/**
+ * @brief  Register hook called from RX ISR for every frame of a receive side
+ * @param  driver: Receive side
+ * @param  hook: Hook function, NULL to remove
+ */
+void CAN_DriverSetRxHook(CanDriver_t* driver, CanRxHook_t hook)
+{
+    driver->rx_hook = hook;
+}
+
+/**
+ * @brief  Get last error of a receive side
+ * @param  driver: Receive side
+ * @retval Last error code
+ */
+CanError_t CAN_DriverGetLastError(const CanDriver_t* driver)
+{
+    return driver->last_error;
+}
+
+/**
+ * @brief  Bind a channel to a controller and initialize it
+ * @note   CAN2 is a slave of CAN1: its filter banks live in CAN1 and its
+ *         registers need the CAN1 clock, so the CAN_BUS_1 channel of a
+ *         receive side must be initialized first.
+ * @param  channel: Channel to initialize
+ * @param  driver: Receive side shared with the other controller
+ * @param  regs: Controller registers
+ * @param  bus: Role of the controller (CAN_BUS_1 owns the filter banks)
+ * @param  baudrate: CAN bus baudrate (e.g., 500000 for 500 kbit/s)
+ * @param  mode: Operating mode (CAN_MODE_NORMAL on a vehicle bus)
+ * @retval true if successful, false otherwise
+ */
+bool CAN_ChannelInit(CanChannel_t* channel, CanDriver_t* driver, CAN_TypeDef* regs, CanBus_t bus,
+                     uint32_t baudrate, CanMode_t mode)
+{
+    if (channel == NULL || driver == NULL || bus >= CAN_BUS_COUNT) return false;
+    if ((uint32_t)mode >= sizeof(can_mode_bits) / sizeof(can_mode_bits[0])) return false;
+    
+    CAN_TypeDef* can = regs;
+    channel->regs = regs;
+    channel->driver = driver;
+    channel->bus = (uint8_t)bus;
+    channel->mode = (uint8_t)mode;
+    
+    /* Enable CAN clocks (CAN1 clock is required for CAN2 as well) */
+    RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
+    if (bus == CAN_BUS_2) {
+        RCC->APB1ENR |= RCC_APB1ENR_CAN2EN;
+    }
+    
+    /* Request initialization mode */
+    can->MCR |= CAN_MCR_INRQ;
+    
+    /* Wait for initialization mode acknowledgment */
+    uint32_t timeout = SystemCoreClock / 1000; /* 1 ms timeout */
+    while (!(can->MSR & CAN_MSR_INAK) && timeout--);
+    if (timeout == 0) return false;
+    
+    /* Configure CAN options */
+    can->MCR = CAN_MCR_INRQ |           /* Initialization request */
+               CAN_MCR_NART |           /* No automatic retransmission */
+               CAN_MCR_AWUM |           /* Automatic wake-up mode */
+               CAN_MCR_ABOM |           /* Automatic bus-off management */
+               CAN_MCR_TXFP;            /* TX mailboxes in request order */
+    
+    /* Configure bit timing, then loopback/silent test mode (BTR as well);
+       without an exact timing the controller stays off the bus */
+    if (!CAN_ConfigureBitTiming(can, baudrate)) return false;
+    can->BTR |= can_mode_bits[mode];
+    
+    /* Configure receive filters; list banks start over */
+    channel->list_bank_next = (bus == CAN_BUS_1) ? CAN_FILTER_BANK_CAN1_LIST : CAN_FILTER_BANK_CAN2;
+    CAN_ConfigureFilters(channel);
+    
+    /* Accept everything the hardware passes until routes are registered */
+    for (uint16_t i = 0; i < CAN_RX_ACCEPT_WORDS; i++) {
+        channel->rx_accept[i] = 0;
+    }
+    channel->rx_accept_enabled = false;
+    
+    /* RX statistics cover both controllers; counting restarts with CAN1 */
+    if (bus == CAN_BUS_1) {
+        driver->rx_stats = (CanRxStats_t){0};
+    }
+    
+    /* Reset software TX queue */
+    channel->tx.head = 0;
+    channel->tx.tail = 0;
+    channel->tx.count = 0;
+    channel->tx_hook = NULL;
+    
+    /* Enable FIFO 0 message pending interrupt (TX empty is enabled on demand) */
+    can->IER = CAN_IER_FMPIE0 |         /* FIFO 0 message pending */
+               CAN_IER_FOVIE0 |         /* FIFO 0 overrun */
+               CAN_IER_BOFIE |          /* Bus-off */
+               CAN_IER_EPVIE |          /* Error passive */
+               CAN_IER_EWGIE;           /* Error warning */
+    
+    /* Leave initialization mode */
+    can->MCR &= ~CAN_MCR_INRQ;
+    
+    /* Wait for normal mode */
+    timeout = SystemCoreClock / 1000;
+    while ((can->MSR & CAN_MSR_INAK) && timeout--);
+    if (timeout == 0) return false;
+    
+    /* Clear error flags */
+    CAN_ChannelClearError(channel);
+    
+    return true;
+}
+
+/**
+ * @brief  Accept a list of standard identifiers on a channel
+ * @note   Uses 16-bit identifier-list banks (4 IDs per bank) from the
+ *         controller's half of the filter banks, below the banks reserved
+ *         for 29-bit filters. Each call appends banks for the identifiers
+ *         not yet listed in that class, so repeating a configuration (a
+ *         router initialized again) does not use up banks. List filters
+ *         win over mask filters of the same scale (hence the 16-bit CAN1
+ *         0x100-0x107 mask), so an ID inside that range can be moved to
+ *         another priority class this way.
+ * @param  channel: Channel receiving the identifiers
+ * @param  ids: Array of 11-bit identifiers
+ * @param  count: Number of identifiers
+ * @param  rx_class: RX queue of frames matching these filters
+ * @retval true if successful, false if not enough filter banks
+ */
+bool CAN_ChannelConfigureFilterList(CanChannel_t* channel, const uint32_t* ids, uint8_t count, CanRxClass_t rx_class)
+{
+    uint32_t fresh[CAN_FMI_MAX];
+    uint8_t fresh_count = 0;
+    
+    if (rx_class >= CAN_RX_CLASS_COUNT || (ids == NULL && count > 0) || count > CAN_FMI_MAX) return false;
+    
+    for (uint8_t n = 0; n < count; n++) {
+        if (!CAN_IsListed(channel, ids[n], rx_class)) {
+            fresh[fresh_count++] = ids[n];
         }
+    }
+    if (fresh_count == 0) return true;
+    ids = fresh;
+    count = fresh_count;
+    
+    CAN_TypeDef* filter = channel->driver->filter_regs;
+    uint8_t bank = channel->list_bank_next;
+    uint8_t bank_end = ((channel->bus == CAN_BUS_1) ? CAN_FILTER_BANK_CAN2 : CAN_FILTER_BANK_COUNT) -
+                       CAN_FILTER_EXT_BANKS;
+    
+    if (bank + (count + 3U) / 4U > bank_end) return false;
+    
+    /* Enter filter initialization mode */
+    filter->FMR |= CAN_FMR_FINIT;
+    
+    for (uint8_t i = 0; i < count; i += 4, bank++) {
+        uint32_t filter_id[4];
+        uint32_t bank_bit = 1UL << bank;
         
-        /* Read message from FIFO */
-        CanFrame_t* frame = &rx_buffer[rx_head];
+        /* Pad unused slots of the last bank with the last identifier */
+        for (uint8_t k = 0; k < 4; k++) {
+            uint8_t n = (i + k < count) ? (i + k) : (count - 1);
+            filter_id[k] = (ids[n] & 0x7FFU) << 5;  /* STID[10:0] in bits 15:5 */
+        }
         
-        /* Extract identifier and DLC */
-        frame->id = (CAN1->sFIFOMailBox[0].RIR >> CAN_RI0R_STID_Pos) & 0x7FF;
-        frame->dlc = CAN1->sFIFOMailBox[0].RDTR & CAN_RDT0R_DLC;
+        filter->FA1R &= ~bank_bit;      /* Deactivate while configuring */
+        filter->FM1R |= bank_bit;       /* Identifier list mode */
+        filter->FS1R &= ~bank_bit;      /* 16-bit scale */
+        filter->FFA1R &= ~bank_bit;     /* FIFO 0 assignment */
+        filter->sFilterRegister[bank].FR1 = filter_id[0] | (filter_id[1] << 16);
+        filter->sFilterRegister[bank].FR2 = filter_id[2] | (filter_id[3] << 16);
+        filter->FA1R |= bank_bit;
+        channel->driver->bank_class[bank] = (uint8_t)rx_class;
+    }
+    channel->list_bank_next = bank;
+    
+    /* Leave filter initialization mode */
+    filter->FMR &= ~CAN_FMR_FINIT;
+    
+    CAN_RebuildFmiMap(channel);
+    
+    return true;
+}
+
+/**
+ * @brief  Accept 29-bit identifiers matching id/mask pairs on a channel
+ * @note   Uses the last CAN_FILTER_EXT_BANKS banks of the controller, one
+ *         32-bit mask bank per pair. Replaces any previously configured
+ *         extended filters of that controller. Standard frames never match.
+ *         Matching frames use the normal priority class.
+ * @param  channel: Channel
+ * @param  ids: 29-bit identifiers (CAN_ID_EXT flag optional)
+ * @param  masks: 29-bit masks, 1 = bit must match
+ * @param  count: Number of id/mask pairs
+ * @retval true if successful, false if not enough filter banks
+ */
+bool CAN_ChannelConfigureFilterMaskExt(CanChannel_t* channel, const uint32_t* ids, const uint32_t* masks, uint8_t count)
+{
+    if (count > CAN_FILTER_EXT_BANKS || ((ids == NULL || masks == NULL) && count > 0)) return false;
+    
+    CAN_TypeDef* filter = channel->driver->filter_regs;
+    uint8_t bank_end = (channel->bus == CAN_BUS_1) ? CAN_FILTER_BANK_CAN2 : CAN_FILTER_BANK_COUNT;
+    uint8_t bank = bank_end - CAN_FILTER_EXT_BANKS;
+    
+    /* Enter filter initialization mode */
+    filter->FMR |= CAN_FMR_FINIT;
+    
+    for (uint8_t i = 0; i < CAN_FILTER_EXT_BANKS; i++, bank++) {
+        uint32_t bank_bit = 1UL << bank;
         
-        /* Extract data */
-        uint32_t data_low = CAN1->sFIFOMailBox[0].RDLR;
-        uint32_t data_high = CAN1->sFIFOMailBox[0].RDHR;
+        filter->FA1R &= ~bank_bit;      /* Deactivate while configuring */
+        if (i >= count) continue;       /* Unused banks stay inactive */
         
-        for (int i = 0; i < 4 && i < frame->dlc; i++) {
-            frame->data[i] = (data_low >> (i * 8)) & 0xFF;
+        filter->FM1R &= ~bank_bit;      /* Identifier mask mode */
+        filter->FS1R |= bank_bit;       /* 32-bit scale */
+        filter->FFA1R &= ~bank_bit;     /* FIFO 0 assignment */
+        filter->sFilterRegister[bank].FR1 = ((ids[i] & CAN_ID_EXT_MASK) << CAN_RI0R_EXID_Pos) | CAN_RI0R_IDE;
+        filter->sFilterRegister[bank].FR2 = ((masks[i] & CAN_ID_EXT_MASK) << CAN_RI0R_EXID_Pos) | CAN_RI0R_IDE;
+        filter->FA1R |= bank_bit;
+    }
+    
+    /* Leave filter initialization mode */
+    filter->FMR &= ~CAN_FMR_FINIT;
+    
+    CAN_RebuildFmiMap(channel);
+    
+    return true;
+}
+
+/**
+ * @brief  Queue CAN frame for transmission on a channel (non-blocking, ISR safe)
+ * @note   The frame goes straight into a free mailbox when the software
+ *         queue is empty, otherwise it is queued and the TX-empty
+ *         interrupt loads it as soon as a mailbox completes.
+ * @param  channel: Channel to transmit on
+ * @param  frame: Frame to transmit (id, dlc, data)
+ * @retval true if frame was accepted, false if queue full or invalid
+ */
+bool CAN_ChannelTransmit(CanChannel_t* channel, const CanFrame_t* frame)
+{
+    if (frame == NULL || frame->dlc > 8) return false;
+    
+    return CAN_QueueTx(channel, frame);
+}
+
+/**
+ * @brief  Enable latest-value-wins queuing for identifiers of a channel
+ * @note   A frame whose ID already waits in the RX queue overwrites that
+ *         entry in place instead of taking a new slot, so a slow main loop
+ *         sees the freshest value and the queue keeps room for other IDs.
+ *         Frames of different IDs keep their arrival order. Only suitable
+ *         for latest-value signals: never for segmented transport (ISO-TP,
+ *         J1939 TP), counter-protected or multiplexed messages. Replaces
+ *         the previous list of that controller.
+ * @param  channel: Channel
+ * @param  ids: Identifiers (CAN_ID_EXT flag for 29-bit)
+ * @param  count: Number of identifiers
+ * @retval true if successful, false if the table is full
+ */
+bool CAN_ChannelSetRxCoalescing(CanChannel_t* channel, const uint32_t* ids, uint8_t count)
+{
+    CanDriver_t* driver = channel->driver;
+    bool result = true;
+    uint8_t n = 0;
+    
+    if (ids == NULL && count > 0) return false;
+    
+    __disable_irq();
+    
+    /* Keep entries of the other controller */
+    for (uint8_t i = 0; i < driver->coalesce_count; i++) {
+        if (driver->coalesce_bus[i] != channel->bus) {
+            driver->coalesce_ids[n] = driver->coalesce_ids[i];
+            driver->coalesce_bus[n] = driver->coalesce_bus[i];
+            n++;
         }
-        for (int i = 4; i < 8 && i < frame->dlc; i++) {
-            frame->data[i] = (data_high >> ((i - 4) * 8)) & 0xFF;
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        if (n >= CAN_RX_COALESCE_MAX) {
+            result = false;
+            break;
         }
-        
-        frame->timestamp = HAL_GetTick();
-        
-        /* Update buffer pointers */
-        rx_head = (rx_head + 1) % CAN_RX_BUFFER_SIZE;
-        rx_count++;
-        
-        /* Release FIFO message */
-        CAN1->RF0R |= CAN_RF0R_RFOM0;
+        driver->coalesce_ids[n] = ids[i];
+        driver->coalesce_bus[n] = channel->bus;
+        n++;
     }
+    driver->coalesce_count = n;
     
-    /* FIFO 0 overrun */
-    if (CAN1->RF0R & CAN_RF0R_FOVR0) {
-        last_error = CAN_ERROR_OVERRUN;
-        CAN1->RF0R |= CAN_RF0R_FOVR0; /* Clear flag */
+    /* Forget pending slots: queued frames simply drain without coalescing */
+    for (uint8_t i = 0; i < CAN_RX_COALESCE_MAX; i++) {
+        driver->coalesce_slot[i] = CAN_RX_NONE;
+    }
+    for (uint8_t c = 0; c < CAN_RX_CLASS_COUNT; c++) {
+        for (uint16_t i = 0; i < CAN_RX_BUFFER_SIZE; i++) {
+            driver->rx_queues[c].owner[i] = CAN_RX_NONE;
+        }
     }
     
-    /* Bus-off error */
-    if (CAN1->MSR & CAN_MSR_ERRI) {
-        if (CAN1->ESR & CAN_ESR_BOFF) {
-            last_error = CAN_ERROR_BUS_OFF;
-        } else if (CAN1->ESR & CAN_ESR_EPVF) {
-            last_error = CAN_ERROR_ERROR_PASSIVE;
-        } else if (CAN1->ESR & CAN_ESR_EWGF) {
-            last_error = CAN_ERROR_WARNING;
+    __enable_irq();
+    
+    return result;
+}
+
+/**
+ * @brief  Register routed standard identifiers in the RX accept bitmap
+ * @note   The hardware mask filter lets a whole ID range through; the
+ *         bitmap narrows it to what some consumer (gateway route, router
+ *         signal, diagnostic server) actually handles. The RX ISR tests one
+ *         bit before copying the mailbox, so anything else is released
+ *         without touching the queues and counted as rejected. The first
+ *         call enables the check on that channel; calls add to the set.
+ *         29-bit identifiers are screened by hardware filters and ignored.
+ * @param  channel: Channel
+ * @param  ids: Identifiers to accept
+ * @param  count: Number of identifiers
+ * @retval None
+ */
+void CAN_ChannelAddRxAcceptIds(CanChannel_t* channel, const uint32_t* ids, uint8_t count)
+{
+    if (ids == NULL) return;
+    
+    __disable_irq();
+    for (uint8_t i = 0; i < count; i++) {
+        if (ids[i] <= CAN_ID_STD_MASK) {
+            channel->rx_accept[ids[i] >> 5] |= 1UL << (ids[i] & 0x1FU);
         }
-        CAN1->MSR |= CAN_MSR_ERRI; /* Clear error interrupt flag */
     }
+    channel->rx_accept_enabled = true;
+    __enable_irq();
+}
+
+/**
+ * @brief  Get transmit queue statistics of a channel
+ * @param  channel: Channel
+ * @param  stats: Pointer to statistics structure
+ */
+void CAN_ChannelGetTxStats(CanChannel_t* channel, CanTxStats_t* stats)
+{
+    if (stats == NULL) return;
+    
+    __disable_irq();
+    *stats = channel->tx.stats;
+    __enable_irq();
+}
+
+/**
+ * @brief  Register hook called from TX ISR when the queue of a channel runs empty
+ * @note   With a hook the mailbox-empty interrupt stays enabled, so every
+ *         completed transmission gives the hook a chance to queue more
+ *         frames (CAN_ChannelTransmit() is safe to call from it). A hook
+ *         that queues nothing ends the chain until the next transmit.
+ * @param  channel: Channel
+ * @param  hook: Hook function, NULL to remove
+ */
+void CAN_ChannelSetTxHook(CanChannel_t* channel, CanTxHook_t hook)
+{
+    __disable_irq();
+    channel->tx_hook = hook;
+    if (hook != NULL) {
+        channel->regs->IER |= CAN_IER_TMEIE;
+    }
+    __enable_irq();
+}
+
+/**
+ * @brief  Clear error flags of a channel and of its receive side
+ * @param  channel: Channel
+ */
+void CAN_ChannelClearError(CanChannel_t* channel)
+{
+    channel->driver->last_error = CAN_ERROR_NONE;
+    channel->regs->ESR = 0; /* Clear error flags */
+}
+
+/**
+ * @brief  CAN RX0 interrupt handler of a channel
+ * @param  channel: Channel whose controller raised the interrupt
+ */
+void CAN_ChannelRxIRQHandler(CanChannel_t* channel)
+{
+    CAN_ServiceRx(channel, channel->driver);
+}
+
+/**
+ * @brief  CAN TX interrupt handler of a channel (mailbox empty)
+ * @param  channel: Channel whose controller raised the interrupt
+ */
+void CAN_ChannelTxIRQHandler(CanChannel_t* channel)
+{
+    CAN_ServiceTx(channel);
+}
+
+/**
+ * @brief  Get the channel used by the CAN_Xxx() functions
+ * @param  bus: Controller
+ * @retval Channel, NULL if bus is out of range
+ */
+CanChannel_t* CAN_GetChannel(CanBus_t bus)
+{
+    return (bus < CAN_BUS_COUNT) ? &can_channels[bus] : NULL;
+}
+
+/**
+ * @brief  Get the receive side used by the CAN_Xxx() functions
+ * @retval Receive side of CAN1 and CAN2
+ */
+CanDriver_t* CAN_GetDriver(void)
+{
+    return &can_driver;
 }
 
 /* Private functions ---------------------------------------------------------*/
 
 /**
  * @brief  Configure CAN bit timing for specified baudrate
+ * @param  can: Controller registers
  * @param  baudrate: Target baudrate in bps
+ * @retval true if configured, false if APB1 has no exact timing for it
  */
-static void CAN_ConfigureBitTiming(uint32_t baudrate)
+static bool CAN_ConfigureBitTiming(CAN_TypeDef* can, uint32_t baudrate)
 {
-    uint32_t prescaler, bs1, bs2, sjw;
+    CanBitTiming_t timing;
     
-    /* Calculate bit timing for 500 kbit/s with APB1 = 42 MHz */
-    if (baudrate == 500000) {
-        prescaler = 5;  /* Prescaler = 6 (5+1) */
-        bs1 = 12;       /* BS1 = 13 tq (12+1) */
-        bs2 = 1;        /* BS2 = 2 tq (1+1) */
-        sjw = 0;        /* SJW = 1 tq (0+1) */
-    } else {
-        /* Default to 500 kbit/s if unsupported baudrate */
-        prescaler = 5;
-        bs1 = 12;
-        bs2 = 1;
-        sjw = 0;
+    if (!CAN_CalcBitTiming(APB1_CLOCK_FREQ, baudrate, CAN_SAMPLE_POINT_PERMILLE, &timing)) {
+        return false;
     }
     
-    CAN1->BTR = (sjw << CAN_BTR_SJW_Pos) |
-                (bs1 << CAN_BTR_TS1_Pos) |
-                (bs2 << CAN_BTR_TS2_Pos) |
-                prescaler;
+    can->BTR = ((uint32_t)(timing.sjw - 1U) << CAN_BTR_SJW_Pos) |
+               ((uint32_t)(timing.bs1 - 1U) << CAN_BTR_TS1_Pos) |
+               ((uint32_t)(timing.bs2 - 1U) << CAN_BTR_TS2_Pos) |
+               (uint32_t)(timing.prescaler - 1U);
+    
+    return true;
 }
 
 /**
  * @brief  Configure CAN receive filters
+ * @note   CAN1 owns banks 0..CAN_FILTER_BANK_CAN2-1, CAN2 the rest. CAN2
+ *         starts with no active bank; routed IDs are added with
+ *         CAN_ConfigureFilterList().
+ * @param  channel: Channel being initialized
  */
-static void CAN_ConfigureFilters(void)
+static void CAN_ConfigureFilters(CanChannel_t* channel)
 {
-    /* Enter filter initialization mode */
-    CAN1->FMR |= CAN_FMR_FINIT;
+    if (channel->bus != CAN_BUS_1) return;
+    
+    CanDriver_t* driver = channel->driver;
+    CAN_TypeDef* filter = driver->filter_regs;
+    
+    /* Enter filter initialization mode and split banks between CAN1 and CAN2 */
+    filter->FMR = (filter->FMR & ~CAN_FMR_CAN2SB) |
+                  (CAN_FILTER_BANK_CAN2 << CAN_FMR_CAN2SB_Pos) |
+                  CAN_FMR_FINIT;
     
     /* Configure filter 0 for Engine RPM (ID 0x100) */
-    CAN1->FM1R &= ~CAN_FM1R_FBM0;      /* Identifier mask mode */
-    CAN1->FS1R |= CAN_FS1R_FSC0;       /* 32-bit scale */
-    CAN1->FFA1R &= ~CAN_FFA1R_FFA0;    /* FIFO 0 assignment */
+    filter->FM1R &= ~CAN_FM1R_FBM0;    /* Identifier mask mode */
+    filter->FS1R &= ~CAN_FS1R_FSC0;    /* 16-bit scale: list filters of other classes must win */
+    filter->FFA1R &= ~CAN_FFA1R_FFA0;  /* FIFO 0 assignment */
     
-    /* Set filter to accept IDs 0x100, 0x101, 0x102 */
-    CAN1->sFilterRegister[0].FR1 = (CAN_FILTER_ID_ENGINE << 21);
-    CAN1->sFilterRegister[0].FR2 = (0x7F8 << 21); /* Mask for 0x100-0x107 */
+    /* Set filter to accept IDs 0x100-0x107, 11-bit only (mask in bits 31:16, ID in 15:0) */
+    filter->sFilterRegister[0].FR1 = ((((0x7F8U << 5) | CAN_FILTER16_IDE) << 16) | (CAN_FILTER_ID_ENGINE << 5));
+    filter->sFilterRegister[0].FR2 = filter->sFilterRegister[0].FR1;
     
     /* Activate filter 0 */
-    CAN1->FA1R |= CAN_FA1R_FACT0;
+    filter->FA1R |= CAN_FA1R_FACT0;
+    
+    /* Diagnostic request ID: 16-bit list, all four slots on the same ID */
+    uint32_t diag = (CAN_FILTER_ID_DIAG_REQ & 0x7FFU) << 5;
+    filter->FM1R |= (1UL << CAN_FILTER_BANK_CAN1_DIAG);
+    filter->FS1R &= ~(1UL << CAN_FILTER_BANK_CAN1_DIAG);
+    filter->FFA1R &= ~(1UL << CAN_FILTER_BANK_CAN1_DIAG);
+    filter->sFilterRegister[CAN_FILTER_BANK_CAN1_DIAG].FR1 = diag | (diag << 16);
+    filter->sFilterRegister[CAN_FILTER_BANK_CAN1_DIAG].FR2 = diag | (diag << 16);
+    filter->FA1R |= (1UL << CAN_FILTER_BANK_CAN1_DIAG);
+    
+    /* Diagnostics drain behind the signal traffic */
+    for (uint8_t bank = 0; bank < CAN_FILTER_BANK_COUNT; bank++) {
+        driver->bank_class[bank] = CAN_RX_CLASS_NORMAL;
+    }
+    driver->bank_class[CAN_FILTER_BANK_CAN1_DIAG] = CAN_RX_CLASS_LOW;
     
     /* Leave filter initialization mode */
-    CAN1->FMR &= ~CAN_FMR_FINIT;
+    filter->FMR &= ~CAN_FMR_FINIT;
+    
+    CAN_RebuildFmiMap(channel);
 }
 
 /**
- * @brief  Wait for available transmit mailbox
- * @retval true if mailbox available, false on timeout
+ * @brief  Load frame into a mailbox and request transmission
+ * @note   Caller guarantees that the mailbox is empty (TSR TMEx, or the
+ *         TSR CODE field for the next empty one).
+ * @param  can: Controller registers
+ * @param  mailbox: Mailbox number (0-2)
+ * @param  frame: Frame to transmit
  */
-static bool CAN_WaitForTxMailbox(void)
+static void CAN_LoadMailbox(CAN_TypeDef* can, uint32_t mailbox, const CanFrame_t* frame)
 {
-    uint32_t timeout = CAN_TIMEOUT_MS * (SystemCoreClock / 1000000);
+    /* Configure identifier (standard or extended) and DLC */
+    if (frame->id & CAN_ID_EXT) {
+        can->sTxMailBox[mailbox].TIR = ((frame->id & CAN_ID_EXT_MASK) << CAN_TI0R_EXID_Pos) | CAN_TI0R_IDE;
+    } else {
+        can->sTxMailBox[mailbox].TIR = ((frame->id & CAN_ID_STD_MASK) << CAN_TI0R_STID_Pos);
+    }
+    can->sTxMailBox[mailbox].TDTR = frame->dlc;
     
-    while (!(CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) && timeout--);
+    /* Load data (only DLC bytes go on the wire) */
+    can->sTxMailBox[mailbox].TDLR = frame->word[0];
+    can->sTxMailBox[mailbox].TDHR = frame->word[1];
     
-    return (timeout > 0);
+    /* Request transmission */
+    can->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
+}
+
+/**
+ * @brief  Account one frame loaded into a mailbox
+ * @param  queue: Controller TX queue
+ * @param  stamp: DWT cycle count when transmission was requested
+ */
+static void CAN_RecordTxLatency(CanTxQueue_t* queue, uint32_t stamp)
+{
+    uint32_t latency = DWT->CYCCNT - stamp;
+    
+    queue->stats.frames_sent++;
+    queue->stats.latency_sum_cycles += latency;
+    if (latency > queue->stats.latency_max_cycles) {
+        queue->stats.latency_max_cycles = latency;
+    }
+}
+
+/**
+ * @brief  Find latest-value-wins entry of a received identifier
+ * @param  driver: Receive side
+ * @param  bus: Controller the frame was received on
+ * @param  id: CAN identifier
+ * @retval Entry index, CAN_RX_NONE if the ID is queued normally
+ */
+static uint8_t CAN_FindCoalesceEntry(const CanDriver_t* driver, uint8_t bus, uint32_t id)
+{
+    for (uint8_t i = 0; i < driver->coalesce_count; i++) {
+        if (driver->coalesce_ids[i] == id && driver->coalesce_bus[i] == bus) {
+            return i;
+        }
+    }
+    return CAN_RX_NONE;
+}
+
+/**
+ * @brief  Recompute priority class of every filter match index
+ * @note   FMI numbers the filters of all banks assigned to FIFO 0 of the
+ *         controller in bank order, active or not: a 32-bit mask bank
+ *         counts one filter, 32-bit list and 16-bit mask two, 16-bit
+ *         list four. CAN2 numbering starts at its first bank (CAN2SB).
+ * @param  channel: Channel
+ */
+static void CAN_RebuildFmiMap(CanChannel_t* channel)
+{
+    const CanDriver_t* driver = channel->driver;
+    CAN_TypeDef* filter = driver->filter_regs;
+    uint8_t bank = (channel->bus == CAN_BUS_1) ? 0 : CAN_FILTER_BANK_CAN2;
+    uint8_t bank_end = (channel->bus == CAN_BUS_1) ? CAN_FILTER_BANK_CAN2 : CAN_FILTER_BANK_COUNT;
+    uint8_t fmi = 0;
+    
+    for (; bank < bank_end; bank++) {
+        uint32_t bank_bit = 1UL << bank;
+        if (filter->FFA1R & bank_bit) continue;     /* FIFO 1 has its own numbering */
+        
+        uint8_t filters = (filter->FS1R & bank_bit) ? 1 : 2;
+        if (filter->FM1R & bank_bit) filters *= 2;
+        
+        for (uint8_t k = 0; k < filters && fmi < CAN_FMI_MAX; k++) {
+            channel->fmi_class[fmi++] = driver->bank_class[bank];
+        }
+    }
+}
+
+/**
+ * @brief  Check whether a list bank of the channel already holds an identifier
+ * @param  channel: Channel
+ * @param  id: 11-bit identifier
+ * @param  rx_class: Priority class the bank must have
+ * @retval true if listed in a bank of that class
+ */
+static bool CAN_IsListed(const CanChannel_t* channel, uint32_t id, CanRxClass_t rx_class)
+{
+    const CAN_TypeDef* filter = channel->driver->filter_regs;
+    uint8_t bank = (channel->bus == CAN_BUS_1) ? CAN_FILTER_BANK_CAN1_LIST : CAN_FILTER_BANK_CAN2;
+    uint32_t filter_id = (id & 0x7FFU) << 5;
+    
+    for (; bank < channel->list_bank_next; bank++) {
+        uint32_t fr1 = filter->sFilterRegister[bank].FR1;
+        uint32_t fr2 = filter->sFilterRegister[bank].FR2;
+        
+        if (channel->driver->bank_class[bank] != rx_class) continue;
+        if ((fr1 & 0xFFFFU) == filter_id || (fr1 >> 16) == filter_id ||
+            (fr2 & 0xFFFFU) == filter_id || (fr2 >> 16) == filter_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief  Load a frame into a free mailbox or the software TX queue
+ * @note   Forced inline: the CAN_Xxx() wrappers index the static channel
+ *         table directly, as the single-instance driver did.
+ * @param  channel: Channel to transmit on
+ * @param  frame: Frame to transmit (validated by the caller)
+ * @retval true if frame was accepted, false if queue full
+ */
+__STATIC_FORCEINLINE bool CAN_QueueTx(CanChannel_t* channel, const CanFrame_t* frame)
+{
+    CAN_TypeDef* can = channel->regs;
+    CanTxQueue_t* queue = &channel->tx;
+    uint32_t stamp = DWT->CYCCNT;
+    bool accepted = true;
+    
+    /* Callable from main loop and from any ISR: save and restore PRIMASK */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    if (queue->count == 0 && (can->TSR & CAN_TSR_TME_ANY)) {
+        CAN_LoadMailbox(can, (can->TSR & CAN_TSR_CODE) >> CAN_TSR_CODE_Pos, frame);
+        CAN_RecordTxLatency(queue, stamp);
+    } else if (queue->count < CAN_TX_QUEUE_SIZE) {
+        queue->frames[queue->head] = *frame;
+        queue->stamps[queue->head] = stamp;
+        queue->head = (queue->head + 1) % CAN_TX_QUEUE_SIZE;
+        queue->count++;
+        queue->stats.frames_queued++;
+        can->IER |= CAN_IER_TMEIE;
+    } else {
+        queue->stats.queue_full++;
+        accepted = false;
+    }
+    
+    __set_PRIMASK(primask);
+    
+    return accepted;
+}
+
+/**
+ * @brief  Take the next frame from the class queues
+ * @param  driver: Receive side
+ * @param  frame: Pointer to frame structure
+ * @retval true if frame received, false if buffer empty
+ */
+__STATIC_FORCEINLINE bool CAN_DequeueRx(CanDriver_t* driver, CanFrame_t* frame)
+{
+    if (driver->rx_count == 0) return false;
+    
+    /* Disable interrupts for atomic operation */
+    __disable_irq();
+    
+    /* Strict priority: highest non-empty class, unless a waiting lower
+     * class has been passed over CAN_RX_STARVATION_LIMIT times */
+    uint8_t selected = CAN_RX_NONE;
+    for (uint8_t i = 0; i < CAN_RX_CLASS_COUNT; i++) {
+        uint8_t c = rx_class_order[i];
+        if (driver->rx_queues[c].count == 0) continue;
+        if (selected == CAN_RX_NONE) {
+            selected = c;
+        } else if (driver->rx_passed_over[c] >= CAN_RX_STARVATION_LIMIT) {
+            selected = c;
+            driver->rx_stats.starvation_grants++;
+            break;
+        }
+    }
+    
+    for (uint8_t c = 0; c < CAN_RX_CLASS_COUNT; c++) {
+        if (c == selected || driver->rx_queues[c].count == 0) {
+            driver->rx_passed_over[c] = 0;
+        } else if (driver->rx_passed_over[c] < CAN_RX_STARVATION_LIMIT) {
+            driver->rx_passed_over[c]++;
+        }
+    }
+    
+    /* Copy frame from buffer; a coalesced ID may queue again afterwards */
+    CanRxQueue_t* queue = &driver->rx_queues[selected];
+    *frame = queue->frames[queue->tail];
+    if (queue->owner[queue->tail] != CAN_RX_NONE) {
+        driver->coalesce_slot[queue->owner[queue->tail]] = CAN_RX_NONE;
+    }
+    queue->tail = (queue->tail + 1) % CAN_RX_BUFFER_SIZE;
+    queue->count--;
+    driver->rx_count--;
+    
+    __enable_irq();
+    
+    return true;
+}
+
+/**
+ * @brief  RX FIFO 0 and error service of a channel
+ * @note   The receive side is passed separately so the CAN_Xxx() wrappers
+ *         address the static driver without loading channel->driver.
+ * @param  channel: Channel whose controller raised the interrupt
+ * @param  driver: Receive side of the channel
+ */
+__STATIC_FORCEINLINE void CAN_ServiceRx(CanChannel_t* channel, CanDriver_t* driver)
+{
+    CAN_TypeDef* can = channel->regs;
+    
+    uint32_t rir = can->sFIFOMailBox[0].RIR;
+    
+    /* FIFO 0 message pending */
+    if ((can->RF0R & CAN_RF0R_FMP0) && !(rir & CAN_RI0R_IDE) &&
+        channel->rx_accept_enabled && !CAN_RX_ID_ACCEPTED(channel, rir)) {
+        /* Unrouted standard ID: release it without copying the mailbox */
+        can->RF0R |= CAN_RF0R_RFOM0;
+        driver->rx_stats.frames_rejected++;
+    } else if (can->RF0R & CAN_RF0R_FMP0) {
+        CanFrame_t frame;
+        
+        /* Extract identifier (standard or extended) and DLC */
+        if (rir & CAN_RI0R_IDE) {
+            frame.id = ((rir >> CAN_RI0R_EXID_Pos) & CAN_ID_EXT_MASK) | CAN_ID_EXT;
+        } else {
+            frame.id = (rir >> CAN_RI0R_STID_Pos) & CAN_ID_STD_MASK;
+        }
+        uint32_t rdtr = can->sFIFOMailBox[0].RDTR;
+        frame.dlc = rdtr & CAN_RDT0R_DLC;
+        frame.bus = channel->bus;
+        frame.time = (uint16_t)HAL_GetTick();
+        
+        /* Copy data registers as they are (bytes past the DLC are ignored) */
+        frame.word[0] = can->sFIFOMailBox[0].RDLR;
+        frame.word[1] = can->sFIFOMailBox[0].RDHR;
+        
+        /* Release FIFO message */
+        can->RF0R |= CAN_RF0R_RFOM0;
+        
+        /* Fast path (e.g. CAN-to-CAN forwarding) runs even if the ring is full */
+        if (driver->rx_hook != NULL) {
+            driver->rx_hook(&frame);
+        }
+        
+        /* Priority class from the filter that accepted the frame */
+        uint32_t fmi = (rdtr & CAN_RDT0R_FMI) >> CAN_RDT0R_FMI_Pos;
+        uint8_t rx_class = (fmi < CAN_FMI_MAX) ? channel->fmi_class[fmi] : CAN_RX_CLASS_NORMAL;
+        CanRxQueue_t* queue = &driver->rx_queues[rx_class];
+        
+        driver->rx_stats.frames_received++;
+        uint8_t entry = (driver->coalesce_count > 0) ?
+                        CAN_FindCoalesceEntry(driver, channel->bus, frame.id) : CAN_RX_NONE;
+        
+        if (entry != CAN_RX_NONE && driver->coalesce_slot[entry] != CAN_RX_NONE) {
+            /* Same ID still queued: newest value replaces it in place */
+            driver->rx_queues[driver->coalesce_class[entry]].frames[driver->coalesce_slot[entry]] = frame;
+            driver->rx_stats.frames_coalesced++;
+        } else if (queue->count >= CAN_RX_BUFFER_SIZE) {
+            /* Check for buffer overflow */
+            driver->rx_stats.frames_dropped++;
+            driver->last_error = CAN_ERROR_OVERRUN;
+        } else {
+            queue->frames[queue->head] = frame;
+            queue->owner[queue->head] = entry;
+            if (entry != CAN_RX_NONE) {
+                driver->coalesce_slot[entry] = (uint8_t)queue->head;
+                driver->coalesce_class[entry] = rx_class;
+            }
+            
+            /* Update buffer pointers */
+            queue->head = (queue->head + 1) % CAN_RX_BUFFER_SIZE;
+            queue->count++;
+            driver->rx_count++;
+            if (queue->count > driver->rx_stats.queue_high_water[rx_class]) {
+                driver->rx_stats.queue_high_water[rx_class] = queue->count;
+            }
+        }
+    }
+    
+    /* FIFO 0 overrun */
+    if (can->RF0R & CAN_RF0R_FOVR0) {
+        driver->rx_stats.fifo_overruns++;
+        driver->last_error = CAN_ERROR_OVERRUN;
+        can->RF0R |= CAN_RF0R_FOVR0; /* Clear flag */
+    }
+    
+    /* Bus-off error */
+    if (can->MSR & CAN_MSR_ERRI) {
+        if (can->ESR & CAN_ESR_BOFF) {
+            driver->last_error = CAN_ERROR_BUS_OFF;
+        } else if (can->ESR & CAN_ESR_EPVF) {
+            driver->last_error = CAN_ERROR_ERROR_PASSIVE;
+        } else if (can->ESR & CAN_ESR_EWGF) {
+            driver->last_error = CAN_ERROR_WARNING;
+        }
+        can->MSR |= CAN_MSR_ERRI; /* Clear error interrupt flag */
+    }
+}
+
+/**
+ * @brief  TX mailbox-empty service of a channel
+ * @param  channel: Channel whose controller raised the interrupt
+ */
+__STATIC_FORCEINLINE void CAN_ServiceTx(CanChannel_t* channel)
+{
+    CAN_TypeDef* can = channel->regs;
+    CanTxQueue_t* queue = &channel->tx;
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    /* Mailboxes empty on entry, each refilled at most once (TSR read once) */
+    uint32_t tsr = can->TSR;
+    
+    /* Acknowledge completed requests */
+    can->TSR = CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2;
+    
+    /* Refill from the software queue, in queue order */
+    for (uint32_t mailbox = 0; mailbox < CAN_TX_MAILBOX_COUNT && queue->count > 0; mailbox++) {
+        if (!(tsr & (CAN_TSR_TME0 << mailbox))) continue;
+        
+        CAN_LoadMailbox(can, mailbox, &queue->frames[queue->tail]);
+        CAN_RecordTxLatency(queue, queue->stamps[queue->tail]);
+        queue->tail = (queue->tail + 1) % CAN_TX_QUEUE_SIZE;
+        queue->count--;
+    }
+    
+    if (queue->count == 0 && channel->tx_hook == NULL) {
+        can->IER &= ~CAN_IER_TMEIE;
+    }
+    
+    __set_PRIMASK(primask);
+    
+    /* Let the application top up the queue, outside the critical section */
+    if (queue->count == 0 && channel->tx_hook != NULL) {
+        channel->tx_hook((CanBus_t)channel->bus);
+    }
 }
@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ * @file    can_gateway.c
+ * @brief   CAN-to-CAN frame gateway for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Forwarding runs in the RX ISR of the source controller through
+ *          the CAN driver RX hook: the received frame is matched against
+ *          the route table, remapped and handed to the destination
+ *          controller's TX queue. It never touches the RX ring, the PDU
+ *          router or the UART formatter.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_gateway.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define GATEWAY_ROUTE_COUNT     3
+#define GATEWAY_MAX_FILTER_IDS  (GATEWAY_ROUTE_COUNT)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief Frame routing table
+ */
+static const CanGatewayRoute_t route_table[GATEWAY_ROUTE_COUNT] = {
+    /* Engine RPM to body bus, remapped to 0x300 */
+    { .src_bus = CAN_BUS_1, .src_id = 0x100, .dst_bus = CAN_BUS_2, .dst_id = 0x300, .min_interval_ms = 0 },
+    
+    /* Vehicle speed to body bus, at most every 100 ms */
+    { .src_bus = CAN_BUS_1, .src_id = 0x102, .dst_bus = CAN_BUS_2, .dst_id = CAN_GW_ID_SAME, .min_interval_ms = 100 },
+    
+    /* Body bus request to powertrain bus */
+    { .src_bus = CAN_BUS_2, .src_id = 0x200, .dst_bus = CAN_BUS_1, .dst_id = 0x180, .min_interval_ms = 0 }
+};
+
+static uint32_t last_forward_time[GATEWAY_ROUTE_COUNT];
+static bool route_forwarded[GATEWAY_ROUTE_COUNT];
+static CanGatewayStats_t gateway_stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize CAN gateway
+ * @note   Must be called after both controllers are initialized. Adds
+ *         receive filters for every source identifier and installs the
+ *         forwarding fast path as CAN RX hook.
+ * @param  None
+ * @retval true if successful, false if filters could not be configured
+ */
+bool CanGateway_Init(void)
+{
+    memset(&gateway_stats, 0, sizeof(gateway_stats));
+    memset(last_forward_time, 0, sizeof(last_forward_time));
+    memset(route_forwarded, 0, sizeof(route_forwarded));
+    
+    /* Accept every routed source identifier on its controller */
+    for (int bus = 0; bus < CAN_BUS_COUNT; bus++) {
+        uint32_t ids[GATEWAY_MAX_FILTER_IDS];
+        uint8_t count = 0;
+        
+        for (int i = 0; i < GATEWAY_ROUTE_COUNT; i++) {
+            if (route_table[i].src_bus == (CanBus_t)bus) {
+                ids[count++] = route_table[i].src_id;
+            }
+        }
+        
+        if (count > 0 && !CAN_ConfigureFilterList((CanBus_t)bus, ids, count, CAN_RX_CLASS_NORMAL)) {
+            return false;
+        }
+        if (count > 0) {
+            CAN_AddRxAcceptIds((CanBus_t)bus, ids, count);
+        }
+    }
+    
+    CAN_SetRxHook(CanGateway_ForwardFromIsr);
+    
+    return true;
+}
+
+/**
+ * @brief  Forward received frame to its destination controller
+ * @note   Called from RX ISR context.
+ * @param  frame: Received frame
+ * @retval None
+ */
+void CanGateway_ForwardFromIsr(const CanFrame_t* frame)
+{
+    uint32_t start = DWT->CYCCNT;
+    
+    for (int i = 0; i < GATEWAY_ROUTE_COUNT; i++) {
+        const CanGatewayRoute_t* route = &route_table[i];
+        
+        if (route->src_id != frame->id || route->src_bus != (CanBus_t)frame->bus) {
+            continue;
+        }
+        
+        /* Per-route rate limit */
+        if (route->min_interval_ms > 0) {
+            uint32_t rx_tick = CAN_FRAME_TICK(frame, HAL_GetTick());
+            if (route_forwarded[i] &&
+                (rx_tick - last_forward_time[i]) < route->min_interval_ms) {
+                gateway_stats.frames_rate_limited++;
+                continue;
+            }
+            last_forward_time[i] = rx_tick;
+            route_forwarded[i] = true;
+        }
+        
+        CanFrame_t out = *frame;
+        if (route->dst_id != CAN_GW_ID_SAME) {
+            out.id = route->dst_id;
+        }
+        
+        if (CAN_Transmit(route->dst_bus, &out)) {
+            uint32_t cycles = DWT->CYCCNT - start;
+            gateway_stats.frames_forwarded++;
+            gateway_stats.isr_cycles_sum += cycles;
+            if (cycles > gateway_stats.isr_cycles_max) {
+                gateway_stats.isr_cycles_max = cycles;
+            }
+        } else {
+            gateway_stats.tx_failed++;
+        }
+    }
+}
+
+/**
+ * @brief  Get gateway statistics
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void CanGateway_GetStatistics(CanGatewayStats_t* stats)
+{
+    if (stats != NULL) {
+        __disable_irq();
+        *stats = gateway_stats;
+        __enable_irq();
+    }
+}
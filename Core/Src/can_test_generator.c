@@ -1,132 +1,454 @@
 /**
  ******************************************************************************
  * @file    can_test_generator.c
- * @brief   CAN test frame generator for Gateway ECU testing
+ * @brief   CAN traffic generator for Gateway ECU testing
  * @author  Automotive Firmware Engineer
  * @date    August 2025
  ******************************************************************************
  * @note    This file can be compiled separately for a second STM32 board
- *          to generate test CAN frames for the Gateway ECU
+ *          to generate test CAN frames for the Gateway ECU. The host tool
+ *          can_trafgen runs the same code on the simulated controller.
+ *
+ *          Traffic is described by a profile: a target bus load, an
+ *          optional burst pattern and a weighted identifier mix with a
+ *          DLC range per identifier. Routed signals follow a drive cycle
+ *          (speed from a piecewise linear speed trace, RPM from speed and
+ *          gear, coolant temperature from a warm-up ramp); all other
+ *          payload bytes are pseudo-random.
+ *
+ *          Nothing blocks: CANTestGenerator_Run() accrues load credit
+ *          once per tick and tops up the driver TX queue, and the
+ *          mailbox-empty interrupt (CAN_SetTxHook()) refills it while the
+ *          bus drains it. The first Run() after a new tick queues the
+ *          first frames; from then on a 100% profile keeps the bus
+ *          saturated up to 1 Mbit/s from the interrupt alone, so the main
+ *          loop only needs to call Run() once per tick.
  ******************************************************************************
  */
 
 /* Includes ------------------------------------------------------------------*/
-#include "stm32f4xx.h"
-#include "can_drv.h"
-#include <stdint.h>
+#include "can_test_generator.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Point of the drive cycle speed trace
+ */
+typedef struct {
+    uint16_t time_s;            /* Seconds since cycle start */
+    uint8_t speed_kmh;
+} TestGenCyclePoint_t;
+
+/**
+ * @brief Gear of the RPM model
+ */
+typedef struct {
+    uint8_t max_speed_kmh;      /* Upshift speed */
+    uint8_t rpm_per_kmh;
+} TestGenGear_t;
+
+/**
+ * @brief Generator state
+ */
+typedef struct {
+    const TestGenProfile_t* profile;
+    CanChannel_t* channel;
+    uint32_t bits_per_ms;       /* Credit accrued per tick at the target load */
+    int32_t credit_bits;        /* Bus time the generator may still fill */
+    uint32_t weight_total;
+    uint32_t random;            /* xorshift32 state */
+    uint32_t start_tick;
+    uint32_t last_tick;
+    uint32_t burst_tick;
+    uint16_t burst_pending;
+    bool running;
+    TestGenStats_t stats;
+} TestGen_t;
 
 /* Private define ------------------------------------------------------------*/
-#define TEST_FRAME_INTERVAL_MS  100     /* Send test frame every 100ms */
+#define TESTGEN_LOAD_UNPACED    100     /* Profile load that skips pacing */
+#define TESTGEN_STD_FRAME_BITS  47      /* 11-bit frame without data, intermission included */
+#define TESTGEN_EXT_FRAME_BITS  67      /* 29-bit frame without data, intermission included */
+#define TESTGEN_STUFF_DIVISOR   10      /* Stuff bits, about one in ten for typical payloads */
+#define TESTGEN_IDLE_RPM        800
+#define TESTGEN_TEMP_START_C    20      /* Coolant temperature at cycle start */
+#define TESTGEN_TEMP_HOT_C      90      /* Thermostat open */
+#define TESTGEN_WARMUP_S        600     /* Time from start to hot */
+
+/* Private macro -------------------------------------------------------------*/
+#define TESTGEN_COUNT(table)    ((uint8_t)(sizeof(table) / sizeof((table)[0])))
 
 /* Private variables ---------------------------------------------------------*/
-static uint32_t last_frame_time = 0;
-static uint16_t rpm_value = 800;        /* Starting RPM value */
-static uint8_t temp_value = 70;         /* Starting temperature (30°C = 70 raw) */
-static uint16_t speed_value = 0;        /* Starting speed */
 
-/* Test frame generation functions -------------------------------------------*/
+/* Routed signals only, as sent by the engine and ABS ECUs */
+static const TestGenStream_t testgen_nominal_streams[] = {
+    { CAN_FILTER_ID_ENGINE, 4, 8, 8, TESTGEN_SIGNAL_RPM   },
+    { CAN_FILTER_ID_TEMP,   1, 8, 8, TESTGEN_SIGNAL_TEMP  },
+    { CAN_FILTER_ID_SPEED,  2, 8, 8, TESTGEN_SIGNAL_SPEED },
+};
+
+/* Routed signals among traffic the filters or the accept bitmap discard */
+static const TestGenStream_t testgen_mixed_streams[] = {
+    { CAN_FILTER_ID_ENGINE,      4, 8, 8, TESTGEN_SIGNAL_RPM   },
+    { CAN_FILTER_ID_TEMP,        1, 8, 8, TESTGEN_SIGNAL_TEMP  },
+    { CAN_FILTER_ID_SPEED,       2, 8, 8, TESTGEN_SIGNAL_SPEED },
+    { 0x105,                     3, 0, 8, TESTGEN_SIGNAL_NONE  },
+    { 0x555,                     2, 0, 8, TESTGEN_SIGNAL_NONE  },
+    { 0x0CF00400U | CAN_ID_EXT,  2, 8, 8, TESTGEN_SIGNAL_NONE  },
+    { 0x18FEF100U | CAN_ID_EXT,  1, 8, 8, TESTGEN_SIGNAL_NONE  },
+};
+
+static const TestGenProfile_t testgen_profiles[] = {
+    { "nominal",  30,  0,   0, testgen_nominal_streams, TESTGEN_COUNT(testgen_nominal_streams) },
+    { "mixed",    70,  0,   0, testgen_mixed_streams,   TESTGEN_COUNT(testgen_mixed_streams)   },
+    { "burst",    20, 48, 100, testgen_mixed_streams,   TESTGEN_COUNT(testgen_mixed_streams)   },
+    { "saturate", 100, 0,   0, testgen_mixed_streams,   TESTGEN_COUNT(testgen_mixed_streams)   },
+};
+
+/* Urban start, city driving, motorway stretch, back to standstill */
+static const TestGenCyclePoint_t testgen_cycle[] = {
+    {   0,   0 }, {  10,   0 }, {  25,  50 }, {  45,  50 }, {  55,   0 },
+    {  65,   0 }, {  90,  90 }, { 130, 120 }, { 150, 120 }, { 170,  60 },
+    { 185,   0 }, { 200,   0 },
+};
+
+static const TestGenGear_t testgen_gears[] = {
+    { 20, 110 }, { 40, 62 }, { 60, 42 }, { 85, 32 }, { 255, 26 },
+};
+
+static TestGen_t testgen;
+
+/* Private function prototypes -----------------------------------------------*/
+static void TestGen_TxHook(CanBus_t bus);
+static void TestGen_Pump(void);
+static void TestGen_BuildFrame(CanFrame_t* frame);
+static uint16_t TestGen_SpeedRaw(uint32_t elapsed_ms);
+static uint16_t TestGen_RpmRaw(uint16_t speed_raw);
+static uint8_t TestGen_TempRaw(uint32_t elapsed_ms);
+static uint16_t TestGen_FrameBits(const CanFrame_t* frame);
+static uint32_t TestGen_Random(void);
+
+/* Exported functions --------------------------------------------------------*/
 
 /**
- * @brief  Generate Engine RPM test frame (CAN ID 0x100)
- * @param  None
- * @retval None
+ * @brief  Initialize the CAN controller and start generating traffic
+ * @param  bus: Controller to transmit on
+ * @param  bitrate: CAN bus bitrate (e.g., 1000000 for 1 Mbit/s)
+ * @param  profile: Bus-load profile (see CANTestGenerator_FindProfile())
+ * @param  seed: Seed of the payload, DLC and ID pseudo-random sequence (not 0)
+ * @retval true if successful, false otherwise
+ */
+bool CANTestGenerator_Init(CanBus_t bus, uint32_t bitrate, const TestGenProfile_t* profile, uint32_t seed)
+{
+    if (!CAN_InitBus(bus, bitrate, CAN_MODE_NORMAL)) return false;
+    
+    return CANTestGenerator_Start(bus, bitrate, profile, seed);
+}
+
+/**
+ * @brief  Start generating traffic on an initialized controller
+ * @note   For a controller the application set up itself, e.g. in
+ *         loopback mode with the gateway's filters (gw_selftest.c).
+ * @param  bus: Controller to transmit on
+ * @param  bitrate: Bitrate the controller runs at (pacing)
+ * @param  profile: Bus-load profile (see CANTestGenerator_FindProfile())
+ * @param  seed: Seed of the payload, DLC and ID pseudo-random sequence (not 0)
+ * @retval true if successful, false otherwise
  */
-void GenerateEngineRpmFrame(void)
+bool CANTestGenerator_Start(CanBus_t bus, uint32_t bitrate, const TestGenProfile_t* profile, uint32_t seed)
 {
-    uint8_t data[8] = {0};
+    if (profile == NULL || profile->stream_count == 0 || bitrate == 0 || seed == 0) return false;
+    if (bus >= CAN_BUS_COUNT) return false;
+    
+    memset(&testgen, 0, sizeof(testgen));
+    testgen.profile = profile;
+    testgen.channel = CAN_GetChannel(bus);
+    testgen.bits_per_ms = (bitrate / 1000U) * profile->load_pct / 100U;
+    testgen.random = seed;
+    for (uint8_t i = 0; i < profile->stream_count; i++) {
+        testgen.weight_total += profile->streams[i].weight;
+    }
+    if (testgen.weight_total == 0) return false;
     
-    /* Engine RPM: bytes 0-1, scale factor /4 */
-    /* For 2000 RPM: raw_value = 2000 * 4 = 8000 = 0x1F40 */
-    uint16_t raw_rpm = rpm_value * 4;
-    data[0] = raw_rpm & 0xFF;           /* Low byte */
-    data[1] = (raw_rpm >> 8) & 0xFF;    /* High byte */
+    testgen.start_tick = HAL_GetTick();
+    testgen.last_tick = testgen.start_tick;
+    testgen.burst_tick = testgen.start_tick;
+    testgen.running = true;
     
-    /* Send CAN frame */
-    CAN_Send(0x100, data, 8);
+    CAN_SetTxHook(bus, TestGen_TxHook);
     
-    /* Update RPM for next frame (simulate engine acceleration) */
-    rpm_value += 50;
-    if (rpm_value > 6000) rpm_value = 800;
+    return true;
 }
 
 /**
- * @brief  Generate Engine Temperature test frame (CAN ID 0x101)
+ * @brief  Main-loop part of the generator: pacing, bursts and queue restart
+ * @note   Call as often as the main loop allows; the TX interrupt does the
+ *         rest of the work.
  * @param  None
  * @retval None
  */
-void GenerateEngineTempFrame(void)
+void CANTestGenerator_Run(void)
 {
-    uint8_t data[8] = {0};
+    const TestGenProfile_t* profile = testgen.profile;
+    uint32_t now = HAL_GetTick();
     
-    /* Engine Temperature: byte 2, offset +40°C */
-    /* For 90°C: raw_value = 90 + 40 = 130 */
-    data[2] = temp_value;
+    if (!testgen.running || now == testgen.last_tick) return;
     
-    /* Send CAN frame */
-    CAN_Send(0x101, data, 8);
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    /* Accrue credit for the ticks passed, never more than a few ms worth,
+       so a stalled bus is not followed by a catch-up burst */
+    int32_t credit = testgen.credit_bits + (int32_t)((now - testgen.last_tick) * testgen.bits_per_ms);
+    int32_t credit_max = (int32_t)(TESTGEN_CREDIT_MS * testgen.bits_per_ms);
+    testgen.credit_bits = (credit > credit_max) ? credit_max : credit;
+    testgen.last_tick = now;
+    
+    if (profile->burst_frames > 0 && (now - testgen.burst_tick) >= profile->burst_period_ms) {
+        testgen.burst_tick = now;
+        testgen.burst_pending = profile->burst_frames;
+    }
     
-    /* Update temperature for next frame */
-    temp_value++;
-    if (temp_value > 130) temp_value = 70; /* 30°C to 90°C range */
+    /* Restart the interrupt chain if the queue ran dry waiting for credit */
+    TestGen_Pump();
+    
+    __set_PRIMASK(primask);
 }
 
 /**
- * @brief  Generate Vehicle Speed test frame (CAN ID 0x102)
+ * @brief  Stop generating traffic (frames already queued are still sent)
  * @param  None
  * @retval None
  */
-void GenerateVehicleSpeedFrame(void)
+void CANTestGenerator_Stop(void)
 {
-    uint8_t data[8] = {0};
+    if (testgen.channel == NULL) return;
+    
+    __disable_irq();
+    testgen.running = false;
+    __enable_irq();
     
-    /* Vehicle Speed: bytes 4-5, scale factor /10 */
-    /* For 120 km/h: raw_value = 120 * 10 = 1200 = 0x04B0 */
-    uint16_t raw_speed = speed_value * 10;
-    data[4] = raw_speed & 0xFF;         /* Low byte */
-    data[5] = (raw_speed >> 8) & 0xFF;  /* High byte */
+    CAN_SetTxHook((CanBus_t)testgen.channel->bus, NULL);
+}
+
+/**
+ * @brief  Get a built-in profile by index
+ * @param  index: Profile index, from 0
+ * @retval Profile, NULL past the last one
+ */
+const TestGenProfile_t* CANTestGenerator_GetProfile(uint8_t index)
+{
+    return (index < TESTGEN_COUNT(testgen_profiles)) ? &testgen_profiles[index] : NULL;
+}
+
+/**
+ * @brief  Find a built-in profile by name
+ * @param  name: Profile name ("nominal", "mixed", "burst", "saturate")
+ * @retval Profile, NULL if unknown
+ */
+const TestGenProfile_t* CANTestGenerator_FindProfile(const char* name)
+{
+    for (uint8_t i = 0; i < TESTGEN_COUNT(testgen_profiles); i++) {
+        if (strcmp(testgen_profiles[i].name, name) == 0) {
+            return &testgen_profiles[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Get generator statistics
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void CANTestGenerator_GetStats(TestGenStats_t* stats)
+{
+    if (stats == NULL) return;
     
-    /* Send CAN frame */
-    CAN_Send(0x102, data, 8);
+    __disable_irq();
+    *stats = testgen.stats;
+    __enable_irq();
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Mailbox-empty hook: refill the driver queue
+ * @param  bus: Controller whose queue ran empty
+ * @retval None
+ */
+static void TestGen_TxHook(CanBus_t bus)
+{
+    if (testgen.channel == NULL || testgen.channel->bus != bus) return;
     
-    /* Update speed for next frame */
-    speed_value += 5;
-    if (speed_value > 120) speed_value = 0;
+    TestGen_Pump();
 }
 
 /**
- * @brief  Main test generator function
+ * @brief  Queue frames while the driver has room and the profile allows
+ * @note   Runs in the TX ISR or with interrupts disabled. Frames go to
+ *         free mailboxes first; TESTGEN_QUEUE_LEVEL more wait in the
+ *         software queue so the bus never idles between interrupts.
  * @param  None
  * @retval None
  */
-void CANTestGenerator_Run(void)
+static void TestGen_Pump(void)
 {
-    uint32_t current_time = HAL_GetTick();
+    bool unpaced = (testgen.profile->load_pct >= TESTGEN_LOAD_UNPACED);
+    CanFrame_t frame;
     
-    /* Generate test frames at specified interval */
-    if ((current_time - last_frame_time) >= TEST_FRAME_INTERVAL_MS) {
-        /* Generate all test frames */
-        GenerateEngineRpmFrame();
-        HAL_Delay(10);
+    while (testgen.running && testgen.channel->tx.count < TESTGEN_QUEUE_LEVEL) {
+        bool burst = (testgen.burst_pending > 0);
         
-        GenerateEngineTempFrame();
-        HAL_Delay(10);
+        if (!burst && !unpaced && testgen.credit_bits <= 0) break;
         
-        GenerateVehicleSpeedFrame();
-        HAL_Delay(10);
+        TestGen_BuildFrame(&frame);
+        if (!CAN_ChannelTransmit(testgen.channel, &frame)) {
+            testgen.stats.tx_rejected++;
+            break;
+        }
         
-        last_frame_time = current_time;
+        uint16_t bits = TestGen_FrameBits(&frame);
+        testgen.stats.frames_sent++;
+        testgen.stats.bits_sent += bits;
+        if (burst) {
+            testgen.burst_pending--;
+            testgen.stats.frames_burst++;
+        } else {
+            testgen.credit_bits -= bits;
+        }
     }
 }
 
 /**
- * @brief  Initialize CAN test generator
- * @param  None
+ * @brief  Draw the next frame of the profile's identifier mix
+ * @param  frame: Frame to fill
  * @retval None
  */
-void CANTestGenerator_Init(void)
+static void TestGen_BuildFrame(CanFrame_t* frame)
+{
+    const TestGenProfile_t* profile = testgen.profile;
+    const TestGenStream_t* stream = &profile->streams[0];
+    uint32_t pick = TestGen_Random() % testgen.weight_total;
+    
+    for (uint8_t i = 0; i < profile->stream_count; i++) {
+        stream = &profile->streams[i];
+        if (pick < stream->weight) break;
+        pick -= stream->weight;
+    }
+    
+    frame->id = stream->id;
+    frame->dlc = stream->dlc_min;
+    if (stream->dlc_max > stream->dlc_min) {
+        frame->dlc += (uint8_t)(TestGen_Random() % (uint32_t)(stream->dlc_max - stream->dlc_min + 1));
+    }
+    frame->word[0] = 0;
+    frame->word[1] = 0;
+    
+    uint32_t elapsed_ms = HAL_GetTick() - testgen.start_tick;
+    switch (stream->signal) {
+        case TESTGEN_SIGNAL_RPM: {
+            uint16_t raw = TestGen_RpmRaw(TestGen_SpeedRaw(elapsed_ms));
+            frame->data[0] = (uint8_t)raw;
+            frame->data[1] = (uint8_t)(raw >> 8);
+            break;
+        }
+        case TESTGEN_SIGNAL_TEMP:
+            frame->data[2] = TestGen_TempRaw(elapsed_ms);
+            break;
+        case TESTGEN_SIGNAL_SPEED: {
+            uint16_t raw = TestGen_SpeedRaw(elapsed_ms);
+            frame->data[4] = (uint8_t)raw;
+            frame->data[5] = (uint8_t)(raw >> 8);
+            break;
+        }
+        default:
+            frame->word[0] = TestGen_Random();
+            frame->word[1] = TestGen_Random();
+            break;
+    }
+}
+
+/**
+ * @brief  Vehicle speed on the drive cycle, interpolated between points
+ * @param  elapsed_ms: Time since the generator started
+ * @retval Raw speed signal (km/h * 10)
+ */
+static uint16_t TestGen_SpeedRaw(uint32_t elapsed_ms)
+{
+    uint8_t last = TESTGEN_COUNT(testgen_cycle) - 1;
+    uint32_t t = elapsed_ms % (testgen_cycle[last].time_s * 1000U);
+    
+    for (uint8_t i = 0; i < last; i++) {
+        uint32_t t0 = testgen_cycle[i].time_s * 1000U;
+        uint32_t t1 = testgen_cycle[i + 1].time_s * 1000U;
+        
+        if (t < t1) {
+            int32_t v0 = testgen_cycle[i].speed_kmh * 10;
+            int32_t v1 = testgen_cycle[i + 1].speed_kmh * 10;
+            return (uint16_t)(v0 + (v1 - v0) * (int32_t)(t - t0) / (int32_t)(t1 - t0));
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Engine speed for a vehicle speed, in the gear a driver would pick
+ * @param  speed_raw: Raw speed signal (km/h * 10)
+ * @retval Raw RPM signal (rpm * 4)
+ */
+static uint16_t TestGen_RpmRaw(uint16_t speed_raw)
+{
+    uint8_t gear = 0;
+    
+    while (gear < TESTGEN_COUNT(testgen_gears) - 1 &&
+           speed_raw >= testgen_gears[gear].max_speed_kmh * 10U) {
+        gear++;
+    }
+    
+    uint32_t rpm = (uint32_t)speed_raw * testgen_gears[gear].rpm_per_kmh / 10U;
+    if (rpm < TESTGEN_IDLE_RPM) rpm = TESTGEN_IDLE_RPM;
+    
+    return (uint16_t)(rpm * 4U);
+}
+
+/**
+ * @brief  Coolant temperature on the warm-up ramp
+ * @param  elapsed_ms: Time since the generator started
+ * @retval Raw temperature signal (C + 40)
+ */
+static uint8_t TestGen_TempRaw(uint32_t elapsed_ms)
 {
-    /* Initialize CAN driver */
-    CAN_Init(500000); /* 500 kbit/s */
+    uint32_t t = elapsed_ms / 1000U;
+    if (t > TESTGEN_WARMUP_S) t = TESTGEN_WARMUP_S;
     
-    last_frame_time = HAL_GetTick();
+    return (uint8_t)(TESTGEN_TEMP_START_C + 40 + (TESTGEN_TEMP_HOT_C - TESTGEN_TEMP_START_C) * t / TESTGEN_WARMUP_S);
+}
+
+/**
+ * @brief  Estimated bus time of a frame, for pacing
+ * @param  frame: Frame
+ * @retval Bits from SOF to end of intermission, average stuffing included
+ */
+static uint16_t TestGen_FrameBits(const CanFrame_t* frame)
+{
+    uint16_t bits = ((frame->id & CAN_ID_EXT) ? TESTGEN_EXT_FRAME_BITS : TESTGEN_STD_FRAME_BITS) + 8U * frame->dlc;
+    
+    return bits + bits / TESTGEN_STUFF_DIVISOR;
+}
+
+/**
+ * @brief  Next value of the xorshift32 sequence
+ * @param  None
+ * @retval Pseudo-random value
+ */
+static uint32_t TestGen_Random(void)
+{
+    uint32_t x = testgen.random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    testgen.random = x;
+    return x;
 }
@@ -0,0 +1,275 @@
+/**
+ ******************************************************************************
+ * @file    cycle_monitor.c
+ * @brief   Message cycle-time and timeout monitor for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Deadlines are kept in a hashed timer wheel with 1 ms slots. Each
+ *          monitored message owns one timer linked into the slot of its
+ *          expiry tick; deadlines longer than one wheel revolution carry a
+ *          round count. Arming, re-arming and cancelling are O(1) list
+ *          operations, and each elapsed tick only visits a single slot, so
+ *          the cost does not depend on the number of monitored messages.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "cycle_monitor.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define CYCLE_WHEEL_MASK        (CYCLE_WHEEL_SLOTS - 1U)
+#define WHEEL_NIL               0xFFU
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief Monitored message table
+ *
+ * Deadline is typically 2.5-3x the expected cycle so a single late frame
+ * does not raise a timeout.
+ */
+static const CycleMonitorConfig_t cycle_table[CYCLE_TABLE_SIZE] = {
+    { .can_id = 0x100, .cycle_ms = 100, .timeout_ms = 300 },   /* Engine RPM */
+    { .can_id = 0x101, .cycle_ms = 100, .timeout_ms = 300 },   /* Engine temperature */
+    { .can_id = 0x102, .cycle_ms = 100, .timeout_ms = 300 }    /* Vehicle speed */
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static int FindCycleConfig(uint32_t can_id);
+static void Wheel_Arm(CycleMonitor_t* monitor, uint8_t index, uint32_t delay_ms);
+static void Wheel_Cancel(CycleMonitor_t* monitor, uint8_t index);
+static void Wheel_ProcessSlot(CycleMonitor_t* monitor);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize cycle monitor
+ * @param  monitor: Monitor
+ * @param  timeout_callback: Called for each message whose deadline expires
+ * @param  context: First argument of timeout_callback
+ * @retval None
+ */
+void CycleMonitor_Init(CycleMonitor_t* monitor, CycleMonitorCallback_t timeout_callback, void* context)
+{
+    monitor->timeout_cb = timeout_callback;
+    monitor->context = context;
+    memset(monitor->timers, 0, sizeof(monitor->timers));
+    memset(monitor->slots, WHEEL_NIL, sizeof(monitor->slots));
+    monitor->tick = 0;
+    monitor->started = false;
+    CycleMonitor_ClearStats(monitor);
+}
+
+/**
+ * @brief  Record reception of a frame and re-arm its deadline
+ * @param  monitor: Monitor
+ * @param  can_id: CAN identifier
+ * @param  timestamp: Reception tick
+ * @retval None
+ */
+void CycleMonitor_OnFrame(CycleMonitor_t* monitor, uint32_t can_id, uint32_t timestamp)
+{
+    int index = FindCycleConfig(can_id);
+    if (index < 0) return;
+    
+    const CycleMonitorConfig_t* config = &cycle_table[index];
+    CycleState_t* state = &monitor->states[index];
+    
+    if (state->rx_count > 0) {
+        uint32_t period = timestamp - state->last_rx;
+        if (period > 0xFFFFU) period = 0xFFFFU;
+        uint32_t jitter = (period > config->cycle_ms) ? (period - config->cycle_ms)
+                                                      : (config->cycle_ms - period);
+        
+        if (period < state->min_ms) state->min_ms = (uint16_t)period;
+        if (period > state->max_ms) state->max_ms = (uint16_t)period;
+        if (jitter > state->max_jitter_ms) state->max_jitter_ms = (uint16_t)jitter;
+        
+        /* EWMA in fixed point: avg += (sample - avg) / 2^shift */
+        state->avg_scaled += period - (state->avg_scaled >> CYCLE_EWMA_SHIFT);
+        state->jitter_scaled += jitter - (state->jitter_scaled >> CYCLE_EWMA_SHIFT);
+    } else {
+        state->avg_scaled = (uint32_t)config->cycle_ms << CYCLE_EWMA_SHIFT;
+    }
+    
+    state->last_rx = timestamp;
+    state->rx_count++;
+    state->timed_out = false;
+    
+    if (monitor->started) {
+        Wheel_Arm(monitor, (uint8_t)index, config->timeout_ms);
+    }
+}
+
+/**
+ * @brief  Advance timer wheel to current tick and raise expired deadlines
+ * @param  monitor: Monitor
+ * @param  now: Current system tick (ms)
+ * @retval None
+ */
+void CycleMonitor_Process(CycleMonitor_t* monitor, uint32_t now)
+{
+    if (!monitor->started) {
+        /* Start the wheel and arm every message so silence is detected too */
+        monitor->tick = now;
+        monitor->started = true;
+        for (uint8_t i = 0; i < CYCLE_TABLE_SIZE; i++) {
+            Wheel_Arm(monitor, i, cycle_table[i].timeout_ms);
+        }
+        return;
+    }
+    
+    while (monitor->tick != now) {
+        monitor->tick++;
+        Wheel_ProcessSlot(monitor);
+    }
+}
+
+/**
+ * @brief  Get number of monitored messages
+ * @retval Message count
+ */
+uint16_t CycleMonitor_GetCount(void)
+{
+    return CYCLE_TABLE_SIZE;
+}
+
+/**
+ * @brief  Get cycle statistics of a monitored message
+ * @param  monitor: Monitor
+ * @param  index: Monitor index (0..count-1)
+ * @param  stats: Pointer to statistics structure
+ * @retval true if index is valid, false otherwise
+ */
+bool CycleMonitor_GetStats(const CycleMonitor_t* monitor, uint16_t index, CycleStats_t* stats)
+{
+    if (index >= CYCLE_TABLE_SIZE || stats == NULL) return false;
+    
+    const CycleState_t* state = &monitor->states[index];
+    
+    stats->can_id = cycle_table[index].can_id;
+    stats->expected_ms = cycle_table[index].cycle_ms;
+    stats->min_ms = (state->rx_count > 1) ? state->min_ms : 0;
+    stats->max_ms = state->max_ms;
+    stats->avg_ms = (uint16_t)(state->avg_scaled >> CYCLE_EWMA_SHIFT);
+    stats->jitter_ms = (uint16_t)(state->jitter_scaled >> CYCLE_EWMA_SHIFT);
+    stats->max_jitter_ms = state->max_jitter_ms;
+    stats->rx_count = state->rx_count;
+    stats->timeouts = state->timeouts;
+    stats->timed_out = state->timed_out;
+    
+    return true;
+}
+
+/**
+ * @brief  Clear measured cycle statistics (deadlines stay armed)
+ * @param  monitor: Monitor
+ * @retval None
+ */
+void CycleMonitor_ClearStats(CycleMonitor_t* monitor)
+{
+    memset(monitor->states, 0, sizeof(monitor->states));
+    for (int i = 0; i < CYCLE_TABLE_SIZE; i++) {
+        monitor->states[i].min_ms = 0xFFFFU;
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Find monitor index for CAN ID
+ * @param  can_id: CAN identifier
+ * @retval Index into cycle table, -1 if not monitored
+ */
+static int FindCycleConfig(uint32_t can_id)
+{
+    for (int i = 0; i < CYCLE_TABLE_SIZE; i++) {
+        if (cycle_table[i].can_id == can_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  (Re-)arm timer to expire delay_ms ticks after the current tick
+ * @param  monitor: Monitor
+ * @param  index: Timer index
+ * @param  delay_ms: Delay in ticks (>= 1)
+ */
+static void Wheel_Arm(CycleMonitor_t* monitor, uint8_t index, uint32_t delay_ms)
+{
+    WheelTimer_t* timer = &monitor->timers[index];
+    
+    if (delay_ms == 0) delay_ms = 1;
+    Wheel_Cancel(monitor, index);
+    
+    /* Slot is visited (delay - 1) / SLOTS times before the expiry visit */
+    timer->slot = (uint8_t)((monitor->tick + delay_ms) & CYCLE_WHEEL_MASK);
+    timer->rounds = (uint16_t)((delay_ms - 1U) / CYCLE_WHEEL_SLOTS);
+    
+    /* Push to head of slot list */
+    timer->prev = WHEEL_NIL;
+    timer->next = monitor->slots[timer->slot];
+    if (timer->next != WHEEL_NIL) {
+        monitor->timers[timer->next].prev = index;
+    }
+    monitor->slots[timer->slot] = index;
+    timer->armed = true;
+}
+
+/**
+ * @brief  Unlink timer from its slot list
+ * @param  monitor: Monitor
+ * @param  index: Timer index
+ */
+static void Wheel_Cancel(CycleMonitor_t* monitor, uint8_t index)
+{
+    WheelTimer_t* timer = &monitor->timers[index];
+    
+    if (!timer->armed) return;
+    
+    if (timer->prev != WHEEL_NIL) {
+        monitor->timers[timer->prev].next = timer->next;
+    } else {
+        monitor->slots[timer->slot] = timer->next;
+    }
+    if (timer->next != WHEEL_NIL) {
+        monitor->timers[timer->next].prev = timer->prev;
+    }
+    timer->armed = false;
+}
+
+/**
+ * @brief  Visit the slot of the current tick and fire due timers
+ * @param  monitor: Monitor
+ */
+static void Wheel_ProcessSlot(CycleMonitor_t* monitor)
+{
+    uint8_t index = monitor->slots[monitor->tick & CYCLE_WHEEL_MASK];
+    
+    while (index != WHEEL_NIL) {
+        WheelTimer_t* timer = &monitor->timers[index];
+        uint8_t next = timer->next;
+        
+        if (timer->rounds > 0) {
+            timer->rounds--;
+        } else {
+            /* Deadline expired: report once, re-armed by next reception */
+            Wheel_Cancel(monitor, index);
+            monitor->states[index].timeouts++;
+            monitor->states[index].timed_out = true;
+            if (monitor->timeout_cb != NULL) {
+                monitor->timeout_cb(monitor->context, cycle_table[index].can_id);
+            }
+        }
+        
+        index = next;
+    }
+}
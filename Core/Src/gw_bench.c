@@ -0,0 +1,452 @@
+/**
+ ******************************************************************************
+ * @file    gw_bench.c
+ * @brief   Router and driver hot-path microbenchmarks
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Built only with GATEWAY_BENCH=1. Times the signal lookup,
+ *          extraction and formatting stages of the router, UART_WriteData,
+ *          a whole Router_ProcessCanFrame() per output mode and, on the
+ *          host, the CAN RX interrupt body and CAN_Receive(). Target runs
+ *          count DWT cycles, host runs count nanoseconds. Operations too
+ *          short to time alone run in batches of many rounds and report
+ *          the fastest round.
+ *
+ *          Output, one line per measurement after a header line:
+ *            BENCHFMT,<version>,name,params,ops,unit,per_op
+ *            BENCH,<name>,<key=value[;key=value]>,<ops>,<ns|cyc>,<per_op>
+ *          per_op has two decimals. Names and parameters only ever get
+ *          added, so results of two runs can be joined on name+params.
+ *
+ *          UART output produced by a stage under test is drained outside
+ *          the timed sections, in batches that fit the TX ring.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "gw_bench.h"
+
+#if GATEWAY_BENCH
+
+#include "can_drv.h"
+#include "uart_drv.h"
+#include "stm32f4xx_hal.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+#ifdef GATEWAY_HOST
+typedef uint64_t BenchTime_t;
+#else
+typedef uint32_t BenchTime_t;
+#endif
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_LINE_LENGTH       96
+#define BENCH_PARAM_LENGTH      32
+#define BENCH_SIGNALS_MAX       8       /* Largest signals-per-frame step */
+#define BENCH_FORMAT_BATCH      32      /* Formatted signals between UART drains */
+#define BENCH_FRAME_BATCH       32      /* Routed frames between UART drains */
+#define BENCH_MISS_ID           0x7FF   /* Standard ID absent from the signal table */
+#define BENCH_MUX_ID            0x103   /* Multiplexed message, 2 signals per selector */
+#define BENCH_RX_BATCH          256     /* RX interrupts per round on paths that queue nothing */
+
+/* Private macro -------------------------------------------------------------*/
+#ifdef GATEWAY_HOST
+#define BENCH_UNIT              "ns"
+#define BENCH_NOW()             HostPort_GetTimeNs()
+#else
+#define BENCH_UNIT              "cyc"
+#define BENCH_NOW()             DWT->CYCCNT
+#endif
+
+#define BENCH_MIN(a, b)         (((a) < (b)) ? (a) : (b))
+
+/* Private variables ---------------------------------------------------------*/
+static BenchPrint_t bench_print = NULL;
+static uint32_t bench_iterations = 0;
+static const SignalConfig_t* bench_configs[BENCH_SIGNALS_MAX];
+static uint8_t bench_config_count = 0;
+static const uint8_t bench_steps[] = { 1, 2, 4, 8 };
+static volatile uint32_t bench_sink;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Bench_FindSignal(void);
+static void Bench_Extract(void);
+static void Bench_Format(void);
+static void Bench_UartWrite(void);
+static void Bench_ProcessFrame(RouterOutputMode_t mode, uint32_t can_id, uint8_t signals);
+#ifdef GATEWAY_HOST
+static void Bench_RxIsr(const char* path, uint32_t can_id, uint32_t batch);
+static void Bench_CanReceive(uint8_t depth);
+static void Bench_DrainCan(void);
+#endif
+static void Bench_FlushUart(void);
+static void Bench_Report(const char* name, const char* params, uint32_t ops, BenchTime_t elapsed);
+static void Bench_ReportPerOp(const char* name, const char* params, uint32_t ops, uint64_t per_op_x100);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Run all benchmarks and print one result line each
+ * @note   Blocking. Expects the gateway modules to be initialized; leaves
+ *         router statistics cleared and the output mode as it was (with
+ *         the default snapshot period).
+ * @param  iterations: Operations per measurement
+ * @param  print: Sink for result lines
+ * @retval None
+ */
+void Bench_Run(uint32_t iterations, BenchPrint_t print)
+{
+    char line[BENCH_LINE_LENGTH];
+    RouterOutputMode_t mode = Router_GetOutputMode();
+    
+    if (iterations == 0 || print == NULL) return;
+    
+    bench_print = print;
+    bench_iterations = iterations;
+    
+    /* First signals of the table, the configurations a frame would carry */
+    bench_config_count = (uint8_t)BENCH_MIN(Router_GetSignalCount(), BENCH_SIGNALS_MAX);
+    for (uint8_t i = 0; i < bench_config_count; i++) {
+        bench_configs[i] = Router_GetSignalConfig(i);
+    }
+    
+    Bench_FlushUart();
+    sprintf(line, "BENCHFMT,%u,name,params,ops,unit,per_op\r\n", BENCH_FORMAT_VERSION);
+    bench_print(line);
+    
+    Bench_FindSignal();
+    Bench_Extract();
+    Bench_Format();
+    Bench_UartWrite();
+    Bench_ProcessFrame(ROUTER_OUTPUT_EVENT, CAN_FILTER_ID_ENGINE, 1);
+    Bench_ProcessFrame(ROUTER_OUTPUT_EVENT, BENCH_MUX_ID, 2);
+    Bench_ProcessFrame(ROUTER_OUTPUT_SNAPSHOT, CAN_FILTER_ID_ENGINE, 1);
+    Bench_ProcessFrame(ROUTER_OUTPUT_SNAPSHOT, BENCH_MUX_ID, 2);
+
+#ifdef GATEWAY_HOST
+    /* Target needs frames on the bus for these (loopback mode) */
+    Bench_DrainCan();
+    Bench_RxIsr("queue", BENCH_MUX_ID, CAN_RX_BUFFER_SIZE);
+    Bench_RxIsr("coalesce", CAN_FILTER_ID_TEMP, BENCH_RX_BATCH);
+    Bench_RxIsr("reject", CAN_FILTER_ID_ENGINE + 5, BENCH_RX_BATCH);
+    Bench_RxIsr("ext", 0x0CF00400U | CAN_ID_EXT, CAN_RX_BUFFER_SIZE);
+    Bench_CanReceive(1);
+    Bench_CanReceive(8);
+    Bench_CanReceive(CAN_RX_BUFFER_SIZE);
+    Bench_DrainCan();
+#endif
+    
+    Bench_FlushUart();
+    Router_SetOutputMode(mode, ROUTER_SNAPSHOT_PERIOD_MS);
+    Router_ClearStatistics();
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Signal lookup: one hit per table position, then a miss
+ * @note   The table size is fixed at compile time; a hit at position N
+ *         costs what a lookup in an N-entry table costs, so "table" is
+ *         the number of entries scanned. Multiplexed IDs are reported at
+ *         their first entry only.
+ * @param  None
+ * @retval None
+ */
+static void Bench_FindSignal(void)
+{
+    char params[BENCH_PARAM_LENGTH];
+    uint16_t count = Router_GetSignalCount();
+    
+    for (uint16_t pos = 0; pos <= count; pos++) {
+        bool hit = (pos < count);
+        uint32_t can_id = hit ? Router_GetSignalConfig(pos)->can_id : BENCH_MISS_ID;
+        
+        if (hit && Router_BenchFindSignalConfig(can_id) != Router_GetSignalConfig(pos)) continue;
+        
+        BenchTime_t start = BENCH_NOW();
+        for (uint32_t i = 0; i < bench_iterations; i++) {
+            bench_sink = (uint32_t)(uintptr_t)Router_BenchFindSignalConfig(can_id);
+        }
+        BenchTime_t elapsed = BENCH_NOW() - start;
+        
+        sprintf(params, "table=%u;hit=%u", (unsigned)(hit ? pos + 1 : count), (unsigned)hit);
+        Bench_Report("find_signal", params, bench_iterations, elapsed);
+    }
+}
+
+/**
+ * @brief  Raw value extraction of 1..8 signals from one frame
+ * @param  None
+ * @retval None
+ */
+static void Bench_Extract(void)
+{
+    char params[BENCH_PARAM_LENGTH];
+    uint8_t data[8] = { 0x10, 0x27, 0x5A, 0x00, 0xE8, 0x03, 0x00, 0x00 };
+    
+    for (uint8_t s = 0; s < sizeof(bench_steps); s++) {
+        uint8_t signals = bench_steps[s];
+        uint32_t sum = 0;
+        
+        if (signals > bench_config_count) break;
+        
+        BenchTime_t start = BENCH_NOW();
+        for (uint32_t i = 0; i < bench_iterations; i++) {
+            data[0] = (uint8_t)i;
+            for (uint8_t k = 0; k < signals; k++) {
+                sum += Router_BenchExtractSignalValue(data, bench_configs[k]);
+            }
+        }
+        BenchTime_t elapsed = BENCH_NOW() - start;
+        bench_sink = sum;
+        
+        sprintf(params, "signals=%u", signals);
+        Bench_Report("extract", params, bench_iterations, elapsed);
+    }
+}
+
+/**
+ * @brief  Scale, format and UART output of 1..8 signals per frame
+ * @note   ops counts frames; the TX ring is drained between batches.
+ * @param  None
+ * @retval None
+ */
+static void Bench_Format(void)
+{
+    char params[BENCH_PARAM_LENGTH];
+    
+    for (uint8_t s = 0; s < sizeof(bench_steps); s++) {
+        uint8_t signals = bench_steps[s];
+        uint32_t batch = BENCH_FORMAT_BATCH / signals;
+        BenchTime_t elapsed = 0;
+        
+        if (signals > bench_config_count) break;
+        
+        Bench_FlushUart();
+        for (uint32_t done = 0; done < bench_iterations; done += batch) {
+            uint32_t frames = BENCH_MIN(batch, bench_iterations - done);
+            
+            BenchTime_t start = BENCH_NOW();
+            for (uint32_t f = 0; f < frames; f++) {
+                for (uint8_t k = 0; k < signals; k++) {
+                    Router_BenchFormatAndSendSignal(bench_configs[k], done + f);
+                }
+            }
+            elapsed += BENCH_NOW() - start;
+            Bench_FlushUart();
+        }
+        
+        sprintf(params, "signals=%u", signals);
+        Bench_Report("format", params, bench_iterations, elapsed);
+    }
+}
+
+/**
+ * @brief  UART_WriteData() into the TX ring for 8, 32 and 128 byte records
+ * @param  None
+ * @retval None
+ */
+static void Bench_UartWrite(void)
+{
+    static const uint16_t lengths[] = { 8, 32, 128 };
+    char params[BENCH_PARAM_LENGTH];
+    uint8_t data[128];
+    
+    memset(data, 'U', sizeof(data));
+    
+    for (uint8_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+        uint16_t length = lengths[n];
+        uint32_t batch = (UART_TX_BUFFER_SIZE / length) - 1;
+        BenchTime_t elapsed = 0;
+        
+        Bench_FlushUart();
+        for (uint32_t done = 0; done < bench_iterations; done += batch) {
+            uint32_t writes = BENCH_MIN(batch, bench_iterations - done);
+            
+            BenchTime_t start = BENCH_NOW();
+            for (uint32_t w = 0; w < writes; w++) {
+                UART_WriteData(data, length);
+            }
+            elapsed += BENCH_NOW() - start;
+            Bench_FlushUart();
+        }
+        
+        sprintf(params, "len=%u", length);
+        Bench_Report("uart_write", params, bench_iterations, elapsed);
+    }
+}
+
+/**
+ * @brief  Router_ProcessCanFrame() of one message in one output mode
+ * @param  mode: Router output mode under test
+ * @param  can_id: Message to route
+ * @param  signals: Signals the message carries (reported parameter)
+ * @retval None
+ */
+static void Bench_ProcessFrame(RouterOutputMode_t mode, uint32_t can_id, uint8_t signals)
+{
+    char params[BENCH_PARAM_LENGTH];
+    CanFrame_t frame = { .id = can_id, .dlc = 8, .bus = CAN_BUS_1 };
+    BenchTime_t elapsed = 0;
+    
+    Router_SetOutputMode(mode, ROUTER_SNAPSHOT_PERIOD_MS);
+    Bench_FlushUart();
+    
+    for (uint32_t done = 0; done < bench_iterations; done += BENCH_FRAME_BATCH) {
+        uint32_t frames = BENCH_MIN(BENCH_FRAME_BATCH, bench_iterations - done);
+        
+        frame.time = (uint16_t)HAL_GetTick();
+        BenchTime_t start = BENCH_NOW();
+        for (uint32_t f = 0; f < frames; f++) {
+            frame.data[2] = (uint8_t)f;     /* Selector (byte 0) stays 0 */
+            Router_ProcessCanFrame(&frame);
+        }
+        elapsed += BENCH_NOW() - start;
+        Bench_FlushUart();
+    }
+    
+    sprintf(params, "mode=%s;signals=%u", (mode == ROUTER_OUTPUT_EVENT) ? "event" : "snapshot", signals);
+    Bench_Report("process_frame", params, bench_iterations, elapsed);
+}
+
+#ifdef GATEWAY_HOST
+/**
+ * @brief  CAN RX interrupt body for one receive path, with the FIFO load
+ * @note   One interrupt costs about as much as a clock read, so rounds of
+ *         'batch' interrupts are timed and the fastest round is reported:
+ *         "rx_isr" is FIFO load plus interrupt, "rx_fifo_load" the load
+ *         alone. The RX queues are drained between rounds; a path that
+ *         queues its frames takes at most CAN_RX_BUFFER_SIZE per round.
+ * @param  path: Receive path name (reported parameter)
+ * @param  can_id: Identifier that takes this path
+ * @param  batch: Interrupts per round
+ * @retval None
+ */
+static void Bench_RxIsr(const char* path, uint32_t can_id, uint32_t batch)
+{
+    static const uint8_t data[8] = { 0x10, 0x27, 0x5A, 0x00, 0xE8, 0x03, 0x00, 0x00 };
+    char params[BENCH_PARAM_LENGTH];
+    BenchTime_t fastest = (BenchTime_t)-1;
+    BenchTime_t fastest_load = (BenchTime_t)-1;
+    uint32_t rounds = (bench_iterations + batch - 1) / batch;
+    
+    if (!HostPort_CanLoadFifo(CAN_BUS_1, can_id, 8, data)) return;   /* Filtered in hardware */
+    
+    for (uint32_t r = 0; r < rounds; r++) {
+        Bench_DrainCan();
+        
+        BenchTime_t start = BENCH_NOW();
+        for (uint32_t f = 0; f < batch; f++) {
+            HostPort_CanLoadFifo(CAN_BUS_1, can_id, 8, data);
+            CAN_RxIRQHandler(CAN_BUS_1);
+        }
+        BenchTime_t elapsed = BENCH_NOW() - start;
+        fastest = BENCH_MIN(fastest, elapsed);
+        
+        start = BENCH_NOW();
+        for (uint32_t f = 0; f < batch; f++) {
+            HostPort_CanLoadFifo(CAN_BUS_1, can_id, 8, data);
+        }
+        elapsed = BENCH_NOW() - start;
+        fastest_load = BENCH_MIN(fastest_load, elapsed);
+    }
+    Bench_DrainCan();
+    
+    sprintf(params, "path=%s;batch=%lu", path, (unsigned long)batch);
+    Bench_ReportPerOp("rx_isr", params, rounds * batch, ((uint64_t)fastest * 100U) / batch);
+    Bench_ReportPerOp("rx_fifo_load", params, rounds * batch, ((uint64_t)fastest_load * 100U) / batch);
+}
+
+/**
+ * @brief  CAN_Receive() with a given number of frames queued
+ * @param  depth: Frames queued before each timed drain
+ * @retval None
+ */
+static void Bench_CanReceive(uint8_t depth)
+{
+    static const uint8_t data[8] = { 0x00, 0x10, 0x27, 0x5A, 0x00, 0x00, 0x00, 0x00 };
+    char params[BENCH_PARAM_LENGTH];
+    CanFrame_t frame;
+    BenchTime_t elapsed = 0;
+    uint32_t received = 0;
+    
+    while (received < bench_iterations) {
+        for (uint8_t d = 0; d < depth; d++) {
+            HostPort_CanDeliver(CAN_BUS_1, BENCH_MUX_ID, 8, data);
+        }
+        
+        BenchTime_t start = BENCH_NOW();
+        for (uint8_t d = 0; d < depth; d++) {
+            received += CAN_Receive(&frame) ? 1 : 0;
+        }
+        elapsed += BENCH_NOW() - start;
+    }
+    
+    sprintf(params, "depth=%u", depth);
+    Bench_Report("can_receive", params, received, elapsed);
+}
+
+/**
+ * @brief  Empty the CAN RX queues
+ * @param  None
+ * @retval None
+ */
+static void Bench_DrainCan(void)
+{
+    CanFrame_t frame;
+    while (CAN_Receive(&frame)) {
+    }
+}
+#endif
+
+/**
+ * @brief  Wait until the UART TX ring is empty (host: discard its content)
+ * @param  None
+ * @retval None
+ */
+static void Bench_FlushUart(void)
+{
+#ifdef GATEWAY_HOST
+    HostPort_UartTransmit(NULL, UINT32_MAX);
+#else
+    while (UART_GetTxFreeSpace() < UART_TX_BUFFER_SIZE) {
+    }
+#endif
+}
+
+/**
+ * @brief  Print one result line
+ * @param  name: Benchmark name
+ * @param  params: Parameters, key=value separated by ';'
+ * @param  ops: Operations measured
+ * @param  elapsed: Total time of all operations
+ * @retval None
+ */
+static void Bench_Report(const char* name, const char* params, uint32_t ops, BenchTime_t elapsed)
+{
+    Bench_ReportPerOp(name, params, ops, (ops > 0) ? ((uint64_t)elapsed * 100U) / ops : 0);
+}
+
+/**
+ * @brief  Print one result line with a given time per operation
+ * @param  name: Benchmark name
+ * @param  params: Parameters, key=value separated by ';'
+ * @param  ops: Operations measured
+ * @param  per_op_x100: Time per operation in hundredths
+ * @retval None
+ */
+static void Bench_ReportPerOp(const char* name, const char* params, uint32_t ops, uint64_t per_op_x100)
+{
+    char line[BENCH_LINE_LENGTH];
+    
+    sprintf(line, "BENCH,%s,%s,%lu,%s,%lu.%02lu\r\n", name, params, (unsigned long)ops, BENCH_UNIT,
+            (unsigned long)(per_op_x100 / 100U), (unsigned long)(per_op_x100 % 100U));
+    
+    Bench_FlushUart();
+    bench_print(line);
+}
+
+#endif /* GATEWAY_BENCH */
@@ -0,0 +1,291 @@
+/**
+ ******************************************************************************
+ * @file    gw_selftest.c
+ * @brief   Loopback throughput self-test
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Capacity check of a firmware build on its own board: the CAN
+ *          controller, initialized in loopback or silent-loopback mode,
+ *          receives every frame it sends. The traffic generator keeps its
+ *          mailboxes full with the "saturate" profile from the TX
+ *          interrupt, and the frames take the real path: hardware
+ *          filters, RX interrupt, class queues, CAN_Receive(),
+ *          Router_ProcessCanFrame(), Router_Poll() and the UART driver.
+ *
+ *          CPU load is measured by counting idle main-loop passes. Before
+ *          the run the same loop counts its passes on an idle bus, which
+ *          gives 0% load, and the passes missing during the run are busy
+ *          time. Interrupt handlers count as busy as well. Printed as:
+ *            SELFTEST,Mode:<mode>,Bitrate:<bps>,Ms:<ms>,Sent:<n>,Received:<n>,
+ *            Processed:<n>,FramesPerSec:<n>,CpuLoad:<pct>%,RxDropped:<n>,
+ *            FifoOverruns:<n>,UartDropped:<n>
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "gw_selftest.h"
+#include "can_test_generator.h"
+#include "pdu_router.h"
+#include "uart_drv.h"
+#include <stdio.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Counters sampled at the start and at the end of a run
+ */
+typedef struct {
+    CanRxStats_t rx;
+    RouterStats_t router;
+    uint32_t uart_rejected;
+} SelfTestSample_t;
+
+/**
+ * @brief Self-test state
+ */
+typedef struct {
+    CanBus_t bus;
+    uint32_t start_tick;
+    uint32_t duration_ms;
+    uint32_t idle_passes;
+    uint32_t calibrated_passes; /* Idle passes in SELFTEST_CALIBRATE_MS, 0 = none */
+    bool running;
+    SelfTestSample_t start;
+    SelfTestSample_t end;
+    TestGenStats_t generator;
+} SelfTest_t;
+
+/* Private define ------------------------------------------------------------*/
+#define SELFTEST_LINE_LENGTH    256     /* Result line with all counters at 10 digits */
+#define SELFTEST_PROFILE        "saturate"
+#define SELFTEST_SETTLE_MS      10      /* Loopback frames still in flight after the stop */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static SelfTest_t selftest;
+
+static const char* const selftest_mode_names[] = {
+    "NORMAL", "LOOPBACK", "SILENT", "SILENT_LOOPBACK"
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static bool SelfTest_Pass(void);
+static void SelfTest_Sample(SelfTestSample_t* sample);
+static void SelfTest_DrainUart(void);
+static bool SelfTest_WaitTick(void);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Run the whole self-test and print its result line
+ * @note   Blocking for about seconds + 1 s. The controller must already be
+ *         initialized in CAN_MODE_LOOPBACK or CAN_MODE_SILENT_LOOPBACK (use
+ *         the latter on a connected vehicle bus), and the router and UART
+ *         must be initialized. Router statistics keep the test frames.
+ * @param  bus: Controller in loopback mode
+ * @param  bitrate: Bitrate the controller runs at
+ * @param  seconds: Duration of the saturated run
+ * @param  print: Sink for the result line
+ * @retval true if the test ran, false if the controller is not in loopback
+ *         or the tick does not advance (SysTick not started)
+ */
+bool SelfTest_RunLoopback(CanBus_t bus, uint32_t bitrate, uint32_t seconds, SelfTestPrint_t print)
+{
+    SelfTestResult_t result;
+    char line[SELFTEST_LINE_LENGTH];
+    CanMode_t mode = CAN_GetMode(bus);
+    
+    if (print == NULL || (mode != CAN_MODE_LOOPBACK && mode != CAN_MODE_SILENT_LOOPBACK)) {
+        return false;
+    }
+    
+    /* Every wait below is timed by the tick: give up if SysTick is not running */
+    if (!SelfTest_WaitTick()) return false;
+    
+    /* Idle reference: same loop, no traffic, quiet UART */
+    SelfTest_DrainUart();
+    SelfTest_WaitTick();
+    uint32_t tick = HAL_GetTick();
+    
+    uint32_t passes = 0;
+    while ((HAL_GetTick() - tick) < SELFTEST_CALIBRATE_MS) {
+        CANTestGenerator_Run();
+        if (!SelfTest_Pass()) passes++;
+    }
+    
+    if (!SelfTest_Start(bus, bitrate, seconds)) return false;
+    selftest.calibrated_passes = passes;
+    
+    while (SelfTest_Poll());
+    
+    /* Let the frames still in the mailboxes come back, then empty the UART */
+    tick = HAL_GetTick();
+    while ((HAL_GetTick() - tick) < SELFTEST_SETTLE_MS) {
+        SelfTest_Pass();
+    }
+    SelfTest_DrainUart();
+    
+    SelfTest_Finish(&result);
+    snprintf(line, sizeof(line),
+             "SELFTEST,Mode:%s,Bitrate:%lu,Ms:%lu,Sent:%lu,Received:%lu,Processed:%lu,FramesPerSec:%lu,"
+             "CpuLoad:%u.%u%%,RxDropped:%lu,FifoOverruns:%lu,UartDropped:%lu\r\n",
+             selftest_mode_names[mode], (unsigned long)bitrate, (unsigned long)result.duration_ms,
+             (unsigned long)result.frames_sent, (unsigned long)result.frames_received,
+             (unsigned long)result.frames_processed, (unsigned long)result.frames_per_sec,
+             result.cpu_load_permille / 10U, result.cpu_load_permille % 10U,
+             (unsigned long)result.rx_dropped, (unsigned long)result.fifo_overruns,
+             (unsigned long)result.uart_dropped);
+    print(line);
+    
+    return true;
+}
+
+/**
+ * @brief  Start a saturated loopback run without the idle calibration
+ * @note   For callers with their own main loop (host tools): call
+ *         SelfTest_Poll() until it returns false, then SelfTest_Finish().
+ * @param  bus: Controller in loopback mode
+ * @param  bitrate: Bitrate the controller runs at
+ * @param  seconds: Duration of the run
+ * @retval true if started, false if the controller is not in loopback
+ */
+bool SelfTest_Start(CanBus_t bus, uint32_t bitrate, uint32_t seconds)
+{
+    CanMode_t mode = CAN_GetMode(bus);
+    
+    if (seconds == 0 || (mode != CAN_MODE_LOOPBACK && mode != CAN_MODE_SILENT_LOOPBACK)) {
+        return false;
+    }
+    
+    selftest.bus = bus;
+    selftest.duration_ms = seconds * 1000U;
+    selftest.idle_passes = 0;
+    selftest.calibrated_passes = 0;
+    SelfTest_Sample(&selftest.start);
+    
+    if (!CANTestGenerator_Start(bus, bitrate, CANTestGenerator_FindProfile(SELFTEST_PROFILE), SELFTEST_SEED)) {
+        return false;
+    }
+    
+    selftest.start_tick = HAL_GetTick();
+    selftest.running = true;
+    
+    return true;
+}
+
+/**
+ * @brief  One main-loop pass of a run
+ * @param  None
+ * @retval true while the run lasts, false once it has ended
+ */
+bool SelfTest_Poll(void)
+{
+    if (!selftest.running) return false;
+    
+    CANTestGenerator_Run();
+    if (!SelfTest_Pass()) {
+        selftest.idle_passes++;
+    }
+    
+    if ((HAL_GetTick() - selftest.start_tick) < selftest.duration_ms) return true;
+    
+    /* Counters first: frames still in flight do not count */
+    SelfTest_Sample(&selftest.end);
+    CANTestGenerator_GetStats(&selftest.generator);
+    CANTestGenerator_Stop();
+    selftest.running = false;
+    
+    return false;
+}
+
+/**
+ * @brief  Results of the last run
+ * @param  result: Pointer to result structure
+ * @retval None
+ */
+void SelfTest_Finish(SelfTestResult_t* result)
+{
+    const SelfTestSample_t* start = &selftest.start;
+    const SelfTestSample_t* end = &selftest.end;
+    
+    if (result == NULL) return;
+    
+    result->duration_ms = selftest.duration_ms;
+    result->frames_sent = selftest.generator.frames_sent;
+    result->frames_received = end->rx.frames_received - start->rx.frames_received;
+    result->frames_processed = end->router.frames_processed - start->router.frames_processed;
+    result->rx_dropped = end->rx.frames_dropped - start->rx.frames_dropped;
+    result->fifo_overruns = end->rx.fifo_overruns - start->rx.fifo_overruns;
+    result->uart_dropped = end->uart_rejected - start->uart_rejected;
+    result->frames_per_sec = (uint32_t)((uint64_t)result->frames_processed * 1000U / selftest.duration_ms);
+    result->cpu_load_permille = 0;
+    
+    if (selftest.calibrated_passes > 0) {
+        uint64_t idle_expected = (uint64_t)selftest.calibrated_passes * selftest.duration_ms / SELFTEST_CALIBRATE_MS;
+        if (selftest.idle_passes < idle_expected) {
+            result->cpu_load_permille = (uint16_t)(1000U - (uint64_t)selftest.idle_passes * 1000U / idle_expected);
+        }
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Gateway main loop body: drain the RX queues, then periodic tasks
+ * @param  None
+ * @retval true if frames were processed, false for an idle pass
+ */
+static bool SelfTest_Pass(void)
+{
+    CanFrame_t frame;
+    bool busy = false;
+    
+    while (CAN_Receive(&frame)) {
+        Router_ProcessCanFrame(&frame);
+        busy = true;
+    }
+    Router_Poll();
+    
+    return busy;
+}
+
+/**
+ * @brief  Read the counters a run is measured with
+ * @param  sample: Counters
+ * @retval None
+ */
+static void SelfTest_Sample(SelfTestSample_t* sample)
+{
+    CAN_GetRxStats(&sample->rx);
+    Router_GetStatistics(&sample->router);
+    sample->uart_rejected = UART_GetPort()->tx_rejected;
+}
+
+/**
+ * @brief  Wait until the UART has sent everything queued, or time out
+ * @param  None
+ * @retval None
+ */
+static void SelfTest_DrainUart(void)
+{
+    uint32_t tick = HAL_GetTick();
+    
+    while (UART_GetTxFreeSpace() < UART_TX_BUFFER_SIZE && (HAL_GetTick() - tick) < SELFTEST_DRAIN_MS);
+}
+
+/**
+ * @brief  Wait for the next tick edge
+ * @param  None
+ * @retval true on a tick edge, false if the tick stood still (SysTick stopped)
+ */
+static bool SelfTest_WaitTick(void)
+{
+    uint32_t tick = HAL_GetTick();
+    uint32_t timeout = SystemCoreClock / 1000; /* At least 1 ms of polls */
+    
+    while (HAL_GetTick() == tick && timeout--);
+    
+    return (HAL_GetTick() != tick);
+}
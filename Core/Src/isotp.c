@@ -0,0 +1,417 @@
+/**
+ ******************************************************************************
+ * @file    isotp.c
+ * @brief   ISO 15765-2 (ISO-TP) transport layer for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Normal addressing, classic CAN (8-byte frames), payloads up to
+ *          4095 bytes. The layer does not touch the CAN driver directly:
+ *          frames leave through the link's send function and arrive through
+ *          IsoTp_OnFrame(), so two links can be connected back to back.
+ *          Reassembly buffers come from a static pool shared by all links;
+ *          a first frame that finds the pool empty is answered with a flow
+ *          control OVFLW. Time is in ms; sub-millisecond STmin values
+ *          (0xF1-0xF9) are honoured as 1 ms.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isotp.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define ISOTP_PCI_SF            0x0
+#define ISOTP_PCI_FF            0x1
+#define ISOTP_PCI_CF            0x2
+#define ISOTP_PCI_FC            0x3
+
+#define ISOTP_FC_CTS            0x0
+#define ISOTP_FC_WAIT           0x1
+#define ISOTP_FC_OVFLW          0x2
+
+#define ISOTP_SF_MAX            7
+#define ISOTP_FF_DATA           6
+#define ISOTP_CF_DATA           7
+
+/* Private macro -------------------------------------------------------------*/
+#define ISOTP_TIME_REACHED(now, t)  ((int32_t)((now) - (t)) >= 0)
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t rx_pool[ISOTP_POOL_BUFFERS][ISOTP_MAX_PAYLOAD];
+static bool rx_pool_used[ISOTP_POOL_BUFFERS];
+
+/* Private function prototypes -----------------------------------------------*/
+static bool IsoTp_SendFrame(IsoTpLink_t* link, const uint8_t* data, uint8_t length);
+static void IsoTp_SendFlowControl(IsoTpLink_t* link, uint8_t status);
+static uint8_t* IsoTp_PoolAlloc(void);
+static void IsoTp_PoolFree(uint8_t* buffer);
+static void IsoTp_AbortReception(IsoTpLink_t* link);
+static uint8_t IsoTp_DecodeStMin(uint8_t st_min);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize ISO-TP link
+ * @param  link: Link instance
+ * @param  config: Link configuration (copied)
+ * @param  send: Frame transmit function
+ * @param  on_receive: Called with every completely received message
+ * @param  context: Passed to send and on_receive
+ * @retval None
+ */
+void IsoTp_Init(IsoTpLink_t* link, const IsoTpConfig_t* config, IsoTpSendFn_t send,
+                IsoTpReceiveFn_t on_receive, void* context)
+{
+    memset(link, 0, sizeof(IsoTpLink_t));
+    link->config = *config;
+    if (link->config.timeout_ms == 0) {
+        link->config.timeout_ms = ISOTP_DEFAULT_TIMEOUT;
+    }
+    link->send = send;
+    link->on_receive = on_receive;
+    link->context = context;
+}
+
+/**
+ * @brief  Start transmission of a message
+ * @param  link: Link instance
+ * @param  data: Message (must stay valid until IsoTp_IsBusy() returns false)
+ * @param  length: Message length (1-4095)
+ * @param  now: Current tick (ms)
+ * @retval true if transmission started, false if busy or invalid
+ */
+bool IsoTp_Send(IsoTpLink_t* link, const uint8_t* data, uint16_t length, uint32_t now)
+{
+    uint8_t frame[8];
+    
+    if (link->tx_state != ISOTP_STATE_IDLE || data == NULL ||
+        length == 0 || length > ISOTP_MAX_PAYLOAD) {
+        return false;
+    }
+    
+    if (length <= ISOTP_SF_MAX) {
+        /* Single frame */
+        frame[0] = (ISOTP_PCI_SF << 4) | (uint8_t)length;
+        memcpy(&frame[1], data, length);
+        if (!IsoTp_SendFrame(link, frame, (uint8_t)(length + 1))) {
+            return false;
+        }
+        link->stats.messages_sent++;
+        link->stats.bytes_sent += length;
+        return true;
+    }
+    
+    /* First frame, then wait for the receiver's flow control */
+    frame[0] = (ISOTP_PCI_FF << 4) | (uint8_t)(length >> 8);
+    frame[1] = (uint8_t)(length & 0xFF);
+    memcpy(&frame[2], data, ISOTP_FF_DATA);
+    if (!IsoTp_SendFrame(link, frame, 8)) {
+        return false;
+    }
+    
+    link->tx_data = data;
+    link->tx_length = length;
+    link->tx_offset = ISOTP_FF_DATA;
+    link->tx_sn = 1;
+    link->tx_state = ISOTP_STATE_WAIT_FC;
+    link->tx_timer = now + link->config.timeout_ms;
+    
+    return true;
+}
+
+/**
+ * @brief  Handle received CAN frame
+ * @param  link: Link instance
+ * @param  frame: Received frame (ignored unless id matches rx_id)
+ * @param  now: Current tick (ms)
+ * @retval None
+ */
+void IsoTp_OnFrame(IsoTpLink_t* link, const CanFrame_t* frame, uint32_t now)
+{
+    if (frame->id != link->config.rx_id || frame->dlc == 0) return;
+    
+    const uint8_t* data = frame->data;
+    uint8_t pci = data[0] >> 4;
+    
+    switch (pci) {
+        case ISOTP_PCI_SF: {
+            uint8_t length = data[0] & 0x0F;
+            if (length == 0 || length > ISOTP_SF_MAX || length > frame->dlc - 1) break;
+            
+            /* A new message terminates any reception in progress */
+            IsoTp_AbortReception(link);
+            link->stats.messages_received++;
+            link->stats.bytes_received += length;
+            if (link->on_receive != NULL) {
+                link->on_receive(link->context, &data[1], length);
+            }
+            break;
+        }
+        
+        case ISOTP_PCI_FF: {
+            uint16_t length = ((uint16_t)(data[0] & 0x0F) << 8) | data[1];
+            if (length <= ISOTP_SF_MAX || frame->dlc < 8) break;
+            
+            IsoTp_AbortReception(link);
+            link->rx_buffer = IsoTp_PoolAlloc();
+            if (link->rx_buffer == NULL) {
+                link->stats.pool_exhausted++;
+                IsoTp_SendFlowControl(link, ISOTP_FC_OVFLW);
+                break;
+            }
+            
+            memcpy(link->rx_buffer, &data[2], ISOTP_FF_DATA);
+            link->rx_length = length;
+            link->rx_offset = ISOTP_FF_DATA;
+            link->rx_sn = 1;
+            link->rx_block_count = 0;
+            link->rx_state = ISOTP_STATE_RECEIVING;
+            link->rx_timer = now + link->config.timeout_ms;
+            IsoTp_SendFlowControl(link, ISOTP_FC_CTS);
+            break;
+        }
+        
+        case ISOTP_PCI_CF: {
+            if (link->rx_state != ISOTP_STATE_RECEIVING) break;
+            
+            if ((data[0] & 0x0F) != link->rx_sn) {
+                link->stats.sequence_errors++;
+                IsoTp_AbortReception(link);
+                break;
+            }
+            
+            uint16_t remaining = link->rx_length - link->rx_offset;
+            uint8_t chunk = (remaining < ISOTP_CF_DATA) ? (uint8_t)remaining : ISOTP_CF_DATA;
+            if (frame->dlc < chunk + 1) {
+                link->stats.sequence_errors++;
+                IsoTp_AbortReception(link);
+                break;
+            }
+            
+            memcpy(&link->rx_buffer[link->rx_offset], &data[1], chunk);
+            link->rx_offset += chunk;
+            link->rx_sn = (link->rx_sn + 1) & 0x0F;
+            link->rx_timer = now + link->config.timeout_ms;
+            
+            if (link->rx_offset >= link->rx_length) {
+                link->stats.messages_received++;
+                link->stats.bytes_received += link->rx_length;
+                if (link->on_receive != NULL) {
+                    link->on_receive(link->context, link->rx_buffer, link->rx_length);
+                }
+                IsoTp_AbortReception(link);     /* Releases pool buffer */
+            } else if (link->config.block_size > 0 &&
+                       ++link->rx_block_count >= link->config.block_size) {
+                link->rx_block_count = 0;
+                IsoTp_SendFlowControl(link, ISOTP_FC_CTS);
+            }
+            break;
+        }
+        
+        case ISOTP_PCI_FC: {
+            if (link->tx_state != ISOTP_STATE_WAIT_FC || frame->dlc < 3) break;
+            
+            switch (data[0] & 0x0F) {
+                case ISOTP_FC_CTS:
+                    link->tx_block_size = data[1];
+                    link->tx_block_left = data[1];
+                    link->tx_st_min_ms = IsoTp_DecodeStMin(data[2]);
+                    link->tx_state = ISOTP_STATE_SENDING;
+                    link->tx_timer = now;
+                    IsoTp_Poll(link, now);      /* First CF without waiting for next poll */
+                    break;
+                    
+                case ISOTP_FC_WAIT:
+                    link->tx_timer = now + link->config.timeout_ms;
+                    break;
+                    
+                default:
+                    link->stats.overflow_aborts++;
+                    link->tx_state = ISOTP_STATE_IDLE;
+                    break;
+            }
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief  Send due consecutive frames and supervise timeouts
+ * @param  link: Link instance
+ * @param  now: Current tick (ms)
+ * @retval None
+ */
+void IsoTp_Poll(IsoTpLink_t* link, uint32_t now)
+{
+    /* Receive timeout (N_Cr) */
+    if (link->rx_state == ISOTP_STATE_RECEIVING && ISOTP_TIME_REACHED(now, link->rx_timer)) {
+        link->stats.timeouts++;
+        IsoTp_AbortReception(link);
+    }
+    
+    /* Flow control timeout (N_Bs) */
+    if (link->tx_state == ISOTP_STATE_WAIT_FC && ISOTP_TIME_REACHED(now, link->tx_timer)) {
+        link->stats.timeouts++;
+        link->tx_state = ISOTP_STATE_IDLE;
+        return;
+    }
+    
+    /* Consecutive frames: burst while STmin is 0, else one per STmin */
+    while (link->tx_state == ISOTP_STATE_SENDING && ISOTP_TIME_REACHED(now, link->tx_timer)) {
+        uint8_t frame[8];
+        uint16_t remaining = link->tx_length - link->tx_offset;
+        uint8_t chunk = (remaining < ISOTP_CF_DATA) ? (uint8_t)remaining : ISOTP_CF_DATA;
+        
+        frame[0] = (ISOTP_PCI_CF << 4) | link->tx_sn;
+        memcpy(&frame[1], &link->tx_data[link->tx_offset], chunk);
+        if (!IsoTp_SendFrame(link, frame, (uint8_t)(chunk + 1))) {
+            break;  /* TX queue full: retry on next poll */
+        }
+        
+        link->tx_offset += chunk;
+        link->tx_sn = (link->tx_sn + 1) & 0x0F;
+        
+        if (link->tx_offset >= link->tx_length) {
+            link->stats.messages_sent++;
+            link->stats.bytes_sent += link->tx_length;
+            link->tx_state = ISOTP_STATE_IDLE;
+            break;
+        }
+        
+        if (link->tx_block_size > 0 && --link->tx_block_left == 0) {
+            link->tx_state = ISOTP_STATE_WAIT_FC;
+            link->tx_timer = now + link->config.timeout_ms;
+            break;
+        }
+        
+        /* The frame may have left late in tick 'now': one extra tick keeps
+           the gap to the next one at least STmin */
+        link->tx_timer = now + link->tx_st_min_ms + ((link->tx_st_min_ms > 0) ? 1U : 0U);
+    }
+}
+
+/**
+ * @brief  Check whether a transmission is in progress
+ * @param  link: Link instance
+ * @retval true while the caller's TX buffer is still in use
+ */
+bool IsoTp_IsBusy(const IsoTpLink_t* link)
+{
+    return link->tx_state != ISOTP_STATE_IDLE;
+}
+
+/**
+ * @brief  Default send function: queue frame on a CAN controller
+ * @param  context: Pointer to CanBus_t of the controller
+ * @param  id: CAN identifier
+ * @param  data: Frame data
+ * @param  dlc: Data length code
+ * @retval true if accepted by the CAN TX queue
+ */
+bool IsoTp_CanSend(void* context, uint32_t id, const uint8_t* data, uint8_t dlc)
+{
+    CanFrame_t frame;
+    
+    frame.id = id;
+    frame.dlc = dlc;
+    memcpy(frame.data, data, dlc);
+    
+    return CAN_Transmit(*(const CanBus_t*)context, &frame);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Send one frame, padded to 8 bytes if configured
+ * @param  link: Link instance
+ * @param  data: Frame bytes
+ * @param  length: Number of meaningful bytes
+ * @retval true if accepted
+ */
+static bool IsoTp_SendFrame(IsoTpLink_t* link, const uint8_t* data, uint8_t length)
+{
+    uint8_t frame[8];
+    
+    memcpy(frame, data, length);
+    if (link->config.padding) {
+        memset(&frame[length], ISOTP_PAD_BYTE, 8 - length);
+        length = 8;
+    }
+    
+    return link->send(link->context, link->config.tx_id, frame, length);
+}
+
+/**
+ * @brief  Send flow control frame with our BS/STmin
+ * @param  link: Link instance
+ * @param  status: Flow status (CTS, WAIT, OVFLW)
+ */
+static void IsoTp_SendFlowControl(IsoTpLink_t* link, uint8_t status)
+{
+    uint8_t frame[3];
+    
+    frame[0] = (ISOTP_PCI_FC << 4) | status;
+    frame[1] = link->config.block_size;
+    frame[2] = link->config.st_min;
+    
+    IsoTp_SendFrame(link, frame, sizeof(frame));
+}
+
+/**
+ * @brief  Take a free reassembly buffer from the static pool
+ * @retval Buffer, NULL if all buffers are in use
+ */
+static uint8_t* IsoTp_PoolAlloc(void)
+{
+    for (int i = 0; i < ISOTP_POOL_BUFFERS; i++) {
+        if (!rx_pool_used[i]) {
+            rx_pool_used[i] = true;
+            return rx_pool[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Return reassembly buffer to the pool
+ * @param  buffer: Buffer obtained from IsoTp_PoolAlloc()
+ */
+static void IsoTp_PoolFree(uint8_t* buffer)
+{
+    for (int i = 0; i < ISOTP_POOL_BUFFERS; i++) {
+        if (buffer == rx_pool[i]) {
+            rx_pool_used[i] = false;
+        }
+    }
+}
+
+/**
+ * @brief  Drop reception in progress and release its buffer
+ * @param  link: Link instance
+ */
+static void IsoTp_AbortReception(IsoTpLink_t* link)
+{
+    if (link->rx_buffer != NULL) {
+        IsoTp_PoolFree(link->rx_buffer);
+        link->rx_buffer = NULL;
+    }
+    link->rx_state = ISOTP_STATE_IDLE;
+}
+
+/**
+ * @brief  Convert STmin from ISO encoding to milliseconds
+ * @param  st_min: 0x00-0x7F = ms, 0xF1-0xF9 = 100-900 us, others reserved
+ * @retval Separation time in ms (reserved values map to 127 ms)
+ */
+static uint8_t IsoTp_DecodeStMin(uint8_t st_min)
+{
+    if (st_min <= 0x7F) return st_min;
+    if (st_min >= 0xF1 && st_min <= 0xF9) return 1;
+    return 0x7F;
+}
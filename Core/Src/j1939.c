@@ -0,0 +1,443 @@
+/**
+ ******************************************************************************
+ * @file    j1939.c
+ * @brief   SAE J1939 PGN routing for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    29-bit frames are decoded into PGN / priority / source /
+ *          destination and dispatched through a PGN hash table built from
+ *          the constant route table at init, so lookup cost does not grow
+ *          with the number of routes. Routes may ignore source address and
+ *          priority. Multi-packet messages sent with the BAM transport
+ *          protocol (TP.CM / TP.DT to the global address) are reassembled
+ *          and dispatched like single frames. Connection-mode transfers
+ *          (RTS/CTS) are addressed to other nodes and are not taken part in.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "j1939.h"
+#include "uart_drv.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief BAM reassembly session
+ */
+typedef struct {
+    bool active;
+    uint8_t bus;
+    uint8_t source;
+    uint8_t priority;
+    uint32_t pgn;               /* Transported PGN */
+    uint16_t size;              /* Announced message size */
+    uint8_t packets;            /* Announced number of packets */
+    uint8_t next_seq;           /* Expected TP.DT sequence number */
+    uint32_t timer;             /* T1 deadline */
+    uint8_t data[J1939_BAM_MAX_SIZE];
+} J1939BamSession_t;
+
+/* Private define ------------------------------------------------------------*/
+#define J1939_ROUTE_COUNT       (sizeof(route_table) / sizeof(route_table[0]))
+#define J1939_ROUTE_END         0xFF
+#define J1939_PF_PDU2           240     /* PF >= 240: PDU2, PS is group extension */
+#define J1939_PGN_MASK          0x3FFFFU
+#define J1939_TP_CM_BAM         0x20
+#define J1939_TP_PACKET_SIZE    7
+
+#define J1939_PGN_EEC1          0xF004  /* Electronic engine controller 1 */
+#define J1939_PGN_ET1           0xFEEE  /* Engine temperature 1 */
+#define J1939_PGN_CCVS          0xFEF1  /* Cruise control / vehicle speed */
+#define J1939_PGN_DM1           0xFECA  /* Active diagnostic trouble codes */
+
+/* Private macro -------------------------------------------------------------*/
+#define J1939_HASH(pgn)         ((((pgn) * 2654435761U) >> 16) & (J1939_HASH_SIZE - 1))
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Route handlers, referenced by the route table */
+static void J1939_HandleEec1(const J1939Message_t* msg);
+static void J1939_HandleCcvs(const J1939Message_t* msg);
+static void J1939_HandleDm1(const J1939Message_t* msg);
+
+/**
+ * @brief PGN routing table
+ */
+static const J1939Route_t route_table[] = {
+    /* Engine speed: decode and pass on to body bus */
+    { .pgn = J1939_PGN_EEC1, .src_bus = CAN_BUS_1, .source = J1939_MATCH_ANY,
+      .priority = J1939_PRIORITY_ANY, .dst_bus = CAN_BUS_2, .handler = J1939_HandleEec1 },
+    
+    /* Engine temperature: forward only */
+    { .pgn = J1939_PGN_ET1, .src_bus = CAN_BUS_1, .source = J1939_MATCH_ANY,
+      .priority = J1939_PRIORITY_ANY, .dst_bus = CAN_BUS_2, .handler = NULL },
+    
+    /* Wheel-based vehicle speed from the engine controller only */
+    { .pgn = J1939_PGN_CCVS, .src_bus = CAN_BUS_1, .source = 0x00,
+      .priority = J1939_PRIORITY_ANY, .dst_bus = CAN_BUS_COUNT, .handler = J1939_HandleCcvs },
+    
+    /* Active DTCs, single frame or BAM */
+    { .pgn = J1939_PGN_DM1, .src_bus = CAN_BUS_1, .source = J1939_MATCH_ANY,
+      .priority = J1939_PRIORITY_ANY, .dst_bus = CAN_BUS_COUNT, .handler = J1939_HandleDm1 }
+};
+
+static uint8_t hash_head[J1939_HASH_SIZE];
+static uint8_t route_next[J1939_ROUTE_COUNT];
+static J1939BamSession_t bam_sessions[J1939_BAM_SESSIONS];
+static J1939Stats_t j1939_stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static void J1939_Decode(const CanFrame_t* frame, J1939Message_t* msg);
+static void J1939_Dispatch(const J1939Message_t* msg, const CanFrame_t* frame);
+static void J1939_HandleTpCm(const J1939Message_t* msg);
+static void J1939_HandleTpDt(const J1939Message_t* msg);
+static J1939BamSession_t* J1939_FindSession(uint8_t bus, uint8_t source);
+static bool J1939_IsPdu1(uint32_t pgn);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize J1939 routing
+ * @note   Must be called after the CAN controllers are initialized. Builds
+ *         the PGN hash table and programs 29-bit filters for every routed
+ *         PGN plus the BAM transport PGNs.
+ * @param  None
+ * @retval true if successful, false if filters could not be configured
+ */
+bool J1939_Init(void)
+{
+    memset(hash_head, J1939_ROUTE_END, sizeof(hash_head));
+    memset(bam_sessions, 0, sizeof(bam_sessions));
+    memset(&j1939_stats, 0, sizeof(j1939_stats));
+    
+    /* Chain routes by bucket, keeping table order within a bucket */
+    for (int i = J1939_ROUTE_COUNT - 1; i >= 0; i--) {
+        uint32_t bucket = J1939_HASH(route_table[i].pgn);
+        route_next[i] = hash_head[bucket];
+        hash_head[bucket] = (uint8_t)i;
+    }
+    
+    for (uint8_t bus = 0; bus < CAN_BUS_COUNT; bus++) {
+        uint32_t ids[CAN_FILTER_EXT_BANKS];
+        uint32_t masks[CAN_FILTER_EXT_BANKS];
+        uint8_t count = 0;
+        
+        for (uint16_t i = 0; i < J1939_ROUTE_COUNT; i++) {
+            const J1939Route_t* route = &route_table[i];
+            if (route->src_bus != (CanBus_t)bus) continue;
+            if (count >= CAN_FILTER_EXT_BANKS - 2) return false;
+            
+            ids[count] = route->pgn << 8;
+            masks[count] = (J1939_IsPdu1(route->pgn) ? 0x3FF00U : J1939_PGN_MASK) << 8;
+            if (route->source != J1939_MATCH_ANY) {
+                ids[count] |= route->source;
+                masks[count] |= 0xFF;
+            }
+            if (route->priority != J1939_PRIORITY_ANY) {
+                ids[count] |= (uint32_t)route->priority << 26;
+                masks[count] |= 0x07UL << 26;
+            }
+            count++;
+        }
+        
+        if (count == 0) continue;
+        
+        /* BAM transport: broadcast TP.CM / TP.DT from any source */
+        ids[count] = (J1939_PGN_TP_CM | J1939_ADDR_GLOBAL) << 8;
+        masks[count++] = J1939_PGN_MASK << 8;
+        ids[count] = (J1939_PGN_TP_DT | J1939_ADDR_GLOBAL) << 8;
+        masks[count++] = J1939_PGN_MASK << 8;
+        
+        if (!CAN_ConfigureFilterMaskExt((CanBus_t)bus, ids, masks, count)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Process received 29-bit CAN frame
+ * @param  frame: Pointer to CAN frame (standard frames are ignored)
+ * @retval None
+ */
+void J1939_ProcessCanFrame(const CanFrame_t* frame)
+{
+    J1939Message_t msg;
+    
+    if (frame == NULL || !(frame->id & CAN_ID_EXT)) return;
+    
+    j1939_stats.frames_received++;
+    J1939_Decode(frame, &msg);
+    
+    switch (msg.pgn) {
+        case J1939_PGN_TP_CM:
+            J1939_HandleTpCm(&msg);
+            break;
+            
+        case J1939_PGN_TP_DT:
+            J1939_HandleTpDt(&msg);
+            break;
+            
+        default:
+            J1939_Dispatch(&msg, frame);
+            break;
+    }
+}
+
+/**
+ * @brief  Supervise BAM reassembly timeouts
+ * @param  None
+ * @retval None
+ */
+void J1939_Poll(void)
+{
+    uint32_t now = HAL_GetTick();
+    
+    for (int i = 0; i < J1939_BAM_SESSIONS; i++) {
+        if (bam_sessions[i].active && (int32_t)(now - bam_sessions[i].timer) >= 0) {
+            bam_sessions[i].active = false;
+            j1939_stats.bam_aborted++;
+        }
+    }
+}
+
+/**
+ * @brief  Get J1939 statistics
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void J1939_GetStatistics(J1939Stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = j1939_stats;
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Split 29-bit identifier into J1939 fields
+ * @param  frame: Received frame
+ * @param  msg: Decoded message (data points into frame)
+ */
+static void J1939_Decode(const CanFrame_t* frame, J1939Message_t* msg)
+{
+    uint32_t id = frame->id & CAN_ID_EXT_MASK;
+    
+    msg->priority = (uint8_t)J1939_ID_PRIORITY(id);
+    msg->source = (uint8_t)J1939_ID_SA(id);
+    msg->pgn = (id >> 8) & J1939_PGN_MASK;
+    if (J1939_ID_PF(id) < J1939_PF_PDU2) {
+        /* PDU1: PS is the destination address, not part of the PGN */
+        msg->destination = (uint8_t)J1939_ID_PS(id);
+        msg->pgn &= ~0xFFU;
+    } else {
+        msg->destination = J1939_ADDR_GLOBAL;
+    }
+    msg->bus = frame->bus;
+    msg->length = frame->dlc;
+    msg->data = frame->data;
+    msg->timestamp = CAN_FRAME_TICK(frame, HAL_GetTick());
+}
+
+/**
+ * @brief  Deliver message to all matching routes
+ * @param  msg: Decoded message
+ * @param  frame: Original frame for forwarding, NULL for reassembled messages
+ */
+static void J1939_Dispatch(const J1939Message_t* msg, const CanFrame_t* frame)
+{
+    bool routed = false;
+    
+    for (uint8_t i = hash_head[J1939_HASH(msg->pgn)]; i != J1939_ROUTE_END; i = route_next[i]) {
+        const J1939Route_t* route = &route_table[i];
+        
+        if (route->pgn != msg->pgn || route->src_bus != (CanBus_t)msg->bus) continue;
+        if (route->source != J1939_MATCH_ANY && route->source != msg->source) continue;
+        if (route->priority != J1939_PRIORITY_ANY && route->priority != msg->priority) continue;
+        
+        routed = true;
+        
+        if (frame != NULL && route->dst_bus < CAN_BUS_COUNT) {
+            if (CAN_Transmit(route->dst_bus, frame)) {
+                j1939_stats.frames_forwarded++;
+            } else {
+                j1939_stats.forward_failed++;
+            }
+        }
+        
+        if (route->handler != NULL) {
+            route->handler(msg);
+            j1939_stats.messages_dispatched++;
+        }
+    }
+    
+    if (!routed) {
+        j1939_stats.messages_unrouted++;
+    }
+}
+
+/**
+ * @brief  Handle TP.CM: open BAM session on broadcast announce
+ * @param  msg: Decoded TP.CM frame
+ */
+static void J1939_HandleTpCm(const J1939Message_t* msg)
+{
+    const uint8_t* d = msg->data;
+    
+    if (msg->length < 8 || d[0] != J1939_TP_CM_BAM || msg->destination != J1939_ADDR_GLOBAL) return;
+    
+    uint16_t size = (uint16_t)d[1] | ((uint16_t)d[2] << 8);
+    uint8_t packets = d[3];
+    if (size <= 8 || size > J1939_BAM_MAX_SIZE ||
+        packets != (size + J1939_TP_PACKET_SIZE - 1) / J1939_TP_PACKET_SIZE) return;
+    
+    /* A new announce from the same source replaces an unfinished transfer */
+    J1939BamSession_t* session = J1939_FindSession(msg->bus, msg->source);
+    if (session != NULL) {
+        j1939_stats.bam_aborted++;
+    } else {
+        for (int i = 0; i < J1939_BAM_SESSIONS && session == NULL; i++) {
+            if (!bam_sessions[i].active) session = &bam_sessions[i];
+        }
+        if (session == NULL) {
+            j1939_stats.bam_no_session++;
+            return;
+        }
+    }
+    
+    session->active = true;
+    session->bus = msg->bus;
+    session->source = msg->source;
+    session->priority = msg->priority;
+    session->pgn = (uint32_t)d[5] | ((uint32_t)d[6] << 8) | ((uint32_t)d[7] << 16);
+    session->size = size;
+    session->packets = packets;
+    session->next_seq = 1;
+    session->timer = msg->timestamp + J1939_BAM_TIMEOUT_MS;
+}
+
+/**
+ * @brief  Handle TP.DT: store packet, dispatch completed message
+ * @param  msg: Decoded TP.DT frame
+ */
+static void J1939_HandleTpDt(const J1939Message_t* msg)
+{
+    J1939BamSession_t* session = J1939_FindSession(msg->bus, msg->source);
+    
+    if (session == NULL || msg->destination != J1939_ADDR_GLOBAL) return;
+    
+    if (msg->length < 8 || msg->data[0] != session->next_seq) {
+        session->active = false;
+        j1939_stats.bam_aborted++;
+        return;
+    }
+    
+    uint16_t offset = (uint16_t)(msg->data[0] - 1) * J1939_TP_PACKET_SIZE;
+    uint16_t chunk = session->size - offset;
+    if (chunk > J1939_TP_PACKET_SIZE) chunk = J1939_TP_PACKET_SIZE;
+    memcpy(&session->data[offset], &msg->data[1], chunk);
+    
+    session->next_seq++;
+    session->timer = msg->timestamp + J1939_BAM_TIMEOUT_MS;
+    
+    if (msg->data[0] == session->packets) {
+        J1939Message_t full = {
+            .pgn = session->pgn,
+            .priority = session->priority,
+            .source = session->source,
+            .destination = J1939_ADDR_GLOBAL,
+            .bus = session->bus,
+            .length = session->size,
+            .data = session->data,
+            .timestamp = msg->timestamp
+        };
+        
+        session->active = false;
+        j1939_stats.bam_completed++;
+        J1939_Dispatch(&full, NULL);
+    }
+}
+
+/**
+ * @brief  Find active BAM session of a sender
+ * @param  bus: Controller
+ * @param  source: Sender source address
+ * @retval Session, NULL if none
+ */
+static J1939BamSession_t* J1939_FindSession(uint8_t bus, uint8_t source)
+{
+    for (int i = 0; i < J1939_BAM_SESSIONS; i++) {
+        if (bam_sessions[i].active && bam_sessions[i].bus == bus &&
+            bam_sessions[i].source == source) {
+            return &bam_sessions[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Check whether PGN is destination specific (PDU1 format)
+ * @param  pgn: Parameter group number
+ * @retval true for PDU1 (PF < 240)
+ */
+static bool J1939_IsPdu1(uint32_t pgn)
+{
+    return ((pgn >> 8) & 0xFF) < J1939_PF_PDU2;
+}
+
+/**
+ * @brief  EEC1: engine speed, 0.125 rpm/bit in bytes 4-5
+ * @param  msg: Message
+ */
+static void J1939_HandleEec1(const J1939Message_t* msg)
+{
+    char buffer[64];
+    
+    if (msg->length < 5) return;
+    
+    uint32_t rpm = ((uint32_t)msg->data[3] | ((uint32_t)msg->data[4] << 8)) / 8;
+    sprintf(buffer, "J1939,EEC1,SA:0x%02X,RPM:%lu\r\n", msg->source, (unsigned long)rpm);
+    UART_Write(buffer);
+}
+
+/**
+ * @brief  CCVS: wheel-based vehicle speed, 1/256 km/h per bit in bytes 2-3
+ * @param  msg: Message
+ */
+static void J1939_HandleCcvs(const J1939Message_t* msg)
+{
+    char buffer[64];
+    
+    if (msg->length < 3) return;
+    
+    uint32_t speed = ((uint32_t)msg->data[1] | ((uint32_t)msg->data[2] << 8)) / 256;
+    sprintf(buffer, "J1939,CCVS,SA:0x%02X,Speed:%lu\r\n", msg->source, (unsigned long)speed);
+    UART_Write(buffer);
+}
+
+/**
+ * @brief  DM1: lamp status followed by 4-byte DTCs (SPN/FMI/OC)
+ * @param  msg: Message
+ */
+static void J1939_HandleDm1(const J1939Message_t* msg)
+{
+    char buffer[80];
+    
+    if (msg->length < 6) return;
+    
+    const uint8_t* dtc = &msg->data[2];
+    uint16_t count = (msg->length - 2) / 4;
+    uint32_t spn = (uint32_t)dtc[0] | ((uint32_t)dtc[1] << 8) | ((uint32_t)(dtc[2] & 0xE0) << 11);
+    
+    /* Single frame with SPN 0 means "no active DTC" */
+    if (count == 1 && spn == 0) count = 0;
+    
+    sprintf(buffer, "J1939,DM1,SA:0x%02X,DTCs:%u,SPN:%lu,FMI:%u\r\n",
+            msg->source, count, (unsigned long)spn, dtc[2] & 0x1F);
+    UART_Write(buffer);
+}
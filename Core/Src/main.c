@@ -28,6 +28,14 @@
 #include "can_drv.h"
 #include "uart_drv.h"
 #include "pdu_router.h"
+#include "cycle_monitor.h"
+#include "can_gateway.h"
+#include "pdu_tx.h"
+#include "uart_cmd.h"
+#include "uds_server.h"
+#include "j1939.h"
+#include "e2e.h"
+#include "gw_bench.h"
 #include <stdio.h>
 /* USER CODE END Includes */
 
@@ -39,9 +47,13 @@
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 #define CAN_BAUDRATE            500000      /* 500 kbit/s */
+#define CAN2_BAUDRATE           500000      /* 500 kbit/s */
 #define UART_BAUDRATE           115200      /* 115200 baud */
 #define MAIN_LOOP_DELAY_MS      1           /* Main loop delay */
 #define STATS_PRINT_INTERVAL_MS 10000       /* Statistics print interval */
+#define GATEWAY_OUTPUT_MODE     ROUTER_OUTPUT_EVENT /* or ROUTER_OUTPUT_SNAPSHOT */
+#define E2E_BENCH_ITERATIONS    1000        /* CRC throughput measurement at startup */
+#define GATEWAY_BENCH_ITERATIONS 200        /* Hot-path benchmarks (GATEWAY_BENCH=1) */
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -52,7 +64,10 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
+/* Latest-value signals: a newer frame replaces one still waiting in the RX queue */
+static const uint32_t coalesced_ids[] = { CAN_FILTER_ID_ENGINE, CAN_FILTER_ID_TEMP, CAN_FILTER_ID_SPEED };
 static uint32_t last_stats_time = 0;
+static uint32_t last_forwarded = 0;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -112,9 +127,18 @@ int main(void)
     /* Process CAN messages */
     Gateway_ProcessCanMessages();
     
+    /* Binary PC command channel (CAN frame injection) */
+    UartCmd_Process();
+    
     /* Router polling for error handling */
     Router_Poll();
     
+    /* Diagnostic transport timers and periodic DIDs */
+    Uds_Poll();
+    
+    /* J1939 BAM reassembly timeouts */
+    J1939_Poll();
+    
     /* Print statistics periodically */
     Gateway_PrintStatistics();
     
@@ -167,8 +191,24 @@ static void Gateway_Init(void)
   /* Initialize system configuration (clocks, GPIO, NVIC) */
   SystemConfig_Init();
   
-  /* Initialize CAN driver */
-  if (!CAN_Init(CAN_BAUDRATE)) {
+  /* Initialize CAN driver (CAN1 first: it owns the shared filter banks) */
+  if (!CAN_Init(CAN_BAUDRATE, CAN_MODE_NORMAL)) {
+    Error_Handler();
+  }
+  if (!CAN_InitBus(CAN_BUS_2, CAN2_BAUDRATE, CAN_MODE_NORMAL)) {
+    Error_Handler();
+  }
+  if (!CAN_SetRxCoalescing(CAN_BUS_1, coalesced_ids, sizeof(coalesced_ids) / sizeof(coalesced_ids[0]))) {
+    Error_Handler();
+  }
+  
+  /* Initialize CAN-to-CAN frame forwarding */
+  if (!CanGateway_Init()) {
+    Error_Handler();
+  }
+  
+  /* Initialize J1939 PGN routing (29-bit filters) */
+  if (!J1939_Init()) {
     Error_Handler();
   }
   
@@ -177,8 +217,27 @@ static void Gateway_Init(void)
     Error_Handler();
   }
   
+  /* Initialize binary command channel on UART RX */
+  UartCmd_Init();
+  
   /* Initialize PDU Router */
   Router_Init();
+  Router_SetOutputMode(GATEWAY_OUTPUT_MODE, ROUTER_SNAPSHOT_PERIOD_MS);
+  
+  /* Report E2E CRC cost, CRC unit versus software */
+  E2eBenchmark_t bench;
+  char bench_msg[64];
+  E2E_MeasureThroughput(E2E_BENCH_ITERATIONS, &bench);
+  sprintf(bench_msg, "E2EBENCH,HW:%lu,SW:%lu cycles/frame\r\n", bench.hw_cycles, bench.sw_cycles);
+  UART_Write(bench_msg);
+  
+#if GATEWAY_BENCH
+  /* Router and driver hot paths, one BENCH line each */
+  Bench_Run(GATEWAY_BENCH_ITERATIONS, UART_Write);
+#endif
+  
+  /* Initialize UDS server (DIDs map onto router signals) */
+  Uds_Init();
   
   /* Record initialization time */
   last_stats_time = HAL_GetTick();
@@ -195,7 +254,12 @@ static void Gateway_ProcessCanMessages(void)
   
   /* Process all available CAN frames */
   while (CAN_Receive(&frame)) {
-    Router_ProcessCanFrame(&frame);
+    if (frame.id & CAN_ID_EXT) {
+      J1939_ProcessCanFrame(&frame);
+    } else if (!Uds_ProcessCanFrame(&frame) && frame.bus == CAN_BUS_1) {
+      /* The signal table describes CAN1; CAN2 frames were forwarded by the gateway */
+      Router_ProcessCanFrame(&frame);
+    }
   }
 }
 
@@ -214,13 +278,88 @@ static void Gateway_PrintStatistics(void)
     Router_GetStatistics(&stats);
     
     /* Format and send statistics */
-    char stats_msg[128];
-    sprintf(stats_msg, "STATS,Processed:%lu,Routed:%lu,Dropped:%lu,CANErr:%lu,UARTErr:%lu\r\n",
-            stats.frames_processed, stats.frames_routed, stats.frames_dropped,
-            stats.can_errors, stats.uart_errors);
+    char stats_msg[192];    /* Longest line (J1939, CANRX) with 10-digit counters */
+    snprintf(stats_msg, sizeof(stats_msg), "STATS,Processed:%lu,Routed:%lu,Dropped:%lu,CANErr:%lu,UARTErr:%lu\r\n",
+             stats.frames_processed, stats.frames_routed, stats.frames_dropped,
+             stats.can_errors, stats.uart_errors);
+    
+    UART_Write(stats_msg);
+    
+    /* RX queues: unrouted (bitmap), coalesced (superseded) versus lost frames, depth per class */
+    CanRxStats_t rx;
+    CAN_GetRxStats(&rx);
+    snprintf(stats_msg, sizeof(stats_msg), "CANRX,Rx:%lu,Rejected:%lu,Coalesced:%lu,Dropped:%lu,Starved:%lu,QMaxHigh:%u,QMaxNorm:%u,QMaxLow:%u\r\n",
+             rx.frames_received, rx.frames_rejected, rx.frames_coalesced, rx.frames_dropped, rx.starvation_grants,
+             rx.queue_high_water[CAN_RX_CLASS_HIGH], rx.queue_high_water[CAN_RX_CLASS_NORMAL],
+             rx.queue_high_water[CAN_RX_CLASS_LOW]);
+    UART_Write(stats_msg);
+    
+    /* CAN-to-CAN forwarding rate and latency (DWT cycles) */
+    CanGatewayStats_t gw;
+    CanTxStats_t tx;
+    CanGateway_GetStatistics(&gw);
+    CAN_GetTxStats(CAN_BUS_2, &tx);
+    uint32_t elapsed_s = (current_time - last_stats_time) / 1000;
+    uint32_t rate = (elapsed_s > 0) ? (gw.frames_forwarded - last_forwarded) / elapsed_s : 0;
+    snprintf(stats_msg, sizeof(stats_msg), "CANGW,Fwd:%lu,Rate:%lu/s,RateLim:%lu,TxFail:%lu,IsrAvg:%lu,IsrMax:%lu,QMax:%lu\r\n",
+             gw.frames_forwarded, rate, gw.frames_rate_limited, gw.tx_failed,
+             (gw.frames_forwarded > 0) ? gw.isr_cycles_sum / gw.frames_forwarded : 0,
+             gw.isr_cycles_max, tx.latency_max_cycles);
+    UART_Write(stats_msg);
+    last_forwarded = gw.frames_forwarded;
     
+    /* Repacked outgoing PDUs */
+    PduTxStats_t pdu;
+    PduTx_GetStatistics(&Router_GetInstance()->pdu_tx, &pdu);
+    snprintf(stats_msg, sizeof(stats_msg), "PDUTX,Sent:%lu,Cyclic:%lu,Change:%lu,TxFail:%lu\r\n",
+             pdu.pdus_sent, pdu.cyclic_sent, pdu.change_sent, pdu.tx_failed);
     UART_Write(stats_msg);
     
+    /* PC frame injection */
+    UartCmdStats_t cmd;
+    UartCmd_GetStatistics(&cmd);
+    snprintf(stats_msg, sizeof(stats_msg), "UARTCMD,Ok:%lu,Bad:%lu,Injected:%lu,Rejected:%lu,Acks:%lu\r\n",
+             cmd.packets_ok, cmd.packets_bad, cmd.frames_injected, cmd.frames_rejected, cmd.acks_sent);
+    UART_Write(stats_msg);
+    
+    /* Diagnostic server */
+    UdsStats_t uds;
+    Uds_GetStatistics(&uds);
+    snprintf(stats_msg, sizeof(stats_msg), "UDS,Req:%lu,Pos:%lu,Neg:%lu,Drop:%lu,PerFrames:%lu,PerRecords:%lu,PerFail:%lu\r\n",
+             uds.requests, uds.positive_responses, uds.negative_responses, uds.responses_dropped,
+             uds.periodic_frames, uds.periodic_records, uds.periodic_tx_failed);
+    UART_Write(stats_msg);
+    
+    /* J1939 PGN routing */
+    J1939Stats_t j1939;
+    J1939_GetStatistics(&j1939);
+    snprintf(stats_msg, sizeof(stats_msg), "J1939,Rx:%lu,Disp:%lu,Unrouted:%lu,Fwd:%lu,FwdFail:%lu,BAM:%lu,BAMAbort:%lu,BAMBusy:%lu\r\n",
+             j1939.frames_received, j1939.messages_dispatched, j1939.messages_unrouted,
+             j1939.frames_forwarded, j1939.forward_failed, j1939.bam_completed,
+             j1939.bam_aborted, j1939.bam_no_session);
+    UART_Write(stats_msg);
+    
+    /* E2E protected messages */
+    for (uint16_t i = 0; i < E2E_GetCount(); i++) {
+      E2eStats_t e2e;
+      if (E2E_GetStats(&Router_GetInstance()->e2e, i, &e2e)) {
+        snprintf(stats_msg, sizeof(stats_msg), "E2E,ID:0x%03lX,Ok:%lu,CRC:%lu,Rep:%lu,Lost:%lu,Seq:%lu\r\n",
+                 e2e.can_id, e2e.frames_ok, e2e.crc_errors, e2e.repeated, e2e.lost, e2e.wrong_sequence);
+        UART_Write(stats_msg);
+      }
+    }
+    
+    /* Per-ID cycle time and jitter */
+    for (uint16_t i = 0; i < CycleMonitor_GetCount(); i++) {
+      CycleStats_t cycle;
+      if (CycleMonitor_GetStats(&Router_GetInstance()->cycle, i, &cycle)) {
+        snprintf(stats_msg, sizeof(stats_msg), "CYCLE,ID:0x%03lX,Exp:%u,Min:%u,Max:%u,Avg:%u,Jit:%u,MaxJit:%u,TO:%lu\r\n",
+                 cycle.can_id, cycle.expected_ms, cycle.min_ms, cycle.max_ms, cycle.avg_ms,
+                 cycle.jitter_ms, cycle.max_jitter_ms, cycle.timeouts);
+        UART_Write(stats_msg);
+      }
+    }
+    
     last_stats_time = current_time;
   }
 }
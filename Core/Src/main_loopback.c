@@ -30,6 +30,8 @@
 #include "can_drv.h"
 #include "uart_drv.h"
 #include "pdu_router.h"
+#include "cycle_monitor.h"
+#include "gw_selftest.h"
 #include <stdio.h>
 /* USER CODE END Includes */
 
@@ -45,6 +47,7 @@
 #define MAIN_LOOP_DELAY_MS      1           /* Main loop delay */
 #define STATS_PRINT_INTERVAL_MS 10000       /* Statistics print interval */
 #define TEST_FRAME_INTERVAL_MS  1000        /* Test frame generation interval */
+#define SELFTEST_SECONDS        5           /* Saturated loopback run at startup */
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -107,6 +110,14 @@ int main(void)
   
   /* Send startup message for loopback mode */
   UART_Write("Gateway ECU Started - LOOPBACK MODE\r\n");
+  
+  /* Capacity check of this build: saturate CAN1 through the RX path and router */
+  UART_Write("Running loopback self-test\r\n");
+  if (!SelfTest_RunLoopback(CAN_BUS_1, CAN_BAUDRATE, SELFTEST_SECONDS, UART_Write)) {
+    UART_Write("SELFTEST,Error\r\n");
+  }
+  Router_ClearStatistics();
+  
   UART_Write("Generating test CAN frames internally\r\n");
   
   /* USER CODE END 2 */
@@ -177,63 +188,17 @@ static void Gateway_Init(void)
   /* Initialize system configuration (clocks, GPIO, NVIC) */
   SystemConfig_Init();
   
-  /* Enable CAN1 clock for loopback configuration */
-  RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
-  
-  /* Configure CAN1 in loopback mode */
-  /* Request initialization mode */
-  CAN1->MCR |= CAN_MCR_INRQ;
-  
-  /* Wait for initialization mode acknowledgment */
-  uint32_t timeout = SystemCoreClock / 1000; /* 1 ms timeout */
-  while (!(CAN1->MSR & CAN_MSR_INAK) && timeout--);
-  
-  /* Configure CAN options with loopback mode enabled */
-  CAN1->MCR = CAN_MCR_INRQ |         /* Initialization request */
-              CAN_MCR_NART |          /* No automatic retransmission */
-              CAN_MCR_AWUM |          /* Automatic wake-up mode */
-              CAN_MCR_ABOM;           /* Automatic bus-off management */
-  
-  /* Configure bit timing for 500 kbit/s */
-  /* Prescaler = 6 (5+1), BS1 = 13 tq (12+1), BS2 = 2 tq (1+1), SJW = 1 tq (0+1) */
-  CAN1->BTR = (0 << CAN_BTR_SJW_Pos) |     /* SJW = 1 tq */
-              (12 << CAN_BTR_TS1_Pos) |     /* BS1 = 13 tq */
-              (1 << CAN_BTR_TS2_Pos) |      /* BS2 = 2 tq */
-              (5) |                         /* Prescaler = 6 */
-              CAN_BTR_LBKM;                 /* LOOPBACK MODE ENABLED */
-  
-  /* Configure receive filters */
-  /* Enter filter initialization mode */
-  CAN1->FMR |= CAN_FMR_FINIT;
-  
-  /* Configure filter 0 for all test IDs (0x100, 0x101, 0x102) */
-  CAN1->FM1R &= ~CAN_FM1R_FBM0;      /* Identifier mask mode */
-  CAN1->FS1R |= CAN_FS1R_FSC0;       /* 32-bit scale */
-  CAN1->FFA1R &= ~CAN_FFA1R_FFA0;    /* FIFO 0 assignment */
-  
-  /* Set filter to accept IDs 0x100-0x107 */
-  CAN1->sFilterRegister[0].FR1 = (0x100 << 21);
-  CAN1->sFilterRegister[0].FR2 = (0x7F8 << 21); /* Mask for 0x100-0x107 */
-  
-  /* Activate filter 0 */
-  CAN1->FA1R |= CAN_FA1R_FACT0;
-  
-  /* Leave filter initialization mode */
-  CAN1->FMR &= ~CAN_FMR_FINIT;
-  
-  /* Enable FIFO 0 message pending interrupt */
-  CAN1->IER = CAN_IER_FMPIE0 |        /* FIFO 0 message pending */
-              CAN_IER_FOVIE0 |        /* FIFO 0 overrun */
-              CAN_IER_BOFIE |         /* Bus-off */
-              CAN_IER_EPVIE |         /* Error passive */
-              CAN_IER_EWGIE;          /* Error warning */
-  
-  /* Leave initialization mode */
-  CAN1->MCR &= ~CAN_MCR_INRQ;
+  /* 1 ms SysTick for HAL_GetTick(): HAL_Init() is not called in this build,
+     and the self-test and traffic generator pace themselves by the tick */
+  if (SysTick_Config(SystemCoreClock / 1000U) != 0U) {
+    Error_Handler();
+  }
   
-  /* Wait for normal mode */
-  timeout = SystemCoreClock / 1000;
-  while ((CAN1->MSR & CAN_MSR_INAK) && timeout--);
+  /* Initialize CAN1 in silent loopback: frames come back internally and
+     the bus is never driven, so the board may stay connected to a vehicle */
+  if (!CAN_Init(CAN_BAUDRATE, CAN_MODE_SILENT_LOOPBACK)) {
+    Error_Handler();
+  }
   
   /* Initialize UART driver */
   if (!UART_Init(UART_BAUDRATE)) {
@@ -265,65 +230,28 @@ static void Gateway_SendTestFrames(void)
     /* Debug message */
     UART_Write("Sending CAN test frame\r\n");
     
-    /* Wait for available transmit mailbox */
-    uint32_t timeout = 1000;
-    while (!(CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) && timeout--);
+    CanFrame_t frame = { .dlc = 8 };
     
-    if (timeout > 0) {
-      uint8_t mailbox = 0;
-      if (CAN1->TSR & CAN_TSR_TME0) mailbox = 0;
-      else if (CAN1->TSR & CAN_TSR_TME1) mailbox = 1;
-      else if (CAN1->TSR & CAN_TSR_TME2) mailbox = 2;
-      
-      /* Send Engine RPM frame (ID 0x100) */
-      uint16_t rpm_raw = test_rpm * 4;
-      CAN1->sTxMailBox[mailbox].TIR = (0x100 << CAN_TI0R_STID_Pos);
-      CAN1->sTxMailBox[mailbox].TDTR = 8; /* DLC = 8 */
-      CAN1->sTxMailBox[mailbox].TDLR = (rpm_raw & 0xFF) | ((rpm_raw >> 8) << 8);
-      CAN1->sTxMailBox[mailbox].TDHR = 0;
-      CAN1->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
-      
-      /* Small delay between frames */
-      for(volatile int i = 0; i < 1680000; i++);  /* ~10ms delay */
-      
-      /* Wait for next mailbox */
-      timeout = 1000;
-      while (!(CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) && timeout--);
-      
-      if (timeout > 0) {
-        if (CAN1->TSR & CAN_TSR_TME0) mailbox = 0;
-        else if (CAN1->TSR & CAN_TSR_TME1) mailbox = 1;
-        else if (CAN1->TSR & CAN_TSR_TME2) mailbox = 2;
-        
-        /* Send Engine Temperature frame (ID 0x101) */
-        uint8_t temp_raw = test_temp + 40;
-        CAN1->sTxMailBox[mailbox].TIR = (0x101 << CAN_TI0R_STID_Pos);
-        CAN1->sTxMailBox[mailbox].TDTR = 8; /* DLC = 8 */
-        CAN1->sTxMailBox[mailbox].TDLR = temp_raw << 16; /* Byte 2 */
-        CAN1->sTxMailBox[mailbox].TDHR = 0;
-        CAN1->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
-        
-        for(volatile int i = 0; i < 1680000; i++);  /* ~10ms delay */
-        
-        /* Wait for next mailbox */
-        timeout = 1000;
-        while (!(CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) && timeout--);
-        
-        if (timeout > 0) {
-          if (CAN1->TSR & CAN_TSR_TME0) mailbox = 0;
-          else if (CAN1->TSR & CAN_TSR_TME1) mailbox = 1;
-          else if (CAN1->TSR & CAN_TSR_TME2) mailbox = 2;
-          
-          /* Send Vehicle Speed frame (ID 0x102) */
-          uint16_t speed_raw = test_speed * 10;
-          CAN1->sTxMailBox[mailbox].TIR = (0x102 << CAN_TI0R_STID_Pos);
-          CAN1->sTxMailBox[mailbox].TDTR = 8; /* DLC = 8 */
-          CAN1->sTxMailBox[mailbox].TDLR = 0;
-          CAN1->sTxMailBox[mailbox].TDHR = (speed_raw & 0xFF) | ((speed_raw >> 8) << 8); /* Bytes 4-5 */
-          CAN1->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
-        }
-      }
-    }
+    /* Engine RPM frame (ID 0x100), bytes 0-1 */
+    uint16_t rpm_raw = test_rpm * 4;
+    frame.id = CAN_FILTER_ID_ENGINE;
+    frame.word[0] = rpm_raw;
+    frame.word[1] = 0;
+    CAN_Transmit(CAN_BUS_1, &frame);
+    
+    /* Engine Temperature frame (ID 0x101), byte 2 */
+    uint8_t temp_raw = test_temp + 40;
+    frame.id = CAN_FILTER_ID_TEMP;
+    frame.word[0] = (uint32_t)temp_raw << 16;
+    frame.word[1] = 0;
+    CAN_Transmit(CAN_BUS_1, &frame);
+    
+    /* Vehicle Speed frame (ID 0x102), bytes 4-5 */
+    uint16_t speed_raw = test_speed * 10;
+    frame.id = CAN_FILTER_ID_SPEED;
+    frame.word[0] = 0;
+    frame.word[1] = speed_raw;
+    CAN_Transmit(CAN_BUS_1, &frame);
     
     /* Update test values for next iteration */
     test_rpm += 100;
@@ -379,6 +307,17 @@ static void Gateway_PrintStatistics(void)
             stats.can_errors, stats.uart_errors);
     
     UART_Write(stats_msg);
+    
+    /* Per-ID cycle time and jitter */
+    for (uint16_t i = 0; i < CycleMonitor_GetCount(); i++) {
+      CycleStats_t cycle;
+      if (CycleMonitor_GetStats(&Router_GetInstance()->cycle, i, &cycle)) {
+        sprintf(stats_msg, "CYCLE,ID:0x%03lX,Exp:%u,Min:%u,Max:%u,Avg:%u,Jit:%u,MaxJit:%u,TO:%lu\r\n",
+                cycle.can_id, cycle.expected_ms, cycle.min_ms, cycle.max_ms, cycle.avg_ms,
+                cycle.jitter_ms, cycle.max_jitter_ms, cycle.timeouts);
+        UART_Write(stats_msg);
+      }
+    }
   }
 }
 
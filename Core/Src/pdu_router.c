@@ -16,7 +16,13 @@
 
 /* Private define ------------------------------------------------------------*/
 #define MAX_OUTPUT_LENGTH       64
-#define SIGNAL_TABLE_SIZE       3
+#define MAX_SNAPSHOT_LENGTH     128
+#define SIGNAL_TABLE_SIZE       ROUTER_SIGNAL_TABLE_SIZE
+#define MUX_TABLE_SIZE          ROUTER_MUX_TABLE_SIZE
+
+#if SIGNAL_TABLE_SIZE > SIGNAL_STORE_MAX_SIGNALS
+#error "Signal table exceeds signal store capacity"
+#endif
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -31,6 +37,8 @@
  * - Byte position and length in CAN frame
  * - Scaling and offset for engineering units conversion
  * - Format string for UART output
+ * Signals of a multiplexed CAN ID (see mux_table) also give the selector
+ * value of the group they belong to.
  */
 static const SignalConfig_t signal_table[SIGNAL_TABLE_SIZE] = {
     /* Engine RPM: ID 0x100, bytes 0-1, scale /4, format: RPM,xxxx */
@@ -41,7 +49,9 @@ static const SignalConfig_t signal_table[SIGNAL_TABLE_SIZE] = {
         .scale = 0.25f,         /* RPM = raw_value / 4 */
         .offset = 0.0f,
         .format_string = "RPM,%d\r\n",
-        .signal_name = "Engine_RPM"
+        .signal_name = "Engine_RPM",
+        .snapshot_label = "RPM",
+        .snapshot_divisor = 1
     },
     
     /* Engine Temperature: ID 0x101, byte 2, scale 1, offset -40°C */
@@ -52,7 +62,9 @@ static const SignalConfig_t signal_table[SIGNAL_TABLE_SIZE] = {
         .scale = 1.0f,
         .offset = -40.0f,       /* Temp = raw_value - 40 */
         .format_string = "TEMP,%d\r\n",
-        .signal_name = "Engine_Temp"
+        .signal_name = "Engine_Temp",
+        .snapshot_label = "TEMP",
+        .snapshot_divisor = 10  /* Slow signal: every 10th period */
     },
     
     /* Vehicle Speed: ID 0x102, bytes 4-5, scale /10, format: SPEED,xxx */
@@ -63,17 +75,111 @@ static const SignalConfig_t signal_table[SIGNAL_TABLE_SIZE] = {
         .scale = 0.1f,          /* Speed = raw_value / 10 */
         .offset = 0.0f,
         .format_string = "SPEED,%d\r\n",
-        .signal_name = "Vehicle_Speed"
+        .signal_name = "Vehicle_Speed",
+        .snapshot_label = "SPEED",
+        .snapshot_divisor = 2
+    },
+    
+    /* Oil pressure: ID 0x103 mux 0, bytes 1-2, scale /10 (kPa) */
+    {
+        .can_id = 0x103,
+        .start_byte = 1,
+        .length = 2,
+        .scale = 0.1f,
+        .offset = 0.0f,
+        .format_string = "OILP,%d\r\n",
+        .signal_name = "Oil_Pressure",
+        .snapshot_label = "OILP",
+        .snapshot_divisor = 10,
+        .mux_value = 0
+    },
+    
+    /* Oil temperature: ID 0x103 mux 0, byte 3, offset -40°C */
+    {
+        .can_id = 0x103,
+        .start_byte = 3,
+        .length = 1,
+        .scale = 1.0f,
+        .offset = -40.0f,
+        .format_string = "OILT,%d\r\n",
+        .signal_name = "Oil_Temp",
+        .snapshot_label = "OILT",
+        .snapshot_divisor = 10,
+        .mux_value = 0
+    },
+    
+    /* Fuel rate: ID 0x103 mux 1, bytes 1-2, scale /20 (l/h) */
+    {
+        .can_id = 0x103,
+        .start_byte = 1,
+        .length = 2,
+        .scale = 0.05f,
+        .offset = 0.0f,
+        .format_string = "FUEL,%d\r\n",
+        .signal_name = "Fuel_Rate",
+        .snapshot_label = "FUEL",
+        .snapshot_divisor = 10,
+        .mux_value = 1
+    },
+    
+    /* Battery voltage: ID 0x103 mux 1, byte 3, scale /10 (V) */
+    {
+        .can_id = 0x103,
+        .start_byte = 3,
+        .length = 1,
+        .scale = 0.1f,
+        .offset = 0.0f,
+        .format_string = "VBAT,%d\r\n",
+        .signal_name = "Battery_Voltage",
+        .snapshot_label = "VBAT",
+        .snapshot_divisor = 10,
+        .mux_value = 1
+    },
+    
+    /* Brake pressure: ID 0x104, E2E protected, bytes 2-3, scale /10 (bar) */
+    {
+        .can_id = 0x104,
+        .start_byte = 2,
+        .length = 2,
+        .scale = 0.1f,
+        .offset = 0.0f,
+        .format_string = "BRAKE,%d\r\n",
+        .signal_name = "Brake_Pressure",
+        .snapshot_label = "BRAKE",
+        .snapshot_divisor = 1,
+        .rx_class = CAN_RX_CLASS_HIGH
     }
 };
 
-static RouterStats_t router_stats = {0};
+/**
+ * @brief Multiplexed messages
+ */
+static const MuxConfig_t mux_table[MUX_TABLE_SIZE] = {
+    /* Engine auxiliary data: selector in low nibble of byte 0 */
+    { .can_id = 0x103, .selector_byte = 0, .selector_mask = 0x0F }
+};
+
+/* Gateway router on USART3 and CAN1/CAN2, bound by Router_Init() */
+static Router_t router_default = {
+    .output_mode = ROUTER_OUTPUT_EVENT,
+    .snapshot_period_ms = ROUTER_SNAPSHOT_PERIOD_MS
+};
 
 /* Private function prototypes -----------------------------------------------*/
 static const SignalConfig_t* FindSignalConfig(uint32_t can_id);
+static int FindMuxConfig(uint32_t can_id);
+static bool BuildMuxJumpTables(Router_t* router);
+static void ConfigureRxClasses(Router_t* router);
+static void ConfigureRxAccept(Router_t* router);
+static bool RouteSignal(Router_t* router, const SignalConfig_t* config, const CanFrame_t* frame);
+static bool RouteMuxFrame(Router_t* router, int mux_index, const CanFrame_t* frame);
 static uint32_t ExtractSignalValue(const uint8_t* data, const SignalConfig_t* config);
-static void FormatAndSendSignal(const SignalConfig_t* config, uint32_t raw_value);
-static void SendErrorMessage(const char* error_type, const char* details);
+static int32_t ScaleSignalValue(const SignalConfig_t* config, uint32_t raw_value);
+static void FormatAndSendSignal(Router_t* router, const SignalConfig_t* config, uint32_t raw_value);
+static void SendSnapshotRecord(Router_t* router);
+static void Router_OnSignalTimeout(void* context, uint32_t can_id);
+static void SendErrorMessage(Router_t* router, const char* error_type, const char* details);
+__STATIC_FORCEINLINE void RouteFrame(Router_t* router, const CanFrame_t* frame);
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -84,12 +190,9 @@ static void SendErrorMessage(const char* error_type, const char* details);
  */
 void Router_Init(void)
 {
-    /* Clear statistics */
-    Router_ClearStatistics();
+    CanChannel_t* can[CAN_BUS_COUNT] = { CAN_GetChannel(CAN_BUS_1), CAN_GetChannel(CAN_BUS_2) };
     
-    /* Send startup message */
-    UART_Write("Gateway ECU Started\r\n");
-    UART_Write("Monitoring CAN IDs: 0x100, 0x101, 0x102\r\n");
+    Router_InstanceInit(&router_default, UART_GetPort(), can);
 }
 
 /**
@@ -101,114 +204,300 @@ void Router_ProcessCanFrame(const CanFrame_t* frame)
 {
     if (frame == NULL) return;
     
-    router_stats.frames_processed++;
-    
-    /* Find signal configuration for this CAN ID */
-    const SignalConfig_t* config = FindSignalConfig(frame->id);
-    if (config == NULL) {
-        router_stats.frames_dropped++;
-        return;
+    RouteFrame(&router_default, frame);
+}
+
+/**
+ * @brief  Poll router for periodic tasks
+ * @param  None
+ * @retval None
+ */
+void Router_Poll(void)
+{
+    Router_InstancePoll(&router_default);
+}
+
+/**
+ * @brief  Get router statistics
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void Router_GetStatistics(RouterStats_t* stats)
+{
+    Router_InstanceGetStatistics(&router_default, stats);
+}
+
+/**
+ * @brief  Clear router statistics
+ * @param  None
+ * @retval None
+ */
+void Router_ClearStatistics(void)
+{
+    Router_InstanceClearStatistics(&router_default);
+}
+
+/**
+ * @brief  Select event-driven or periodic snapshot output
+ * @param  mode: Output mode
+ * @param  period_ms: Snapshot record period (0 keeps the default period)
+ * @retval None
+ */
+void Router_SetOutputMode(RouterOutputMode_t mode, uint32_t period_ms)
+{
+    Router_InstanceSetOutputMode(&router_default, mode, period_ms);
+}
+
+/**
+ * @brief  Get current output mode
+ * @retval Output mode
+ */
+RouterOutputMode_t Router_GetOutputMode(void)
+{
+    return router_default.output_mode;
+}
+
+/**
+ * @brief  Bind a router to its UART sink and bxCAN pair and initialize it
+ * @note   Only the router's own store, E2E counters, cycle monitor and
+ *         PDU scheduler are (re)started; other routers are not touched.
+ * @param  router: Router to initialize
+ * @param  uart: UART port receiving the output
+ * @param  can: Channels of the pair; CAN_BUS_1 carries the routed signals,
+ *         outgoing PDUs go to the channel of their configured bus
+ * @retval None
+ */
+void Router_InstanceInit(Router_t* router, UartPort_t* uart, CanChannel_t* const can[CAN_BUS_COUNT])
+{
+    router->uart = uart;
+    router->can = can[CAN_BUS_1];
+    if (router->snapshot_period_ms == 0) {
+        router->snapshot_period_ms = ROUTER_SNAPSHOT_PERIOD_MS;
     }
     
-    /* Validate DLC */
-    if (frame->dlc < (config->start_byte + config->length)) {
-        router_stats.frames_dropped++;
-        char error_msg[64];
-        sprintf(error_msg, "CAN_ERR,INVALID_DLC,ID:0x%03X\r\n", (unsigned int)frame->id);
-        UART_Write(error_msg);
-        return;
+    /* Clear statistics and latest-value store */
+    Router_InstanceClearStatistics(router);
+    SignalStore_Init(&router->store);
+    if (!BuildMuxJumpTables(router)) {
+        SendErrorMessage(router, "CONFIG_ERR", "MUX_SELECTOR");
     }
     
-    /* Extract signal value */
-    uint32_t raw_value = ExtractSignalValue(frame->data, config);
+    /* Start CRC / alive counter checks of protected messages */
+    E2E_Init(&router->e2e);
+    
+    /* Start cycle-time monitoring of periodic messages */
+    CycleMonitor_Init(&router->cycle, Router_OnSignalTimeout, router);
     
-    /* Format and send via UART */
-    FormatAndSendSignal(config, raw_value);
+    /* Start outgoing PDU scheduler */
+    PduTx_Init(&router->pdu_tx, &router->store, can);
     
-    router_stats.frames_routed++;
+    /* Route critical signals through the high priority RX queue */
+    ConfigureRxClasses(router);
+    ConfigureRxAccept(router);
+    
+    /* Send startup message */
+    UART_PortWrite(router->uart, "Gateway ECU Started\r\n");
+    UART_PortWrite(router->uart, "Monitoring CAN IDs: 0x100, 0x101, 0x102, 0x103 (mux), 0x104 (E2E)\r\n");
 }
 
 /**
- * @brief  Poll router for periodic tasks
- * @param  None
+ * @brief  Process received CAN frame on a router
+ * @param  router: Router
+ * @param  frame: Pointer to CAN frame
  * @retval None
  */
-void Router_Poll(void)
+void Router_InstanceProcessCanFrame(Router_t* router, const CanFrame_t* frame)
+{
+    if (frame == NULL) return;
+    
+    RouteFrame(router, frame);
+}
+
+/**
+ * @brief  Poll a router for periodic tasks
+ * @param  router: Router
+ * @retval None
+ */
+void Router_InstancePoll(Router_t* router)
 {
     /* Check for CAN errors */
-    CanError_t can_error = CAN_GetLastError();
+    CanError_t can_error = CAN_DriverGetLastError(router->can->driver);
     if (can_error != CAN_ERROR_NONE) {
-        router_stats.can_errors++;
+        router->stats.can_errors++;
         
         switch (can_error) {
             case CAN_ERROR_BUS_OFF:
-                SendErrorMessage("CAN_ERR", "BUS_OFF");
+                SendErrorMessage(router, "CAN_ERR", "BUS_OFF");
                 break;
             case CAN_ERROR_ERROR_PASSIVE:
-                SendErrorMessage("CAN_ERR", "ERROR_PASSIVE");
+                SendErrorMessage(router, "CAN_ERR", "ERROR_PASSIVE");
                 break;
             case CAN_ERROR_WARNING:
-                SendErrorMessage("CAN_ERR", "WARNING");
+                SendErrorMessage(router, "CAN_ERR", "WARNING");
                 break;
             case CAN_ERROR_OVERRUN:
-                SendErrorMessage("CAN_ERR", "OVERRUN");
+                SendErrorMessage(router, "CAN_ERR", "OVERRUN");
                 break;
             default:
-                SendErrorMessage("CAN_ERR", "UNKNOWN");
+                SendErrorMessage(router, "CAN_ERR", "UNKNOWN");
                 break;
         }
         
-        CAN_ClearError();
+        CAN_ChannelClearError(router->can);
     }
     
     /* Check for UART errors */
-    UartError_t uart_error = UART_GetLastError();
+    UartError_t uart_error = UART_PortGetLastError(router->uart);
     if (uart_error != UART_ERROR_NONE) {
-        router_stats.uart_errors++;
+        router->stats.uart_errors++;
         
         switch (uart_error) {
             case UART_ERROR_OVERRUN:
-                SendErrorMessage("UART_ERR", "OVERRUN");
+                SendErrorMessage(router, "UART_ERR", "OVERRUN");
                 break;
             case UART_ERROR_FRAMING:
-                SendErrorMessage("UART_ERR", "FRAMING");
+                SendErrorMessage(router, "UART_ERR", "FRAMING");
                 break;
             case UART_ERROR_PARITY:
-                SendErrorMessage("UART_ERR", "PARITY");
+                SendErrorMessage(router, "UART_ERR", "PARITY");
                 break;
             case UART_ERROR_BUFFER_FULL:
-                SendErrorMessage("UART_ERR", "BUFFER_FULL");
+                SendErrorMessage(router, "UART_ERR", "BUFFER_FULL");
                 break;
             default:
-                SendErrorMessage("UART_ERR", "UNKNOWN");
+                SendErrorMessage(router, "UART_ERR", "UNKNOWN");
                 break;
         }
         
-        UART_ClearError();
+        UART_PortClearError(router->uart);
+    }
+    
+    uint32_t current_time = HAL_GetTick();
+    
+    /* Advance reception deadline wheel */
+    CycleMonitor_Process(&router->cycle, current_time);
+    
+    /* Repack and transmit outgoing PDUs */
+    PduTx_Process(&router->pdu_tx, current_time);
+    
+    /* Emit aggregated snapshot record once per period */
+    if (router->output_mode == ROUTER_OUTPUT_SNAPSHOT) {
+        if ((current_time - router->last_snapshot_time) >= router->snapshot_period_ms) {
+            router->last_snapshot_time = current_time;
+            SendSnapshotRecord(router);
+        }
     }
 }
 
 /**
- * @brief  Get router statistics
+ * @brief  Get statistics of a router
+ * @param  router: Router
  * @param  stats: Pointer to statistics structure
  * @retval None
  */
-void Router_GetStatistics(RouterStats_t* stats)
+void Router_InstanceGetStatistics(const Router_t* router, RouterStats_t* stats)
 {
     if (stats != NULL) {
-        *stats = router_stats;
+        *stats = router->stats;
     }
 }
 
 /**
- * @brief  Clear router statistics
- * @param  None
+ * @brief  Clear statistics of a router
+ * @param  router: Router
  * @retval None
  */
-void Router_ClearStatistics(void)
+void Router_InstanceClearStatistics(Router_t* router)
+{
+    memset(&router->stats, 0, sizeof(RouterStats_t));
+}
+
+/**
+ * @brief  Select event-driven or periodic snapshot output of a router
+ * @param  router: Router
+ * @param  mode: Output mode
+ * @param  period_ms: Snapshot record period (0 keeps the default period)
+ * @retval None
+ */
+void Router_InstanceSetOutputMode(Router_t* router, RouterOutputMode_t mode, uint32_t period_ms)
+{
+    router->snapshot_period_ms = (period_ms > 0) ? period_ms : ROUTER_SNAPSHOT_PERIOD_MS;
+    router->snapshot_counter = 0;
+    router->last_snapshot_time = HAL_GetTick();
+    router->output_mode = mode;
+}
+
+/**
+ * @brief  Get current output mode of a router
+ * @param  router: Router
+ * @retval Output mode
+ */
+RouterOutputMode_t Router_InstanceGetOutputMode(const Router_t* router)
+{
+    return router->output_mode;
+}
+
+/**
+ * @brief  Get the router used by the Router_Xxx() functions
+ * @retval Router on USART3 and CAN1/CAN2
+ */
+Router_t* Router_GetInstance(void)
+{
+    return &router_default;
+}
+
+/**
+ * @brief  Get number of configured signals (valid handles are 0..count-1)
+ * @retval Signal count
+ */
+uint16_t Router_GetSignalCount(void)
+{
+    return SIGNAL_TABLE_SIZE;
+}
+
+/**
+ * @brief  Get signal configuration by handle
+ * @param  handle: Signal handle
+ * @retval Pointer to signal configuration, NULL if handle is invalid
+ */
+const SignalConfig_t* Router_GetSignalConfig(SignalHandle_t handle)
+{
+    return (handle < SIGNAL_TABLE_SIZE) ? &signal_table[handle] : NULL;
+}
+
+#if GATEWAY_BENCH
+/**
+ * @brief  Signal lookup stage, exposed for the benchmark build
+ * @param  can_id: CAN identifier
+ * @retval Pointer to signal configuration, NULL if not found
+ */
+const SignalConfig_t* Router_BenchFindSignalConfig(uint32_t can_id)
+{
+    return FindSignalConfig(can_id);
+}
+
+/**
+ * @brief  Signal extraction stage, exposed for the benchmark build
+ * @param  data: Pointer to CAN data bytes
+ * @param  config: Signal configuration
+ * @retval Extracted raw signal value
+ */
+uint32_t Router_BenchExtractSignalValue(const uint8_t* data, const SignalConfig_t* config)
+{
+    return ExtractSignalValue(data, config);
+}
+
+/**
+ * @brief  Format and UART output stage, exposed for the benchmark build
+ * @param  config: Signal configuration
+ * @param  raw_value: Raw signal value
+ * @retval None
+ */
+void Router_BenchFormatAndSendSignal(const SignalConfig_t* config, uint32_t raw_value)
 {
-    memset(&router_stats, 0, sizeof(RouterStats_t));
+    FormatAndSendSignal(&router_default, config, raw_value);
 }
+#endif
 
 /* Private functions ---------------------------------------------------------*/
 
@@ -227,6 +516,203 @@ static const SignalConfig_t* FindSignalConfig(uint32_t can_id)
     return NULL;
 }
 
+/**
+ * @brief  Find multiplexed message configuration for CAN ID
+ * @param  can_id: CAN identifier
+ * @retval Index into mux_table, -1 if the ID is not multiplexed
+ */
+static int FindMuxConfig(uint32_t can_id)
+{
+    for (int i = 0; i < MUX_TABLE_SIZE; i++) {
+        if (mux_table[i].can_id == can_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  Build selector jump tables from the signal table
+ * @note   Members of every (message, selector value) group are stored
+ *         contiguously in mux_members so a frame only visits its group.
+ *         A message whose selector field does not fit the jump table, or
+ *         that has signals outside its field, is rejected: its groups stay
+ *         empty and its frames count as mux_unknown.
+ * @param  router: Router owning the tables
+ * @retval true if every multiplexed message was accepted
+ */
+static bool BuildMuxJumpTables(Router_t* router)
+{
+    uint8_t next = 0;
+    bool valid = true;
+    
+    memset(router->mux_jump, 0, sizeof(router->mux_jump));
+    memset(router->mux_fields, 0, sizeof(router->mux_fields));
+    
+    for (int m = 0; m < MUX_TABLE_SIZE; m++) {
+        uint8_t mask = mux_table[m].selector_mask;
+        uint8_t shift = 0;
+        
+        /* Right-align the selector field; it must index the jump table */
+        if (mask == 0) {
+            valid = false;
+            continue;
+        }
+        while (!(mask & (1U << shift))) shift++;
+        mask >>= shift;
+        if (mask >= ROUTER_MUX_MAX_VALUES) {
+            valid = false;
+            continue;
+        }
+        
+        /* Every signal of the message must be reachable from the field */
+        bool reachable = true;
+        for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+            if (signal_table[i].can_id == mux_table[m].can_id &&
+                (signal_table[i].mux_value & ~mask) != 0) {
+                reachable = false;
+            }
+        }
+        if (!reachable) {
+            valid = false;
+            continue;
+        }
+        
+        router->mux_fields[m].shift = shift;
+        router->mux_fields[m].mask = mask;
+        
+        for (int value = 0; value < ROUTER_MUX_MAX_VALUES; value++) {
+            MuxGroup_t* group = &router->mux_jump[m][value];
+            
+            group->first = next;
+            for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+                if (signal_table[i].can_id == mux_table[m].can_id &&
+                    signal_table[i].mux_value == value) {
+                    router->mux_members[next++] = (uint8_t)i;
+                }
+            }
+            group->count = next - group->first;
+        }
+    }
+    
+    return valid;
+}
+
+/**
+ * @brief  Program list filters for signals outside the normal RX class
+ * @note   List filters take precedence over the CAN1 mask filter, so the
+ *         filter match index of these IDs selects their class queue.
+ * @param  router: Router
+ * @retval None
+ */
+static void ConfigureRxClasses(Router_t* router)
+{
+    for (uint8_t rx_class = 0; rx_class < CAN_RX_CLASS_COUNT; rx_class++) {
+        uint32_t ids[SIGNAL_TABLE_SIZE];
+        uint8_t count = 0;
+        
+        if (rx_class == CAN_RX_CLASS_NORMAL) continue;
+        
+        for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+            if (signal_table[i].rx_class == rx_class &&
+                (count == 0 || ids[count - 1] != signal_table[i].can_id)) {
+                ids[count++] = signal_table[i].can_id;
+            }
+        }
+        
+        if (count > 0 && !CAN_ChannelConfigureFilterList(router->can, ids, count, (CanRxClass_t)rx_class)) {
+            SendErrorMessage(router, "CAN_ERR", "RX_CLASS_FILTER");
+        }
+    }
+}
+
+/**
+ * @brief  Register every signal-carrying identifier in the CAN RX accept bitmap
+ * @note   Frames inside the hardware filter range that no signal uses are
+ *         then discarded in the RX ISR instead of being queued and dropped
+ *         here as unknown.
+ * @param  router: Router
+ * @retval None
+ */
+static void ConfigureRxAccept(Router_t* router)
+{
+    uint32_t ids[SIGNAL_TABLE_SIZE];
+    uint8_t count = 0;
+    
+    for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+        if (FindSignalConfig(signal_table[i].can_id) == &signal_table[i]) {
+            ids[count++] = signal_table[i].can_id;     /* First entry of each ID */
+        }
+    }
+    
+    CAN_ChannelAddRxAcceptIds(router->can, ids, count);
+}
+
+/**
+ * @brief  Decode one signal from a frame and hand it on
+ * @param  router: Router
+ * @param  config: Signal configuration
+ * @param  frame: Received frame
+ * @retval true if routed, false if the frame is too short
+ */
+static bool RouteSignal(Router_t* router, const SignalConfig_t* config, const CanFrame_t* frame)
+{
+    /* Validate DLC */
+    if (frame->dlc < (config->start_byte + config->length)) {
+        char error_msg[64];
+        sprintf(error_msg, "CAN_ERR,INVALID_DLC,ID:0x%03X\r\n", (unsigned int)frame->id);
+        UART_PortWrite(router->uart, error_msg);
+        return false;
+    }
+    
+    /* Extract signal value */
+    uint32_t raw_value = ExtractSignalValue(frame->data, config);
+    
+    /* Latch latest value; the snapshot task emits it on its own period */
+    SignalHandle_t handle = (SignalHandle_t)(config - signal_table);
+    SignalStore_Write(&router->store, handle, ScaleSignalValue(config, raw_value),
+                      CAN_FRAME_TICK(frame, HAL_GetTick()));
+    PduTx_OnSignalUpdate(&router->pdu_tx, handle);
+    
+    if (router->output_mode != ROUTER_OUTPUT_SNAPSHOT) {
+        /* Format and send via UART */
+        FormatAndSendSignal(router, config, raw_value);
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Decode the signal group selected by a multiplexed frame
+ * @param  router: Router
+ * @param  mux_index: Index into mux_table
+ * @param  frame: Received frame
+ * @retval true if routed, false if too short or selector value unknown
+ */
+static bool RouteMuxFrame(Router_t* router, int mux_index, const CanFrame_t* frame)
+{
+    const MuxConfig_t* mux = &mux_table[mux_index];
+    
+    if (frame->dlc <= mux->selector_byte) {
+        return false;
+    }
+    
+    const MuxField_t* field = &router->mux_fields[mux_index];
+    uint8_t value = (frame->data[mux->selector_byte] >> field->shift) & field->mask;
+    const MuxGroup_t* group = &router->mux_jump[mux_index][value];
+    if (group->count == 0) {
+        router->stats.mux_unknown++;
+        return false;
+    }
+    
+    bool routed = true;
+    for (uint8_t i = 0; i < group->count; i++) {
+        routed &= RouteSignal(router, &signal_table[router->mux_members[group->first + i]], frame);
+    }
+    
+    return routed;
+}
+
 /**
  * @brief  Extract signal value from CAN data
  * @param  data: Pointer to CAN data bytes
@@ -242,12 +728,12 @@ static uint32_t ExtractSignalValue(const uint8_t* data, const SignalConfig_t* co
         case 1:
             value = data[config->start_byte];
             break;
-            
+        
         case 2:
             /* Little-endian extraction */
             value = (data[config->start_byte + 1] << 8) | data[config->start_byte];
             break;
-            
+        
         case 4:
             /* Little-endian extraction */
             value = (data[config->start_byte + 3] << 24) |
@@ -255,7 +741,7 @@ static uint32_t ExtractSignalValue(const uint8_t* data, const SignalConfig_t* co
                    (data[config->start_byte + 1] << 8) |
                    data[config->start_byte];
             break;
-            
+        
         default:
             value = 0;
             break;
@@ -264,41 +750,176 @@ static uint32_t ExtractSignalValue(const uint8_t* data, const SignalConfig_t* co
     return value;
 }
 
+/**
+ * @brief  Convert raw signal value to rounded engineering units
+ * @param  config: Signal configuration
+ * @param  raw_value: Raw signal value
+ * @retval Engineering value rounded to nearest integer
+ */
+static int32_t ScaleSignalValue(const SignalConfig_t* config, uint32_t raw_value)
+{
+    /* Apply scaling and offset */
+    float eng_value = (raw_value * config->scale) + config->offset;
+    return (int32_t)(eng_value + 0.5f); /* Round to nearest integer */
+}
+
 /**
  * @brief  Format signal value and send via UART
+ * @param  router: Router
  * @param  config: Signal configuration
  * @param  raw_value: Raw signal value
  * @retval None
  */
-static void FormatAndSendSignal(const SignalConfig_t* config, uint32_t raw_value)
+static void FormatAndSendSignal(Router_t* router, const SignalConfig_t* config, uint32_t raw_value)
 {
     char output_buffer[MAX_OUTPUT_LENGTH];
-    
-    /* Apply scaling and offset */
-    float eng_value = (raw_value * config->scale) + config->offset;
-    int32_t rounded_value = (int32_t)(eng_value + 0.5f); /* Round to nearest integer */
+    int32_t rounded_value = ScaleSignalValue(config, raw_value);
     
     /* Format according to configuration */
     int length = sprintf(output_buffer, config->format_string, rounded_value);
     
     /* Ensure string is properly terminated and within bounds */
     if (length > 0 && length < MAX_OUTPUT_LENGTH) {
-        UART_Write(output_buffer);
+        UART_PortWrite(router->uart, output_buffer);
+    }
+}
+
+/**
+ * @brief  Send one aggregated record of all due signals via UART
+ * @note   Format: LABEL,value[,LABEL,value...]\r\n. A signal is due when the
+ *         period counter is a multiple of its snapshot_divisor and it has
+ *         been received at least once.
+ * @param  router: Router
+ * @retval None
+ */
+static void SendSnapshotRecord(Router_t* router)
+{
+    SignalHandle_t handles[SIGNAL_TABLE_SIZE];
+    SignalState_t states[SIGNAL_TABLE_SIZE];
+    char record[MAX_SNAPSHOT_LENGTH];
+    int length = 0;
+    
+    for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+        handles[i] = (SignalHandle_t)i;
+    }
+    
+    /* Take one consistent copy of all signals before formatting */
+    if (!SignalStore_ReadMulti(&router->store, handles, SIGNAL_TABLE_SIZE, states)) {
+        return;
+    }
+    
+    for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+        uint8_t divisor = signal_table[i].snapshot_divisor;
+        if (states[i].status == SIGNAL_STATUS_NEVER_RECEIVED ||
+            (divisor > 1 && (router->snapshot_counter % divisor) != 0)) {
+            continue;
+        }
+        
+        int written = snprintf(&record[length], sizeof(record) - length, "%s%s,%ld",
+                               (length > 0) ? "," : "",
+                               signal_table[i].snapshot_label, (long)states[i].value);
+        if (written < 0 || written >= (int)(sizeof(record) - length)) {
+            break;
+        }
+        length += written;
+    }
+    router->snapshot_counter++;
+    
+    if (length > 0 && length < (int)sizeof(record) - 2) {
+        record[length++] = '\r';
+        record[length++] = '\n';
+        if (UART_PortWriteData(router->uart, (const uint8_t*)record, (uint16_t)length)) {
+            router->stats.snapshots_sent++;
+        }
+    }
+}
+
+/**
+ * @brief  Handle expired reception deadline of a monitored message
+ * @param  context: Router owning the cycle monitor
+ * @param  can_id: CAN identifier that stopped arriving
+ * @retval None
+ */
+static void Router_OnSignalTimeout(void* context, uint32_t can_id)
+{
+    Router_t* router = context;
+    
+    router->stats.signal_timeouts++;
+    
+    /* Mark all signals carried by this message as stale */
+    for (int i = 0; i < SIGNAL_TABLE_SIZE; i++) {
+        if (signal_table[i].can_id == can_id) {
+            SignalStore_SetStatus(&router->store, (SignalHandle_t)i, SIGNAL_STATUS_TIMEOUT);
+        }
     }
+    
+    char details[16];
+    sprintf(details, "ID:0x%03X", (unsigned int)can_id);
+    SendErrorMessage(router, "SIGNAL_TIMEOUT", details);
 }
 
 /**
  * @brief  Send error message via UART
+ * @param  router: Router
  * @param  error_type: Error type string
  * @param  details: Error details string
  * @retval None
  */
-static void SendErrorMessage(const char* error_type, const char* details)
+static void SendErrorMessage(Router_t* router, const char* error_type, const char* details)
 {
     char error_buffer[MAX_OUTPUT_LENGTH];
     int length = sprintf(error_buffer, "%s,%s\r\n", error_type, details);
     
     if (length > 0 && length < MAX_OUTPUT_LENGTH) {
-        UART_Write(error_buffer);
+        UART_PortWrite(router->uart, error_buffer);
+    }
+}
+
+/**
+ * @brief  Check, time-stamp and route one received frame
+ * @note   Forced inline so Router_ProcessCanFrame() addresses the default
+ *         router statically, as the single-instance router did.
+ * @param  router: Router
+ * @param  frame: Pointer to CAN frame
+ * @retval None
+ */
+__STATIC_FORCEINLINE void RouteFrame(Router_t* router, const CanFrame_t* frame)
+{
+    router->stats.frames_processed++;
+    
+    /* Protected messages must pass CRC and counter checks before routing */
+    E2eStatus_t e2e_status = E2E_Check(&router->e2e, frame);
+    if (e2e_status == E2E_STATUS_CRC_ERROR || e2e_status == E2E_STATUS_REPEATED ||
+        e2e_status == E2E_STATUS_WRONG_SEQUENCE) {
+        router->stats.e2e_rejected++;
+        router->stats.frames_dropped++;
+        return;
+    }
+    
+    /* Re-arm reception deadline and measure cycle time */
+    CycleMonitor_OnFrame(&router->cycle, frame->id, CAN_FRAME_TICK(frame, HAL_GetTick()));
+    
+    /* Multiplexed message: only the active selector's group is decoded */
+    int mux_index = FindMuxConfig(frame->id);
+    if (mux_index >= 0) {
+        if (RouteMuxFrame(router, mux_index, frame)) {
+            router->stats.frames_routed++;
+        } else {
+            router->stats.frames_dropped++;
+        }
+        return;
+    }
+    
+    /* Find signal configuration for this CAN ID */
+    const SignalConfig_t* config = FindSignalConfig(frame->id);
+    if (config == NULL) {
+        router->stats.frames_dropped++;
+        return;
+    }
+    
+    if (RouteSignal(router, config, frame)) {
+        router->stats.frames_routed++;
+    } else {
+        router->stats.frames_dropped++;
     }
 }
@@ -0,0 +1,269 @@
+/**
+ ******************************************************************************
+ * @file    pdu_tx.c
+ * @brief   Outgoing PDU packing and transmit scheduler for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Outgoing PDUs are composed from the latest values in the signal
+ *          store. Each signal's placement is reduced at init to a 64-bit
+ *          mask and shift, applied either to the little-endian payload word
+ *          (Intel) or to the byte-reversed word (Motorola), so packing a
+ *          signal is a multiply, a shift and a mask. The packed payload is
+ *          kept in a per-PDU shadow buffer; the scheduler transmits it
+ *          cyclically and/or when the shadow changes.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "pdu_tx.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define PDU_TX_MAX_SIGNALS      8       /* Signals per PDU */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief Outgoing signal placement table
+ *
+ * Sources are router signal handles (signal table index):
+ * 0 = Engine_RPM, 1 = Engine_Temp, 2 = Vehicle_Speed.
+ */
+static const PduTxSignal_t pdu_signal_table[PDU_TX_SIGNAL_COUNT] = {
+    /* 0x280 bits 0-15: RPM, 1 rpm/bit, Intel */
+    { .source = 0, .start_bit = 0,  .bit_length = 16, .byte_order = PDU_BYTE_ORDER_INTEL,
+      .scale = 1.0f,  .offset = 0.0f },
+    
+    /* 0x280 bits 16-31: Speed, 0.01 km/h per bit, Intel */
+    { .source = 2, .start_bit = 16, .bit_length = 16, .byte_order = PDU_BYTE_ORDER_INTEL,
+      .scale = 0.01f, .offset = 0.0f },
+    
+    /* 0x280 byte 4: Temperature, 1 degC/bit, offset -40, Motorola (MSB at bit 39) */
+    { .source = 1, .start_bit = 39, .bit_length = 8,  .byte_order = PDU_BYTE_ORDER_MOTOROLA,
+      .scale = 1.0f,  .offset = -40.0f }
+};
+
+/**
+ * @brief Outgoing PDU table
+ */
+static const PduTxConfig_t pdu_tx_table[PDU_TX_TABLE_SIZE] = {
+    /* Combined powertrain status to body bus */
+    { .can_id = PDU_TX_ID_POWERTRAIN, .bus = CAN_BUS_2, .dlc = 8, .mode = PDU_TX_MIXED,
+      .cycle_ms = 100, .min_delay_ms = 20, .first_signal = 0, .signal_count = 3 }
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void PduTx_Repack(PduTx_t* pdu_tx, uint8_t index);
+static bool PduTx_Send(PduTx_t* pdu_tx, uint8_t index, uint32_t now);
+static inline uint64_t PduTx_Reverse64(uint64_t value);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize outgoing PDU scheduler and precompute packing masks
+ * @param  pdu_tx: Scheduler
+ * @param  store: Signal store the PDUs are packed from
+ * @param  channels: Controllers, indexed by the bus of each PDU
+ * @retval None
+ */
+void PduTx_Init(PduTx_t* pdu_tx, const SignalStore_t* store, CanChannel_t* const channels[CAN_BUS_COUNT])
+{
+    memset(pdu_tx, 0, sizeof(PduTx_t));
+    pdu_tx->store = store;
+    for (int bus = 0; bus < CAN_BUS_COUNT; bus++) {
+        pdu_tx->channels[bus] = channels[bus];
+    }
+    
+    for (int i = 0; i < PDU_TX_SIGNAL_COUNT; i++) {
+        const PduTxSignal_t* signal = &pdu_signal_table[i];
+        PduTxPackInfo_t* info = &pdu_tx->pack_info[i];
+        int lsb;
+        
+        if (signal->byte_order == PDU_BYTE_ORDER_MOTOROLA) {
+            /* MSB position in the reversed word, byte 0 most significant */
+            int msb = (7 - (signal->start_bit / 8)) * 8 + (signal->start_bit % 8);
+            lsb = msb - (signal->bit_length - 1);
+            info->motorola = true;
+        } else {
+            lsb = signal->start_bit;
+            info->motorola = false;
+        }
+        
+        if (signal->bit_length == 0 || signal->bit_length > 32 ||
+            lsb < 0 || (lsb + signal->bit_length) > 64 || signal->scale == 0.0f) {
+            info->mask = 0;     /* Invalid placement: signal is never packed */
+            continue;
+        }
+        
+        info->shift = (uint8_t)lsb;
+        info->mask = (((uint64_t)1 << signal->bit_length) - 1U) << lsb;
+        info->inv_scale = 1.0f / signal->scale;
+    }
+    
+    /* Signal-to-PDU dependency map for on-change detection */
+    for (int p = 0; p < PDU_TX_TABLE_SIZE; p++) {
+        const PduTxConfig_t* pdu = &pdu_tx_table[p];
+        for (int i = pdu->first_signal; i < pdu->first_signal + pdu->signal_count; i++) {
+            if (pdu_signal_table[i].source < SIGNAL_STORE_MAX_SIGNALS) {
+                pdu_tx->signal_pdu_mask[pdu_signal_table[i].source] |= (1UL << p);
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Notify scheduler that a source signal has a new value
+ * @param  pdu_tx: Scheduler
+ * @param  handle: Updated signal handle
+ * @retval None
+ */
+void PduTx_OnSignalUpdate(PduTx_t* pdu_tx, SignalHandle_t handle)
+{
+    if (handle < SIGNAL_STORE_MAX_SIGNALS) {
+        pdu_tx->dirty |= pdu_tx->signal_pdu_mask[handle];
+    }
+}
+
+/**
+ * @brief  Repack changed PDUs and transmit those that are due
+ * @param  pdu_tx: Scheduler
+ * @param  now: Current system tick (ms)
+ * @retval None
+ */
+void PduTx_Process(PduTx_t* pdu_tx, uint32_t now)
+{
+    for (uint8_t i = 0; i < PDU_TX_TABLE_SIZE; i++) {
+        const PduTxConfig_t* pdu = &pdu_tx_table[i];
+        PduTxState_t* state = &pdu_tx->states[i];
+        
+        if (pdu_tx->dirty & (1UL << i)) {
+            pdu_tx->dirty &= ~(1UL << i);
+            PduTx_Repack(pdu_tx, i);
+        }
+        
+        if ((pdu->mode & PDU_TX_CYCLIC) && (now - state->last_cyclic_tx) >= pdu->cycle_ms) {
+            state->last_cyclic_tx = now;
+            if (PduTx_Send(pdu_tx, i, now)) {
+                pdu_tx->stats.cyclic_sent++;
+            }
+        } else if ((pdu->mode & PDU_TX_ON_CHANGE) && state->change_pending &&
+                   (now - state->last_tx) >= pdu->min_delay_ms) {
+            if (PduTx_Send(pdu_tx, i, now)) {
+                pdu_tx->stats.change_sent++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Get outgoing PDU statistics
+ * @param  pdu_tx: Scheduler
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void PduTx_GetStatistics(const PduTx_t* pdu_tx, PduTxStats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = pdu_tx->stats;
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Pack latest signal values into the PDU shadow buffer
+ * @param  pdu_tx: Scheduler
+ * @param  index: PDU index
+ */
+static void PduTx_Repack(PduTx_t* pdu_tx, uint8_t index)
+{
+    const PduTxConfig_t* pdu = &pdu_tx_table[index];
+    SignalHandle_t handles[PDU_TX_MAX_SIGNALS];
+    SignalState_t states[PDU_TX_MAX_SIGNALS];
+    uint8_t count = (pdu->signal_count < PDU_TX_MAX_SIGNALS) ? pdu->signal_count : PDU_TX_MAX_SIGNALS;
+    
+    for (uint8_t n = 0; n < count; n++) {
+        handles[n] = pdu_signal_table[pdu->first_signal + n].source;
+    }
+    
+    /* One consistent copy of all source signals of this PDU */
+    if (!SignalStore_ReadMulti(pdu_tx->store, handles, count, states)) {
+        pdu_tx->dirty |= (1UL << index);    /* Retry on next pass */
+        return;
+    }
+    
+    uint64_t intel_word = 0;
+    uint64_t motorola_word = 0;
+    
+    for (uint8_t n = 0; n < count; n++) {
+        const PduTxSignal_t* signal = &pdu_signal_table[pdu->first_signal + n];
+        const PduTxPackInfo_t* info = &pdu_tx->pack_info[pdu->first_signal + n];
+        
+        if (info->mask == 0 || states[n].status == SIGNAL_STATUS_NEVER_RECEIVED) {
+            continue;
+        }
+        
+        /* Inverse scaling, rounded to nearest */
+        float raw_f = ((float)states[n].value - signal->offset) * info->inv_scale;
+        int32_t raw = (int32_t)(raw_f + ((raw_f >= 0.0f) ? 0.5f : -0.5f));
+        uint64_t field = ((uint64_t)(uint32_t)raw << info->shift) & info->mask;
+        
+        if (info->motorola) {
+            motorola_word |= field;
+        } else {
+            intel_word |= field;
+        }
+    }
+    
+    uint64_t payload = intel_word | PduTx_Reverse64(motorola_word);
+    
+    if (payload != pdu_tx->states[index].shadow) {
+        pdu_tx->states[index].shadow = payload;
+        pdu_tx->states[index].change_pending = true;
+    }
+}
+
+/**
+ * @brief  Transmit PDU shadow buffer
+ * @param  pdu_tx: Scheduler
+ * @param  index: PDU index
+ * @param  now: Current system tick (ms)
+ * @retval true if frame was accepted by the CAN driver
+ */
+static bool PduTx_Send(PduTx_t* pdu_tx, uint8_t index, uint32_t now)
+{
+    const PduTxConfig_t* pdu = &pdu_tx_table[index];
+    PduTxState_t* state = &pdu_tx->states[index];
+    CanFrame_t frame;
+    
+    frame.id = pdu->can_id;
+    frame.dlc = pdu->dlc;
+    frame.bus = (uint8_t)pdu->bus;
+    memcpy(frame.data, &state->shadow, sizeof(frame.data));  /* Little-endian core */
+    
+    if (!CAN_ChannelTransmit(pdu_tx->channels[pdu->bus], &frame)) {
+        pdu_tx->stats.tx_failed++;
+        return false;
+    }
+    
+    state->last_tx = now;
+    state->change_pending = false;
+    pdu_tx->stats.pdus_sent++;
+    
+    return true;
+}
+
+/**
+ * @brief  Reverse byte order of a 64-bit word
+ * @param  value: Input word
+ * @retval Byte-reversed word
+ */
+static inline uint64_t PduTx_Reverse64(uint64_t value)
+{
+    return ((uint64_t)__REV((uint32_t)value) << 32) | __REV((uint32_t)(value >> 32));
+}
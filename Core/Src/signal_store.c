@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file    signal_store.c
+ * @brief   Latest-value signal store implementation for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    The store is written only from the routing path (main loop) and
+ *          may be read from any context. A single sequence counter guards
+ *          the whole store: it is odd while an update is in progress, so a
+ *          reader that sees the same even value before and after copying
+ *          has a consistent multi-signal snapshot. A reader that preempts
+ *          the writer (ISR) cannot wait for it, so reads are bounded by
+ *          SIGNAL_STORE_READ_RETRIES and report failure instead of spinning.
+ *          Every router owns its own store (SignalStore_t).
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "signal_store.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static inline void SignalStore_BeginWrite(SignalStore_t* store);
+static inline void SignalStore_EndWrite(SignalStore_t* store);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize signal store
+ * @param  store: Store
+ * @retval None
+ */
+void SignalStore_Init(SignalStore_t* store)
+{
+    SignalStore_BeginWrite(store);
+    memset(store->states, 0, sizeof(store->states));
+    SignalStore_EndWrite(store);
+}
+
+/**
+ * @brief  Store new value for a signal
+ * @param  store: Store
+ * @param  handle: Signal handle
+ * @param  value: Engineering value
+ * @param  timestamp: Tick of reception
+ * @retval None
+ */
+void SignalStore_Write(SignalStore_t* store, SignalHandle_t handle, int32_t value, uint32_t timestamp)
+{
+    if (handle >= SIGNAL_STORE_MAX_SIGNALS) return;
+    
+    SignalState_t* state = &store->states[handle];
+    
+    SignalStore_BeginWrite(store);
+    state->value = value;
+    state->timestamp = timestamp;
+    state->update_count++;
+    state->status = SIGNAL_STATUS_VALID;
+    SignalStore_EndWrite(store);
+}
+
+/**
+ * @brief  Update status of a signal without changing its value
+ * @param  store: Store
+ * @param  handle: Signal handle
+ * @param  status: New status
+ * @retval None
+ */
+void SignalStore_SetStatus(SignalStore_t* store, SignalHandle_t handle, SignalStatus_t status)
+{
+    if (handle >= SIGNAL_STORE_MAX_SIGNALS) return;
+    
+    SignalStore_BeginWrite(store);
+    store->states[handle].status = status;
+    SignalStore_EndWrite(store);
+}
+
+/**
+ * @brief  Read state of one signal
+ * @param  store: Store
+ * @param  handle: Signal handle
+ * @param  state: Pointer to state structure
+ * @retval true if a consistent copy was obtained, false otherwise
+ */
+bool SignalStore_Read(const SignalStore_t* store, SignalHandle_t handle, SignalState_t* state)
+{
+    return SignalStore_ReadMulti(store, &handle, 1, state);
+}
+
+/**
+ * @brief  Read states of several signals as one consistent snapshot
+ * @param  store: Store
+ * @param  handles: Array of signal handles
+ * @param  count: Number of handles
+ * @param  states: Output array (count entries)
+ * @retval true if a consistent copy was obtained, false otherwise
+ */
+bool SignalStore_ReadMulti(const SignalStore_t* store, const SignalHandle_t* handles, uint8_t count,
+                           SignalState_t* states)
+{
+    if (handles == NULL || states == NULL) return false;
+    
+    for (uint8_t i = 0; i < count; i++) {
+        if (handles[i] >= SIGNAL_STORE_MAX_SIGNALS) return false;
+    }
+    
+    for (int retry = 0; retry < SIGNAL_STORE_READ_RETRIES; retry++) {
+        uint32_t start = store->sequence;
+        if (start & 1U) {
+            continue;   /* Writer in progress */
+        }
+        __DMB();
+        
+        for (uint8_t i = 0; i < count; i++) {
+            states[i] = store->states[handles[i]];
+        }
+        
+        __DMB();
+        if (store->sequence == start) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Mark start of a store update (sequence becomes odd)
+ * @param  store: Store
+ */
+static inline void SignalStore_BeginWrite(SignalStore_t* store)
+{
+    store->sequence++;
+    __DMB();
+}
+
+/**
+ * @brief  Mark end of a store update (sequence becomes even)
+ * @param  store: Store
+ */
+static inline void SignalStore_EndWrite(SignalStore_t* store)
+{
+    __DMB();
+    store->sequence++;
+}
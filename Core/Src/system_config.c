@@ -37,6 +37,9 @@ void SystemConfig_Init(void)
     
     /* Configure NVIC priorities */
     NVIC_Config();
+    
+    /* Enable cycle counter for latency measurements */
+    DWT_Config();
 }
 
 /**
@@ -110,6 +113,23 @@ void GPIO_Config(void)
     GPIOA->AFR[1] &= ~(GPIO_AFRH_AFSEL12);
     GPIOA->AFR[1] |= (GPIO_AF9_CAN1 << GPIO_AFRH_AFSEL12_Pos);
     
+    /* Configure CAN2 pins (PB12, PB13) */
+    /* PB12 - CAN2_RX: Alternate Function, Pull-up */
+    GPIOB->MODER &= ~(GPIO_MODER_MODE12);
+    GPIOB->MODER |= GPIO_MODER_MODE12_1;        /* Alternate function */
+    GPIOB->PUPDR &= ~(GPIO_PUPDR_PUPD12);
+    GPIOB->PUPDR |= GPIO_PUPDR_PUPD12_0;        /* Pull-up */
+    GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL12);
+    GPIOB->AFR[1] |= (GPIO_AF9_CAN2 << GPIO_AFRH_AFSEL12_Pos);
+    
+    /* PB13 - CAN2_TX: Alternate Function, Push-pull */
+    GPIOB->MODER &= ~(GPIO_MODER_MODE13);
+    GPIOB->MODER |= GPIO_MODER_MODE13_1;        /* Alternate function */
+    GPIOB->OTYPER &= ~GPIO_OTYPER_OT13;         /* Push-pull */
+    GPIOB->OSPEEDR |= GPIO_OSPEEDR_OSPEED13;    /* High speed */
+    GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL13);
+    GPIOB->AFR[1] |= (GPIO_AF9_CAN2 << GPIO_AFRH_AFSEL13_Pos);
+    
     /* Configure USART3 pins (PB10, PB11) */
     /* PB10 - USART3_TX: Alternate Function, Push-pull */
     GPIOB->MODER &= ~(GPIO_MODER_MODE10);
@@ -142,7 +162,29 @@ void NVIC_Config(void)
     NVIC_SetPriority(CAN1_RX0_IRQn, NVIC_EncodePriority(0x03, 1, 0));
     NVIC_EnableIRQ(CAN1_RX0_IRQn);
     
+    /* CAN2 RX0 shares CAN1 RX0 priority: both feed the same RX ring */
+    NVIC_SetPriority(CAN2_RX0_IRQn, NVIC_EncodePriority(0x03, 1, 0));
+    NVIC_EnableIRQ(CAN2_RX0_IRQn);
+    
+    /* CAN TX mailbox-empty interrupts (software TX queue refill) */
+    NVIC_SetPriority(CAN1_TX_IRQn, NVIC_EncodePriority(0x03, 1, 0));
+    NVIC_EnableIRQ(CAN1_TX_IRQn);
+    NVIC_SetPriority(CAN2_TX_IRQn, NVIC_EncodePriority(0x03, 1, 0));
+    NVIC_EnableIRQ(CAN2_TX_IRQn);
+    
     /* Configure USART3 interrupt priority */
     NVIC_SetPriority(USART3_IRQn, NVIC_EncodePriority(0x03, 2, 0));
     NVIC_EnableIRQ(USART3_IRQn);
 }
+
+/**
+ * @brief  Enable DWT cycle counter
+ * @param  None
+ * @retval None
+ */
+void DWT_Config(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
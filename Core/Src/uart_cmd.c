@@ -0,0 +1,372 @@
+/**
+ ******************************************************************************
+ * @file    uart_cmd.c
+ * @brief   Binary UART command channel for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Commands arrive on USART3 RX as COBS-encoded packets delimited by
+ *          0x00 and inject CAN frames straight into the non-blocking CAN TX
+ *          queue. Acknowledgements are batched (one ACK per
+ *          UART_CMD_ACK_BATCH commands or UART_CMD_ACK_INTERVAL_MS) and sent
+ *          as 0x00-framed COBS packets; the text output never contains 0x00,
+ *          so the PC side can separate both streams. RX handling is bounded
+ *          to UART_CMD_RX_BUDGET bytes per call so routing of received CAN
+ *          traffic is never starved.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_cmd.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Periodic transmit slot
+ */
+typedef struct {
+    bool active;
+    CanBus_t bus;
+    CanFrame_t frame;
+    uint16_t period_ms;
+    uint32_t last_tx;
+} UartCmdPeriodic_t;
+
+/* Private define ------------------------------------------------------------*/
+#define UART_CMD_HEADER_SIZE    2       /* cmd, seq */
+#define UART_CMD_MIN_PACKET     3       /* cmd, seq, chk */
+#define UART_CMD_ACK_LENGTH     7       /* cmd, last_seq, ok(2), failed(2), chk */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* COBS stream decoder state */
+static uint8_t packet[UART_CMD_MAX_PACKET];
+static uint16_t packet_len = 0;
+static uint8_t cobs_code = 0;
+static uint8_t cobs_left = 0;
+static bool packet_overflow = false;
+
+/* Batched acknowledgement state */
+static uint8_t ack_last_seq = 0;
+static uint16_t ack_ok = 0;
+static uint16_t ack_failed = 0;
+static uint16_t ack_pending = 0;
+static uint32_t ack_first_time = 0;
+
+static UartCmdPeriodic_t periodic_slots[UART_CMD_PERIODIC_SLOTS];
+static UartCmdStats_t cmd_stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static void UartCmd_DecodeByte(uint8_t byte);
+static void UartCmd_HandlePacket(const uint8_t* data, uint16_t length);
+static uint16_t UartCmd_ParseFrame(const uint8_t* data, uint16_t length, CanFrame_t* frame);
+static bool UartCmd_Inject(CanBus_t bus, const CanFrame_t* frame);
+static void UartCmd_ServicePeriodic(uint32_t now);
+static void UartCmd_SendAck(void);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize command channel
+ * @param  None
+ * @retval None
+ */
+void UartCmd_Init(void)
+{
+    packet_len = 0;
+    cobs_code = 0;
+    cobs_left = 0;
+    packet_overflow = false;
+    ack_pending = 0;
+    ack_ok = 0;
+    ack_failed = 0;
+    memset(periodic_slots, 0, sizeof(periodic_slots));
+    memset(&cmd_stats, 0, sizeof(cmd_stats));
+}
+
+/**
+ * @brief  Handle received command bytes, periodic slots and pending ACKs
+ * @param  None
+ * @retval None
+ */
+void UartCmd_Process(void)
+{
+    char rx_chunk[64];
+    uint16_t budget = UART_CMD_RX_BUDGET;
+    
+    while (budget > 0) {
+        uint16_t length = (budget < sizeof(rx_chunk)) ? budget : sizeof(rx_chunk);
+        if (!UART_Read(rx_chunk, &length) || length == 0) {
+            break;
+        }
+        for (uint16_t i = 0; i < length; i++) {
+            UartCmd_DecodeByte((uint8_t)rx_chunk[i]);
+        }
+        budget -= length;
+    }
+    
+    uint32_t now = HAL_GetTick();
+    
+    UartCmd_ServicePeriodic(now);
+    
+    if (ack_pending > 0 &&
+        (ack_pending >= UART_CMD_ACK_BATCH || (now - ack_first_time) >= UART_CMD_ACK_INTERVAL_MS)) {
+        UartCmd_SendAck();
+    }
+}
+
+/**
+ * @brief  Get command channel statistics
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void UartCmd_GetStatistics(UartCmdStats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = cmd_stats;
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Feed one byte to the streaming COBS decoder
+ * @param  byte: Received byte
+ */
+static void UartCmd_DecodeByte(uint8_t byte)
+{
+    if (byte == 0x00) {
+        /* Delimiter: a complete packet ends exactly at a block boundary */
+        if (packet_len > 0 || cobs_code != 0) {
+            if (!packet_overflow && cobs_left == 0 && packet_len >= UART_CMD_MIN_PACKET) {
+                UartCmd_HandlePacket(packet, packet_len);
+            } else {
+                cmd_stats.packets_bad++;
+            }
+        }
+        packet_len = 0;
+        cobs_code = 0;
+        cobs_left = 0;
+        packet_overflow = false;
+        return;
+    }
+    
+    if (packet_overflow) return;
+    
+    if (cobs_left == 0) {
+        /* New block: previous block shorter than 254 bytes implies a zero */
+        if (cobs_code != 0 && cobs_code != 0xFF) {
+            if (packet_len >= UART_CMD_MAX_PACKET) {
+                packet_overflow = true;
+                return;
+            }
+            packet[packet_len++] = 0x00;
+        }
+        cobs_code = byte;
+        cobs_left = byte - 1;
+    } else {
+        if (packet_len >= UART_CMD_MAX_PACKET) {
+            packet_overflow = true;
+            return;
+        }
+        packet[packet_len++] = byte;
+        cobs_left--;
+    }
+}
+
+/**
+ * @brief  Validate and execute one decoded packet
+ * @param  data: Decoded packet
+ * @param  length: Packet length including checksum
+ */
+static void UartCmd_HandlePacket(const uint8_t* data, uint16_t length)
+{
+    uint8_t sum = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    if (sum != 0) {
+        cmd_stats.packets_bad++;
+        return;
+    }
+    
+    uint8_t cmd = data[0];
+    const uint8_t* payload = &data[UART_CMD_HEADER_SIZE];
+    uint16_t payload_len = length - UART_CMD_MIN_PACKET;
+    CanFrame_t frame;
+    bool ok = false;
+    
+    switch (cmd) {
+        case UART_CMD_TX_FRAME:
+            if (payload_len >= 1 &&
+                UartCmd_ParseFrame(&payload[1], payload_len - 1, &frame) == payload_len - 1) {
+                ok = UartCmd_Inject((CanBus_t)payload[0], &frame);
+            }
+            break;
+            
+        case UART_CMD_TX_BURST:
+            if (payload_len >= 2) {
+                uint16_t offset = 2;
+                uint8_t n;
+                
+                /* Exactly count records, as TX_FRAME/PERIODIC: nothing is
+                   injected from a short or over-long packet */
+                for (n = 0; n < payload[1]; n++) {
+                    uint16_t used = UartCmd_ParseFrame(&payload[offset], payload_len - offset, &frame);
+                    if (used == 0) break;
+                    offset += used;
+                }
+                if (n < payload[1] || offset != payload_len) break;
+                
+                ok = true;
+                offset = 2;
+                for (n = 0; n < payload[1]; n++) {
+                    offset += UartCmd_ParseFrame(&payload[offset], payload_len - offset, &frame);
+                    ok &= UartCmd_Inject((CanBus_t)payload[0], &frame);
+                }
+            }
+            break;
+            
+        case UART_CMD_PERIODIC:
+            if (payload_len >= 2 + 5 + 2 && payload[0] < UART_CMD_PERIODIC_SLOTS) {
+                UartCmdPeriodic_t* slot = &periodic_slots[payload[0]];
+                uint16_t used = UartCmd_ParseFrame(&payload[2], payload_len - 4, &frame);
+                if (used == payload_len - 4 && payload[1] < CAN_BUS_COUNT) {
+                    uint16_t period = payload[payload_len - 2] | (payload[payload_len - 1] << 8);
+                    slot->bus = (CanBus_t)payload[1];
+                    slot->frame = frame;
+                    slot->period_ms = period;
+                    slot->last_tx = HAL_GetTick() - period;   /* First frame on next pass */
+                    slot->active = (period > 0);
+                    ok = true;
+                }
+            }
+            break;
+            
+        default:
+            cmd_stats.packets_bad++;
+            return;
+    }
+    
+    cmd_stats.packets_ok++;
+    
+    /* Batch acknowledgement */
+    if (ack_pending == 0) {
+        ack_first_time = HAL_GetTick();
+    }
+    ack_pending++;
+    ack_last_seq = data[1];
+    if (ok) {
+        ack_ok++;
+    } else {
+        ack_failed++;
+    }
+}
+
+/**
+ * @brief  Parse frame record { id(4), dlc, data[dlc] }
+ * @param  data: Record start
+ * @param  length: Bytes available
+ * @param  frame: Output frame
+ * @retval Bytes consumed, 0 if record is invalid
+ */
+static uint16_t UartCmd_ParseFrame(const uint8_t* data, uint16_t length, CanFrame_t* frame)
+{
+    if (length < 5) return 0;
+    
+    uint8_t dlc = data[4];
+    if (dlc > 8 || length < 5U + dlc) return 0;
+    
+    frame->id = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    frame->dlc = dlc;
+    memset(frame->data, 0, sizeof(frame->data));
+    memcpy(frame->data, &data[5], dlc);
+    
+    return 5U + dlc;
+}
+
+/**
+ * @brief  Hand injected frame to the CAN TX queue
+ * @param  bus: Destination controller
+ * @param  frame: Frame to transmit
+ * @retval true if accepted
+ */
+static bool UartCmd_Inject(CanBus_t bus, const CanFrame_t* frame)
+{
+    if (bus < CAN_BUS_COUNT && CAN_ID_IS_VALID(frame->id) && CAN_Transmit(bus, frame)) {
+        cmd_stats.frames_injected++;
+        return true;
+    }
+    cmd_stats.frames_rejected++;
+    return false;
+}
+
+/**
+ * @brief  Transmit due periodic slots
+ * @param  now: Current system tick (ms)
+ */
+static void UartCmd_ServicePeriodic(uint32_t now)
+{
+    for (int i = 0; i < UART_CMD_PERIODIC_SLOTS; i++) {
+        UartCmdPeriodic_t* slot = &periodic_slots[i];
+        
+        if (slot->active && (now - slot->last_tx) >= slot->period_ms) {
+            slot->last_tx += slot->period_ms;
+            if ((now - slot->last_tx) >= slot->period_ms) {
+                slot->last_tx = now;    /* Fell behind: do not burst to catch up */
+            }
+            UartCmd_Inject(slot->bus, &slot->frame);
+        }
+    }
+}
+
+/**
+ * @brief  Send batched acknowledgement as 0x00-framed COBS packet
+ */
+static void UartCmd_SendAck(void)
+{
+    uint8_t ack[UART_CMD_ACK_LENGTH];
+    uint8_t out[UART_CMD_ACK_LENGTH + 3];  /* Leading 0x00, COBS overhead, trailing 0x00 */
+    uint8_t sum = 0;
+    
+    ack[0] = UART_CMD_ACK;
+    ack[1] = ack_last_seq;
+    ack[2] = ack_ok & 0xFF;
+    ack[3] = ack_ok >> 8;
+    ack[4] = ack_failed & 0xFF;
+    ack[5] = ack_failed >> 8;
+    for (int i = 0; i < UART_CMD_ACK_LENGTH - 1; i++) {
+        sum += ack[i];
+    }
+    ack[UART_CMD_ACK_LENGTH - 1] = (uint8_t)(0U - sum);
+    
+    /* COBS encode */
+    uint16_t code_pos = 1;
+    uint16_t out_len = 2;
+    uint8_t code = 1;
+    out[0] = 0x00;
+    for (int i = 0; i < UART_CMD_ACK_LENGTH; i++) {
+        if (ack[i] == 0x00) {
+            out[code_pos] = code;
+            code_pos = out_len++;
+            code = 1;
+        } else {
+            out[out_len++] = ack[i];
+            code++;
+        }
+    }
+    out[code_pos] = code;
+    out[out_len++] = 0x00;
+    
+    /* Keep counters if the TX ring is full; retry on next pass */
+    if (UART_WriteData(out, out_len)) {
+        cmd_stats.acks_sent++;
+        ack_pending = 0;
+        ack_ok = 0;
+        ack_failed = 0;
+    }
+}
@@ -19,46 +19,45 @@
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
-static uint8_t tx_buffer[UART_TX_BUFFER_SIZE];
-static volatile uint16_t tx_head = 0;
-static volatile uint16_t tx_tail = 0;
-static volatile uint16_t tx_count = 0;
-
-static uint8_t rx_buffer[UART_RX_BUFFER_SIZE];
-static volatile uint16_t rx_head = 0;
-static volatile uint16_t rx_tail = 0;
-static volatile uint16_t rx_count = 0;
-
-static volatile UartError_t last_error = UART_ERROR_NONE;
-static volatile bool tx_in_progress = false;
+static UartPort_t uart_port = { .usart = USART3 };  /* Gateway console */
 
 /* Private function prototypes -----------------------------------------------*/
-static void UART_StartTransmission(void);
+static bool UART_EnableClock(USART_TypeDef* usart, uint32_t* clock);
+__STATIC_FORCEINLINE bool UART_WriteBytes(UartPort_t* port, const uint8_t* data, uint16_t length);
+__STATIC_FORCEINLINE void UART_ServiceIrq(UartPort_t* port);
+__STATIC_FORCEINLINE void UART_StartTransmission(UartPort_t* port);
 
 /* Exported functions --------------------------------------------------------*/
 
 /**
- * @brief  Initialize UART peripheral
+ * @brief  Bind a port to a USART and initialize it
+ * @note   USART1 (APB2), USART2 and USART3 (APB1) are supported. Both ring
+ *         buffers start empty.
+ * @param  port: Port to initialize
+ * @param  usart: Peripheral registers
  * @param  baudrate: UART baudrate (e.g., 115200)
- * @retval true if successful, false otherwise
+ * @retval true if successful, false for an unsupported USART
  */
-bool UART_Init(uint32_t baudrate)
+bool UART_PortInit(UartPort_t* port, USART_TypeDef* usart, uint32_t baudrate)
 {
-    /* Enable USART3 clock */
-    RCC->APB1ENR |= RCC_APB1ENR_USART3EN;
+    uint32_t clock;
     
-    /* Reset USART3 to ensure clean state */
-    RCC->APB1RSTR |= RCC_APB1RSTR_USART3RST;
-    RCC->APB1RSTR &= ~RCC_APB1RSTR_USART3RST;
+    if (port == NULL || baudrate == 0) return false;
+    
+    memset(port, 0, sizeof(*port));
+    port->usart = usart;
+    
+    /* Enable the USART clock and reset it to ensure clean state */
+    if (!UART_EnableClock(usart, &clock)) return false;
     
     /* Small delay after reset */
     for(volatile int i = 0; i < 1000; i++);
     
     /* Calculate baudrate register value with fractional part */
     /* BRR format: [15:4] = Mantissa, [3:0] = Fraction */
-    /* BRR = APB1_FREQ / (16 * baudrate) - USART3 is on APB1! */
+    /* BRR = APBx_FREQ / (16 * baudrate) */
     
-    uint32_t usartdiv = (APB1_CLOCK_FREQ * 25) / (4 * baudrate);  /* Multiply by 25 for precision */
+    uint32_t usartdiv = (clock * 25) / (4 * baudrate);             /* Multiply by 25 for precision */
     uint32_t mantissa = usartdiv / 100;                            /* Integer part */
     uint32_t fraction = ((usartdiv - (mantissa * 100)) * 16 + 50) / 100; /* Fractional part */
     
@@ -70,94 +69,72 @@ bool UART_Init(uint32_t baudrate)
     
     uint32_t brr = (mantissa << 4) | (fraction & 0x0F);
     
-    /* Debug calculation for 115200 baud:
+    /* Debug calculation for 115200 baud on USART3 (APB1):
      * usartdiv = (42000000 * 25) / (4 * 115200) = 1050000000 / 460800 = 2278.6458
      * mantissa = 2278 / 100 = 22
      * fraction = ((2278 - 2200) * 16 + 50) / 100 = (78 * 16 + 50) / 100 = 1298 / 100 = 12
      * BRR = (22 << 4) | 12 = 0x160 | 0xC = 0x16C
      */
     
-    USART3->BRR = brr;
+    usart->BRR = brr;
     
     /* Configure UART parameters */
-    USART3->CR1 = USART_CR1_UE |        /* USART enable */
-                  USART_CR1_TE |        /* Transmitter enable */
-                  USART_CR1_RE |        /* Receiver enable */
-                  USART_CR1_RXNEIE;     /* RX not empty interrupt */
+    usart->CR1 = USART_CR1_UE |         /* USART enable */
+                 USART_CR1_TE |         /* Transmitter enable */
+                 USART_CR1_RE |         /* Receiver enable */
+                 USART_CR1_RXNEIE;      /* RX not empty interrupt */
     
-    USART3->CR2 = 0;                    /* 1 stop bit, no clock output */
-    USART3->CR3 = 0;                    /* No hardware flow control */
+    usart->CR2 = 0;                     /* 1 stop bit, no clock output */
+    usart->CR3 = 0;                     /* No hardware flow control */
     
     /* Wait for UART to be ready */
-    while (!(USART3->SR & USART_SR_TC));
+    while (!(usart->SR & USART_SR_TC));
     
     /* Clear status register */
-    USART3->SR = 0;
+    usart->SR = 0;
     
     /* Clear error flags */
-    UART_ClearError();
+    UART_PortClearError(port);
     
     return true;
 }
 
 /**
- * @brief  Write string to UART (non-blocking)
+ * @brief  Write string to a port (non-blocking)
+ * @param  port: UART port
  * @param  str: Null-terminated string to send
  * @retval true if successful, false if buffer full
  */
-bool UART_Write(const char* str)
+bool UART_PortWrite(UartPort_t* port, const char* str)
 {
     if (str == NULL) return false;
     
     uint16_t length = strlen(str);
-    return UART_WriteData((const uint8_t*)str, length);
+    return UART_WriteBytes(port, (const uint8_t*)str, length);
 }
 
 /**
- * @brief  Write data to UART (non-blocking)
+ * @brief  Write data to a port (non-blocking)
+ * @param  port: UART port
  * @param  data: Pointer to data buffer
  * @param  length: Number of bytes to send
  * @retval true if successful, false if buffer full
  */
-bool UART_WriteData(const uint8_t* data, uint16_t length)
+bool UART_PortWriteData(UartPort_t* port, const uint8_t* data, uint16_t length)
 {
-    if (data == NULL || length == 0) return false;
-    
-    /* Check if enough space in buffer */
-    if ((UART_TX_BUFFER_SIZE - tx_count) < length) {
-        last_error = UART_ERROR_BUFFER_FULL;
-        return false;
-    }
-    
-    /* Disable interrupts for atomic operation */
-    __disable_irq();
-    
-    /* Copy data to buffer */
-    for (uint16_t i = 0; i < length; i++) {
-        tx_buffer[tx_head] = data[i];
-        tx_head = (tx_head + 1) % UART_TX_BUFFER_SIZE;
-        tx_count++;
-    }
-    
-    /* Start transmission if not already in progress */
-    if (!tx_in_progress) {
-        UART_StartTransmission();
-    }
-    
-    __enable_irq();
-    
-    return true;
+    return UART_WriteBytes(port, data, length);
 }
 
 /**
- * @brief  Read data from UART buffer
+ * @brief  Read data from the RX buffer of a port
+ * @param  port: UART port
  * @param  data: Pointer to data buffer
  * @param  length: Pointer to length (input: max bytes, output: actual bytes)
  * @retval true if data available, false if buffer empty
  */
-bool UART_Read(char* data, uint16_t* length)
+bool UART_PortRead(UartPort_t* port, char* data, uint16_t* length)
 {
-    if (data == NULL || length == NULL || rx_count == 0) {
+    if (data == NULL || length == NULL || port->rx_count == 0) {
         if (length) *length = 0;
         return false;
     }
@@ -165,13 +142,13 @@ bool UART_Read(char* data, uint16_t* length)
     /* Disable interrupts for atomic operation */
     __disable_irq();
     
-    uint16_t bytes_to_read = (*length < rx_count) ? *length : rx_count;
+    uint16_t bytes_to_read = (*length < port->rx_count) ? *length : port->rx_count;
     
     /* Copy data from buffer */
     for (uint16_t i = 0; i < bytes_to_read; i++) {
-        data[i] = rx_buffer[rx_tail];
-        rx_tail = (rx_tail + 1) % UART_RX_BUFFER_SIZE;
-        rx_count--;
+        data[i] = port->rx_buffer[port->rx_tail];
+        port->rx_tail = (port->rx_tail + 1) % UART_RX_BUFFER_SIZE;
+        port->rx_count--;
     }
     
     *length = bytes_to_read;
@@ -181,13 +158,115 @@ bool UART_Read(char* data, uint16_t* length)
     return true;
 }
 
+/**
+ * @brief  Get free space in the TX buffer of a port
+ * @param  port: UART port
+ * @retval Number of free bytes
+ */
+uint16_t UART_PortGetTxFreeSpace(const UartPort_t* port)
+{
+    return UART_TX_BUFFER_SIZE - port->tx_count;
+}
+
+/**
+ * @brief  Get number of bytes in the RX buffer of a port
+ * @param  port: UART port
+ * @retval Number of available bytes
+ */
+uint16_t UART_PortGetRxCount(const UartPort_t* port)
+{
+    return port->rx_count;
+}
+
+/**
+ * @brief  Get last error of a port
+ * @param  port: UART port
+ * @retval Last error code
+ */
+UartError_t UART_PortGetLastError(const UartPort_t* port)
+{
+    return port->last_error;
+}
+
+/**
+ * @brief  Clear error flags of a port
+ * @param  port: UART port
+ */
+void UART_PortClearError(UartPort_t* port)
+{
+    port->last_error = UART_ERROR_NONE;
+    /* Clear UART status register */
+    (void)port->usart->SR;
+    (void)port->usart->DR;
+}
+
+/**
+ * @brief  Interrupt handler of a port
+ * @param  port: UART port whose USART raised the interrupt
+ */
+void UART_PortIRQHandler(UartPort_t* port)
+{
+    UART_ServiceIrq(port);
+}
+
+/**
+ * @brief  Get the gateway console port (USART3)
+ * @retval Port used by the UART_Xxx() functions
+ */
+UartPort_t* UART_GetPort(void)
+{
+    return &uart_port;
+}
+
+/**
+ * @brief  Initialize UART peripheral
+ * @param  baudrate: UART baudrate (e.g., 115200)
+ * @retval true if successful, false otherwise
+ */
+bool UART_Init(uint32_t baudrate)
+{
+    return UART_PortInit(&uart_port, USART3, baudrate);
+}
+
+/**
+ * @brief  Write string to UART (non-blocking)
+ * @param  str: Null-terminated string to send
+ * @retval true if successful, false if buffer full
+ */
+bool UART_Write(const char* str)
+{
+    return UART_PortWrite(&uart_port, str);
+}
+
+/**
+ * @brief  Write data to UART (non-blocking)
+ * @param  data: Pointer to data buffer
+ * @param  length: Number of bytes to send
+ * @retval true if successful, false if buffer full
+ */
+bool UART_WriteData(const uint8_t* data, uint16_t length)
+{
+    return UART_WriteBytes(&uart_port, data, length);
+}
+
+/**
+ * @brief  Read data from UART buffer
+ * @param  data: Pointer to data buffer
+ * @param  length: Pointer to length (input: max bytes, output: actual bytes)
+ * @retval true if data available, false if buffer empty
+ */
+bool UART_Read(char* data, uint16_t* length)
+{
+    return UART_PortRead(&uart_port, data, length);
+}
+
 /**
  * @brief  Get free space in TX buffer
  * @retval Number of free bytes
  */
 uint16_t UART_GetTxFreeSpace(void)
 {
-    return UART_TX_BUFFER_SIZE - tx_count;
+    return UART_TX_BUFFER_SIZE - uart_port.tx_count;
 }
 
 /**
@@ -196,7 +275,7 @@ uint16_t UART_GetTxFreeSpace(void)
  */
 uint16_t UART_GetRxCount(void)
 {
-    return rx_count;
+    return uart_port.rx_count;
 }
 
 /**
@@ -205,7 +284,7 @@ uint16_t UART_GetRxCount(void)
  */
 UartError_t UART_GetLastError(void)
 {
-    return last_error;
+    return uart_port.last_error;
 }
 
 /**
@@ -213,10 +292,7 @@ UartError_t UART_GetLastError(void)
  */
 void UART_ClearError(void)
 {
-    last_error = UART_ERROR_NONE;
-    /* Clear UART status register */
-    (void)USART3->SR;
-    (void)USART3->DR;
+    UART_PortClearError(&uart_port);
 }
 
 /**
@@ -224,74 +300,155 @@ void UART_ClearError(void)
  */
 void UART_IRQHandler(void)
 {
-    uint32_t sr = USART3->SR;
+    UART_ServiceIrq(&uart_port);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Enable and reset the clock of a USART
+ * @param  usart: Peripheral registers
+ * @param  clock: Bus clock of the USART in Hz
+ * @retval true if successful, false for an unsupported USART
+ */
+static bool UART_EnableClock(USART_TypeDef* usart, uint32_t* clock)
+{
+    if (usart == USART3) {
+        RCC->APB1ENR |= RCC_APB1ENR_USART3EN;
+        RCC->APB1RSTR |= RCC_APB1RSTR_USART3RST;
+        RCC->APB1RSTR &= ~RCC_APB1RSTR_USART3RST;
+        *clock = APB1_CLOCK_FREQ;
+    } else if (usart == USART2) {
+        RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
+        RCC->APB1RSTR |= RCC_APB1RSTR_USART2RST;
+        RCC->APB1RSTR &= ~RCC_APB1RSTR_USART2RST;
+        *clock = APB1_CLOCK_FREQ;
+    } else if (usart == USART1) {
+        RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+        RCC->APB2RSTR |= RCC_APB2RSTR_USART1RST;
+        RCC->APB2RSTR &= ~RCC_APB2RSTR_USART1RST;
+        *clock = APB2_CLOCK_FREQ;
+    } else {
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Copy data into the TX ring and start transmission
+ * @note   Forced inline: UART_WriteData() keeps the fixed-address code of
+ *         the single-port driver, UART_PortWriteData() works on any port.
+ * @param  port: UART port
+ * @param  data: Pointer to data buffer
+ * @param  length: Number of bytes to send
+ * @retval true if successful, false if buffer full
+ */
+__STATIC_FORCEINLINE bool UART_WriteBytes(UartPort_t* port, const uint8_t* data, uint16_t length)
+{
+    if (data == NULL || length == 0) return false;
+    
+    /* Check if enough space in buffer */
+    if ((UART_TX_BUFFER_SIZE - port->tx_count) < length) {
+        port->last_error = UART_ERROR_BUFFER_FULL;
+        port->tx_rejected++;
+        return false;
+    }
+    
+    /* Disable interrupts for atomic operation */
+    __disable_irq();
+    
+    /* Copy data to buffer */
+    for (uint16_t i = 0; i < length; i++) {
+        port->tx_buffer[port->tx_head] = data[i];
+        port->tx_head = (port->tx_head + 1) % UART_TX_BUFFER_SIZE;
+        port->tx_count++;
+    }
+    
+    /* Start transmission if not already in progress */
+    if (!port->tx_in_progress) {
+        UART_StartTransmission(port);
+    }
+    
+    __enable_irq();
+    
+    return true;
+}
+
+/**
+ * @brief  Interrupt service of a port (RX, TX empty, errors)
+ * @param  port: UART port
+ */
+__STATIC_FORCEINLINE void UART_ServiceIrq(UartPort_t* port)
+{
+    USART_TypeDef* usart = port->usart;
+    uint32_t sr = usart->SR;
     
     /* Receive data register not empty */
     if (sr & USART_SR_RXNE) {
-        uint8_t data = USART3->DR;
+        uint8_t data = usart->DR;
         
         /* Check for buffer overflow */
-        if (rx_count < UART_RX_BUFFER_SIZE) {
-            rx_buffer[rx_head] = data;
-            rx_head = (rx_head + 1) % UART_RX_BUFFER_SIZE;
-            rx_count++;
+        if (port->rx_count < UART_RX_BUFFER_SIZE) {
+            port->rx_buffer[port->rx_head] = data;
+            port->rx_head = (port->rx_head + 1) % UART_RX_BUFFER_SIZE;
+            port->rx_count++;
         } else {
-            last_error = UART_ERROR_OVERRUN;
+            port->last_error = UART_ERROR_OVERRUN;
         }
     }
     
     /* Transmit data register empty */
-    if ((sr & USART_SR_TXE) && (USART3->CR1 & USART_CR1_TXEIE)) {
-        if (tx_count > 0) {
+    if ((sr & USART_SR_TXE) && (usart->CR1 & USART_CR1_TXEIE)) {
+        if (port->tx_count > 0) {
             /* Send next byte */
-            USART3->DR = tx_buffer[tx_tail];
-            tx_tail = (tx_tail + 1) % UART_TX_BUFFER_SIZE;
-            tx_count--;
+            usart->DR = port->tx_buffer[port->tx_tail];
+            port->tx_tail = (port->tx_tail + 1) % UART_TX_BUFFER_SIZE;
+            port->tx_count--;
         } else {
             /* No more data to send, disable TXE interrupt */
-            USART3->CR1 &= ~USART_CR1_TXEIE;
-            tx_in_progress = false;
+            usart->CR1 &= ~USART_CR1_TXEIE;
+            port->tx_in_progress = false;
         }
     }
     
     /* Transmission complete */
     if (sr & USART_SR_TC) {
-        USART3->SR &= ~USART_SR_TC; /* Clear TC flag */
+        usart->SR &= ~USART_SR_TC; /* Clear TC flag */
     }
     
     /* Error handling */
     if (sr & USART_SR_ORE) {
-        last_error = UART_ERROR_OVERRUN;
-        (void)USART3->DR; /* Clear ORE flag */
+        port->last_error = UART_ERROR_OVERRUN;
+        (void)usart->DR; /* Clear ORE flag */
     }
     
     if (sr & USART_SR_FE) {
-        last_error = UART_ERROR_FRAMING;
-        (void)USART3->DR; /* Clear FE flag */
+        port->last_error = UART_ERROR_FRAMING;
+        (void)usart->DR; /* Clear FE flag */
     }
     
     if (sr & USART_SR_PE) {
-        last_error = UART_ERROR_PARITY;
-        (void)USART3->DR; /* Clear PE flag */
+        port->last_error = UART_ERROR_PARITY;
+        (void)usart->DR; /* Clear PE flag */
     }
 }
 
-/* Private functions ---------------------------------------------------------*/
-
 /**
  * @brief  Start UART transmission
+ * @param  port: UART port
  */
-static void UART_StartTransmission(void)
+__STATIC_FORCEINLINE void UART_StartTransmission(UartPort_t* port)
 {
-    if (tx_count > 0 && !tx_in_progress) {
-        tx_in_progress = true;
+    if (port->tx_count > 0 && !port->tx_in_progress) {
+        port->tx_in_progress = true;
         
         /* Send first byte */
-        USART3->DR = tx_buffer[tx_tail];
-        tx_tail = (tx_tail + 1) % UART_TX_BUFFER_SIZE;
-        tx_count--;
+        port->usart->DR = port->tx_buffer[port->tx_tail];
+        port->tx_tail = (port->tx_tail + 1) % UART_TX_BUFFER_SIZE;
+        port->tx_count--;
         
         /* Enable TXE interrupt */
-        USART3->CR1 |= USART_CR1_TXEIE;
+        port->usart->CR1 |= USART_CR1_TXEIE;
     }
 }
@@ -0,0 +1,449 @@
+/**
+ ******************************************************************************
+ * @file    uds_server.c
+ * @brief   UDS diagnostic server for STM32F407 Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Serves router signals over ISO-TP on CAN1 (0x7E0 / 0x7E8):
+ *          - 0x22 ReadDataByIdentifier, several DIDs per request
+ *          - 0x2A ReadDataByPeriodicIdentifier, slow/medium/fast/stop
+ *          DIDs live in a constant table sorted by identifier and are
+ *          looked up by binary search. Periodic data is sent as single
+ *          unsegmented frames on UDS_PERIODIC_ID; all records due at the
+ *          same rate are packed back to back ([PDID][data]...) into as
+ *          few 8-byte frames as possible, read as one coherent snapshot.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uds_server.h"
+#include "isotp.h"
+#include "pdu_router.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Periodic schedule entry
+ */
+typedef struct {
+    uint8_t did_index;          /* Index into did_table */
+    uint8_t rate;               /* UdsRate_t, 0 = free slot */
+} UdsPeriodicSlot_t;
+
+/* Private define ------------------------------------------------------------*/
+#define UDS_DID_COUNT               (sizeof(did_table) / sizeof(did_table[0]))
+#define UDS_MAX_DIDS_PER_READ       16
+#define UDS_PERIODIC_DID_BASE       0xF200U
+#define UDS_RATE_COUNT              3
+
+#define UDS_SID_READ_DID            0x22
+#define UDS_SID_READ_PERIODIC       0x2A
+#define UDS_SID_NEGATIVE            0x7F
+#define UDS_POSITIVE_OFFSET         0x40
+
+#define UDS_NRC_SERVICE_NOT_SUPPORTED   0x11
+#define UDS_NRC_INCORRECT_LENGTH        0x13
+#define UDS_NRC_REQUEST_OUT_OF_RANGE    0x31
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * @brief DID table - MUST stay sorted by DID (binary search)
+ */
+static const UdsDidConfig_t did_table[] = {
+    { .did = 0xF201, .can_id = CAN_FILTER_ID_ENGINE, .size = 2 },  /* Engine RPM */
+    { .did = 0xF202, .can_id = CAN_FILTER_ID_TEMP,   .size = 1 },  /* Engine temperature */
+    { .did = 0xF203, .can_id = CAN_FILTER_ID_SPEED,  .size = 2 }   /* Vehicle speed */
+};
+
+static const uint16_t rate_period_ms[UDS_RATE_COUNT] = {
+    UDS_RATE_SLOW_MS, UDS_RATE_MEDIUM_MS, UDS_RATE_FAST_MS
+};
+
+static const CanBus_t uds_bus = UDS_BUS;
+
+static SignalHandle_t did_handles[UDS_DID_COUNT];
+static IsoTpLink_t uds_link;
+static uint8_t response[UDS_MAX_RESPONSE];
+static UdsPeriodicSlot_t periodic_slots[UDS_PERIODIC_MAX];
+static uint32_t rate_next_time[UDS_RATE_COUNT];
+static uint32_t uds_now = 0;
+static UdsStats_t uds_stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static void Uds_OnRequest(void* context, const uint8_t* data, uint16_t length);
+static void Uds_ReadDataByIdentifier(const uint8_t* data, uint16_t length);
+static void Uds_ReadDataByPeriodicIdentifier(const uint8_t* data, uint16_t length);
+static int Uds_FindDid(uint16_t did);
+static uint8_t Uds_EncodeValue(uint8_t* dest, int32_t value, uint8_t size);
+static void Uds_SendResponse(uint16_t length);
+static void Uds_SendNegativeResponse(uint8_t sid, uint8_t nrc);
+static void Uds_SendPeriodic(uint8_t rate);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Initialize UDS server
+ * @note   Must be called after Router_Init(): DIDs are resolved to router
+ *         signal handles here.
+ * @param  None
+ * @retval None
+ */
+void Uds_Init(void)
+{
+    IsoTpConfig_t config = {
+        .tx_id = UDS_RESPONSE_ID,
+        .rx_id = UDS_REQUEST_ID,
+        .block_size = 8,            /* Keep request bursts within the CAN RX ring */
+        .st_min = 0,
+        .timeout_ms = ISOTP_DEFAULT_TIMEOUT,
+        .padding = true
+    };
+    
+    IsoTp_Init(&uds_link, &config, IsoTp_CanSend, Uds_OnRequest, (void*)&uds_bus);
+    
+    /* Let requests past the RX accept bitmap */
+    const uint32_t request_id = UDS_REQUEST_ID;
+    CAN_AddRxAcceptIds(UDS_BUS, &request_id, 1);
+    
+    /* Resolve DIDs to router signal handles */
+    for (uint16_t i = 0; i < UDS_DID_COUNT; i++) {
+        did_handles[i] = SIGNAL_HANDLE_INVALID;
+        for (SignalHandle_t h = 0; h < Router_GetSignalCount(); h++) {
+            if (Router_GetSignalConfig(h)->can_id == did_table[i].can_id) {
+                did_handles[i] = h;
+                break;
+            }
+        }
+    }
+    
+    memset(periodic_slots, 0, sizeof(periodic_slots));
+    memset(&uds_stats, 0, sizeof(uds_stats));
+}
+
+/**
+ * @brief  Pass received CAN frame to the diagnostic transport
+ * @param  frame: Pointer to CAN frame
+ * @retval true if the frame was a diagnostic request frame (consumed)
+ */
+bool Uds_ProcessCanFrame(const CanFrame_t* frame)
+{
+    if (frame->id != UDS_REQUEST_ID || frame->bus != UDS_BUS) return false;
+    
+    uds_now = HAL_GetTick();
+    IsoTp_OnFrame(&uds_link, frame, uds_now);
+    
+    return true;
+}
+
+/**
+ * @brief  Run transport timers and periodic transmission
+ * @param  None
+ * @retval None
+ */
+void Uds_Poll(void)
+{
+    uds_now = HAL_GetTick();
+    IsoTp_Poll(&uds_link, uds_now);
+    
+    for (uint8_t r = 0; r < UDS_RATE_COUNT; r++) {
+        if ((int32_t)(uds_now - rate_next_time[r]) >= 0) {
+            rate_next_time[r] = uds_now + rate_period_ms[r];
+            Uds_SendPeriodic(UDS_RATE_SLOW + r);
+        }
+    }
+}
+
+/**
+ * @brief  Get UDS server statistics
+ * @param  stats: Pointer to statistics structure
+ * @retval None
+ */
+void Uds_GetStatistics(UdsStats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = uds_stats;
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Handle complete diagnostic request (ISO-TP receive callback)
+ * @param  context: Unused
+ * @param  data: Request bytes
+ * @param  length: Request length
+ */
+static void Uds_OnRequest(void* context, const uint8_t* data, uint16_t length)
+{
+    (void)context;
+    
+    uds_stats.requests++;
+    
+    /* The response buffer is still owned by the transport */
+    if (IsoTp_IsBusy(&uds_link)) {
+        uds_stats.responses_dropped++;
+        return;
+    }
+    
+    switch (data[0]) {
+        case UDS_SID_READ_DID:
+            Uds_ReadDataByIdentifier(data, length);
+            break;
+            
+        case UDS_SID_READ_PERIODIC:
+            Uds_ReadDataByPeriodicIdentifier(data, length);
+            break;
+            
+        default:
+            Uds_SendNegativeResponse(data[0], UDS_NRC_SERVICE_NOT_SUPPORTED);
+            break;
+    }
+}
+
+/**
+ * @brief  0x22 ReadDataByIdentifier
+ * @note   Unknown DIDs are skipped; NRC 0x31 only if none is known. All
+ *         values come from one coherent signal store snapshot.
+ * @param  data: Request [0x22][DID hi][DID lo]...
+ * @param  length: Request length
+ */
+static void Uds_ReadDataByIdentifier(const uint8_t* data, uint16_t length)
+{
+    SignalHandle_t handles[UDS_MAX_DIDS_PER_READ];
+    SignalState_t states[UDS_MAX_DIDS_PER_READ];
+    uint8_t indices[UDS_MAX_DIDS_PER_READ];
+    uint8_t found = 0;
+    
+    if (length < 3 || ((length - 1) % 2) != 0 || (length - 1) / 2 > UDS_MAX_DIDS_PER_READ) {
+        Uds_SendNegativeResponse(UDS_SID_READ_DID, UDS_NRC_INCORRECT_LENGTH);
+        return;
+    }
+    
+    for (uint16_t i = 1; i < length; i += 2) {
+        int index = Uds_FindDid(((uint16_t)data[i] << 8) | data[i + 1]);
+        if (index >= 0 && did_handles[index] != SIGNAL_HANDLE_INVALID) {
+            indices[found] = (uint8_t)index;
+            handles[found] = did_handles[index];
+            found++;
+        }
+    }
+    
+    if (found == 0) {
+        Uds_SendNegativeResponse(UDS_SID_READ_DID, UDS_NRC_REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    
+    SignalStore_ReadMulti(&Router_GetInstance()->store, handles, found, states);
+    
+    uint16_t pos = 0;
+    response[pos++] = UDS_SID_READ_DID + UDS_POSITIVE_OFFSET;
+    for (uint8_t i = 0; i < found; i++) {
+        const UdsDidConfig_t* did = &did_table[indices[i]];
+        response[pos++] = (uint8_t)(did->did >> 8);
+        response[pos++] = (uint8_t)(did->did & 0xFF);
+        pos += Uds_EncodeValue(&response[pos], states[i].value, did->size);
+    }
+    
+    Uds_SendResponse(pos);
+}
+
+/**
+ * @brief  0x2A ReadDataByPeriodicIdentifier
+ * @note   The request is validated completely before the schedule is
+ *         touched. Stop without identifiers stops all periodic DIDs.
+ * @param  data: Request [0x2A][mode][PDID]...
+ * @param  length: Request length
+ */
+static void Uds_ReadDataByPeriodicIdentifier(const uint8_t* data, uint16_t length)
+{
+    int indices[UDS_PERIODIC_MAX];
+    
+    if (length < 2 || (data[1] != UDS_RATE_STOP && length < 3) ||
+        (length - 2) > UDS_PERIODIC_MAX) {
+        Uds_SendNegativeResponse(UDS_SID_READ_PERIODIC, UDS_NRC_INCORRECT_LENGTH);
+        return;
+    }
+    
+    uint8_t mode = data[1];
+    if (mode < UDS_RATE_SLOW || mode > UDS_RATE_STOP) {
+        Uds_SendNegativeResponse(UDS_SID_READ_PERIODIC, UDS_NRC_REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    
+    uint8_t count = (uint8_t)(length - 2);
+    uint8_t new_slots = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        indices[i] = Uds_FindDid(UDS_PERIODIC_DID_BASE | data[2 + i]);
+        if (indices[i] < 0) {
+            Uds_SendNegativeResponse(UDS_SID_READ_PERIODIC, UDS_NRC_REQUEST_OUT_OF_RANGE);
+            return;
+        }
+        
+        bool scheduled = false;
+        for (uint8_t s = 0; s < UDS_PERIODIC_MAX; s++) {
+            if (periodic_slots[s].rate != 0 && periodic_slots[s].did_index == indices[i]) {
+                scheduled = true;
+            }
+        }
+        if (!scheduled) new_slots++;
+    }
+    
+    if (mode == UDS_RATE_STOP) {
+        for (uint8_t s = 0; s < UDS_PERIODIC_MAX; s++) {
+            bool listed = (count == 0);
+            for (uint8_t i = 0; i < count; i++) {
+                if (periodic_slots[s].did_index == indices[i]) listed = true;
+            }
+            if (listed) periodic_slots[s].rate = 0;
+        }
+    } else {
+        uint8_t free_slots = 0;
+        for (uint8_t s = 0; s < UDS_PERIODIC_MAX; s++) {
+            if (periodic_slots[s].rate == 0) free_slots++;
+        }
+        if (new_slots > free_slots) {
+            Uds_SendNegativeResponse(UDS_SID_READ_PERIODIC, UDS_NRC_REQUEST_OUT_OF_RANGE);
+            return;
+        }
+        
+        for (uint8_t i = 0; i < count; i++) {
+            UdsPeriodicSlot_t* target = NULL;
+            for (uint8_t s = 0; s < UDS_PERIODIC_MAX; s++) {
+                if (periodic_slots[s].rate != 0 && periodic_slots[s].did_index == indices[i]) {
+                    target = &periodic_slots[s];    /* Reschedule at new rate */
+                    break;
+                }
+                if (target == NULL && periodic_slots[s].rate == 0) {
+                    target = &periodic_slots[s];
+                }
+            }
+            target->did_index = (uint8_t)indices[i];
+            target->rate = mode;
+        }
+        
+        /* First transmission at the next poll */
+        rate_next_time[mode - UDS_RATE_SLOW] = uds_now;
+    }
+    
+    response[0] = UDS_SID_READ_PERIODIC + UDS_POSITIVE_OFFSET;
+    Uds_SendResponse(1);
+}
+
+/**
+ * @brief  Look up DID in the sorted table
+ * @param  did: Data identifier
+ * @retval Table index, -1 if not found
+ */
+static int Uds_FindDid(uint16_t did)
+{
+    int low = 0;
+    int high = (int)UDS_DID_COUNT - 1;
+    
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (did_table[mid].did == did) {
+            return mid;
+        }
+        if (did_table[mid].did < did) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  Encode signal value big-endian
+ * @param  dest: Destination buffer
+ * @param  value: Engineering value
+ * @param  size: Encoded size in bytes (1-4)
+ * @retval Number of bytes written
+ */
+static uint8_t Uds_EncodeValue(uint8_t* dest, int32_t value, uint8_t size)
+{
+    for (uint8_t i = 0; i < size; i++) {
+        dest[i] = (uint8_t)((uint32_t)value >> (8 * (size - 1 - i)));
+    }
+    return size;
+}
+
+/**
+ * @brief  Send response through ISO-TP
+ * @param  length: Response length in response buffer
+ */
+static void Uds_SendResponse(uint16_t length)
+{
+    if (!IsoTp_Send(&uds_link, response, length, uds_now)) {
+        uds_stats.responses_dropped++;
+    } else if (response[0] == UDS_SID_NEGATIVE) {
+        uds_stats.negative_responses++;
+    } else {
+        uds_stats.positive_responses++;
+    }
+}
+
+/**
+ * @brief  Send negative response
+ * @param  sid: Service identifier of the request
+ * @param  nrc: Negative response code
+ */
+static void Uds_SendNegativeResponse(uint8_t sid, uint8_t nrc)
+{
+    response[0] = UDS_SID_NEGATIVE;
+    response[1] = sid;
+    response[2] = nrc;
+    Uds_SendResponse(3);
+}
+
+/**
+ * @brief  Send all periodic DIDs scheduled at one rate
+ * @param  rate: Transmission rate (UdsRate_t)
+ */
+static void Uds_SendPeriodic(uint8_t rate)
+{
+    SignalHandle_t handles[UDS_PERIODIC_MAX];
+    SignalState_t states[UDS_PERIODIC_MAX];
+    uint8_t indices[UDS_PERIODIC_MAX];
+    uint8_t count = 0;
+    
+    for (uint8_t s = 0; s < UDS_PERIODIC_MAX; s++) {
+        if (periodic_slots[s].rate == rate &&
+            did_handles[periodic_slots[s].did_index] != SIGNAL_HANDLE_INVALID) {
+            indices[count] = periodic_slots[s].did_index;
+            handles[count] = did_handles[indices[count]];
+            count++;
+        }
+    }
+    if (count == 0) return;
+    
+    SignalStore_ReadMulti(&Router_GetInstance()->store, handles, count, states);
+    
+    /* Pack [PDID][data] records into as few frames as possible */
+    CanFrame_t frame;
+    frame.id = UDS_PERIODIC_ID;
+    frame.dlc = 0;
+    for (uint8_t i = 0; i <= count; i++) {
+        const UdsDidConfig_t* did = (i < count) ? &did_table[indices[i]] : NULL;
+        
+        if (frame.dlc > 0 && (did == NULL || frame.dlc + 1 + did->size > 8)) {
+            if (CAN_Transmit(UDS_BUS, &frame)) {
+                uds_stats.periodic_frames++;
+            } else {
+                uds_stats.periodic_tx_failed++;
+            }
+            frame.dlc = 0;
+        }
+        
+        if (did != NULL) {
+            frame.data[frame.dlc++] = (uint8_t)(did->did & 0xFF);
+            frame.dlc += Uds_EncodeValue(&frame.data[frame.dlc], states[i].value, did->size);
+            uds_stats.periodic_records++;
+        }
+    }
+}
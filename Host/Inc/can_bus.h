@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ * @file    can_bus.h
+ * @brief   Multi-node virtual CAN bus with the gateway as one node (header)
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef CAN_BUS_H
+#define CAN_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CAN_BUS_MAX_NODES       16
+#define CAN_BUS_MAX_MESSAGES    64
+#define CAN_BUS_MAX_IDS         96      /* Distinct IDs with latency statistics */
+#define CAN_BUS_NAME_LENGTH     16
+#define CAN_BUS_GATEWAY_NODE    0       /* Node index of the gateway controller */
+
+#define CAN_BUS_IFS_BITS        3       /* Intermission */
+#define CAN_BUS_TAIL_BITS       (1 + 1 + 1 + 7)     /* CRC delimiter, ACK slot and delimiter, EOF */
+#define CAN_BUS_ERROR_FLAG_BITS 12      /* Active error flag plus echoed flags (worst case) */
+#define CAN_BUS_ERROR_DELIM_BITS 8
+#define CAN_BUS_SUSPEND_BITS    8       /* Error-passive transmitter pause */
+#define CAN_BUS_BUSOFF_BITS     (128 * 11)  /* Recovery: 128 x 11 recessive bits */
+#define CAN_BUS_TEC_PASSIVE     128
+#define CAN_BUS_TEC_BUSOFF      256
+#define CAN_BUS_RX_RESPONSE_NS  2000    /* RX interrupt, frame valid to FIFO release (irq_sim worst case) */
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Bit-level cost of one data frame
+ */
+typedef struct {
+    uint16_t bits;              /* SOF to end of intermission, stuff bits included */
+    uint16_t stuff_bits;        /* Stuff bits between SOF and the CRC delimiter */
+    uint32_t arbitration;       /* Arbitration field MSB first; lower value wins */
+} CanBusFrameTiming_t;
+
+/**
+ * @brief Fault confinement state of a node
+ */
+typedef enum {
+    CAN_BUS_ERROR_ACTIVE = 0,
+    CAN_BUS_ERROR_PASSIVE,
+    CAN_BUS_OFF
+} CanBusNodeState_t;
+
+/**
+ * @brief One node on the bus (node 0 is the gateway's bxCAN controller)
+ */
+typedef struct {
+    char name[CAN_BUS_NAME_LENGTH];
+    uint16_t tec;               /* Transmit error counter */
+    CanBusNodeState_t state;
+    uint64_t ready_bit;         /* Earliest SOF (error-passive suspend, bus-off recovery) */
+    uint64_t sent;              /* Frames transmitted successfully */
+    uint64_t errors;            /* Error frames while transmitting */
+    uint64_t arbitration_lost;  /* Arbitration rounds lost */
+    uint64_t tx_dropped;        /* Frames given up (gateway: no retransmission) */
+    uint64_t overwritten;       /* Periodic frames replaced before they were sent */
+} CanBusNode_t;
+
+/**
+ * @brief Periodic message of a simulated node
+ */
+typedef struct {
+    uint8_t node;               /* Transmitting node index (not the gateway) */
+    uint32_t id;                /* Identifier (CAN_ID_EXT set for 29-bit) */
+    uint8_t dlc;
+    uint8_t data[8];            /* Template; E2E messages get counter and CRC */
+    bool e2e;                   /* Byte 0 = CRC, byte 1 low nibble = counter */
+    uint32_t period_us;
+    uint32_t offset_us;
+    /* Run-time state */
+    uint64_t next_us;           /* Next release */
+    bool pending;               /* Waiting for the bus */
+    uint64_t queued_bit;        /* Release time of the pending instance */
+    uint8_t counter;
+} CanBusMessage_t;
+
+/**
+ * @brief Queue-to-wire latency of one identifier
+ */
+typedef struct {
+    uint32_t id;
+    uint64_t count;
+    uint64_t sum_bits;
+    uint64_t max_bits;
+} CanBusLatency_t;
+
+/**
+ * @brief Simulation setup and results
+ */
+typedef struct {
+    /* Setup */
+    uint32_t bitrate;           /* 125000, 250000, 500000 or 1000000 */
+    uint8_t gateway_bus;        /* Gateway controller on this bus (0 = CAN1, 1 = CAN2) */
+    uint32_t poll_us;           /* Gateway main loop period */
+    uint32_t rx_response_ns;    /* RX interrupt: end of frame to FIFO release, per message */
+    uint32_t masked_us;         /* Interrupts masked at the start of every main loop pass */
+    uint32_t error_ppm;         /* Chance of an error frame per frame, per million */
+    uint32_t seed;              /* Error injection PRNG (xorshift32, non-zero) */
+    CanBusNode_t nodes[CAN_BUS_MAX_NODES];
+    uint8_t node_count;
+    CanBusMessage_t messages[CAN_BUS_MAX_MESSAGES];
+    uint8_t message_count;
+    /* Results */
+    uint64_t now_bit;           /* Simulated time in bit times */
+    uint64_t busy_bits;         /* Bits with a frame or error frame on the wire */
+    uint64_t frames;            /* Frames completed */
+    uint64_t error_frames;
+    uint64_t stuff_bits;
+    uint64_t gateway_polls;
+    uint64_t rx_fifo_lost;      /* Frames lost to a full gateway RX FIFO */
+    uint8_t rx_fifo_high_water; /* Most messages waiting in the gateway RX FIFO */
+    CanBusLatency_t latency[CAN_BUS_MAX_IDS];
+    uint16_t latency_count;
+} CanBusSim_t;
+
+/* Exported macro ------------------------------------------------------------*/
+#define CAN_BUS_BITS_TO_US(sim, bits)   ((double)(bits) * 1e6 / (double)(sim)->bitrate)
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool CanBus_IsValidBitrate(uint32_t bitrate);
+void CanBus_FrameTiming(uint32_t id, uint8_t dlc, const uint8_t* data, CanBusFrameTiming_t* timing);
+void CanBus_Init(CanBusSim_t* sim, uint32_t bitrate);
+int CanBus_AddNode(CanBusSim_t* sim, const char* name);
+bool CanBus_AddMessage(CanBusSim_t* sim, const CanBusMessage_t* message);
+void CanBus_Run(CanBusSim_t* sim, uint64_t duration_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_BUS_H */
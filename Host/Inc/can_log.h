@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * @file    can_log.h
+ * @brief   Recorded CAN traffic reader (candump / Vector ASC) header
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef CAN_LOG_H
+#define CAN_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Log file formats
+ */
+typedef enum {
+    CAN_LOG_FORMAT_CANDUMP = 0,     /* candump -l: "(sec.usec) can0 123#11223344" */
+    CAN_LOG_FORMAT_ASC              /* Vector ASC: "0.001 1 123 Rx d 4 11 22 33 44" */
+} CanLogFormat_t;
+
+/**
+ * @brief One recorded classic CAN data frame
+ */
+typedef struct {
+    uint64_t time_us;           /* Time since the first frame of the log */
+    uint32_t id;                /* Identifier (CAN_ID_EXT set for 29-bit) */
+    uint8_t bus;                /* 0 = CAN1, 1 = CAN2 */
+    uint8_t dlc;                /* Data length code (0-8) */
+    uint8_t data[8];            /* Data bytes */
+} CanLogFrame_t;
+
+/**
+ * @brief Open log (memory-mapped file, parsed in place)
+ */
+typedef struct {
+    const char* base;           /* Mapping of the whole file */
+    size_t size;                /* File size */
+    const char* pos;            /* Start of next line */
+    const char* end;            /* End of mapping */
+    CanLogFormat_t format;
+    bool asc_decimal;           /* ASC "base dec": IDs and data in decimal */
+    bool asc_relative;          /* ASC "timestamps relative": per-line deltas */
+    bool time_valid;            /* time_origin_us holds the first frame time */
+    uint64_t time_origin_us;    /* Absolute time of the first frame */
+    uint64_t time_last_us;      /* Absolute time of the previous line (relative ASC) */
+    char interfaces[2][16];     /* candump interface names mapped to CAN1/CAN2 */
+    uint8_t interface_count;
+    uint32_t lines_skipped;     /* Non-frame lines, FD/remote/error frames, other buses */
+} CanLog_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool CanLog_Open(CanLog_t* log, const char* path);
+bool CanLog_Next(CanLog_t* log, CanLogFrame_t* frame);
+void CanLog_Rewind(CanLog_t* log);
+void CanLog_Close(CanLog_t* log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAN_LOG_H */
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file    host_ecu.h
+ * @brief   Gateway ECU application bring-up for host builds header
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ */
+
+#ifndef HOST_ECU_H
+#define HOST_ECU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "pdu_router.h"
+#include "can_drv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Called by HostEcu_Poll() after each received frame was handled
+ */
+typedef void (*HostEcuFrameHook_t)(const CanFrame_t* frame);
+
+/* Exported constants --------------------------------------------------------*/
+#define HOST_ECU_CAN_BAUDRATE   500000      /* CAN1 and CAN2, as on target */
+#define HOST_ECU_UART_BAUDRATE  115200      /* USART3, as on target */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool HostEcu_Init(RouterOutputMode_t mode);
+void HostEcu_Poll(void);
+void HostEcu_SetFrameHook(HostEcuFrameHook_t hook);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_ECU_H */
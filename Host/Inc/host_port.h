@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ * @file    host_port.h
+ * @brief   Host (PC) port of the Gateway ECU peripherals
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Force-included into every translation unit of a host build
+ *          (gcc -include host_port.h). The CMSIS device header is used as
+ *          is for register layouts; the peripheral base pointers the
+ *          drivers touch are redirected to plain structures in RAM and the
+ *          interrupt intrinsics and NVIC calls work on host copies of
+ *          PRIMASK and the NVIC registers, so the unmodified Core modules
+ *          run on the PC. Time is virtual: HAL_GetTick() returns whatever
+ *          the host tool last set.
+ ******************************************************************************
+ */
+
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Called whenever PRIMASK changes, with the new value
+ */
+typedef void (*HostIrqHook_t)(uint32_t primask);
+
+/**
+ * @brief Outcome of a frame arriving at a receive FIFO
+ */
+typedef enum {
+    HOST_CAN_RX_FILTERED = 0,   /* Discarded by the acceptance filters */
+    HOST_CAN_RX_QUEUED,         /* Stored in FIFO 0 */
+    HOST_CAN_RX_OVERRUN         /* FIFO 0 full: frame lost, FOVR0 set */
+} HostCanRx_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define GATEWAY_HOST            1       /* Core modules are built for the PC */
+#define HOST_CAN_BUS_COUNT      2       /* CAN1 and CAN2 */
+#define HOST_NVIC_IRQ_COUNT     82      /* External interrupts of the STM32F407 */
+#define HOST_CAN_RX_FIFO_DEPTH  3       /* Messages per bxCAN receive FIFO */
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Peripherals used by the Core modules live in host memory */
+#undef CAN1
+#undef CAN2
+#undef RCC
+#undef DWT
+#undef USART3
+#undef CRC
+#define CAN1                    (&host_can1)
+#define CAN2                    (&host_can2)
+#define RCC                     (&host_rcc)
+#define DWT                     (&host_dwt)
+#define USART3                  (&host_usart3)
+#define CRC                     (&host_crc)
+
+/* One thread on the host: PRIMASK is a variable, interrupts are run by the
+   host tool (synchronously, or from the hook in irq_sim.c); barriers stay real */
+#define __disable_irq()         HostPort_SetPrimask(1U)
+#define __enable_irq()          HostPort_SetPrimask(0U)
+#define __get_PRIMASK()         HostPort_GetPrimask()
+#define __set_PRIMASK(x)        HostPort_SetPrimask(x)
+#define __DMB()                 __sync_synchronize()
+
+/* NVIC priority and enable state live in host memory */
+#undef NVIC_SetPriorityGrouping
+#undef NVIC_GetPriorityGrouping
+#undef NVIC_EnableIRQ
+#undef NVIC_GetEnableIRQ
+#undef NVIC_SetPriority
+#undef NVIC_GetPriority
+#define NVIC_SetPriorityGrouping(group)     HostPort_NvicSetPriorityGrouping(group)
+#define NVIC_GetPriorityGrouping()          HostPort_NvicGetPriorityGrouping()
+#define NVIC_EnableIRQ(irq)                 HostPort_NvicEnableIRQ(irq)
+#define NVIC_GetEnableIRQ(irq)              HostPort_NvicGetEnableIRQ(irq)
+#define NVIC_SetPriority(irq, priority)     HostPort_NvicSetPriority((irq), (priority))
+#define NVIC_GetPriority(irq)               HostPort_NvicGetPriority(irq)
+
+/* Exported variables --------------------------------------------------------*/
+extern CAN_TypeDef host_can1;
+extern CAN_TypeDef host_can2;
+extern RCC_TypeDef host_rcc;
+extern DWT_Type host_dwt;
+extern USART_TypeDef host_usart3;
+extern CRC_TypeDef host_crc;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void HostPort_Init(void);
+void HostPort_SetTick(uint32_t tick);
+uint32_t HostPort_GetTick(void);
+uint64_t HostPort_GetTimeNs(void);
+uint32_t HostPort_GetPrimask(void);
+void HostPort_SetPrimask(uint32_t primask);
+void HostPort_SetIrqHook(HostIrqHook_t hook);
+void HostPort_NvicSetPriorityGrouping(uint32_t group);
+uint32_t HostPort_NvicGetPriorityGrouping(void);
+void HostPort_NvicEnableIRQ(IRQn_Type irq);
+uint32_t HostPort_NvicGetEnableIRQ(IRQn_Type irq);
+void HostPort_NvicSetPriority(IRQn_Type irq, uint32_t priority);
+uint32_t HostPort_NvicGetPriority(IRQn_Type irq);
+bool HostPort_CanDeliver(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data);
+bool HostPort_CanLoadFifo(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data);
+void HostPort_CanAttach(uint8_t bus, bool attached);
+uint8_t HostPort_CanRefillTx(uint8_t bus);
+bool HostPort_CanPeekTx(uint8_t bus, uint32_t* id, uint8_t* dlc, uint8_t* data);
+void HostPort_CanCompleteTx(uint8_t bus);
+bool HostPort_CanTxRequest(uint8_t bus);
+HostCanRx_t HostPort_CanArrive(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data);
+void HostPort_CanReleaseRx(uint8_t bus);
+uint32_t HostPort_UartTransmit(uint8_t* out, uint32_t max_bytes);
+bool HostPort_UartShift(uint8_t* byte);
+bool HostPort_UartTxeRequest(void);
+void HostPort_UartIrq(void);
+bool HostPort_UartReceive(uint8_t byte);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_PORT_H */
@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * @file    can_bittiming.c
+ * @brief   Host check of the CAN bit-timing calculator
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Runs CAN_CalcBitTiming() (Core/Src/can_drv.c) over the common
+ *          bitrates and the APB1 clocks of the usual STM32 setups, and
+ *          compares every result with an exhaustive search of the bxCAN
+ *          register ranges: the timing must divide the clock exactly, sit
+ *          within half a time quantum of the requested sample point and
+ *          use the most time quanta any valid timing has. Bitrates the
+ *          gateway runs at must be reachable from the target APB1 clock.
+ *          One line per case, then a summary:
+ *            BITTIMING,Clock:<hz>,Bitrate:<bps>,Prescaler:<n>,BS1:<tq>,BS2:<tq>,
+ *              SJW:<tq>,Tq:<n>,SamplePoint:<pct>%,BTR:<hex>,Check:<OK|FAIL>
+ *            BITTIMING,Checked:<n>,Exact:<n>,Failed:<n>
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h
+ *                -IHost/Inc -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/can_bittiming.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o can_bittiming
+ *
+ *          Usage: can_bittiming [-s sample_permille] [-c clock_hz] [-b bitrate]
+ *          -c and -b limit the sweep to one clock or bitrate. Exit code 1 if
+ *          a case fails.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "can_drv.h"
+#include "system_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define BT_ARRAY_SIZE(a)        (sizeof(a) / sizeof((a)[0]))
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* APB1 clocks: F407 at 168 MHz (target), F429 at 180 MHz, F103 at 72 MHz,
+   F446 at 180 MHz with APB1/2 = 45 MHz, and HSI/HSE-only setups */
+static const uint32_t bt_clocks[] = {
+    42000000, 45000000, 36000000, 40000000, 48000000, 30000000,
+    24000000, 16000000, 8000000
+};
+
+static const uint32_t bt_bitrates[] = {
+    1000000, 800000, 500000, 250000, 125000, 100000, 83333, 50000,
+    33333, 20000, 10000
+};
+
+/* Bitrates of the gateway's buses: must work on the target clock */
+static const uint32_t bt_required[] = {
+    1000000, 500000, 250000, 125000
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t BitTiming_BestTq(uint32_t clock_hz, uint32_t bitrate, uint16_t sample_point);
+static bool BitTiming_Check(uint32_t clock_hz, uint32_t bitrate, uint16_t sample_point, bool* exact);
+static bool BitTiming_IsRequired(uint32_t clock_hz, uint32_t bitrate);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Bit-timing check entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if every case passed, 1 on failures or usage errors
+ */
+int main(int argc, char** argv)
+{
+    uint32_t sample_point = CAN_SAMPLE_POINT_PERMILLE;
+    uint32_t only_clock = 0;
+    uint32_t only_bitrate = 0;
+    uint32_t checked = 0, exact_count = 0, failed = 0;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "s:c:b:")) != -1) {
+        switch (opt) {
+        case 's': sample_point = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'c': only_clock = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'b': only_bitrate = (uint32_t)strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-s sample_permille] [-c clock_hz] [-b bitrate]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (sample_point == 0 || sample_point >= 1000) {
+        fprintf(stderr, "can_bittiming: sample point must be 1..999 permille\n");
+        return 1;
+    }
+    
+    uint32_t clock_count = only_clock ? 1 : BT_ARRAY_SIZE(bt_clocks);
+    uint32_t bitrate_count = only_bitrate ? 1 : BT_ARRAY_SIZE(bt_bitrates);
+    
+    for (uint32_t c = 0; c < clock_count; c++) {
+        uint32_t clock_hz = only_clock ? only_clock : bt_clocks[c];
+        
+        for (uint32_t b = 0; b < bitrate_count; b++) {
+            uint32_t bitrate = only_bitrate ? only_bitrate : bt_bitrates[b];
+            bool exact = false;
+            
+            checked++;
+            if (!BitTiming_Check(clock_hz, bitrate, (uint16_t)sample_point, &exact)) failed++;
+            if (exact) exact_count++;
+        }
+    }
+    
+    printf("BITTIMING,Checked:%u,Exact:%u,Failed:%u\n", checked, exact_count, failed);
+    
+    return (failed == 0) ? 0 : 1;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Most time quanta of any valid timing, by exhaustive search
+ * @param  clock_hz: CAN peripheral clock
+ * @param  bitrate: Bitrate in bit/s
+ * @param  sample_point: Requested sample point in permille
+ * @retval Time quanta per bit, 0 if no exact timing exists
+ */
+static uint8_t BitTiming_BestTq(uint32_t clock_hz, uint32_t bitrate, uint16_t sample_point)
+{
+    uint8_t best = 0;
+    
+    for (uint32_t prescaler = 1; prescaler <= CAN_BT_PRESCALER_MAX; prescaler++) {
+        for (uint32_t bs1 = 1; bs1 <= CAN_BT_BS1_MAX; bs1++) {
+            for (uint32_t bs2 = 1; bs2 <= CAN_BT_BS2_MAX; bs2++) {
+                uint32_t tq = 1 + bs1 + bs2;
+                int32_t error = (int32_t)((1 + bs1) * 1000) - (int32_t)(tq * sample_point);
+                
+                if (tq < CAN_BT_TQ_MIN || tq <= best) continue;
+                if ((uint64_t)prescaler * tq * bitrate != clock_hz) continue;
+                if (error > 500 || error < -500) continue;
+                best = (uint8_t)tq;
+            }
+        }
+    }
+    
+    return best;
+}
+
+/**
+ * @brief  Compute one case, compare it with the exhaustive search, print it
+ * @param  clock_hz: CAN peripheral clock
+ * @param  bitrate: Bitrate in bit/s
+ * @param  sample_point: Requested sample point in permille
+ * @param  exact: Set if the calculator found a timing
+ * @retval true if the case passed
+ */
+static bool BitTiming_Check(uint32_t clock_hz, uint32_t bitrate, uint16_t sample_point, bool* exact)
+{
+    CanBitTiming_t timing;
+    uint8_t best = BitTiming_BestTq(clock_hz, bitrate, sample_point);
+    
+    *exact = CAN_CalcBitTiming(clock_hz, bitrate, sample_point, &timing);
+    
+    if (!*exact) {
+        bool pass = (best == 0) && !BitTiming_IsRequired(clock_hz, bitrate);
+        printf("BITTIMING,Clock:%u,Bitrate:%u,None,Check:%s\n", clock_hz, bitrate, pass ? "OK" : "FAIL");
+        return pass;
+    }
+    
+    int32_t error = (int32_t)((1 + timing.bs1) * 1000) - (int32_t)(timing.tq * sample_point);
+    bool pass = (uint64_t)timing.prescaler * timing.tq * bitrate == clock_hz &&
+                timing.tq == 1 + timing.bs1 + timing.bs2 &&
+                timing.tq == best &&
+                timing.prescaler >= 1 && timing.prescaler <= CAN_BT_PRESCALER_MAX &&
+                timing.bs1 >= 1 && timing.bs1 <= CAN_BT_BS1_MAX &&
+                timing.bs2 >= 1 && timing.bs2 <= CAN_BT_BS2_MAX &&
+                timing.sjw >= 1 && timing.sjw <= CAN_BT_SJW_MAX && timing.sjw <= timing.bs2 &&
+                error <= 500 && error >= -500;
+    
+    uint32_t btr = ((uint32_t)(timing.sjw - 1U) << CAN_BTR_SJW_Pos) |
+                   ((uint32_t)(timing.bs1 - 1U) << CAN_BTR_TS1_Pos) |
+                   ((uint32_t)(timing.bs2 - 1U) << CAN_BTR_TS2_Pos) |
+                   (uint32_t)(timing.prescaler - 1U);
+    
+    printf("BITTIMING,Clock:%u,Bitrate:%u,Prescaler:%u,BS1:%u,BS2:%u,SJW:%u,Tq:%u,SamplePoint:%u.%u%%,"
+           "BTR:0x%08X,Check:%s\n",
+           clock_hz, bitrate, timing.prescaler, timing.bs1, timing.bs2, timing.sjw, timing.tq,
+           timing.sample_point / 10U, timing.sample_point % 10U, btr, pass ? "OK" : "FAIL");
+    
+    return pass;
+}
+
+/**
+ * @brief  Whether the gateway needs this bitrate on this clock
+ * @param  clock_hz: CAN peripheral clock
+ * @param  bitrate: Bitrate in bit/s
+ * @retval true for the target APB1 clock and a bus bitrate of the gateway
+ */
+static bool BitTiming_IsRequired(uint32_t clock_hz, uint32_t bitrate)
+{
+    if (clock_hz != APB1_CLOCK_FREQ) return false;
+    
+    for (uint32_t i = 0; i < BT_ARRAY_SIZE(bt_required); i++) {
+        if (bt_required[i] == bitrate) return true;
+    }
+    
+    return false;
+}
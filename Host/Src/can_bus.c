@@ -0,0 +1,657 @@
+/**
+ ******************************************************************************
+ * @file    can_bus.c
+ * @brief   Multi-node virtual CAN bus with the gateway as one node
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Time advances in bit times. Whenever the bus is idle, every
+ *          node with a frame ready starts it; the lowest arbitration field
+ *          (dominant 0 wins, bit for bit) takes the bus and the others
+ *          retry at the next idle. Frame length is exact: the bit stream
+ *          from SOF to the CRC is built, stuffed as on the wire, and the
+ *          fixed tail plus intermission is added.
+ *
+ *          Faults: an injected error (error_ppm) hits a random bit of the
+ *          frame, followed by error flag, delimiter and intermission; a
+ *          frame nobody acknowledges (only the sender is active) ends in
+ *          an ACK error. Transmit error counters drive error-passive
+ *          (suspend transmission) and bus-off (128 x 11 bit recovery).
+ *
+ *          Node 0 is the gateway's bxCAN controller (host_port.c model
+ *          attached to the bus): a frame passing the filters enters the
+ *          3-message RX FIFO at end of frame and is lost if the FIFO is
+ *          full. The RX interrupt releases one message rx_response_ns
+ *          after it was raised; it is held off while interrupts are masked
+ *          (masked_us at the start of each main loop pass, every poll_us).
+ *          The gateway offers its mailboxes in request order. It is configured
+ *          without automatic retransmission (CAN_MCR_NART), so a frame
+ *          losing arbitration or hit by an error is given up.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_bus.h"
+#include "host_port.h"
+#include "host_ecu.h"
+#include "can_drv.h"
+#include "e2e.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Frame competing in one arbitration round
+ */
+typedef struct {
+    int message;                /* Message index, -1 = gateway mailbox */
+    uint8_t node;
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+    uint64_t queued_bit;
+    CanBusFrameTiming_t timing;
+} CanBusContender_t;
+
+/* Private define ------------------------------------------------------------*/
+#define CAN_BUS_FIELD_MAX       (1 + 32 + 2 + 4 + 64 + 15)  /* SOF .. CRC, extended frame */
+#define CAN_BUS_CRC15_POLY      0x4599U
+#define CAN_BUS_STUFF_RUN       5
+#define CAN_BUS_PPM             1000000U
+#define CAN_BUS_TIME_NEVER      UINT64_MAX
+
+/* Private macro -------------------------------------------------------------*/
+#define CAN_BUS_US_TO_BITS(sim, us)     ((uint64_t)(us) * (sim)->bitrate / 1000000U)
+#define CAN_BUS_TO_US(sim, bits)        ((uint64_t)(bits) * 1000000U / (sim)->bitrate)
+#define CAN_BUS_TO_NS(sim, bits)        ((uint64_t)(bits) * 1000000000U / (sim)->bitrate)
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t gateway_queued_bit = CAN_BUS_TIME_NEVER;   /* First seen oldest request */
+static uint64_t gateway_rx_ns = CAN_BUS_TIME_NEVER;        /* Next RX interrupt done */
+static uint64_t gateway_masked_ns = 0;                     /* Interrupts masked until */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t CanBus_PutBits(uint8_t* bits, uint16_t count, uint32_t value, uint8_t width);
+static void CanBus_Release(CanBusSim_t* sim);
+static void CanBus_PollGateway(CanBusSim_t* sim, uint64_t until_bit, uint64_t* next_poll_bit);
+static void CanBus_Deliver(CanBusSim_t* sim, const CanBusContender_t* frame, uint64_t eof_bit);
+static void CanBus_ServiceRx(CanBusSim_t* sim, uint64_t until_ns);
+static void CanBus_RefillGateway(CanBusSim_t* sim);
+static uint8_t CanBus_Collect(CanBusSim_t* sim, CanBusContender_t* contenders);
+static uint64_t CanBus_NextEvent(const CanBusSim_t* sim, uint64_t next_poll_bit, uint64_t end_bit);
+static void CanBus_TransmitError(CanBusSim_t* sim, CanBusNode_t* node, uint64_t end_bit, bool count);
+static void CanBus_GatewayDone(CanBusSim_t* sim, bool sent);
+static void CanBus_RecordLatency(CanBusSim_t* sim, uint32_t id, uint64_t bits);
+static uint32_t CanBus_Random(CanBusSim_t* sim);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Check for a supported bit rate
+ * @param  bitrate: Bits per second
+ * @retval true for 125k, 250k, 500k and 1M
+ */
+bool CanBus_IsValidBitrate(uint32_t bitrate)
+{
+    return bitrate == 125000U || bitrate == 250000U || bitrate == 500000U || bitrate == 1000000U;
+}
+
+/**
+ * @brief  Exact bus time and arbitration field of a data frame
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code (0-8)
+ * @param  data: Data bytes (dlc bytes)
+ * @param  timing: Result
+ * @retval None
+ */
+void CanBus_FrameTiming(uint32_t id, uint8_t dlc, const uint8_t* data, CanBusFrameTiming_t* timing)
+{
+    uint8_t bits[CAN_BUS_FIELD_MAX];
+    uint16_t count = 0;
+    uint16_t crc = 0;
+    
+    count = CanBus_PutBits(bits, count, 0, 1);                          /* SOF */
+    if (id & CAN_ID_EXT) {
+        count = CanBus_PutBits(bits, count, (id >> 18) & 0x7FFU, 11);   /* Base ID */
+        count = CanBus_PutBits(bits, count, 3, 2);                      /* SRR, IDE */
+        count = CanBus_PutBits(bits, count, id & 0x3FFFFU, 18);         /* ID extension */
+        count = CanBus_PutBits(bits, count, 0, 3);                      /* RTR, r1, r0 */
+    } else {
+        count = CanBus_PutBits(bits, count, id & CAN_ID_STD_MASK, 11);
+        count = CanBus_PutBits(bits, count, 0, 3);                      /* RTR, IDE, r0 */
+    }
+    count = CanBus_PutBits(bits, count, dlc, 4);
+    for (uint8_t i = 0; i < dlc && i < 8; i++) {
+        count = CanBus_PutBits(bits, count, data[i], 8);
+    }
+    
+    /* Arbitration field, MSB first and left aligned: standard ID, RTR,
+       IDE (13 bits) or base ID, SRR, IDE, extension, RTR (32 bits) */
+    timing->arbitration = 0;
+    for (uint8_t i = 0; i < 32; i++) {
+        timing->arbitration = (timing->arbitration << 1) |
+                              ((i < ((id & CAN_ID_EXT) ? 32 : 13)) ? bits[1 + i] : 0);
+    }
+    
+    for (uint16_t i = 0; i < count; i++) {
+        bool crc_next = bits[i] ^ ((crc >> 14) & 1U);
+        crc = (uint16_t)((crc << 1) & 0x7FFFU);
+        if (crc_next) crc ^= CAN_BUS_CRC15_POLY;
+    }
+    count = CanBus_PutBits(bits, count, crc, 15);
+    
+    /* After five equal bits the sender inserts one of opposite level */
+    uint16_t stuff = 0;
+    uint8_t level = bits[0];
+    uint8_t run = 1;
+    for (uint16_t i = 1; i < count; i++) {
+        if (bits[i] == level) {
+            run++;
+        } else {
+            level = bits[i];
+            run = 1;
+        }
+        if (run == CAN_BUS_STUFF_RUN) {
+            stuff++;
+            level ^= 1U;
+            run = 1;
+        }
+    }
+    
+    timing->stuff_bits = stuff;
+    timing->bits = (uint16_t)(count + stuff + CAN_BUS_TAIL_BITS + CAN_BUS_IFS_BITS);
+}
+
+/**
+ * @brief  Empty bus with the gateway as node 0
+ * @param  sim: Simulation
+ * @param  bitrate: Bits per second
+ * @retval None
+ */
+void CanBus_Init(CanBusSim_t* sim, uint32_t bitrate)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->bitrate = bitrate;
+    sim->poll_us = 1000;
+    sim->rx_response_ns = CAN_BUS_RX_RESPONSE_NS;
+    sim->seed = 1;
+    CanBus_AddNode(sim, "GATEWAY");
+    gateway_queued_bit = CAN_BUS_TIME_NEVER;
+    gateway_rx_ns = CAN_BUS_TIME_NEVER;
+    gateway_masked_ns = 0;
+}
+
+/**
+ * @brief  Add a simulated node
+ * @param  sim: Simulation
+ * @param  name: Node name (truncated)
+ * @retval Node index, -1 if the node table is full
+ */
+int CanBus_AddNode(CanBusSim_t* sim, const char* name)
+{
+    if (sim->node_count >= CAN_BUS_MAX_NODES) return -1;
+    
+    CanBusNode_t* node = &sim->nodes[sim->node_count];
+    memset(node, 0, sizeof(*node));
+    strncpy(node->name, name, CAN_BUS_NAME_LENGTH - 1);
+    
+    return sim->node_count++;
+}
+
+/**
+ * @brief  Add a periodic message
+ * @param  sim: Simulation
+ * @param  message: Message (node, id, dlc, data, e2e, period_us, offset_us)
+ * @retval true if added, false if invalid or the table is full
+ */
+bool CanBus_AddMessage(CanBusSim_t* sim, const CanBusMessage_t* message)
+{
+    if (sim->message_count >= CAN_BUS_MAX_MESSAGES || message->node == CAN_BUS_GATEWAY_NODE ||
+        message->node >= sim->node_count || message->dlc > 8 || message->period_us == 0 ||
+        !CAN_ID_IS_VALID(message->id)) {
+        return false;
+    }
+    
+    CanBusMessage_t* entry = &sim->messages[sim->message_count++];
+    *entry = *message;
+    entry->next_us = message->offset_us;
+    entry->pending = false;
+    entry->counter = 0;
+    
+    return true;
+}
+
+/**
+ * @brief  Run the bus and the gateway for a span of time
+ * @note   The gateway modules must be initialized (HostEcu_Init) and its
+ *         controller attached (HostPort_CanAttach) beforehand.
+ * @param  sim: Simulation
+ * @param  duration_us: Simulated time to add
+ * @retval None
+ */
+void CanBus_Run(CanBusSim_t* sim, uint64_t duration_us)
+{
+    CanBusContender_t contenders[CAN_BUS_MAX_MESSAGES + 1];
+    uint64_t end_bit = sim->now_bit + CAN_BUS_US_TO_BITS(sim, duration_us);
+    uint64_t next_poll_bit = sim->now_bit;
+    
+    while (sim->now_bit < end_bit) {
+        CanBus_PollGateway(sim, sim->now_bit, &next_poll_bit);
+        CanBus_Release(sim);
+        
+        uint8_t count = CanBus_Collect(sim, contenders);
+        if (count == 0) {
+            sim->now_bit = CanBus_NextEvent(sim, next_poll_bit, end_bit);
+            continue;
+        }
+        
+        /* Arbitration: lowest field wins, everyone else backs off */
+        uint8_t winner = 0;
+        for (uint8_t i = 1; i < count; i++) {
+            if (contenders[i].timing.arbitration < contenders[winner].timing.arbitration) {
+                winner = i;
+            }
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            if (i == winner) continue;
+            sim->nodes[contenders[i].node].arbitration_lost++;
+            if (contenders[i].message < 0) {
+                CanBus_GatewayDone(sim, false);     /* No retransmission */
+            }
+        }
+        
+        CanBusContender_t* frame = &contenders[winner];
+        CanBusNode_t* node = &sim->nodes[frame->node];
+        uint64_t start_bit = sim->now_bit;
+        
+        /* Somebody must be active to acknowledge */
+        bool acknowledged = false;
+        for (uint8_t n = 0; n < sim->node_count; n++) {
+            if (n != frame->node && sim->nodes[n].state != CAN_BUS_OFF) {
+                acknowledged = true;
+            }
+        }
+        
+        uint16_t error_bit = 0;
+        if (!acknowledged) {
+            error_bit = frame->timing.bits - CAN_BUS_IFS_BITS - 8;     /* ACK slot */
+        } else if (sim->error_ppm > 0 && (CanBus_Random(sim) % CAN_BUS_PPM) < sim->error_ppm) {
+            error_bit = 1 + (uint16_t)(CanBus_Random(sim) % (frame->timing.bits - CAN_BUS_IFS_BITS - 1));
+        }
+        
+        if (error_bit != 0) {
+            uint64_t bits = error_bit + CAN_BUS_ERROR_FLAG_BITS + CAN_BUS_ERROR_DELIM_BITS + CAN_BUS_IFS_BITS;
+            sim->now_bit += bits;
+            sim->busy_bits += bits;
+            sim->error_frames++;
+            /* An error-passive sender without ACK keeps its counter */
+            CanBus_TransmitError(sim, node, sim->now_bit, acknowledged || node->state == CAN_BUS_ERROR_ACTIVE);
+            if (frame->message < 0) {
+                CanBus_GatewayDone(sim, false);
+            }
+            continue;
+        }
+        
+        sim->now_bit += frame->timing.bits;
+        sim->busy_bits += frame->timing.bits;
+        sim->stuff_bits += frame->timing.stuff_bits;
+        sim->frames++;
+        node->sent++;
+        if (node->tec > 0) node->tec--;
+        if (node->state == CAN_BUS_ERROR_PASSIVE && node->tec < CAN_BUS_TEC_PASSIVE) {
+            node->state = CAN_BUS_ERROR_ACTIVE;
+        }
+        if (node->state == CAN_BUS_ERROR_PASSIVE) {
+            node->ready_bit = sim->now_bit + CAN_BUS_SUSPEND_BITS;
+        }
+        
+        /* Queue to end of frame (the receivers' point of validity) */
+        uint64_t eof_bit = start_bit + frame->timing.bits - CAN_BUS_IFS_BITS;
+        CanBus_RecordLatency(sim, frame->id, eof_bit - frame->queued_bit);
+        
+        if (frame->message >= 0) {
+            sim->messages[frame->message].pending = false;
+            CanBus_PollGateway(sim, eof_bit, &next_poll_bit);
+            CanBus_Deliver(sim, frame, eof_bit);
+        } else {
+            CanBus_GatewayDone(sim, true);
+        }
+    }
+    
+    CanBus_ServiceRx(sim, CAN_BUS_TO_NS(sim, end_bit));
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Append a field MSB first
+ * @param  bits: Bit stream
+ * @param  count: Bits already in the stream
+ * @param  value: Field value
+ * @param  width: Field width in bits
+ * @retval New bit count
+ */
+static uint16_t CanBus_PutBits(uint8_t* bits, uint16_t count, uint32_t value, uint8_t width)
+{
+    while (width > 0) {
+        width--;
+        bits[count++] = (uint8_t)((value >> width) & 1U);
+    }
+    return count;
+}
+
+/**
+ * @brief  Queue every periodic message due by now
+ * @note   A message still waiting from its previous period is replaced,
+ *         as an ECU rewriting its transmit buffer would.
+ * @param  sim: Simulation
+ * @retval None
+ */
+static void CanBus_Release(CanBusSim_t* sim)
+{
+    for (uint8_t i = 0; i < sim->message_count; i++) {
+        CanBusMessage_t* message = &sim->messages[i];
+        
+        while (CAN_BUS_US_TO_BITS(sim, message->next_us) <= sim->now_bit) {
+            if (message->pending) {
+                sim->nodes[message->node].overwritten++;
+            }
+            message->pending = true;
+            message->queued_bit = CAN_BUS_US_TO_BITS(sim, message->next_us);
+            message->next_us += message->period_us;
+            
+            /* Byte 0 = CRC over the payload, byte 1 low nibble = alive counter */
+            if (message->e2e) {
+                message->counter = (message->counter + 1) & 0x0F;
+                message->data[1] = (uint8_t)((message->data[1] & 0xF0) | message->counter);
+                message->data[0] = E2E_ComputeCrc(message->data, (uint16_t)(message->id & CAN_ID_STD_MASK));
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Run the gateway main loop for every period due by a given time
+ * @param  sim: Simulation
+ * @param  until_bit: Bus time reached
+ * @param  next_poll_bit: Time of the next main loop pass (updated)
+ * @retval None
+ */
+static void CanBus_PollGateway(CanBusSim_t* sim, uint64_t until_bit, uint64_t* next_poll_bit)
+{
+    while (*next_poll_bit <= until_bit) {
+        uint64_t poll_ns = CAN_BUS_TO_NS(sim, *next_poll_bit);
+        
+        /* Interrupts taken before the pass; one raised later waits for the mask */
+        CanBus_ServiceRx(sim, poll_ns);
+        if (sim->masked_us > 0) {
+            gateway_masked_ns = poll_ns + (uint64_t)sim->masked_us * 1000U;
+            if (gateway_rx_ns != CAN_BUS_TIME_NEVER && gateway_rx_ns < gateway_masked_ns + sim->rx_response_ns) {
+                gateway_rx_ns = gateway_masked_ns + sim->rx_response_ns;
+            }
+        }
+        
+        HostPort_SetTick((uint32_t)(CAN_BUS_TO_US(sim, *next_poll_bit) / 1000U));
+        HostEcu_Poll();
+        HostPort_UartTransmit(NULL, UINT32_MAX);
+        CanBus_RefillGateway(sim);
+        sim->gateway_polls++;
+        *next_poll_bit += CAN_BUS_US_TO_BITS(sim, sim->poll_us);
+    }
+    HostPort_SetTick((uint32_t)(CAN_BUS_TO_US(sim, until_bit) / 1000U));
+}
+
+/**
+ * @brief  Hand a frame sent by a simulated node to the gateway's RX FIFO
+ * @param  sim: Simulation
+ * @param  frame: Completed frame
+ * @param  eof_bit: End of frame, where the frame becomes valid
+ * @retval None
+ */
+static void CanBus_Deliver(CanBusSim_t* sim, const CanBusContender_t* frame, uint64_t eof_bit)
+{
+    uint64_t eof_ns = CAN_BUS_TO_NS(sim, eof_bit);
+    
+    if (sim->nodes[CAN_BUS_GATEWAY_NODE].state == CAN_BUS_OFF) return;
+    
+    CanBus_ServiceRx(sim, eof_ns);
+    
+    HostCanRx_t result = HostPort_CanArrive(sim->gateway_bus, frame->id, frame->dlc, frame->data);
+    if (result == HOST_CAN_RX_OVERRUN) {
+        sim->rx_fifo_lost++;
+    } else if (result == HOST_CAN_RX_QUEUED && gateway_rx_ns == CAN_BUS_TIME_NEVER) {
+        gateway_rx_ns = ((eof_ns > gateway_masked_ns) ? eof_ns : gateway_masked_ns) + sim->rx_response_ns;
+    }
+    
+    CAN_TypeDef* can = (sim->gateway_bus == 0) ? CAN1 : CAN2;
+    uint8_t waiting = (uint8_t)((can->RF0R & CAN_RF0R_FMP0) >> CAN_RF0R_FMP0_Pos);
+    if (waiting > sim->rx_fifo_high_water) {
+        sim->rx_fifo_high_water = waiting;
+    }
+}
+
+/**
+ * @brief  Run the gateway's RX interrupts that complete by a given time
+ * @note   One message per interrupt; while messages wait, the next
+ *         interrupt follows rx_response_ns after the previous one.
+ * @param  sim: Simulation
+ * @param  until_ns: Time reached, in ns
+ * @retval None
+ */
+static void CanBus_ServiceRx(CanBusSim_t* sim, uint64_t until_ns)
+{
+    CAN_TypeDef* can = (sim->gateway_bus == 0) ? CAN1 : CAN2;
+    
+    while (gateway_rx_ns <= until_ns) {
+        /* Handled before the pass or frame that follows it; the tick never runs back */
+        if (gateway_rx_ns / 1000000U > HAL_GetTick()) {
+            HostPort_SetTick((uint32_t)(gateway_rx_ns / 1000000U));
+        }
+        CAN_RxIRQHandler((CanBus_t)sim->gateway_bus);
+        HostPort_CanReleaseRx(sim->gateway_bus);
+        CanBus_RefillGateway(sim);
+        
+        if ((can->RF0R & CAN_RF0R_FMP0) && (can->IER & CAN_IER_FMPIE0)) {
+            gateway_rx_ns += sim->rx_response_ns;
+        } else {
+            gateway_rx_ns = CAN_BUS_TIME_NEVER;
+        }
+    }
+}
+
+/**
+ * @brief  Let the gateway's TX interrupt fill its empty mailboxes
+ * @param  sim: Simulation
+ * @retval None
+ */
+static void CanBus_RefillGateway(CanBusSim_t* sim)
+{
+    HostPort_CanRefillTx(0);
+    HostPort_CanRefillTx(1);
+    
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+    if (gateway_queued_bit == CAN_BUS_TIME_NEVER && HostPort_CanPeekTx(sim->gateway_bus, &id, &dlc, data)) {
+        gateway_queued_bit = sim->now_bit;
+    }
+}
+
+/**
+ * @brief  Frames ready to start at the current bus time
+ * @param  sim: Simulation
+ * @param  contenders: Filled with one entry per ready frame
+ * @retval Number of contenders
+ */
+static uint8_t CanBus_Collect(CanBusSim_t* sim, CanBusContender_t* contenders)
+{
+    uint8_t count = 0;
+    
+    /* Bus-off nodes come back after the recovery sequence */
+    for (uint8_t n = 0; n < sim->node_count; n++) {
+        CanBusNode_t* node = &sim->nodes[n];
+        if (node->state == CAN_BUS_OFF && node->ready_bit <= sim->now_bit) {
+            node->state = CAN_BUS_ERROR_ACTIVE;
+            node->tec = 0;
+        }
+    }
+    
+    CanBusNode_t* gateway = &sim->nodes[CAN_BUS_GATEWAY_NODE];
+    if (gateway->state != CAN_BUS_OFF && gateway->ready_bit <= sim->now_bit) {
+        CanBusContender_t* c = &contenders[count];
+        if (HostPort_CanPeekTx(sim->gateway_bus, &c->id, &c->dlc, c->data)) {
+            c->message = -1;
+            c->node = CAN_BUS_GATEWAY_NODE;
+            c->queued_bit = (gateway_queued_bit != CAN_BUS_TIME_NEVER) ? gateway_queued_bit : sim->now_bit;
+            CanBus_FrameTiming(c->id, c->dlc, c->data, &c->timing);
+            count++;
+        }
+    }
+    
+    for (uint8_t i = 0; i < sim->message_count; i++) {
+        CanBusMessage_t* message = &sim->messages[i];
+        CanBusNode_t* node = &sim->nodes[message->node];
+        
+        if (!message->pending || node->state == CAN_BUS_OFF || node->ready_bit > sim->now_bit) continue;
+        
+        CanBusContender_t candidate;
+        candidate.message = i;
+        candidate.node = message->node;
+        candidate.id = message->id;
+        candidate.dlc = message->dlc;
+        memcpy(candidate.data, message->data, sizeof(candidate.data));
+        candidate.queued_bit = message->queued_bit;
+        CanBus_FrameTiming(candidate.id, candidate.dlc, candidate.data, &candidate.timing);
+        
+        /* A node offers only its highest priority frame */
+        uint8_t slot = count;
+        for (uint8_t k = 0; k < count; k++) {
+            if (contenders[k].node == candidate.node) {
+                slot = k;
+                break;
+            }
+        }
+        if (slot == count) {
+            count++;
+        } else if (contenders[slot].timing.arbitration <= candidate.timing.arbitration) {
+            continue;
+        }
+        contenders[slot] = candidate;
+    }
+    
+    return count;
+}
+
+/**
+ * @brief  Next time something can happen on an idle bus
+ * @param  sim: Simulation
+ * @param  next_poll_bit: Next gateway main loop pass
+ * @param  end_bit: End of the run
+ * @retval Bus time to continue at
+ */
+static uint64_t CanBus_NextEvent(const CanBusSim_t* sim, uint64_t next_poll_bit, uint64_t end_bit)
+{
+    uint64_t next = (next_poll_bit < end_bit) ? next_poll_bit : end_bit;
+    
+    for (uint8_t i = 0; i < sim->message_count; i++) {
+        const CanBusMessage_t* message = &sim->messages[i];
+        uint64_t release = CAN_BUS_US_TO_BITS(sim, message->next_us);
+        uint64_t ready = sim->nodes[message->node].ready_bit;
+        
+        if (release < next) next = release;
+        if (message->pending && ready > sim->now_bit && ready < next) next = ready;
+    }
+    for (uint8_t n = 0; n < sim->node_count; n++) {
+        uint64_t ready = sim->nodes[n].ready_bit;
+        if (ready > sim->now_bit && ready < next) next = ready;
+    }
+    
+    return (next > sim->now_bit) ? next : sim->now_bit + 1;
+}
+
+/**
+ * @brief  Fault confinement of a transmitter after an error frame
+ * @param  sim: Simulation
+ * @param  node: Transmitter
+ * @param  end_bit: End of the error frame
+ * @param  count: false for the ACK error exception of error-passive nodes
+ * @retval None
+ */
+static void CanBus_TransmitError(CanBusSim_t* sim, CanBusNode_t* node, uint64_t end_bit, bool count)
+{
+    node->errors++;
+    if (count) {
+        node->tec += 8;
+    }
+    
+    if (node->tec >= CAN_BUS_TEC_BUSOFF) {
+        node->state = CAN_BUS_OFF;
+        node->ready_bit = end_bit + CAN_BUS_BUSOFF_BITS;
+    } else if (node->tec >= CAN_BUS_TEC_PASSIVE) {
+        node->state = CAN_BUS_ERROR_PASSIVE;
+        node->ready_bit = end_bit + CAN_BUS_SUSPEND_BITS;
+    }
+    (void)sim;
+}
+
+/**
+ * @brief  Release the gateway's oldest mailbox and refill
+ * @param  sim: Simulation
+ * @param  sent: true if transmitted, false if given up
+ * @retval None
+ */
+static void CanBus_GatewayDone(CanBusSim_t* sim, bool sent)
+{
+    HostPort_CanCompleteTx(sim->gateway_bus);
+    gateway_queued_bit = CAN_BUS_TIME_NEVER;
+    CanBus_RefillGateway(sim);
+    
+    if (!sent) {
+        sim->nodes[CAN_BUS_GATEWAY_NODE].tx_dropped++;
+    }
+}
+
+/**
+ * @brief  Add one queue-to-wire latency sample
+ * @param  sim: Simulation
+ * @param  id: Identifier
+ * @param  bits: Latency in bit times
+ * @retval None
+ */
+static void CanBus_RecordLatency(CanBusSim_t* sim, uint32_t id, uint64_t bits)
+{
+    CanBusLatency_t* entry = NULL;
+    
+    for (uint16_t i = 0; i < sim->latency_count; i++) {
+        if (sim->latency[i].id == id) {
+            entry = &sim->latency[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        if (sim->latency_count >= CAN_BUS_MAX_IDS) return;
+        entry = &sim->latency[sim->latency_count++];
+        entry->id = id;
+    }
+    
+    entry->count++;
+    entry->sum_bits += bits;
+    if (bits > entry->max_bits) {
+        entry->max_bits = bits;
+    }
+}
+
+/**
+ * @brief  Next value of the fault injection PRNG (xorshift32)
+ * @param  sim: Simulation
+ * @retval Pseudo-random value
+ */
+static uint32_t CanBus_Random(CanBusSim_t* sim)
+{
+    uint32_t x = sim->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->seed = x;
+    return x;
+}
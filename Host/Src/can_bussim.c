@@ -0,0 +1,444 @@
+/**
+ ******************************************************************************
+ * @file    can_bussim.c
+ * @brief   Multi-node CAN bus simulation around the Gateway ECU
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Puts the gateway's CAN1 (or CAN2) controller on a virtual bus
+ *          with periodic ECUs (can_bus.c) and reports bus load, error
+ *          frames, per-node arbitration losses, per-ID queue-to-wire
+ *          latency and the gateway's receive behaviour: frames lost in
+ *          the 3-message bxCAN RX FIFO and in the software queues. The RX
+ *          interrupt releases a message -i ns after it is raised (default:
+ *          irq_sim's worst case); -m masks interrupts for that many us at
+ *          the start of every main loop pass. -L adds a filler node (IDs
+ *          0x600 and up, 8 data bytes) sized to bring the scheduled load
+ *          to the given percentage.
+ *
+ *          Schedule file (-f), one message per line, '#' comments:
+ *            <node> <id> <period_ms> <offset_ms> <data hex> [e2e]
+ *          IDs above 0x7FF are sent as 29-bit frames. Without -f the
+ *          built-in schedule below is used.
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/can_bussim.c Host/Src/can_bus.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o can_bussim
+ *
+ *          Usage: can_bussim [-b bitrate] [-d seconds] [-L load%] [-e ppm]
+ *                            [-p poll_us] [-i rx_ns] [-m masked_us]
+ *                            [-c 1|2] [-f schedule] [-S seed]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_bus.h"
+#include "host_port.h"
+#include "host_ecu.h"
+#include "can_drv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Simulation options
+ */
+typedef struct {
+    uint32_t bitrate;
+    uint32_t seconds;           /* Simulated time */
+    double load_pct;            /* Target load with filler, 0 = no filler */
+    uint32_t error_ppm;
+    uint32_t poll_us;
+    uint32_t rx_response_ns;    /* RX interrupt, raised to FIFO release */
+    uint32_t masked_us;         /* Interrupts masked per main loop pass */
+    uint8_t gateway_bus;
+    uint32_t seed;
+    const char* schedule_path;  /* NULL = built-in schedule */
+} BusSimOptions_t;
+
+/**
+ * @brief Built-in schedule entry
+ */
+typedef struct {
+    const char* node;
+    uint32_t id;
+    uint32_t period_ms;
+    uint32_t offset_ms;
+    const char* data;
+    bool e2e;
+} BusSimDefault_t;
+
+/* Private define ------------------------------------------------------------*/
+#define BUSSIM_SECONDS          10
+#define BUSSIM_FILLER_MESSAGES  8
+#define BUSSIM_FILLER_BASE_ID   0x600U
+#define BUSSIM_LINE_LENGTH      256
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static CanBusSim_t sim;
+
+/* Engine, J1939 powertrain, diagnostic tester and body traffic on CAN1 */
+static const BusSimDefault_t default_schedule[] = {
+    { "ENGINE", 0x100,      10,  0, "0BB80000000000FF", false },
+    { "ENGINE", 0x101,      100, 1, "5A00000000000000", false },
+    { "ENGINE", 0x102,      20,  2, "0064000000000000", false },
+    { "ENGINE", 0x103,      50,  3, "0010000000000000", false },
+    { "ENGINE", 0x104,      10,  4, "0000E80300000000", true  },
+    { "J1939",  0x0CF00400, 10,  5, "FF7D7D803E00FFFF", false },
+    { "J1939",  0x18FEF100, 100, 6, "FF00320000000000", false },
+    { "TESTER", 0x7E0,      100, 7, "023E00",           false },
+    { "BODY",   0x105,      20,  9, "0102030405060708", false },
+    { "BODY",   0x555,      50,  9, "AA55AA55",         false },
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static bool BusSim_ParseOptions(int argc, char** argv, BusSimOptions_t* options);
+static bool BusSim_AddMessage(const char* node_name, uint32_t id, uint32_t period_ms,
+                              uint32_t offset_ms, const char* hex, bool e2e);
+static bool BusSim_LoadSchedule(const char* path);
+static void BusSim_AddFiller(double load_pct);
+static int BusSim_FindNode(const char* name);
+static void BusSim_Report(void);
+static void BusSim_Usage(const char* name);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Bus simulation entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if successful, 1 on usage or schedule errors
+ */
+int main(int argc, char** argv)
+{
+    BusSimOptions_t options;
+    
+    if (!BusSim_ParseOptions(argc, argv, &options)) {
+        BusSim_Usage(argv[0]);
+        return 1;
+    }
+    
+    CanBus_Init(&sim, options.bitrate);
+    sim.gateway_bus = options.gateway_bus;
+    sim.poll_us = options.poll_us;
+    sim.rx_response_ns = options.rx_response_ns;
+    sim.masked_us = options.masked_us;
+    sim.error_ppm = options.error_ppm;
+    sim.seed = options.seed;
+    
+    if (options.schedule_path != NULL) {
+        if (!BusSim_LoadSchedule(options.schedule_path)) return 1;
+    } else {
+        for (size_t i = 0; i < sizeof(default_schedule) / sizeof(default_schedule[0]); i++) {
+            const BusSimDefault_t* entry = &default_schedule[i];
+            BusSim_AddMessage(entry->node, entry->id, entry->period_ms, entry->offset_ms, entry->data, entry->e2e);
+        }
+    }
+    if (options.load_pct > 0.0) {
+        BusSim_AddFiller(options.load_pct);
+    }
+    
+    if (!HostEcu_Init(ROUTER_OUTPUT_EVENT)) {
+        fprintf(stderr, "can_bussim: gateway initialization failed\n");
+        return 1;
+    }
+    HostPort_UartTransmit(NULL, UINT32_MAX);    /* Startup banner */
+    HostPort_CanAttach(options.gateway_bus, true);
+    
+    CanBus_Run(&sim, (uint64_t)options.seconds * 1000000U);
+    
+    BusSim_Report();
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Parse command line
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @param  options: Parsed options
+ * @retval true if valid
+ */
+static bool BusSim_ParseOptions(int argc, char** argv, BusSimOptions_t* options)
+{
+    int opt;
+    
+    options->bitrate = 500000U;
+    options->seconds = BUSSIM_SECONDS;
+    options->load_pct = 0.0;
+    options->error_ppm = 0;
+    options->poll_us = 1000;
+    options->rx_response_ns = CAN_BUS_RX_RESPONSE_NS;
+    options->masked_us = 0;
+    options->gateway_bus = CAN_BUS_1;
+    options->seed = 1;
+    options->schedule_path = NULL;
+    
+    while ((opt = getopt(argc, argv, "b:d:L:e:p:i:m:c:f:S:")) != -1) {
+        switch (opt) {
+            case 'b':
+                options->bitrate = (uint32_t)strtoul(optarg, NULL, 0);
+                if (!CanBus_IsValidBitrate(options->bitrate)) return false;
+                break;
+            case 'd':
+                options->seconds = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->seconds == 0) return false;
+                break;
+            case 'L':
+                options->load_pct = atof(optarg);
+                if (options->load_pct < 0.0 || options->load_pct > 100.0) return false;
+                break;
+            case 'e':
+                options->error_ppm = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                options->poll_us = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->poll_us == 0) return false;
+                break;
+            case 'i':
+                options->rx_response_ns = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->rx_response_ns == 0) return false;
+                break;
+            case 'm':
+                options->masked_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                if (strcmp(optarg, "1") == 0) {
+                    options->gateway_bus = CAN_BUS_1;
+                } else if (strcmp(optarg, "2") == 0) {
+                    options->gateway_bus = CAN_BUS_2;
+                } else {
+                    return false;
+                }
+                break;
+            case 'f':
+                options->schedule_path = optarg;
+                break;
+            case 'S':
+                options->seed = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->seed == 0) return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    return optind == argc;
+}
+
+/**
+ * @brief  Add one periodic message, creating its node on first use
+ * @param  node_name: Transmitting node
+ * @param  id: Identifier, above 0x7FF = 29-bit (CAN_ID_EXT may be set)
+ * @param  period_ms: Period
+ * @param  offset_ms: First release
+ * @param  hex: Data bytes as hex digits (length gives the DLC)
+ * @param  e2e: Fill in E2E counter and CRC
+ * @retval true if added
+ */
+static bool BusSim_AddMessage(const char* node_name, uint32_t id, uint32_t period_ms,
+                              uint32_t offset_ms, const char* hex, bool e2e)
+{
+    CanBusMessage_t message;
+    size_t length = strlen(hex);
+    
+    memset(&message, 0, sizeof(message));
+    if (length % 2 != 0 || length > 16) return false;
+    
+    for (size_t i = 0; i < length / 2; i++) {
+        char byte[3] = { hex[2 * i], hex[2 * i + 1], '\0' };
+        char* end;
+        message.data[i] = (uint8_t)strtoul(byte, &end, 16);
+        if (*end != '\0') return false;
+    }
+    
+    int node = BusSim_FindNode(node_name);
+    if (node < 0) {
+        node = CanBus_AddNode(&sim, node_name);
+        if (node < 0) return false;
+    }
+    
+    message.node = (uint8_t)node;
+    message.id = (id > CAN_ID_STD_MASK) ? (id | CAN_ID_EXT) : id;
+    message.dlc = (uint8_t)(length / 2);
+    message.e2e = e2e;
+    message.period_us = period_ms * 1000U;
+    message.offset_us = offset_ms * 1000U;
+    
+    return CanBus_AddMessage(&sim, &message);
+}
+
+/**
+ * @brief  Read a schedule file
+ * @param  path: Schedule file
+ * @retval true if every line was valid
+ */
+static bool BusSim_LoadSchedule(const char* path)
+{
+    char line[BUSSIM_LINE_LENGTH];
+    uint32_t line_number = 0;
+    FILE* file = fopen(path, "r");
+    
+    if (file == NULL) {
+        fprintf(stderr, "can_bussim: cannot open %s\n", path);
+        return false;
+    }
+    
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char node[CAN_BUS_NAME_LENGTH];
+        char hex[20];
+        char flag[8] = "";
+        unsigned long id, period_ms, offset_ms;
+        
+        line_number++;
+        if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#') continue;
+        
+        int fields = sscanf(line, "%15s %lx %lu %lu %19s %7s", node, &id, &period_ms, &offset_ms, hex, flag);
+        if (fields < 5 || (fields == 6 && strcmp(flag, "e2e") != 0) || strcmp(node, "GATEWAY") == 0 ||
+            !BusSim_AddMessage(node, (uint32_t)id, (uint32_t)period_ms, (uint32_t)offset_ms, hex, fields == 6)) {
+            fprintf(stderr, "can_bussim: %s:%lu: invalid message\n", path, (unsigned long)line_number);
+            fclose(file);
+            return false;
+        }
+    }
+    
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief  Add a filler node bringing the scheduled load up to a target
+ * @note   The scheduled load is computed from exact frame lengths; the
+ *         gateway's own responses come on top of it.
+ * @param  load_pct: Target load in percent
+ * @retval None
+ */
+static void BusSim_AddFiller(double load_pct)
+{
+    CanBusFrameTiming_t timing;
+    double scheduled_bps = 0.0;
+    static const uint8_t filler_data[8] = { 0xA5, 0x5A, 0xA5, 0x5A, 0xA5, 0x5A, 0xA5, 0x5A };
+    
+    for (uint8_t i = 0; i < sim.message_count; i++) {
+        const CanBusMessage_t* message = &sim.messages[i];
+        CanBus_FrameTiming(message->id, message->dlc, message->data, &timing);
+        scheduled_bps += (double)timing.bits * 1e6 / (double)message->period_us;
+    }
+    
+    double filler_bps = load_pct / 100.0 * (double)sim.bitrate - scheduled_bps;
+    if (filler_bps <= 0.0) return;
+    
+    int node = CanBus_AddNode(&sim, "FILLER");
+    if (node < 0) return;
+    
+    for (uint8_t k = 0; k < BUSSIM_FILLER_MESSAGES; k++) {
+        CanBusMessage_t message;
+        
+        memset(&message, 0, sizeof(message));
+        message.node = (uint8_t)node;
+        message.id = BUSSIM_FILLER_BASE_ID + k;
+        message.dlc = 8;
+        memcpy(message.data, filler_data, sizeof(filler_data));
+        CanBus_FrameTiming(message.id, message.dlc, message.data, &timing);
+        
+        message.period_us = (uint32_t)((double)timing.bits * BUSSIM_FILLER_MESSAGES * 1e6 / filler_bps);
+        if (message.period_us == 0) message.period_us = 1;
+        message.offset_us = message.period_us / BUSSIM_FILLER_MESSAGES * k;
+        CanBus_AddMessage(&sim, &message);
+    }
+}
+
+/**
+ * @brief  Look up a node by name
+ * @param  name: Node name
+ * @retval Node index, -1 if unknown
+ */
+static int BusSim_FindNode(const char* name)
+{
+    for (uint8_t n = 0; n < sim.node_count; n++) {
+        if (strncmp(sim.nodes[n].name, name, CAN_BUS_NAME_LENGTH - 1) == 0) return n;
+    }
+    return -1;
+}
+
+/**
+ * @brief  Print simulation results, one record per line
+ * @retval None
+ */
+static void BusSim_Report(void)
+{
+    static const char* const state_names[] = { "Active", "Passive", "BusOff" };
+    CanRxStats_t rx;
+    
+    CAN_GetRxStats(&rx);
+    
+    printf("BUS,Bitrate:%lu,SimMs:%.0f,Frames:%llu,Load:%.2f%%,ErrorFrames:%llu,StuffBits:%llu\n",
+           (unsigned long)sim.bitrate, CAN_BUS_BITS_TO_US(&sim, sim.now_bit) / 1000.0,
+           (unsigned long long)sim.frames,
+           (sim.now_bit > 0) ? 100.0 * (double)sim.busy_bits / (double)sim.now_bit : 0.0,
+           (unsigned long long)sim.error_frames, (unsigned long long)sim.stuff_bits);
+    
+    for (uint8_t n = 0; n < sim.node_count; n++) {
+        const CanBusNode_t* node = &sim.nodes[n];
+        printf("NODE,%s,Sent:%llu,ArbLost:%llu,Errors:%llu,TEC:%u,State:%s,Dropped:%llu,Overwritten:%llu\n",
+               node->name, (unsigned long long)node->sent, (unsigned long long)node->arbitration_lost,
+               (unsigned long long)node->errors, node->tec, state_names[node->state],
+               (unsigned long long)node->tx_dropped, (unsigned long long)node->overwritten);
+    }
+    
+    for (uint16_t i = 0; i < sim.latency_count; i++) {
+        const CanBusLatency_t* entry = &sim.latency[i];
+        printf("LATENCY,0x%lX,Count:%llu,AvgUs:%.1f,MaxUs:%.1f\n",
+               (unsigned long)(entry->id & ~CAN_ID_EXT), (unsigned long long)entry->count,
+               CAN_BUS_BITS_TO_US(&sim, (double)entry->sum_bits / (double)entry->count),
+               CAN_BUS_BITS_TO_US(&sim, entry->max_bits));
+    }
+    
+    printf("GATEWAY,Rx:%lu,Rejected:%lu,Coalesced:%lu,Dropped:%lu,HighWater:%u/%u/%u,Polls:%llu\n",
+           (unsigned long)rx.frames_received, (unsigned long)rx.frames_rejected,
+           (unsigned long)rx.frames_coalesced, (unsigned long)rx.frames_dropped,
+           rx.queue_high_water[CAN_RX_CLASS_NORMAL], rx.queue_high_water[CAN_RX_CLASS_HIGH],
+           rx.queue_high_water[CAN_RX_CLASS_LOW], (unsigned long long)sim.gateway_polls);
+    printf("RXFIFO,Overruns:%lu,Lost:%llu,HighWater:%u,ResponseNs:%lu,MaskedUs:%lu\n",
+           (unsigned long)rx.fifo_overruns, (unsigned long long)sim.rx_fifo_lost, sim.rx_fifo_high_water,
+           (unsigned long)sim.rx_response_ns, (unsigned long)sim.masked_us);
+}
+
+/**
+ * @brief  Print command line help
+ * @param  name: Program name
+ * @retval None
+ */
+static void BusSim_Usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [-b bitrate] [-d seconds] [-L load%%] [-e ppm] [-p poll_us]\n"
+            "          [-i rx_ns] [-m masked_us] [-c 1|2] [-f schedule] [-S seed]\n"
+            "  -b  125000, 250000, 500000 (default) or 1000000\n"
+            "  -d  simulated seconds (default %u)\n"
+            "  -L  add filler traffic up to this bus load in percent\n"
+            "  -e  error frame probability per frame, per million\n"
+            "  -p  gateway main loop period in microseconds (default 1000)\n"
+            "  -i  RX interrupt time per message in nanoseconds (default %u)\n"
+            "  -m  interrupts masked at the start of each main loop pass, microseconds\n"
+            "  -c  gateway controller on the bus: 1 = CAN1 (default), 2 = CAN2\n"
+            "  -f  schedule: <node> <id> <period_ms> <offset_ms> <data hex> [e2e]\n"
+            "  -S  error injection seed (non-zero)\n",
+            name, BUSSIM_SECONDS, CAN_BUS_RX_RESPONSE_NS);
+}
@@ -0,0 +1,292 @@
+/**
+ ******************************************************************************
+ * @file    can_corpus.c
+ * @brief   Reference CAN traffic corpus generator for the replay gate
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Writes a deterministic candump -l log that exercises every
+ *          gateway path: ramps on all routed signals, both selector
+ *          values of the multiplexed message (and an unknown one), E2E
+ *          protected brake frames with occasional CRC and counter faults,
+ *          CAN2-to-CAN1 forwarding, J1939 PGNs, UDS requests, IDs the
+ *          filters or the accept bitmap discard, and once a second a
+ *          back-to-back burst like those seen in vehicle recordings.
+ *          Same options, same bytes: the corpus is regenerated rather
+ *          than stored, and can_replay -g/-B checks the gateway output
+ *          and cost against a recorded golden output and baseline.
+ *
+ *          Build: same command as can_replay (see can_replay.c), with
+ *          Host/Src/can_corpus.c instead of can_replay.c and can_log.c.
+ *
+ *          Usage: can_corpus [-d seconds] [-S seed] [-o corpus.log]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "can_drv.h"
+#include "e2e.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Generator state
+ */
+typedef struct {
+    FILE* out;
+    uint32_t seed;              /* Burst content PRNG (xorshift32) */
+    uint64_t frames;            /* Frames written */
+} Corpus_t;
+
+/* Private define ------------------------------------------------------------*/
+#define CORPUS_DEFAULT_SECONDS  60
+#define CORPUS_DEFAULT_SEED     0x1D2C3B4AU
+#define CORPUS_EPOCH_S          1754006400ULL   /* Fixed candump start time */
+#define CORPUS_PHASE_US         130     /* Offset between periodic streams */
+#define CORPUS_BURST_PERIOD_MS  1000
+#define CORPUS_BURST_OFFSET_MS  500
+#define CORPUS_BURST_FRAMES     24      /* More frames than one RX class queue holds */
+#define CORPUS_BURST_GAP_US     240     /* 8-byte frame at 500 kbit/s, back to back */
+#define CORPUS_E2E_BAD_CRC      997     /* Every Nth brake frame has a wrong CRC */
+#define CORPUS_E2E_REPEAT       1499    /* Every Nth brake frame repeats its counter */
+#define CORPUS_MUX_UNKNOWN_MS   5000    /* Period of an unconfigured selector value */
+
+#define CORPUS_ID_BRAKE         0x104
+#define CORPUS_ID_UNROUTED      0x105   /* Passes the range filter, rejected by bitmap */
+#define CORPUS_ID_FOREIGN       0x555   /* Discarded by the hardware filters */
+#define CORPUS_ID_CAN2_SRC      0x200   /* Forwarded to CAN1 */
+#define CORPUS_ID_EEC1          (0x0CF00400U | CAN_ID_EXT)
+#define CORPUS_ID_CCVS          (0x18FEF100U | CAN_ID_EXT)
+
+/* Private macro -------------------------------------------------------------*/
+#define CORPUS_DUE(t_ms, period)    (((t_ms) % (period)) == 0)
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t burst_ids[] = {
+    CAN_FILTER_ID_ENGINE, CAN_FILTER_ID_TEMP, CAN_FILTER_ID_SPEED, 0x103, CORPUS_ID_UNROUTED
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void Corpus_Generate(Corpus_t* corpus, uint32_t seconds);
+static void Corpus_Emit(Corpus_t* corpus, uint64_t time_us, uint8_t bus, uint32_t id,
+                        const uint8_t* data, uint8_t dlc);
+static uint32_t Corpus_Random(Corpus_t* corpus);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Corpus generator entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if successful, 1 on usage or file errors
+ */
+int main(int argc, char** argv)
+{
+    Corpus_t corpus = { .out = stdout, .seed = CORPUS_DEFAULT_SEED, .frames = 0 };
+    uint32_t seconds = CORPUS_DEFAULT_SECONDS;
+    const char* out_path = NULL;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "d:S:o:")) != -1) {
+        switch (opt) {
+            case 'd':
+                seconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'S':
+                corpus.seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                out_path = optarg;
+                break;
+            default:
+                seconds = 0;
+                break;
+        }
+    }
+    
+    if (seconds == 0 || corpus.seed == 0 || optind != argc) {
+        fprintf(stderr, "usage: %s [-d seconds] [-S seed] [-o corpus.log]\n"
+                        "  -d    traffic duration (default %u)\n"
+                        "  -S    non-zero seed of the burst content\n"
+                        "  -o    output file (default stdout)\n",
+                argv[0], CORPUS_DEFAULT_SECONDS);
+        return 1;
+    }
+    
+    if (out_path != NULL && (corpus.out = fopen(out_path, "w")) == NULL) {
+        fprintf(stderr, "can_corpus: cannot create %s\n", out_path);
+        return 1;
+    }
+    
+    E2E_Init(NULL);
+    Corpus_Generate(&corpus, seconds);
+    
+    if (corpus.out != stdout) {
+        fclose(corpus.out);
+    }
+    fprintf(stderr, "CORPUS,Seconds:%u,Frames:%llu\n", seconds, (unsigned long long)corpus.frames);
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Write the whole corpus in time order
+ * @param  corpus: Generator state
+ * @param  seconds: Traffic duration
+ * @retval None
+ */
+static void Corpus_Generate(Corpus_t* corpus, uint32_t seconds)
+{
+    uint32_t brake_count = 0;
+    uint8_t counter = 0;
+    
+    for (uint32_t t = 0; t < seconds * 1000U; t++) {
+        uint64_t base_us = (uint64_t)t * 1000U;
+        uint8_t d[8] = { 0 };
+        
+        /* Engine RPM ramp, 0-8000 rpm */
+        if (CORPUS_DUE(t, 10)) {
+            uint16_t rpm = (uint16_t)((t * 4U) % 32000U);
+            uint8_t f[8] = { (uint8_t)rpm, (uint8_t)(rpm >> 8), 0, 0, 0, 0, 0, 0 };
+            Corpus_Emit(corpus, base_us, CAN_BUS_1, CAN_FILTER_ID_ENGINE, f, 8);
+        }
+        
+        /* Coolant temperature ramp, -40..+119 C */
+        if (CORPUS_DUE(t, 100)) {
+            d[2] = (uint8_t)((t / 100U) % 160U);
+            Corpus_Emit(corpus, base_us + CORPUS_PHASE_US, CAN_BUS_1, CAN_FILTER_ID_TEMP, d, 8);
+        }
+        
+        /* Vehicle speed ramp, 0-250 km/h */
+        if (CORPUS_DUE(t, 20)) {
+            uint16_t speed = (uint16_t)(((t / 20U) * 5U) % 2500U);
+            uint8_t f[8] = { 0, 0, 0, 0, (uint8_t)speed, (uint8_t)(speed >> 8), 0, 0 };
+            Corpus_Emit(corpus, base_us + 2 * CORPUS_PHASE_US, CAN_BUS_1, CAN_FILTER_ID_SPEED, f, 8);
+        }
+        
+        /* Multiplexed engine data: selectors 0 and 1, now and then an unknown one */
+        if (CORPUS_DUE(t, 50)) {
+            uint16_t value = (uint16_t)((t / 50U) % 4000U);
+            uint8_t selector = CORPUS_DUE(t, CORPUS_MUX_UNKNOWN_MS) ? 7 : (uint8_t)((t / 50U) % 2U);
+            uint8_t f[8] = { selector, (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value % 200U), 0, 0, 0, 0 };
+            Corpus_Emit(corpus, base_us + 3 * CORPUS_PHASE_US, CAN_BUS_1, 0x103, f, 8);
+        }
+        
+        /* E2E protected brake pressure with injected faults */
+        if (CORPUS_DUE(t, 10)) {
+            uint16_t pressure = (uint16_t)((t / 10U) % 2000U);
+            uint8_t f[8] = { 0, 0, (uint8_t)pressure, (uint8_t)(pressure >> 8), 0, 0, 0, 0 };
+            
+            brake_count++;
+            if (brake_count % CORPUS_E2E_REPEAT != 0) {
+                counter = (counter + 1) & 0x0F;
+            }
+            f[1] = counter;
+            f[0] = E2E_ComputeCrcSoftware(f, CORPUS_ID_BRAKE);
+            if (brake_count % CORPUS_E2E_BAD_CRC == 0) {
+                f[0] ^= 0x5A;
+            }
+            Corpus_Emit(corpus, base_us + 4 * CORPUS_PHASE_US, CAN_BUS_1, CORPUS_ID_BRAKE, f, 8);
+        }
+        
+        /* Body bus frame forwarded to CAN1 */
+        if (CORPUS_DUE(t, 20)) {
+            d[0] = (uint8_t)(t / 20U);
+            Corpus_Emit(corpus, base_us + 5 * CORPUS_PHASE_US, CAN_BUS_2, CORPUS_ID_CAN2_SRC, d, 4);
+        }
+        
+        /* J1939 engine speed and vehicle speed */
+        if (CORPUS_DUE(t, 10)) {
+            uint16_t rpm = (uint16_t)((t * 2U) % 64000U);
+            uint8_t f[8] = { 0xF0, 0x7D, 0x7D, (uint8_t)rpm, (uint8_t)(rpm >> 8), 0x00, 0xF0, 0x7D };
+            Corpus_Emit(corpus, base_us + 6 * CORPUS_PHASE_US, CAN_BUS_1, CORPUS_ID_EEC1, f, 8);
+        }
+        if (CORPUS_DUE(t, 100)) {
+            uint16_t speed = (uint16_t)(((t / 100U) * 64U) % 64000U);
+            uint8_t f[8] = { 0xFF, (uint8_t)speed, (uint8_t)(speed >> 8), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+            Corpus_Emit(corpus, base_us + 7 * CORPUS_PHASE_US, CAN_BUS_1, CORPUS_ID_CCVS, f, 8);
+        }
+        
+        /* Traffic the gateway must not route */
+        if (CORPUS_DUE(t, 50)) {
+            Corpus_Emit(corpus, base_us + 8 * CORPUS_PHASE_US, CAN_BUS_1, CORPUS_ID_UNROUTED, d, 8);
+        }
+        if (CORPUS_DUE(t, 100)) {
+            Corpus_Emit(corpus, base_us + 9 * CORPUS_PHASE_US, CAN_BUS_1, CORPUS_ID_FOREIGN, d, 8);
+        }
+        
+        /* Diagnostic tester: TesterPresent */
+        if (CORPUS_DUE(t, 2000)) {
+            uint8_t f[8] = { 0x02, 0x3E, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55 };
+            Corpus_Emit(corpus, base_us + 10 * CORPUS_PHASE_US, CAN_BUS_1, CAN_FILTER_ID_DIAG_REQ, f, 8);
+        }
+        
+        /* Recorded-style burst: back-to-back frames of random routed IDs,
+           after this millisecond's periodic frames */
+        if (t % CORPUS_BURST_PERIOD_MS == CORPUS_BURST_OFFSET_MS) {
+            uint64_t burst_us = base_us + 11 * CORPUS_PHASE_US;
+            
+            for (uint32_t i = 0; i < CORPUS_BURST_FRAMES; i++) {
+                uint32_t r = Corpus_Random(corpus);
+                uint32_t id = burst_ids[r % (sizeof(burst_ids) / sizeof(burst_ids[0]))];
+                uint8_t f[8];
+                
+                for (uint8_t k = 0; k < 8; k++) {
+                    f[k] = (uint8_t)(Corpus_Random(corpus) >> 24);
+                }
+                if (id == 0x103) {
+                    f[0] &= 0x01;       /* Known selector values only */
+                }
+                Corpus_Emit(corpus, burst_us + i * CORPUS_BURST_GAP_US, CAN_BUS_1, id, f, 8);
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Write one frame as a candump -l line
+ * @param  corpus: Generator state
+ * @param  time_us: Time since the start of the corpus
+ * @param  bus: 0 = can0 (CAN1), 1 = can1 (CAN2)
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  data: Data bytes
+ * @param  dlc: Data length code (0-8)
+ * @retval None
+ */
+static void Corpus_Emit(Corpus_t* corpus, uint64_t time_us, uint8_t bus, uint32_t id,
+                        const uint8_t* data, uint8_t dlc)
+{
+    if (id & CAN_ID_EXT) {
+        fprintf(corpus->out, "(%llu.%06llu) can%u %08lX#", CORPUS_EPOCH_S + time_us / 1000000U,
+                (unsigned long long)(time_us % 1000000U), bus, (unsigned long)(id & CAN_ID_EXT_MASK));
+    } else {
+        fprintf(corpus->out, "(%llu.%06llu) can%u %03lX#", CORPUS_EPOCH_S + time_us / 1000000U,
+                (unsigned long long)(time_us % 1000000U), bus, (unsigned long)id);
+    }
+    for (uint8_t i = 0; i < dlc; i++) {
+        fprintf(corpus->out, "%02X", data[i]);
+    }
+    fputc('\n', corpus->out);
+    corpus->frames++;
+}
+
+/**
+ * @brief  Next value of the burst PRNG (xorshift32, never 0)
+ * @param  corpus: Generator state
+ * @retval Pseudo-random value
+ */
+static uint32_t Corpus_Random(Corpus_t* corpus)
+{
+    uint32_t x = corpus->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    corpus->seed = x;
+    return x;
+}
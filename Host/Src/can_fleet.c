@@ -0,0 +1,599 @@
+/**
+ ******************************************************************************
+ * @file    can_fleet.c
+ * @brief   Replay many CAN logs in parallel, one gateway per log
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Every log runs in its own forked process: a fresh copy of the
+ *          gateway's module state that no other log can disturb, with
+ *          results independent of the order and the worker a log ran on.
+ *          Processes rather than threads: only the router is an instance
+ *          (Router_t); the default CAN and UART channels, J1939, UDS, the
+ *          CAN gateway and the simulated peripherals are module globals.
+ *          Up to -j processes run at once (default: all online cores);
+ *          the next log, largest files first, goes to whichever slot
+ *          frees up, so long logs do not leave cores idle at the end.
+ *          Results come back through a shared mapping. The memory of a
+ *          log's gateway context is the growth of the process's anonymous
+ *          resident set from the fork to the end of the replay: the binary,
+ *          libc and the file-backed log mapping are not anonymous, and what
+ *          the process inherited is counted in both samples.
+ *
+ *          The replay loop is that of can_replay.c at -s 0: frames raise
+ *          RX interrupts per virtual millisecond, the main loop runs
+ *          once, USART3 sends its share of bytes at -b baud. The UART
+ *          output is not stored but hashed (FNV-1a), so two runs can be
+ *          compared log by log.
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/can_fleet.c Host/Src/can_log.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o can_fleet
+ *
+ *          Usage: can_fleet [-j jobs] [-m event|snapshot] [-b baud]
+ *                           [-l list] [log ...]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "host_ecu.h"
+#include "can_log.h"
+#include "can_drv.h"
+#include "pdu_router.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Fleet options
+ */
+typedef struct {
+    uint32_t jobs;              /* Logs replayed at once */
+    RouterOutputMode_t mode;    /* Router UART output mode */
+    uint32_t uart_baud;         /* Simulated line rate (0 = unlimited) */
+    const char* list_path;      /* File with one log path per line, "-" = stdin */
+} FleetOptions_t;
+
+/**
+ * @brief Outcome of one log
+ */
+typedef enum {
+    FLEET_STATUS_PENDING = 0,   /* Not run (or the process died before reporting) */
+    FLEET_STATUS_OK,
+    FLEET_STATUS_OPEN_FAILED,   /* Log could not be mapped */
+    FLEET_STATUS_INIT_FAILED    /* Gateway failed to initialize */
+} FleetStatus_t;
+
+/**
+ * @brief Per-log results, written by the replaying process
+ */
+typedef struct {
+    FleetStatus_t status;
+    uint64_t frames_read;       /* Data frames in the log */
+    uint64_t frames_accepted;   /* Frames passed by the hardware filters */
+    uint32_t lines_skipped;     /* Non-frame lines */
+    CanRxStats_t rx;
+    RouterStats_t router;
+    uint64_t uart_bytes;
+    uint64_t uart_hash;         /* FNV-1a of the UART output */
+    uint32_t virtual_ms;
+    uint64_t wall_ns;           /* Replay only, without fork and mapping */
+    uint64_t cpu_ns;            /* Process CPU time, filled in by the parent from wait4() */
+    long peak_rss_kb;           /* Whole process, filled in by the parent from wait4() */
+    long context_kb;            /* Anonymous memory added by the replay, -1 if unknown */
+    int exit_signal;            /* Signal that ended the process, 0 if none */
+} FleetResult_t;
+
+/**
+ * @brief Log to replay
+ */
+typedef struct {
+    const char* path;
+    off_t size;
+    uint32_t index;             /* Position in the report */
+} FleetLog_t;
+
+/* Private define ------------------------------------------------------------*/
+#define FLEET_UART_BITS_PER_BYTE    10      /* 8N1 */
+#define FLEET_UART_CHUNK            4096    /* Bytes per USART3 service call */
+#define FLEET_DRAIN_MAX_MS          60000   /* Cap on the UART drain after the last frame */
+#define FLEET_FNV_OFFSET            0xCBF29CE484222325ULL
+#define FLEET_FNV_PRIME             0x100000001B3ULL
+#define FLEET_PATH_LENGTH           4096
+#define FLEET_STATUS_LINE           256     /* Line buffer for /proc/self/status */
+#define FLEET_EXIT_FAILED           1       /* Exit status: usage error or a log failed */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t uart_chunk[FLEET_UART_CHUNK];
+
+/* Private function prototypes -----------------------------------------------*/
+static bool Fleet_ParseOptions(int argc, char** argv, FleetOptions_t* options);
+static bool Fleet_ReadList(const char* path, FleetLog_t** logs, uint32_t* count, uint32_t* capacity);
+static bool Fleet_AddLog(const char* path, FleetLog_t** logs, uint32_t* count, uint32_t* capacity);
+static int Fleet_CompareSize(const void* a, const void* b);
+static void Fleet_Replay(const FleetOptions_t* options, const char* path, FleetResult_t* result);
+static uint64_t Fleet_ServiceUart(uint64_t* credit, uint32_t baud, uint64_t* hash);
+static long Fleet_ReadRssAnonKb(void);
+static void Fleet_Report(const FleetLog_t* logs, uint32_t count, const FleetResult_t* results,
+                         const FleetOptions_t* options, uint64_t elapsed_ns);
+static void Fleet_Usage(const char* name);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Fleet replay entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if every log replayed, 1 on usage errors or failed logs
+ */
+int main(int argc, char** argv)
+{
+    FleetOptions_t options;
+    FleetLog_t* logs = NULL;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    struct rusage usage;
+    
+    if (!Fleet_ParseOptions(argc, argv, &options)) {
+        Fleet_Usage(argv[0]);
+        return FLEET_EXIT_FAILED;
+    }
+    
+    for (int i = optind; i < argc; i++) {
+        if (!Fleet_AddLog(argv[i], &logs, &count, &capacity)) return FLEET_EXIT_FAILED;
+    }
+    if (options.list_path != NULL && !Fleet_ReadList(options.list_path, &logs, &count, &capacity)) {
+        return FLEET_EXIT_FAILED;
+    }
+    if (count == 0) {
+        Fleet_Usage(argv[0]);
+        return FLEET_EXIT_FAILED;
+    }
+    
+    /* Results are written by the children, so the mapping is shared */
+    FleetResult_t* results = mmap(NULL, count * sizeof(FleetResult_t), PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        fprintf(stderr, "can_fleet: cannot map results for %lu logs\n", (unsigned long)count);
+        return FLEET_EXIT_FAILED;
+    }
+    memset(results, 0, count * sizeof(FleetResult_t));
+    
+    /* Longest first: the last logs to start are the shortest */
+    qsort(logs, count, sizeof(logs[0]), Fleet_CompareSize);
+    
+    fflush(NULL);
+    
+    uint64_t start_ns = HostPort_GetTimeNs();
+    uint32_t next = 0;
+    uint32_t running = 0;
+    pid_t* slots = calloc(count, sizeof(pid_t));
+    
+    while (next < count || running > 0) {
+        while (next < count && running < options.jobs) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                Fleet_Replay(&options, logs[next].path, &results[logs[next].index]);
+                _exit(0);
+            }
+            if (pid < 0) {
+                fprintf(stderr, "can_fleet: fork failed\n");
+                if (running == 0) return FLEET_EXIT_FAILED;
+                break;
+            }
+            slots[next] = pid;
+            next++;
+            running++;
+        }
+        
+        int status;
+        pid_t pid = wait4(-1, &status, 0, &usage);
+        if (pid < 0) break;
+        running--;
+        
+        for (uint32_t i = 0; i < next; i++) {
+            if (slots[i] == pid) {
+                FleetResult_t* result = &results[logs[i].index];
+                result->cpu_ns = (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL +
+                                 (uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+                result->peak_rss_kb = usage.ru_maxrss;
+                result->exit_signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+                slots[i] = 0;
+                break;
+            }
+        }
+    }
+    
+    uint64_t elapsed_ns = HostPort_GetTimeNs() - start_ns;
+    
+    /* Report in command line / list order */
+    FleetLog_t* ordered = calloc(count, sizeof(FleetLog_t));
+    for (uint32_t i = 0; i < count; i++) {
+        ordered[logs[i].index] = logs[i];
+    }
+    Fleet_Report(ordered, count, results, &options, elapsed_ns);
+    
+    int exit_status = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (results[i].status != FLEET_STATUS_OK || results[i].exit_signal != 0) {
+            exit_status = FLEET_EXIT_FAILED;
+        }
+    }
+    
+    free(ordered);
+    free(slots);
+    munmap(results, count * sizeof(FleetResult_t));
+    for (uint32_t i = 0; i < count; i++) {
+        free((void*)logs[i].path);
+    }
+    free(logs);
+    
+    return exit_status;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Parse command line
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @param  options: Parsed options
+ * @retval true if valid
+ */
+static bool Fleet_ParseOptions(int argc, char** argv, FleetOptions_t* options)
+{
+    int opt;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    options->jobs = (cores > 0) ? (uint32_t)cores : 1;
+    options->mode = ROUTER_OUTPUT_EVENT;
+    options->uart_baud = HOST_ECU_UART_BAUDRATE;
+    options->list_path = NULL;
+    
+    while ((opt = getopt(argc, argv, "j:m:b:l:")) != -1) {
+        switch (opt) {
+            case 'j':
+                options->jobs = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->jobs == 0) return false;
+                break;
+            case 'm':
+                if (strcmp(optarg, "event") == 0) {
+                    options->mode = ROUTER_OUTPUT_EVENT;
+                } else if (strcmp(optarg, "snapshot") == 0) {
+                    options->mode = ROUTER_OUTPUT_SNAPSHOT;
+                } else {
+                    return false;
+                }
+                break;
+            case 'b':
+                options->uart_baud = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                options->list_path = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Add the logs named in a list file (blank lines and '#' skipped)
+ * @param  path: List file, "-" for stdin
+ * @param  logs: Log array (grown as needed)
+ * @param  count: Logs in the array
+ * @param  capacity: Allocated entries
+ * @retval true if successful
+ */
+static bool Fleet_ReadList(const char* path, FleetLog_t** logs, uint32_t* count, uint32_t* capacity)
+{
+    char line[FLEET_PATH_LENGTH];
+    FILE* file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    bool ok = true;
+    
+    if (file == NULL) {
+        fprintf(stderr, "can_fleet: cannot open %s\n", path);
+        return false;
+    }
+    
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        ok = Fleet_AddLog(line, logs, count, capacity);
+    }
+    
+    if (file != stdin) {
+        fclose(file);
+    }
+    return ok;
+}
+
+/**
+ * @brief  Append a log with its file size (0 if it cannot be read; the
+ *         replay reports the error)
+ * @param  path: Log file
+ * @param  logs: Log array (grown as needed)
+ * @param  count: Logs in the array
+ * @param  capacity: Allocated entries
+ * @retval true if successful, false if out of memory
+ */
+static bool Fleet_AddLog(const char* path, FleetLog_t** logs, uint32_t* count, uint32_t* capacity)
+{
+    struct stat st;
+    
+    if (*count == *capacity) {
+        uint32_t grown = (*capacity > 0) ? *capacity * 2 : 64;
+        FleetLog_t* larger = realloc(*logs, grown * sizeof(FleetLog_t));
+        if (larger == NULL) {
+            fprintf(stderr, "can_fleet: out of memory\n");
+            return false;
+        }
+        *logs = larger;
+        *capacity = grown;
+    }
+    
+    FleetLog_t* log = &(*logs)[*count];
+    log->path = strdup(path);
+    log->size = (stat(path, &st) == 0) ? st.st_size : 0;
+    log->index = *count;
+    if (log->path == NULL) return false;
+    (*count)++;
+    
+    return true;
+}
+
+/**
+ * @brief  qsort() order of logs: larger files first
+ * @param  a: Log
+ * @param  b: Log
+ * @retval Negative, zero or positive
+ */
+static int Fleet_CompareSize(const void* a, const void* b)
+{
+    const FleetLog_t* x = a;
+    const FleetLog_t* y = b;
+    
+    if (x->size != y->size) return (x->size > y->size) ? -1 : 1;
+    return (x->index < y->index) ? -1 : 1;
+}
+
+/**
+ * @brief  Replay one log in this process (child side)
+ * @param  options: Fleet options
+ * @param  path: Log file
+ * @param  result: Shared result slot of the log
+ * @retval None
+ */
+static void Fleet_Replay(const FleetOptions_t* options, const char* path, FleetResult_t* result)
+{
+    CanLog_t log;
+    CanLogFrame_t frame;
+    uint64_t uart_credit = 0;
+    uint64_t hash = FLEET_FNV_OFFSET;
+    uint32_t tick = 0;
+    uint32_t drain_ms = 0;
+    long rss_anon_kb = Fleet_ReadRssAnonKb();     /* Inherited from the parent */
+    
+    result->context_kb = -1;
+    if (!CanLog_Open(&log, path)) {
+        result->status = FLEET_STATUS_OPEN_FAILED;
+        return;
+    }
+    if (!HostEcu_Init(options->mode)) {
+        result->status = FLEET_STATUS_INIT_FAILED;
+        CanLog_Close(&log);
+        return;
+    }
+    
+    uint64_t start_ns = HostPort_GetTimeNs();
+    bool pending = CanLog_Next(&log, &frame);
+    result->uart_bytes += Fleet_ServiceUart(&uart_credit, 0, &hash);     /* Startup banner */
+    
+    while (pending || drain_ms < FLEET_DRAIN_MAX_MS) {
+        /* Bus side: frames recorded during this millisecond */
+        while (pending && frame.time_us / 1000U <= tick) {
+            result->frames_read++;
+            if (HostPort_CanDeliver(frame.bus, frame.id, frame.dlc, frame.data)) {
+                result->frames_accepted++;
+            }
+            pending = CanLog_Next(&log, &frame);
+        }
+        
+        HostEcu_Poll();
+        
+        uint64_t sent = Fleet_ServiceUart(&uart_credit, options->uart_baud, &hash);
+        result->uart_bytes += sent;
+        if (!pending) {
+            if (sent == 0 && !(USART3->CR1 & USART_CR1_TXEIE)) break;
+            drain_ms++;
+        }
+        
+        tick++;
+        HostPort_SetTick(tick);
+    }
+    
+    result->wall_ns = HostPort_GetTimeNs() - start_ns;
+    result->virtual_ms = tick;
+    result->uart_hash = hash;
+    result->lines_skipped = log.lines_skipped;
+    CAN_GetRxStats(&result->rx);
+    Router_GetStatistics(&result->router);
+    result->status = FLEET_STATUS_OK;
+    
+    /* Gateway statics are never freed, so the final sample holds the peak */
+    long rss_anon_end_kb = Fleet_ReadRssAnonKb();
+    if (rss_anon_kb >= 0 && rss_anon_end_kb >= rss_anon_kb) {
+        result->context_kb = rss_anon_end_kb - rss_anon_kb;
+    }
+    
+    CanLog_Close(&log);
+}
+
+/**
+ * @brief  Shift out the bytes USART3 can send in one millisecond
+ * @param  credit: Accumulated line time in bit-milliseconds
+ * @param  baud: Line rate (0 = send everything)
+ * @param  hash: Running FNV-1a hash of the output
+ * @retval Bytes sent
+ */
+static uint64_t Fleet_ServiceUart(uint64_t* credit, uint32_t baud, uint64_t* hash)
+{
+    uint64_t budget = UINT64_MAX;
+    uint64_t total = 0;
+    
+    if (baud > 0) {
+        *credit += baud;
+        budget = *credit / (FLEET_UART_BITS_PER_BYTE * 1000U);
+    }
+    
+    while (total < budget) {
+        uint64_t want = budget - total;
+        uint32_t sent = HostPort_UartTransmit(uart_chunk, (want < FLEET_UART_CHUNK) ? (uint32_t)want : FLEET_UART_CHUNK);
+        if (sent == 0) break;
+        for (uint32_t i = 0; i < sent; i++) {
+            *hash = (*hash ^ uart_chunk[i]) * FLEET_FNV_PRIME;
+        }
+        total += sent;
+    }
+    
+    if (baud > 0) {
+        /* An idle line does not bank time for later bursts */
+        *credit = (total < budget) ? 0 : *credit - total * FLEET_UART_BITS_PER_BYTE * 1000U;
+    }
+    
+    return total;
+}
+
+/**
+ * @brief  Read the anonymous resident set of this process
+ * @note   Linux only (RssAnon in /proc/self/status)
+ * @param  None
+ * @retval Kilobytes, -1 if not available
+ */
+static long Fleet_ReadRssAnonKb(void)
+{
+    char line[FLEET_STATUS_LINE];
+    long kb = -1;
+    FILE* file = fopen("/proc/self/status", "r");
+    
+    if (file == NULL) return -1;
+    
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "RssAnon: %ld kB", &kb) == 1) break;
+    }
+    fclose(file);
+    
+    return kb;
+}
+
+/**
+ * @brief  Print per-log results and the fleet totals, one record per line
+ * @param  logs: Logs in report order
+ * @param  count: Number of logs
+ * @param  results: Results indexed by report position
+ * @param  options: Fleet options
+ * @param  elapsed_ns: Host time from the first fork to the last exit
+ * @retval None
+ */
+static void Fleet_Report(const FleetLog_t* logs, uint32_t count, const FleetResult_t* results,
+                         const FleetOptions_t* options, uint64_t elapsed_ns)
+{
+    static const char* const status_names[] = { "crashed", "ok", "open-failed", "init-failed" };
+    uint64_t frames = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t rss_sum = 0;
+    long rss_max = 0;
+    uint64_t context_sum = 0;
+    long context_max = -1;
+    uint32_t context_count = 0;
+    uint32_t failed = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const FleetResult_t* result = &results[i];
+        bool ok = (result->status == FLEET_STATUS_OK && result->exit_signal == 0);
+        
+        if (!ok) {
+            failed++;
+            printf("LOG,%s,Status:%s,Signal:%d,PeakRssKb:%ld\n", logs[i].path,
+                   (result->exit_signal != 0) ? "crashed" : status_names[result->status],
+                   result->exit_signal, result->peak_rss_kb);
+            continue;
+        }
+        
+        frames += result->frames_read;
+        cpu_ns += result->cpu_ns;
+        rss_sum += (uint64_t)result->peak_rss_kb;
+        if (result->peak_rss_kb > rss_max) {
+            rss_max = result->peak_rss_kb;
+        }
+        if (result->context_kb >= 0) {
+            context_sum += (uint64_t)result->context_kb;
+            context_count++;
+            if (result->context_kb > context_max) {
+                context_max = result->context_kb;
+            }
+        }
+        
+        printf("LOG,%s,Status:ok,Frames:%llu,Accepted:%llu,Skipped:%lu,RxDropped:%lu,Coalesced:%lu,"
+               "Routed:%lu,RouterDropped:%lu,UartErr:%lu,UartBytes:%llu,UartHash:%016llx,"
+               "VirtualMs:%lu,WallMs:%.1f,CpuMs:%.1f,ContextKb:%ld,PeakRssKb:%ld\n",
+               logs[i].path, (unsigned long long)result->frames_read,
+               (unsigned long long)result->frames_accepted, (unsigned long)result->lines_skipped,
+               (unsigned long)result->rx.frames_dropped, (unsigned long)result->rx.frames_coalesced,
+               (unsigned long)result->router.frames_routed, (unsigned long)result->router.frames_dropped,
+               (unsigned long)result->router.uart_errors, (unsigned long long)result->uart_bytes,
+               (unsigned long long)result->uart_hash, (unsigned long)result->virtual_ms,
+               (double)result->wall_ns / 1e6, (double)result->cpu_ns / 1e6, result->context_kb,
+               result->peak_rss_kb);
+    }
+    
+    double elapsed_s = (double)elapsed_ns / 1e9;
+    uint32_t passed = count - failed;
+    
+    printf("FLEET,Logs:%lu,Failed:%lu,Jobs:%lu,Frames:%llu,WallMs:%.1f,CpuMs:%.1f,Parallelism:%.2f,"
+           "FramesPerSec:%.0f,AvgContextKb:%.0f,MaxContextKb:%ld,AvgPeakRssKb:%.0f,MaxPeakRssKb:%ld\n",
+           (unsigned long)count, (unsigned long)failed, (unsigned long)options->jobs,
+           (unsigned long long)frames, elapsed_s * 1000.0, (double)cpu_ns / 1e6,
+           (elapsed_ns > 0) ? (double)cpu_ns / (double)elapsed_ns : 0.0,
+           (elapsed_s > 0.0) ? (double)frames / elapsed_s : 0.0,
+           (context_count > 0) ? (double)context_sum / (double)context_count : -1.0, context_max,
+           (passed > 0) ? (double)rss_sum / (double)passed : 0.0, rss_max);
+}
+
+/**
+ * @brief  Print command line help
+ * @param  name: Program name
+ * @retval None
+ */
+static void Fleet_Usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [-j jobs] [-m event|snapshot] [-b baud] [-l list] [log ...]\n"
+            "  log   candump -l or Vector ASC file, one gateway per log\n"
+            "  -j    logs replayed at once (default: online cores)\n"
+            "  -m    router output mode (default event)\n"
+            "  -b    simulated UART line rate in virtual time, 0 = unlimited (default %u)\n"
+            "  -l    file with one log path per line, - for stdin\n",
+            name, HOST_ECU_UART_BAUDRATE);
+}
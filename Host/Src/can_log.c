@@ -0,0 +1,430 @@
+/**
+ ******************************************************************************
+ * @file    can_log.c
+ * @brief   Recorded CAN traffic reader (candump / Vector ASC)
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    The file is memory-mapped and parsed line by line in place, so
+ *          multi-gigabyte logs stream without copying or allocation. Only
+ *          classic data frames on two buses are returned; CAN FD, remote
+ *          and error frames and every other line are counted as skipped.
+ *          Formats:
+ *          - candump -l:  (1436509052.249713) can0 123#DEADBEEF
+ *            The first two interface names become CAN1 and CAN2; IDs with
+ *            more than three digits are 29-bit.
+ *          - Vector ASC:  0.001234 1  18FEF100x  Rx   d 8 01 02 ...
+ *            Channels 1 and 2 are CAN1 and CAN2, an "x" suffix marks a
+ *            29-bit ID. "base dec" and "timestamps relative" headers are
+ *            honoured.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_log.h"
+#include "can_drv.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define CAN_LOG_STD_ID_DIGITS   3       /* candump: longer IDs are 29-bit */
+#define CAN_LOG_US_DIGITS       6       /* Fraction digits kept from timestamps */
+
+/* Private macro -------------------------------------------------------------*/
+#define IS_SPACE(c)             ((c) == ' ' || (c) == '\t' || (c) == '\r')
+#define IS_DIGIT(c)             ((c) >= '0' && (c) <= '9')
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static bool CanLog_ParseCandump(CanLog_t* log, const char* p, const char* e, CanLogFrame_t* frame);
+static bool CanLog_ParseAsc(CanLog_t* log, const char* p, const char* e, CanLogFrame_t* frame);
+static void CanLog_ParseAscHeader(CanLog_t* log, const char* p, const char* e);
+static bool CanLog_ParseTime(const char** p, const char* e, uint64_t* time_us);
+static bool CanLog_ParseNumber(const char** p, const char* e, uint32_t base, uint32_t* value, uint8_t* digits);
+static const char* CanLog_SkipSpaces(const char* p, const char* e);
+static bool CanLog_StartsWith(const char* p, const char* e, const char* word);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Open and map a log file, detecting its format
+ * @param  log: Log state to initialize
+ * @param  path: File name
+ * @retval true if successful, false if the file cannot be mapped
+ */
+bool CanLog_Open(CanLog_t* log, const char* path)
+{
+    struct stat st;
+    
+    if (log == NULL || path == NULL) return false;
+    memset(log, 0, sizeof(*log));
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    
+    log->base = (const char*)map;
+    log->size = (size_t)st.st_size;
+    log->pos = log->base;
+    log->end = log->base + log->size;
+    
+    /* candump lines start with the parenthesised timestamp */
+    const char* first = CanLog_SkipSpaces(log->base, log->end);
+    log->format = (first < log->end && *first == '(') ? CAN_LOG_FORMAT_CANDUMP : CAN_LOG_FORMAT_ASC;
+    
+    return true;
+}
+
+/**
+ * @brief  Read next data frame
+ * @param  log: Open log
+ * @param  frame: Filled with the frame
+ * @retval true if a frame was read, false at end of file
+ */
+bool CanLog_Next(CanLog_t* log, CanLogFrame_t* frame)
+{
+    if (log == NULL || frame == NULL || log->base == NULL) return false;
+    
+    while (log->pos < log->end) {
+        const char* line = log->pos;
+        const char* eol = memchr(line, '\n', (size_t)(log->end - line));
+        if (eol == NULL) eol = log->end;
+        log->pos = (eol < log->end) ? eol + 1 : log->end;
+        
+        bool ok = (log->format == CAN_LOG_FORMAT_CANDUMP) ? CanLog_ParseCandump(log, line, eol, frame)
+                                                          : CanLog_ParseAsc(log, line, eol, frame);
+        if (ok) return true;
+        
+        if (CanLog_SkipSpaces(line, eol) < eol) {
+            log->lines_skipped++;
+        }
+    }
+    
+    return false;
+}
+
+/**
+ * @brief  Restart reading at the first line (mapping and format are kept)
+ * @param  log: Open log
+ * @retval None
+ */
+void CanLog_Rewind(CanLog_t* log)
+{
+    if (log == NULL || log->base == NULL) return;
+    
+    CanLog_t open = *log;
+    
+    memset(log, 0, sizeof(*log));
+    log->base = open.base;
+    log->size = open.size;
+    log->pos = open.base;
+    log->end = open.end;
+    log->format = open.format;
+}
+
+/**
+ * @brief  Unmap log file
+ * @param  log: Open log
+ * @retval None
+ */
+void CanLog_Close(CanLog_t* log)
+{
+    if (log == NULL || log->base == NULL) return;
+    
+    munmap((void*)log->base, log->size);
+    log->base = NULL;
+    log->pos = NULL;
+    log->end = NULL;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Parse one candump -l line
+ * @param  log: Log state (interface mapping, time origin)
+ * @param  p: Start of line
+ * @param  e: End of line
+ * @param  frame: Filled with the frame
+ * @retval true if the line is a classic data frame on a mapped interface
+ */
+static bool CanLog_ParseCandump(CanLog_t* log, const char* p, const char* e, CanLogFrame_t* frame)
+{
+    uint64_t time_us;
+    uint32_t id;
+    uint8_t digits;
+    
+    p = CanLog_SkipSpaces(p, e);
+    if (p >= e || *p != '(') return false;
+    p++;
+    if (!CanLog_ParseTime(&p, e, &time_us) || p >= e || *p != ')') return false;
+    p = CanLog_SkipSpaces(p + 1, e);
+    
+    /* Interface name -> controller, in order of appearance */
+    const char* name = p;
+    while (p < e && !IS_SPACE(*p)) p++;
+    size_t name_len = (size_t)(p - name);
+    if (name_len == 0 || name_len >= sizeof(log->interfaces[0])) return false;
+    
+    uint8_t bus = 0;
+    while (bus < log->interface_count &&
+           (strncmp(log->interfaces[bus], name, name_len) != 0 || log->interfaces[bus][name_len] != '\0')) {
+        bus++;
+    }
+    if (bus == log->interface_count) {
+        if (log->interface_count >= 2) return false;
+        memcpy(log->interfaces[bus], name, name_len);
+        log->interfaces[bus][name_len] = '\0';
+        log->interface_count++;
+    }
+    
+    /* Identifier: 3 digits standard, 8 digits extended (error flag excluded) */
+    p = CanLog_SkipSpaces(p, e);
+    if (!CanLog_ParseNumber(&p, e, 16, &id, &digits) || p >= e || *p != '#') return false;
+    p++;
+    if (digits > CAN_LOG_STD_ID_DIGITS) {
+        if (id > CAN_ID_EXT_MASK) return false;
+        id |= CAN_ID_EXT;
+    } else if (id > CAN_ID_STD_MASK) {
+        return false;
+    }
+    
+    /* "##" is CAN FD, "R" a remote frame */
+    if (p < e && (*p == '#' || *p == 'R')) return false;
+    
+    uint8_t dlc = 0;
+    while (dlc < 8 && p + 1 < e && !IS_SPACE(*p) && *p != '_') {
+        uint32_t byte;
+        const char* q = p;
+        const char* byte_end = p + 2;
+        if (!CanLog_ParseNumber(&q, byte_end, 16, &byte, &digits) || digits != 2) return false;
+        frame->data[dlc++] = (uint8_t)byte;
+        p = byte_end;
+    }
+    
+    if (!log->time_valid) {
+        log->time_origin_us = time_us;
+        log->time_valid = true;
+    }
+    frame->time_us = (time_us >= log->time_origin_us) ? time_us - log->time_origin_us : 0;
+    frame->id = id;
+    frame->bus = bus;
+    frame->dlc = dlc;
+    
+    return true;
+}
+
+/**
+ * @brief  Parse one Vector ASC line
+ * @param  log: Log state (number base, time mode, time origin)
+ * @param  p: Start of line
+ * @param  e: End of line
+ * @param  frame: Filled with the frame
+ * @retval true if the line is a classic data frame on channel 1 or 2
+ */
+static bool CanLog_ParseAsc(CanLog_t* log, const char* p, const char* e, CanLogFrame_t* frame)
+{
+    uint32_t base = log->asc_decimal ? 10 : 16;
+    uint64_t time_us;
+    uint32_t channel;
+    uint32_t id;
+    uint32_t dlc;
+    uint8_t digits;
+    
+    p = CanLog_SkipSpaces(p, e);
+    if (p >= e) return false;
+    if (!IS_DIGIT(*p)) {
+        CanLog_ParseAscHeader(log, p, e);
+        return false;
+    }
+    
+    if (!CanLog_ParseTime(&p, e, &time_us)) return false;
+    if (log->asc_relative) {
+        time_us += log->time_last_us;
+        log->time_last_us = time_us;
+    }
+    
+    /* Channel; "CANFD", "ErrorFrame", "Start of measurement"... fail here */
+    p = CanLog_SkipSpaces(p, e);
+    if (!CanLog_ParseNumber(&p, e, 10, &channel, &digits) || channel < 1 || channel > 2) return false;
+    
+    p = CanLog_SkipSpaces(p, e);
+    if (!CanLog_ParseNumber(&p, e, base, &id, &digits)) return false;
+    if (p < e && *p == 'x') {
+        if (id > CAN_ID_EXT_MASK) return false;
+        id |= CAN_ID_EXT;
+        p++;
+    } else if (id > CAN_ID_STD_MASK) {
+        return false;
+    }
+    
+    /* Direction (Rx/Tx), then "d" for data ("r" remote) */
+    p = CanLog_SkipSpaces(p, e);
+    if (!CanLog_StartsWith(p, e, "Rx") && !CanLog_StartsWith(p, e, "Tx")) return false;
+    p = CanLog_SkipSpaces(p + 2, e);
+    if (p >= e || *p != 'd') return false;
+    p = CanLog_SkipSpaces(p + 1, e);
+    
+    if (!CanLog_ParseNumber(&p, e, 16, &dlc, &digits) || dlc > 8) return false;
+    for (uint32_t i = 0; i < dlc; i++) {
+        uint32_t byte;
+        p = CanLog_SkipSpaces(p, e);
+        if (!CanLog_ParseNumber(&p, e, base, &byte, &digits) || byte > 0xFF) return false;
+        frame->data[i] = (uint8_t)byte;
+    }
+    
+    if (!log->time_valid) {
+        log->time_origin_us = time_us;
+        log->time_valid = true;
+    }
+    frame->time_us = (time_us >= log->time_origin_us) ? time_us - log->time_origin_us : 0;
+    frame->id = id;
+    frame->bus = (uint8_t)(channel - 1);
+    frame->dlc = (uint8_t)dlc;
+    
+    return true;
+}
+
+/**
+ * @brief  Pick up ASC header settings ("base dec", "timestamps relative")
+ * @param  log: Log state
+ * @param  p: First non-blank character of the line
+ * @param  e: End of line
+ * @retval None
+ */
+static void CanLog_ParseAscHeader(CanLog_t* log, const char* p, const char* e)
+{
+    if (CanLog_StartsWith(p, e, "base ")) {
+        p = CanLog_SkipSpaces(p + 5, e);
+        log->asc_decimal = CanLog_StartsWith(p, e, "dec");
+        p += 3;
+        p = CanLog_SkipSpaces(p, e);
+        if (CanLog_StartsWith(p, e, "timestamps ")) {
+            p = CanLog_SkipSpaces(p + 11, e);
+            log->asc_relative = CanLog_StartsWith(p, e, "relative");
+        }
+    }
+}
+
+/**
+ * @brief  Parse "seconds[.fraction]" into microseconds
+ * @param  p: Cursor, advanced past the number
+ * @param  e: End of line
+ * @param  time_us: Parsed time
+ * @retval true if at least one digit was found
+ */
+static bool CanLog_ParseTime(const char** p, const char* e, uint64_t* time_us)
+{
+    const char* s = *p;
+    uint64_t seconds = 0;
+    uint64_t fraction = 0;
+    uint8_t fraction_digits = 0;
+    
+    if (s >= e || !IS_DIGIT(*s)) return false;
+    while (s < e && IS_DIGIT(*s)) {
+        seconds = seconds * 10 + (uint64_t)(*s++ - '0');
+    }
+    
+    if (s < e && *s == '.') {
+        s++;
+        while (s < e && IS_DIGIT(*s)) {
+            if (fraction_digits < CAN_LOG_US_DIGITS) {
+                fraction = fraction * 10 + (uint64_t)(*s - '0');
+                fraction_digits++;
+            }
+            s++;
+        }
+    }
+    while (fraction_digits < CAN_LOG_US_DIGITS) {
+        fraction *= 10;
+        fraction_digits++;
+    }
+    
+    *time_us = seconds * 1000000U + fraction;
+    *p = s;
+    
+    return true;
+}
+
+/**
+ * @brief  Parse an unsigned number
+ * @param  p: Cursor, advanced past the digits
+ * @param  e: End of input
+ * @param  base: 10 or 16
+ * @param  value: Parsed value
+ * @param  digits: Number of digits read
+ * @retval true if at least one digit was found and the value fits 32 bits
+ */
+static bool CanLog_ParseNumber(const char** p, const char* e, uint32_t base, uint32_t* value, uint8_t* digits)
+{
+    const char* s = *p;
+    uint64_t v = 0;
+    uint8_t n = 0;
+    
+    while (s < e) {
+        char c = *s;
+        uint32_t d;
+        
+        if (IS_DIGIT(c)) {
+            d = (uint32_t)(c - '0');
+        } else if (base == 16 && c >= 'a' && c <= 'f') {
+            d = (uint32_t)(c - 'a' + 10);
+        } else if (base == 16 && c >= 'A' && c <= 'F') {
+            d = (uint32_t)(c - 'A' + 10);
+        } else {
+            break;
+        }
+        
+        v = v * base + d;
+        if (v > 0xFFFFFFFFU) return false;
+        n++;
+        s++;
+    }
+    
+    if (n == 0) return false;
+    
+    *value = (uint32_t)v;
+    *digits = n;
+    *p = s;
+    
+    return true;
+}
+
+/**
+ * @brief  Skip blanks
+ * @param  p: Cursor
+ * @param  e: End of line
+ * @retval First non-blank character, or e
+ */
+static const char* CanLog_SkipSpaces(const char* p, const char* e)
+{
+    while (p < e && IS_SPACE(*p)) p++;
+    return p;
+}
+
+/**
+ * @brief  Check for a keyword at the cursor
+ * @param  p: Cursor
+ * @param  e: End of line
+ * @param  word: Keyword
+ * @retval true if the line continues with word
+ */
+static bool CanLog_StartsWith(const char* p, const char* e, const char* word)
+{
+    size_t len = strlen(word);
+    return (size_t)(e - p) >= len && memcmp(p, word, len) == 0;
+}
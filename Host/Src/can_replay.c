@@ -0,0 +1,618 @@
+/**
+ ******************************************************************************
+ * @file    can_replay.c
+ * @brief   Replay recorded CAN logs through the Gateway ECU on the host
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Feeds candump -l or Vector ASC logs into the gateway's RX path:
+ *          every frame passes the bxCAN filter model and the CAN RX
+ *          interrupt handler, then the main loop body (router, UDS, J1939)
+ *          runs once per virtual millisecond and USART3 shifts out bytes
+ *          at the configured line rate. Virtual time drives HAL_GetTick();
+ *          with -s 0 it advances as fast as the host can compute, with
+ *          -s 1 at recorded timing, with -s N N times faster.
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/can_replay.c Host/Src/can_log.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o can_replay
+ *
+ *          Regression gate: -g compares the UART output byte for byte
+ *          with a golden capture, -G compares its length and FNV-1a hash
+ *          with a hash file; Host/Ref/corpus.hash holds the one of the
+ *          reference corpus. -B compares the host time per log frame with
+ *          a stored baseline: the log is replayed once untimed, then -r
+ *          times, and the fastest run counts. A cost beyond -t percent is
+ *          reported; it fails the gate only with -F, since the host time
+ *          depends on the machine and its load. -R records the files from
+ *          the current build instead. Exit status 2 means the gate failed.
+ *          The reference corpus comes from can_corpus.c:
+ *            can_corpus -o corpus.log
+ *            can_replay -G Host/Ref/corpus.hash corpus.log
+ *            can_replay -R -B corpus.baseline -r 11 corpus.log
+ *            can_replay -B corpus.baseline -r 11 corpus.log
+ *
+ *          Usage: can_replay [-s speed] [-m event|snapshot] [-b baud]
+ *                            [-o uart.out] [-g golden] [-G hash]
+ *                            [-B baseline] [-t percent] [-r runs] [-F]
+ *                            [-R] log
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "host_ecu.h"
+#include "can_log.h"
+#include "can_drv.h"
+#include "pdu_router.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Replay options
+ */
+typedef struct {
+    double speed;               /* 0 = as fast as possible, 1 = recorded timing */
+    RouterOutputMode_t mode;    /* Router UART output mode */
+    uint32_t uart_baud;         /* Simulated line rate (0 = unlimited) */
+    const char* out_path;       /* UART capture file, "-" = stdout, NULL = none */
+    const char* log_path;       /* Recorded traffic */
+    const char* golden_path;    /* Expected UART output, NULL = not checked */
+    const char* hash_path;      /* Expected UART output length and hash, NULL = not checked */
+    const char* baseline_path;  /* Stored cost per frame, NULL = not checked */
+    double threshold_pct;       /* Allowed cost increase over the baseline */
+    uint32_t runs;              /* Timed replays of the log; the fastest is reported */
+    bool enforce_cost;          /* A cost beyond the threshold fails the gate */
+    bool record;                /* Write golden output and baseline instead of checking */
+} ReplayOptions_t;
+
+/**
+ * @brief Replay results
+ */
+typedef struct {
+    uint64_t frames_read;       /* Data frames in the log */
+    uint64_t frames_accepted;   /* Frames passed by the hardware filters */
+    uint64_t uart_bytes;        /* Bytes shifted out of USART3 */
+    uint32_t virtual_ms;        /* Virtual time at the end of the replay */
+    uint64_t wall_ns;           /* Host time spent */
+} ReplayResult_t;
+
+/* Private define ------------------------------------------------------------*/
+#define REPLAY_UART_BITS_PER_BYTE   10      /* 8N1 */
+#define REPLAY_UART_CHUNK           4096    /* Bytes per USART3 service call */
+#define REPLAY_DRAIN_MAX_MS         60000   /* Cap on the UART drain after the last frame */
+#define REPLAY_NS_PER_MS            1000000ULL
+#define REPLAY_THRESHOLD_PCT        10.0    /* Default allowed cost regression */
+#define REPLAY_EXIT_GATE            2       /* Exit status: output or cost gate failed */
+#define REPLAY_FNV_OFFSET           0xCBF29CE484222325ULL
+#define REPLAY_FNV_PRIME            0x00000100000001B3ULL
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t uart_chunk[REPLAY_UART_CHUNK];
+
+/* Private function prototypes -----------------------------------------------*/
+static bool Replay_ParseOptions(int argc, char** argv, ReplayOptions_t* options);
+static bool Replay_Run(const ReplayOptions_t* options, CanLog_t* log, FILE* out, ReplayResult_t* result);
+static uint64_t Replay_ServiceUart(uint64_t* credit, uint32_t baud, FILE* out);
+static void Replay_Report(const ReplayResult_t* result, const CanLog_t* log);
+static bool Replay_CheckGolden(const ReplayOptions_t* options, const char* output, size_t size);
+static bool Replay_CheckHash(const ReplayOptions_t* options, const char* output, size_t size);
+static bool Replay_CheckBaseline(const ReplayOptions_t* options, const ReplayResult_t* result, uint64_t median_ns);
+static int Replay_CompareTime(const void* a, const void* b);
+static void Replay_Usage(const char* name);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Replay tool entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if successful, 1 on usage or file errors, 2 if the gate failed
+ */
+int main(int argc, char** argv)
+{
+    ReplayOptions_t options;
+    ReplayResult_t result;
+    ReplayResult_t best = { 0 };
+    CanLog_t log;
+    uint64_t* wall_ns = NULL;
+    FILE* out = NULL;
+    FILE* capture = NULL;
+    char* output = NULL;
+    size_t output_size = 0;
+    bool ok = true;
+    
+    if (!Replay_ParseOptions(argc, argv, &options)) {
+        Replay_Usage(argv[0]);
+        return 1;
+    }
+    
+    if (!CanLog_Open(&log, options.log_path)) {
+        fprintf(stderr, "can_replay: cannot map %s\n", options.log_path);
+        return 1;
+    }
+    
+    if (options.out_path != NULL) {
+        out = (strcmp(options.out_path, "-") == 0) ? stdout : fopen(options.out_path, "wb");
+        if (out == NULL) {
+            fprintf(stderr, "can_replay: cannot create %s\n", options.out_path);
+            CanLog_Close(&log);
+            return 1;
+        }
+    }
+    
+    /* Output checks need the output in memory */
+    if (options.golden_path != NULL || options.hash_path != NULL) {
+        capture = open_memstream(&output, &output_size);
+        if (capture == NULL) ok = false;
+    }
+    
+    /* The output is deterministic: capture the first run. With a baseline
+       it is a warm-up (caches, page faults of the log) and is not timed. */
+    uint32_t warmup = (options.baseline_path != NULL) ? 1 : 0;
+    wall_ns = malloc(options.runs * sizeof(*wall_ns));
+    if (wall_ns == NULL) ok = false;
+    
+    for (uint32_t run = 0; ok && run < warmup + options.runs; run++) {
+        if (run > 0) {
+            CanLog_Rewind(&log);
+        }
+        ok = Replay_Run(&options, &log, (run > 0) ? NULL : (capture != NULL) ? capture : out, &result);
+        if (run < warmup) continue;
+        
+        wall_ns[run - warmup] = result.wall_ns;
+        if (run == warmup || result.wall_ns < best.wall_ns) {
+            best = result;
+        }
+    }
+    
+    if (capture != NULL) {
+        fclose(capture);
+        if (out != NULL) {
+            fwrite(output, 1, output_size, out);
+        }
+    }
+    if (out != NULL && out != stdout) {
+        fclose(out);
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "can_replay: gateway initialization failed\n");
+        free(wall_ns);
+        free(output);
+        CanLog_Close(&log);
+        return 1;
+    }
+    
+    Replay_Report(&best, &log);
+    CanLog_Close(&log);
+    
+    int status = 0;
+    if (options.golden_path != NULL && !Replay_CheckGolden(&options, output, output_size)) {
+        status = REPLAY_EXIT_GATE;
+    }
+    if (options.hash_path != NULL && !Replay_CheckHash(&options, output, output_size)) {
+        status = REPLAY_EXIT_GATE;
+    }
+    if (options.baseline_path != NULL) {
+        qsort(wall_ns, options.runs, sizeof(*wall_ns), Replay_CompareTime);
+        if (!Replay_CheckBaseline(&options, &best, wall_ns[options.runs / 2])) {
+            status = REPLAY_EXIT_GATE;
+        }
+    }
+    free(wall_ns);
+    free(output);
+    
+    return status;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Parse command line
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @param  options: Parsed options
+ * @retval true if valid
+ */
+static bool Replay_ParseOptions(int argc, char** argv, ReplayOptions_t* options)
+{
+    int opt;
+    
+    options->speed = 0.0;
+    options->mode = ROUTER_OUTPUT_EVENT;
+    options->uart_baud = HOST_ECU_UART_BAUDRATE;
+    options->out_path = NULL;
+    options->log_path = NULL;
+    options->golden_path = NULL;
+    options->hash_path = NULL;
+    options->baseline_path = NULL;
+    options->threshold_pct = REPLAY_THRESHOLD_PCT;
+    options->runs = 1;
+    options->enforce_cost = false;
+    options->record = false;
+    
+    while ((opt = getopt(argc, argv, "s:m:b:o:g:G:B:t:r:FR")) != -1) {
+        switch (opt) {
+            case 's':
+                options->speed = atof(optarg);
+                if (options->speed < 0.0) return false;
+                break;
+            case 'm':
+                if (strcmp(optarg, "event") == 0) {
+                    options->mode = ROUTER_OUTPUT_EVENT;
+                } else if (strcmp(optarg, "snapshot") == 0) {
+                    options->mode = ROUTER_OUTPUT_SNAPSHOT;
+                } else {
+                    return false;
+                }
+                break;
+            case 'b':
+                options->uart_baud = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                options->out_path = optarg;
+                break;
+            case 'g':
+                options->golden_path = optarg;
+                break;
+            case 'G':
+                options->hash_path = optarg;
+                break;
+            case 'B':
+                options->baseline_path = optarg;
+                break;
+            case 't':
+                options->threshold_pct = atof(optarg);
+                if (options->threshold_pct < 0.0) return false;
+                break;
+            case 'r':
+                options->runs = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->runs == 0) return false;
+                break;
+            case 'F':
+                options->enforce_cost = true;
+                break;
+            case 'R':
+                options->record = true;
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    if (optind != argc - 1) return false;
+    options->log_path = argv[optind];
+    
+    return true;
+}
+
+/**
+ * @brief  Replay the whole log in virtual milliseconds
+ * @note   Per millisecond: frames stamped within it raise RX interrupts,
+ *         the main loop body runs once, USART3 sends its share of bytes.
+ *         After the last frame the loop continues until the UART is idle.
+ * @param  options: Replay options
+ * @param  log: Open log
+ * @param  out: UART capture (NULL to discard)
+ * @param  result: Replay results
+ * @retval true if successful, false if the gateway failed to initialize
+ */
+static bool Replay_Run(const ReplayOptions_t* options, CanLog_t* log, FILE* out, ReplayResult_t* result)
+{
+    CanLogFrame_t frame;
+    uint64_t uart_credit = 0;
+    uint32_t tick = 0;
+    uint32_t drain_ms = 0;
+    
+    memset(result, 0, sizeof(*result));
+    
+    if (!HostEcu_Init(options->mode)) return false;
+    
+    uint64_t start_ns = HostPort_GetTimeNs();
+    bool pending = CanLog_Next(log, &frame);
+    result->uart_bytes += Replay_ServiceUart(&uart_credit, 0, out);    /* Startup banner */
+    
+    while (pending || drain_ms < REPLAY_DRAIN_MAX_MS) {
+        /* Bus side: frames recorded during this millisecond */
+        while (pending && frame.time_us / 1000U <= tick) {
+            result->frames_read++;
+            if (HostPort_CanDeliver(frame.bus, frame.id, frame.dlc, frame.data)) {
+                result->frames_accepted++;
+            }
+            pending = CanLog_Next(log, &frame);
+        }
+        
+        HostEcu_Poll();
+        
+        uint64_t sent = Replay_ServiceUart(&uart_credit, options->uart_baud, out);
+        result->uart_bytes += sent;
+        if (!pending) {
+            if (sent == 0 && !(USART3->CR1 & USART_CR1_TXEIE)) break;
+            drain_ms++;
+        }
+        
+        tick++;
+        HostPort_SetTick(tick);
+        
+        /* Recorded (or scaled) timing: wait for wall clock to catch up */
+        if (options->speed > 0.0) {
+            uint64_t due_ns = start_ns + (uint64_t)((double)tick * REPLAY_NS_PER_MS / options->speed);
+            uint64_t now_ns = HostPort_GetTimeNs();
+            if (due_ns > now_ns) {
+                struct timespec delay = {
+                    .tv_sec = (time_t)((due_ns - now_ns) / 1000000000ULL),
+                    .tv_nsec = (long)((due_ns - now_ns) % 1000000000ULL)
+                };
+                nanosleep(&delay, NULL);
+            }
+        }
+    }
+    
+    result->virtual_ms = tick;
+    result->wall_ns = HostPort_GetTimeNs() - start_ns;
+    
+    return true;
+}
+
+/**
+ * @brief  Shift out the bytes USART3 can send in one millisecond
+ * @param  credit: Accumulated line time in bit-milliseconds
+ * @param  baud: Line rate (0 = send everything)
+ * @param  out: UART capture (NULL to discard)
+ * @retval Bytes sent
+ */
+static uint64_t Replay_ServiceUart(uint64_t* credit, uint32_t baud, FILE* out)
+{
+    uint64_t budget = UINT64_MAX;
+    uint64_t total = 0;
+    
+    if (baud > 0) {
+        *credit += baud;
+        budget = *credit / (REPLAY_UART_BITS_PER_BYTE * 1000U);
+    }
+    
+    while (total < budget) {
+        uint64_t want = budget - total;
+        uint32_t sent = HostPort_UartTransmit(uart_chunk, (want < REPLAY_UART_CHUNK) ? (uint32_t)want : REPLAY_UART_CHUNK);
+        if (sent == 0) break;
+        if (out != NULL) {
+            fwrite(uart_chunk, 1, sent, out);
+        }
+        total += sent;
+    }
+    
+    if (baud > 0) {
+        /* An idle line does not bank time for later bursts */
+        *credit = (total < budget) ? 0 : *credit - total * REPLAY_UART_BITS_PER_BYTE * 1000U;
+    }
+    
+    return total;
+}
+
+/**
+ * @brief  Print replay results, one record per line
+ * @param  result: Replay results
+ * @param  log: Replayed log
+ * @retval None
+ */
+static void Replay_Report(const ReplayResult_t* result, const CanLog_t* log)
+{
+    RouterStats_t router;
+    CanRxStats_t rx;
+    double wall_s = (double)result->wall_ns / 1e9;
+    double virtual_s = (double)result->virtual_ms / 1000.0;
+    
+    Router_GetStatistics(&router);
+    CAN_GetRxStats(&rx);
+    
+    printf("REPLAY,Format:%s,Frames:%llu,Accepted:%llu,Skipped:%lu\n",
+           (log->format == CAN_LOG_FORMAT_CANDUMP) ? "candump" : "asc",
+           (unsigned long long)result->frames_read, (unsigned long long)result->frames_accepted,
+           (unsigned long)log->lines_skipped);
+    printf("TIME,VirtualMs:%lu,WallMs:%.1f,Speedup:%.1f\n",
+           (unsigned long)result->virtual_ms, wall_s * 1000.0,
+           (wall_s > 0.0) ? virtual_s / wall_s : 0.0);
+    printf("CANRX,Rx:%lu,Rejected:%lu,Coalesced:%lu,Dropped:%lu\n",
+           (unsigned long)rx.frames_received, (unsigned long)rx.frames_rejected,
+           (unsigned long)rx.frames_coalesced, (unsigned long)rx.frames_dropped);
+    printf("ROUTER,Processed:%lu,Routed:%lu,Dropped:%lu,UARTErr:%lu,FramesPerSec:%.0f\n",
+           (unsigned long)router.frames_processed, (unsigned long)router.frames_routed,
+           (unsigned long)router.frames_dropped, (unsigned long)router.uart_errors,
+           (wall_s > 0.0) ? (double)router.frames_processed / wall_s : 0.0);
+    printf("UART,Bytes:%llu,BytesPerVirtualSec:%.0f\n",
+           (unsigned long long)result->uart_bytes,
+           (virtual_s > 0.0) ? (double)result->uart_bytes / virtual_s : 0.0);
+}
+
+/**
+ * @brief  Compare the UART output with the golden capture (or record it)
+ * @param  options: Replay options (golden_path, record)
+ * @param  output: UART output of the replay
+ * @param  size: Output size in bytes
+ * @retval true if identical or recorded, false on mismatch or file errors
+ */
+static bool Replay_CheckGolden(const ReplayOptions_t* options, const char* output, size_t size)
+{
+    FILE* file = fopen(options->golden_path, options->record ? "wb" : "rb");
+    
+    if (file == NULL) {
+        fprintf(stderr, "can_replay: cannot open %s\n", options->golden_path);
+        return false;
+    }
+    
+    if (options->record) {
+        bool written = (fwrite(output, 1, size, file) == size);
+        fclose(file);
+        printf("GOLDEN,Recorded:%s,Bytes:%zu\n", options->golden_path, size);
+        return written;
+    }
+    
+    /* Walk both in step; the first differing byte locates the regression */
+    size_t offset = 0;
+    int c;
+    while ((c = fgetc(file)) != EOF && offset < size && (char)c == output[offset]) {
+        offset++;
+    }
+    size_t expected = offset + ((c != EOF) ? 1 : 0);
+    while (fgetc(file) != EOF) {
+        expected++;
+    }
+    fclose(file);
+    
+    bool match = (c == EOF && offset == size);
+    if (match) {
+        printf("GOLDEN,Bytes:%zu,Expected:%zu,Match:1\n", size, expected);
+    } else {
+        printf("GOLDEN,Bytes:%zu,Expected:%zu,Match:0,FirstDiff:%zu\n", size, expected, offset);
+    }
+    
+    return match;
+}
+
+/**
+ * @brief  Compare the UART output length and hash with the hash file (or record it)
+ * @note   64-bit FNV-1a; small enough to keep under version control,
+ *         where the full capture of a corpus is not.
+ * @param  options: Replay options (hash_path, record)
+ * @param  output: UART output of the replay
+ * @param  size: Output size in bytes
+ * @retval true if identical or recorded, false on mismatch or file errors
+ */
+static bool Replay_CheckHash(const ReplayOptions_t* options, const char* output, size_t size)
+{
+    uint64_t hash = REPLAY_FNV_OFFSET;
+    unsigned long long expected_hash = 0;
+    size_t expected_size = 0;
+    
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t)output[i]) * REPLAY_FNV_PRIME;
+    }
+    
+    FILE* file = fopen(options->hash_path, options->record ? "w" : "r");
+    if (file == NULL) {
+        fprintf(stderr, "can_replay: cannot open %s\n", options->hash_path);
+        return false;
+    }
+    
+    if (options->record) {
+        fprintf(file, "GOLDENHASH,Bytes:%zu,FNV1a64:%016llx\n", size, (unsigned long long)hash);
+        fclose(file);
+        printf("GOLDEN,Recorded:%s,Bytes:%zu,Hash:%016llx\n", options->hash_path, size, (unsigned long long)hash);
+        return true;
+    }
+    
+    bool valid = (fscanf(file, "GOLDENHASH,Bytes:%zu,FNV1a64:%llx", &expected_size, &expected_hash) == 2);
+    fclose(file);
+    if (!valid) {
+        fprintf(stderr, "can_replay: no hash in %s\n", options->hash_path);
+        return false;
+    }
+    
+    bool match = (size == expected_size && hash == expected_hash);
+    printf("GOLDEN,Bytes:%zu,Expected:%zu,Hash:%016llx,ExpectedHash:%016llx,Match:%d\n",
+           size, expected_size, (unsigned long long)hash, expected_hash, match ? 1 : 0);
+    
+    return match;
+}
+
+/**
+ * @brief  Compare host time per log frame with the stored baseline (or record it)
+ * @note   The fastest run is compared; the median shows how noisy the
+ *         runs were. Beyond the threshold fails only with enforce_cost.
+ * @param  options: Replay options (baseline_path, threshold_pct, enforce_cost, record)
+ * @param  result: Fastest replay
+ * @param  median_ns: Median host time of the timed replays
+ * @retval true if within the threshold, not enforced or recorded, false otherwise
+ */
+static bool Replay_CheckBaseline(const ReplayOptions_t* options, const ReplayResult_t* result, uint64_t median_ns)
+{
+    double frames = (result->frames_read > 0) ? (double)result->frames_read : 1.0;
+    double ns_per_frame = (double)result->wall_ns / frames;
+    double median_per_frame = (double)median_ns / frames;
+    double baseline = 0.0;
+    FILE* file = fopen(options->baseline_path, options->record ? "w" : "r");
+    
+    if (file == NULL) {
+        fprintf(stderr, "can_replay: cannot open %s\n", options->baseline_path);
+        return false;
+    }
+    
+    if (options->record) {
+        fprintf(file, "BASELINE,NsPerFrame:%.2f\n", ns_per_frame);
+        fclose(file);
+        printf("GATE,Recorded:%s,NsPerFrame:%.2f,Median:%.2f,Runs:%lu\n", options->baseline_path, ns_per_frame,
+               median_per_frame, (unsigned long)options->runs);
+        return true;
+    }
+    
+    bool valid = (fscanf(file, "BASELINE,NsPerFrame:%lf", &baseline) == 1 && baseline > 0.0);
+    fclose(file);
+    if (!valid) {
+        fprintf(stderr, "can_replay: no baseline in %s\n", options->baseline_path);
+        return false;
+    }
+    
+    double limit = baseline * (1.0 + options->threshold_pct / 100.0);
+    bool pass = (ns_per_frame <= limit);
+    printf("GATE,NsPerFrame:%.2f,Median:%.2f,Runs:%lu,Baseline:%.2f,Limit:%.2f,Pass:%d,Enforced:%d\n",
+           ns_per_frame, median_per_frame, (unsigned long)options->runs, baseline, limit, pass ? 1 : 0,
+           options->enforce_cost ? 1 : 0);
+    
+    return pass || !options->enforce_cost;
+}
+
+/**
+ * @brief  qsort() order of host times
+ * @param  a: First time
+ * @param  b: Second time
+ * @retval <0, 0, >0 as a is shorter, equal, longer
+ */
+static int Replay_CompareTime(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  Print command line help
+ * @param  name: Program name
+ * @retval None
+ */
+static void Replay_Usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [-s speed] [-m event|snapshot] [-b baud] [-o uart.out]\n"
+            "          [-g golden] [-G hash] [-B baseline] [-t percent] [-r runs] [-F] [-R] log\n"
+            "  log   candump -l or Vector ASC file (CAN1/CAN2 = first two interfaces / channels 1-2)\n"
+            "  -s    0 = as fast as possible (default), 1 = recorded timing, N = N times faster\n"
+            "  -m    router output mode (default event)\n"
+            "  -b    simulated UART line rate in virtual time, 0 = unlimited (default %u)\n"
+            "  -o    write UART output to file, - for stdout\n"
+            "  -g    compare UART output with this golden capture\n"
+            "  -G    compare UART output length and hash with this hash file\n"
+            "  -B    compare host ns per log frame with this baseline (after one untimed run)\n"
+            "  -t    allowed increase over the baseline in percent (default %.0f)\n"
+            "  -r    timed replays of the log, the fastest is compared (default 1)\n"
+            "  -F    fail the gate on a cost increase (default: report only)\n"
+            "  -R    record golden capture, hash and baseline instead of checking\n",
+            name, HOST_ECU_UART_BAUDRATE, REPLAY_THRESHOLD_PCT);
+}
@@ -0,0 +1,309 @@
+/**
+ ******************************************************************************
+ * @file    can_trafgen.c
+ * @brief   Host run of the CAN traffic generator on a simulated bus
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Runs can_test_generator.c on the host CAN1 controller, attached
+ *          to a bus that is otherwise idle, in virtual bit time: the
+ *          controller sends its oldest mailbox request, the frame takes
+ *          its exact length on the wire (can_bus.c, stuff bits included),
+ *          and completing it raises the mailbox-empty interrupt that
+ *          refills the driver queue, as on the second STM32 board.
+ *          Reports the achieved bus load, frame rate, identifier mix and
+ *          DLC distribution of a profile; -o writes the traffic as a
+ *          candump -l log for can_replay and can_fleet, which feed it to
+ *          the gateway.
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/can_trafgen.c Host/Src/can_bus.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/can_test_generator.c Core/Src/cycle_monitor.c
+ *                Core/Src/e2e.c Core/Src/isotp.c Core/Src/j1939.c
+ *                Core/Src/pdu_router.c Core/Src/pdu_tx.c Core/Src/signal_store.c
+ *                Core/Src/uart_cmd.c Core/Src/uart_drv.c Core/Src/uds_server.c
+ *                -o can_trafgen
+ *
+ *          Usage: can_trafgen [-p profile] [-b bitrate] [-d seconds] [-S seed]
+ *                             [-o traffic.log]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_bus.h"
+#include "host_port.h"
+#include "can_drv.h"
+#include "can_test_generator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Frames sent per identifier
+ */
+typedef struct {
+    uint32_t id;
+    uint64_t frames;
+} TrafGenIdCount_t;
+
+/**
+ * @brief Simulation state and results
+ */
+typedef struct {
+    FILE* log;                  /* candump output, NULL = none */
+    uint32_t bitrate;
+    uint64_t now_bit;
+    uint64_t busy_bits;
+    uint64_t stuff_bits;
+    uint64_t frames;
+    uint64_t dlc_frames[9];
+} TrafGen_t;
+
+/* Private define ------------------------------------------------------------*/
+#define TRAFGEN_SECONDS         10
+#define TRAFGEN_MAX_IDS         16      /* Distinct identifiers counted */
+#define TRAFGEN_DEFAULT_SEED    0x2545F491U
+#define TRAFGEN_EPOCH_S         1754006400ULL   /* Fixed candump start time, as can_corpus */
+
+/* Private macro -------------------------------------------------------------*/
+#define TRAFGEN_BITS_TO_US(gen, bits)   ((bits) * 1000000ULL / (gen)->bitrate)
+
+/* Private variables ---------------------------------------------------------*/
+static TrafGenIdCount_t id_counts[TRAFGEN_MAX_IDS];
+static uint8_t id_count;
+
+/* Private function prototypes -----------------------------------------------*/
+static void TrafGen_Run(TrafGen_t* gen, uint32_t seconds);
+static void TrafGen_Record(TrafGen_t* gen, uint32_t id, uint8_t dlc, const uint8_t* data);
+static void TrafGen_Report(const TrafGen_t* gen, const TestGenProfile_t* profile);
+static void TrafGen_Usage(const char* name);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Traffic generator entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if successful, 1 on usage or file errors
+ */
+int main(int argc, char** argv)
+{
+    static TrafGen_t gen;
+    const TestGenProfile_t* profile = CANTestGenerator_FindProfile("nominal");
+    const char* log_path = NULL;
+    uint32_t seconds = TRAFGEN_SECONDS;
+    uint32_t seed = TRAFGEN_DEFAULT_SEED;
+    int opt;
+    
+    gen.bitrate = 500000U;
+    
+    while ((opt = getopt(argc, argv, "p:b:d:S:o:")) != -1) {
+        switch (opt) {
+            case 'p':
+                profile = CANTestGenerator_FindProfile(optarg);
+                break;
+            case 'b':
+                gen.bitrate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                seconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'S':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                log_path = optarg;
+                break;
+            default:
+                profile = NULL;
+                break;
+        }
+    }
+    
+    if (profile == NULL || !CanBus_IsValidBitrate(gen.bitrate) || seconds == 0 || seed == 0 || optind != argc) {
+        TrafGen_Usage(argv[0]);
+        return 1;
+    }
+    
+    if (log_path != NULL && (gen.log = fopen(log_path, "w")) == NULL) {
+        fprintf(stderr, "can_trafgen: cannot create %s\n", log_path);
+        return 1;
+    }
+    
+    HostPort_Init();
+    if (!CANTestGenerator_Init(CAN_BUS_1, gen.bitrate, profile, seed)) {
+        fprintf(stderr, "can_trafgen: generator initialization failed\n");
+        return 1;
+    }
+    HostPort_CanAttach(CAN_BUS_1, true);
+    
+    TrafGen_Run(&gen, seconds);
+    
+    if (gen.log != NULL) {
+        fclose(gen.log);
+    }
+    TrafGen_Report(&gen, profile);
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Send frames back to back until the simulated time is up
+ * @note   The main loop (CANTestGenerator_Run()) runs once per tick; the
+ *         bus idles to the next tick whenever no mailbox holds a request.
+ * @param  gen: Simulation state
+ * @param  seconds: Simulated time
+ * @retval None
+ */
+static void TrafGen_Run(TrafGen_t* gen, uint32_t seconds)
+{
+    uint64_t end_bit = (uint64_t)seconds * gen->bitrate;
+    uint32_t tick = 0;
+    
+    HostPort_SetTick(tick);
+    
+    while (gen->now_bit < end_bit) {
+        uint32_t now_ms = (uint32_t)(gen->now_bit * 1000U / gen->bitrate);
+        uint32_t id;
+        uint8_t dlc;
+        uint8_t data[8];
+        
+        while (tick < now_ms) {
+            HostPort_SetTick(++tick);
+            CANTestGenerator_Run();
+        }
+        
+        HostPort_CanRefillTx(CAN_BUS_1);
+        if (!HostPort_CanPeekTx(CAN_BUS_1, &id, &dlc, data)) {
+            gen->now_bit = ((uint64_t)(now_ms + 1) * gen->bitrate + 999U) / 1000U;
+            continue;
+        }
+        
+        CanBusFrameTiming_t timing;
+        CanBus_FrameTiming(id, dlc, data, &timing);
+        gen->now_bit += timing.bits;
+        gen->busy_bits += timing.bits;
+        gen->stuff_bits += timing.stuff_bits;
+        HostPort_CanCompleteTx(CAN_BUS_1);
+        
+        TrafGen_Record(gen, id, dlc, data);
+    }
+}
+
+/**
+ * @brief  Count a frame and write it to the log, stamped at its end of frame
+ * @param  gen: Simulation state
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code
+ * @param  data: Data bytes
+ * @retval None
+ */
+static void TrafGen_Record(TrafGen_t* gen, uint32_t id, uint8_t dlc, const uint8_t* data)
+{
+    uint8_t i;
+    
+    gen->frames++;
+    gen->dlc_frames[(dlc <= 8) ? dlc : 8]++;
+    
+    for (i = 0; i < id_count && id_counts[i].id != id; i++);
+    if (i == id_count && id_count < TRAFGEN_MAX_IDS) {
+        id_counts[id_count++].id = id;
+    }
+    if (i < id_count) {
+        id_counts[i].frames++;
+    }
+    
+    if (gen->log == NULL) return;
+    
+    uint64_t time_us = TRAFGEN_BITS_TO_US(gen, gen->now_bit);
+    if (id & CAN_ID_EXT) {
+        fprintf(gen->log, "(%llu.%06llu) can%u %08lX#", TRAFGEN_EPOCH_S + time_us / 1000000U,
+                (unsigned long long)(time_us % 1000000U), CAN_BUS_1, (unsigned long)(id & CAN_ID_EXT_MASK));
+    } else {
+        fprintf(gen->log, "(%llu.%06llu) can%u %03lX#", TRAFGEN_EPOCH_S + time_us / 1000000U,
+                (unsigned long long)(time_us % 1000000U), CAN_BUS_1, (unsigned long)id);
+    }
+    for (i = 0; i < dlc; i++) {
+        fprintf(gen->log, "%02X", data[i]);
+    }
+    fputc('\n', gen->log);
+}
+
+/**
+ * @brief  Print results, one record per line
+ * @param  gen: Simulation state
+ * @param  profile: Profile that was run
+ * @retval None
+ */
+static void TrafGen_Report(const TrafGen_t* gen, const TestGenProfile_t* profile)
+{
+    TestGenStats_t stats;
+    CanTxStats_t tx;
+    double seconds = (double)gen->now_bit / (double)gen->bitrate;
+    
+    CANTestGenerator_GetStats(&stats);
+    CAN_GetTxStats(CAN_BUS_1, &tx);
+    
+    printf("TRAFGEN,Profile:%s,Bitrate:%lu,SimMs:%.0f,Frames:%llu,FramesPerSec:%.0f,Load:%.2f%%,"
+           "Target:%u%%,Estimated:%.2f%%,StuffBits:%llu\n",
+           profile->name, (unsigned long)gen->bitrate, seconds * 1000.0, (unsigned long long)gen->frames,
+           (seconds > 0.0) ? (double)gen->frames / seconds : 0.0,
+           (gen->now_bit > 0) ? 100.0 * (double)gen->busy_bits / (double)gen->now_bit : 0.0,
+           profile->load_pct,
+           (gen->now_bit > 0) ? 100.0 * (double)stats.bits_sent / (double)gen->now_bit : 0.0,
+           (unsigned long long)gen->stuff_bits);
+    printf("GENERATOR,Sent:%lu,Burst:%lu,Rejected:%lu,Queued:%lu,QueueFull:%lu\n",
+           (unsigned long)stats.frames_sent, (unsigned long)stats.frames_burst,
+           (unsigned long)stats.tx_rejected, (unsigned long)tx.frames_queued, (unsigned long)tx.queue_full);
+    
+    for (uint8_t i = 0; i < id_count; i++) {
+        printf("ID,0x%lX%s,Frames:%llu,Share:%.1f%%\n",
+               (unsigned long)(id_counts[i].id & CAN_ID_EXT_MASK), (id_counts[i].id & CAN_ID_EXT) ? "x" : "",
+               (unsigned long long)id_counts[i].frames, 100.0 * (double)id_counts[i].frames / (double)gen->frames);
+    }
+    
+    printf("DLC");
+    for (uint8_t dlc = 0; dlc <= 8; dlc++) {
+        printf(",%u:%llu", dlc, (unsigned long long)gen->dlc_frames[dlc]);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief  Print command line help
+ * @param  name: Program name
+ * @retval None
+ */
+static void TrafGen_Usage(const char* name)
+{
+    const TestGenProfile_t* profile;
+    
+    fprintf(stderr,
+            "usage: %s [-p profile] [-b bitrate] [-d seconds] [-S seed] [-o traffic.log]\n"
+            "  -p  profile (default nominal):\n", name);
+    for (uint8_t i = 0; (profile = CANTestGenerator_GetProfile(i)) != NULL; i++) {
+        if (profile->burst_frames > 0) {
+            fprintf(stderr, "        %-10s %u%% load, %u-frame burst every %u ms\n",
+                    profile->name, profile->load_pct, profile->burst_frames, profile->burst_period_ms);
+        } else {
+            fprintf(stderr, "        %-10s %u%% load\n", profile->name, profile->load_pct);
+        }
+    }
+    fprintf(stderr,
+            "  -b  125000, 250000, 500000 (default) or 1000000\n"
+            "  -d  simulated seconds (default %u)\n"
+            "  -S  non-zero seed of the IDs, DLCs and payloads\n"
+            "  -o  write the traffic as a candump -l log\n",
+            TRAFGEN_SECONDS);
+}
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    gw_bench_main.c
+ * @brief   Host runner of the router and driver microbenchmarks
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Brings the gateway up like the target does and runs Bench_Run()
+ *          (Core/Src/gw_bench.c), printing the BENCH lines to stdout.
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -DGATEWAY_BENCH=1 -include Host/Inc/host_port.h
+ *                -IHost/Inc -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/gw_bench_main.c Core/Src/gw_bench.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o gw_bench
+ *
+ *          Usage: gw_bench [-n iterations]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "host_ecu.h"
+#include "gw_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_HOST_ITERATIONS   100000  /* Default operations per measurement */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static bool BenchMain_Print(const char* line);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Benchmark runner entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if successful, 1 on usage errors or failed initialization
+ */
+int main(int argc, char** argv)
+{
+    uint32_t iterations = BENCH_HOST_ITERATIONS;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt != 'n' || (iterations = (uint32_t)strtoul(optarg, NULL, 0)) == 0) {
+            fprintf(stderr, "usage: %s [-n iterations]  (default %u)\n", argv[0], BENCH_HOST_ITERATIONS);
+            return 1;
+        }
+    }
+    
+    if (!HostEcu_Init(ROUTER_OUTPUT_EVENT)) {
+        fprintf(stderr, "gw_bench: gateway initialization failed\n");
+        return 1;
+    }
+    
+    Bench_Run(iterations, BenchMain_Print);
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Result line sink (drops the UART line ending)
+ * @param  line: Result line
+ * @retval true
+ */
+static bool BenchMain_Print(const char* line)
+{
+    for (; *line != '\0'; line++) {
+        if (*line != '\r') {
+            putchar(*line);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ * @file    host_ecu.c
+ * @brief   Gateway ECU application bring-up for host builds
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Mirrors Gateway_Init() and the main loop of main.c without the
+ *          clock/GPIO setup and the statistics printout, so host tools
+ *          drive the same modules in the same order as the target.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_ecu.h"
+#include "host_port.h"
+#include "can_drv.h"
+#include "uart_drv.h"
+#include "uart_cmd.h"
+#include "can_gateway.h"
+#include "uds_server.h"
+#include "j1939.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t coalesced_ids[] = { CAN_FILTER_ID_ENGINE, CAN_FILTER_ID_TEMP, CAN_FILTER_ID_SPEED };
+static HostEcuFrameHook_t frame_hook = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Reset the host peripherals and initialize all gateway modules
+ * @param  mode: Router UART output mode
+ * @retval true if successful, false if a module failed to initialize
+ */
+bool HostEcu_Init(RouterOutputMode_t mode)
+{
+    HostPort_Init();
+    
+    if (!CAN_Init(HOST_ECU_CAN_BAUDRATE, CAN_MODE_NORMAL) ||
+        !CAN_InitBus(CAN_BUS_2, HOST_ECU_CAN_BAUDRATE, CAN_MODE_NORMAL)) {
+        return false;
+    }
+    if (!CAN_SetRxCoalescing(CAN_BUS_1, coalesced_ids, sizeof(coalesced_ids) / sizeof(coalesced_ids[0]))) {
+        return false;
+    }
+    if (!CanGateway_Init() || !J1939_Init() || !UART_Init(HOST_ECU_UART_BAUDRATE)) {
+        return false;
+    }
+    
+    UartCmd_Init();
+    Router_Init();
+    Router_SetOutputMode(mode, ROUTER_SNAPSHOT_PERIOD_MS);
+    Uds_Init();
+    
+    return true;
+}
+
+/**
+ * @brief  One pass of the gateway main loop
+ * @param  None
+ * @retval None
+ */
+void HostEcu_Poll(void)
+{
+    CanFrame_t frame;
+    
+    while (CAN_Receive(&frame)) {
+        if (frame.id & CAN_ID_EXT) {
+            J1939_ProcessCanFrame(&frame);
+        } else if (!Uds_ProcessCanFrame(&frame) && frame.bus == CAN_BUS_1) {
+            /* The signal table describes CAN1; CAN2 frames were forwarded by the gateway */
+            Router_ProcessCanFrame(&frame);
+        }
+        if (frame_hook != NULL) {
+            frame_hook(&frame);
+        }
+    }
+    
+    UartCmd_Process();
+    Router_Poll();
+    Uds_Poll();
+    J1939_Poll();
+}
+
+/**
+ * @brief  Install the function called after each frame the main loop handled
+ * @param  hook: Hook, NULL to remove
+ * @retval None
+ */
+void HostEcu_SetFrameHook(HostEcuFrameHook_t hook)
+{
+    frame_hook = hook;
+}
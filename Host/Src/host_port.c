@@ -0,0 +1,721 @@
+/**
+ ******************************************************************************
+ * @file    host_port.c
+ * @brief   Host (PC) port of the Gateway ECU peripherals
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Models just enough of the hardware for the Core modules:
+ *          - bxCAN: frames are matched against the filter banks the driver
+ *            programmed (scale, mode and priority rules of RM0090), placed
+ *            in FIFO 0 with their filter match index and the RX interrupt
+ *            handler is run. TX mailboxes are always empty: a frame loaded
+ *            into a mailbox counts as sent, unless the controller is
+ *            attached to a simulated bus (can_bus.c): then mailboxes stay
+ *            busy until the bus takes their frame, in request order.
+ *            HostPort_CanArrive() instead keeps up to three messages in
+ *            FIFO 0 (overrun beyond) until the host tool runs the handler.
+ *          - USART3: TX bytes are taken out of the data register by
+ *            running the TXE interrupt handler; the caller decides how
+ *            many bytes per call, i.e. the line rate. RX bytes are put in
+ *            the data register and the RXNE interrupt handler is run.
+ *          - SysTick: a virtual millisecond counter set by the host tool.
+ *          - PRIMASK and NVIC: plain variables; clearing PRIMASK calls an
+ *            optional hook, the preemption point of irq_sim.c.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "can_drv.h"
+#include "uart_drv.h"
+#include <string.h>
+#include <time.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Message waiting in a receive FIFO (RIR, RDTR, RDLR, RDHR)
+ */
+typedef struct {
+    uint32_t rir;
+    uint32_t rdtr;
+    uint32_t rdlr;
+    uint32_t rdhr;
+} HostCanRxMessage_t;
+
+/* Private define ------------------------------------------------------------*/
+#define HOST_CORE_CLOCK         168000000U  /* SYSCLK of the target */
+#define HOST_UART_DR_IDLE       0xFFFFFFFFU /* Not a byte: nothing written to DR */
+#define HOST_FILTER_RANK_NONE   -1
+#define HOST_TX_MAILBOXES       3
+#define HOST_TSR_EMPTY          (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+CAN_TypeDef host_can1;
+CAN_TypeDef host_can2;
+RCC_TypeDef host_rcc;
+DWT_Type host_dwt;
+USART_TypeDef host_usart3;
+CRC_TypeDef host_crc;
+
+uint32_t SystemCoreClock = HOST_CORE_CLOCK;
+
+static uint32_t host_tick = 0;
+static bool can_attached[HOST_CAN_BUS_COUNT];
+static uint32_t tx_order[HOST_CAN_BUS_COUNT][HOST_TX_MAILBOXES];    /* Request sequence, 0 = empty */
+static uint32_t tx_sequence = 0;
+static HostCanRxMessage_t rx_fifo[HOST_CAN_BUS_COUNT][HOST_CAN_RX_FIFO_DEPTH];
+static uint8_t rx_fifo_count[HOST_CAN_BUS_COUNT];
+static uint32_t host_primask = 0;
+static HostIrqHook_t irq_hook = NULL;
+static uint32_t nvic_group = 0;
+static uint8_t nvic_priority[HOST_NVIC_IRQ_COUNT];
+static bool nvic_enabled[HOST_NVIC_IRQ_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static int HostPort_MatchFilter(uint8_t bus, uint32_t rir);
+static int HostPort_OldestTx(uint8_t bus);
+static bool HostPort_EncodeRx(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data, HostCanRxMessage_t* message);
+static void HostPort_PresentRx(uint8_t bus);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Reset all modelled peripherals to their idle state
+ * @note   Call before any Core module is initialized. The PRIMASK hook
+ *         is kept.
+ * @param  None
+ * @retval None
+ */
+void HostPort_Init(void)
+{
+    memset(&host_can1, 0, sizeof(host_can1));
+    memset(&host_can2, 0, sizeof(host_can2));
+    memset(&host_rcc, 0, sizeof(host_rcc));
+    memset(&host_dwt, 0, sizeof(host_dwt));
+    memset(&host_usart3, 0, sizeof(host_usart3));
+    memset(&host_crc, 0, sizeof(host_crc));
+    
+    /* Controllers acknowledge initialization mode, all mailboxes empty */
+    host_can1.MSR = CAN_MSR_INAK;
+    host_can2.MSR = CAN_MSR_INAK;
+    host_can1.TSR = HOST_TSR_EMPTY;
+    host_can2.TSR = HOST_TSR_EMPTY;
+    memset(can_attached, 0, sizeof(can_attached));
+    memset(tx_order, 0, sizeof(tx_order));
+    memset(rx_fifo_count, 0, sizeof(rx_fifo_count));
+    
+    /* Out of reset: interrupts enabled globally, none enabled in the NVIC */
+    host_primask = 0;
+    nvic_group = 0;
+    memset(nvic_priority, 0, sizeof(nvic_priority));
+    memset(nvic_enabled, 0, sizeof(nvic_enabled));
+    
+    /* Transmitter idle */
+    host_usart3.SR = USART_SR_TC | USART_SR_TXE;
+    host_usart3.DR = HOST_UART_DR_IDLE;
+    
+    host_tick = 0;
+}
+
+/**
+ * @brief  Set virtual system tick
+ * @param  tick: Milliseconds since start
+ * @retval None
+ */
+void HostPort_SetTick(uint32_t tick)
+{
+    host_tick = tick;
+}
+
+/**
+ * @brief  Get virtual system tick
+ * @param  None
+ * @retval Milliseconds since start
+ */
+uint32_t HostPort_GetTick(void)
+{
+    return host_tick;
+}
+
+/**
+ * @brief  Monotonic host time, for benchmarks and pacing
+ * @param  None
+ * @retval Nanoseconds
+ */
+uint64_t HostPort_GetTimeNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  HAL time base of the host build
+ * @param  None
+ * @retval Virtual system tick (ms)
+ */
+uint32_t HAL_GetTick(void)
+{
+    return host_tick;
+}
+
+/**
+ * @brief  PRIMASK of the host build
+ * @param  None
+ * @retval 1 if interrupts are masked, 0 otherwise
+ */
+uint32_t HostPort_GetPrimask(void)
+{
+    return host_primask;
+}
+
+/**
+ * @brief  Set PRIMASK; a change runs the hook (masked windows, pending interrupts)
+ * @param  primask: 1 = mask interrupts, 0 = unmask
+ * @retval None
+ */
+void HostPort_SetPrimask(uint32_t primask)
+{
+    uint32_t previous = host_primask;
+    
+    host_primask = primask & 1U;
+    if (previous != host_primask && irq_hook != NULL) {
+        irq_hook(host_primask);
+    }
+}
+
+/**
+ * @brief  Install the function called when PRIMASK changes
+ * @param  hook: Hook, NULL to remove
+ * @retval None
+ */
+void HostPort_SetIrqHook(HostIrqHook_t hook)
+{
+    irq_hook = hook;
+}
+
+/**
+ * @brief  NVIC_SetPriorityGrouping() of the host build
+ * @param  group: Priority grouping field (AIRCR PRIGROUP, 0-7)
+ * @retval None
+ */
+void HostPort_NvicSetPriorityGrouping(uint32_t group)
+{
+    nvic_group = group & 7U;
+}
+
+/**
+ * @brief  NVIC_GetPriorityGrouping() of the host build
+ * @param  None
+ * @retval Priority grouping field
+ */
+uint32_t HostPort_NvicGetPriorityGrouping(void)
+{
+    return nvic_group;
+}
+
+/**
+ * @brief  NVIC_EnableIRQ() of the host build
+ * @param  irq: External interrupt number
+ * @retval None
+ */
+void HostPort_NvicEnableIRQ(IRQn_Type irq)
+{
+    if ((int)irq >= 0 && (int)irq < HOST_NVIC_IRQ_COUNT) {
+        nvic_enabled[irq] = true;
+    }
+}
+
+/**
+ * @brief  NVIC_GetEnableIRQ() of the host build
+ * @param  irq: External interrupt number
+ * @retval 1 if enabled, 0 otherwise
+ */
+uint32_t HostPort_NvicGetEnableIRQ(IRQn_Type irq)
+{
+    return ((int)irq >= 0 && (int)irq < HOST_NVIC_IRQ_COUNT && nvic_enabled[irq]) ? 1U : 0U;
+}
+
+/**
+ * @brief  NVIC_SetPriority() of the host build
+ * @param  irq: External interrupt number
+ * @param  priority: Priority (__NVIC_PRIO_BITS wide)
+ * @retval None
+ */
+void HostPort_NvicSetPriority(IRQn_Type irq, uint32_t priority)
+{
+    if ((int)irq >= 0 && (int)irq < HOST_NVIC_IRQ_COUNT) {
+        nvic_priority[irq] = (uint8_t)(priority & ((1U << __NVIC_PRIO_BITS) - 1U));
+    }
+}
+
+/**
+ * @brief  NVIC_GetPriority() of the host build
+ * @param  irq: External interrupt number
+ * @retval Priority (__NVIC_PRIO_BITS wide)
+ */
+uint32_t HostPort_NvicGetPriority(IRQn_Type irq)
+{
+    return ((int)irq >= 0 && (int)irq < HOST_NVIC_IRQ_COUNT) ? nvic_priority[irq] : 0U;
+}
+
+/**
+ * @brief  Put a frame on a controller's bus and run its RX interrupt
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code (0-8)
+ * @param  data: Data bytes (dlc bytes)
+ * @retval true if a filter accepted the frame, false if the hardware
+ *         filters discarded it
+ */
+bool HostPort_CanDeliver(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data)
+{
+    if (!HostPort_CanLoadFifo(bus, id, dlc, data)) return false;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    CAN_RxIRQHandler((CanBus_t)bus);
+    
+    /* Message released; forwarded frames left free mailboxes at once */
+    can->RF0R = 0;
+    if (!can_attached[0]) host_can1.TSR = HOST_TSR_EMPTY;
+    if (!can_attached[1]) host_can2.TSR = HOST_TSR_EMPTY;
+    
+    return true;
+}
+
+/**
+ * @brief  Filter a frame and place it in FIFO 0 without raising the interrupt
+ * @note   For callers that run CAN_RxIRQHandler() themselves (benchmarks).
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code (0-8)
+ * @param  data: Data bytes (dlc bytes)
+ * @retval true if a filter accepted the frame, false if the hardware
+ *         filters discarded it
+ */
+bool HostPort_CanLoadFifo(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data)
+{
+    HostCanRxMessage_t message;
+    
+    if (!HostPort_EncodeRx(bus, id, dlc, data, &message)) return false;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    can->sFIFOMailBox[0].RIR = message.rir;
+    can->sFIFOMailBox[0].RDTR = message.rdtr;
+    can->sFIFOMailBox[0].RDLR = message.rdlr;
+    can->sFIFOMailBox[0].RDHR = message.rdhr;
+    can->RF0R = 1U << CAN_RF0R_FMP0_Pos;   /* One message pending */
+    
+    return true;
+}
+
+/**
+ * @brief  Receive a frame into FIFO 0 behind the messages already waiting
+ * @note   The handler is not run: the host tool raises the interrupt when
+ *         it sees FMP0 with FMPIE0 set and calls HostPort_CanReleaseRx()
+ *         after it. A fourth message is lost and sets FOVR0.
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code (0-8)
+ * @param  data: Data bytes (dlc bytes)
+ * @retval HOST_CAN_RX_QUEUED, HOST_CAN_RX_OVERRUN, or HOST_CAN_RX_FILTERED
+ *         if the hardware filters discarded the frame
+ */
+HostCanRx_t HostPort_CanArrive(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data)
+{
+    HostCanRxMessage_t message;
+    
+    if (!HostPort_EncodeRx(bus, id, dlc, data, &message)) return HOST_CAN_RX_FILTERED;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    if (rx_fifo_count[bus] >= HOST_CAN_RX_FIFO_DEPTH) {
+        can->RF0R |= CAN_RF0R_FOVR0;
+        return HOST_CAN_RX_OVERRUN;
+    }
+    
+    rx_fifo[bus][rx_fifo_count[bus]++] = message;
+    HostPort_PresentRx(bus);
+    
+    return HOST_CAN_RX_QUEUED;
+}
+
+/**
+ * @brief  Complete a receive interrupt: drop the message the handler released
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @retval None
+ */
+void HostPort_CanReleaseRx(uint8_t bus)
+{
+    if (bus >= HOST_CAN_BUS_COUNT) return;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    
+    /* RFOM0 and FOVR0 are write-1 bits; here they stay set in RAM */
+    if ((can->RF0R & CAN_RF0R_RFOM0) && rx_fifo_count[bus] > 0) {
+        rx_fifo_count[bus]--;
+        memmove(&rx_fifo[bus][0], &rx_fifo[bus][1], rx_fifo_count[bus] * sizeof(rx_fifo[bus][0]));
+    }
+    can->RF0R &= ~(CAN_RF0R_RFOM0 | CAN_RF0R_FOVR0);
+    HostPort_PresentRx(bus);
+}
+
+/**
+ * @brief  Attach a controller to a simulated bus (or detach it)
+ * @note   Attached, the driver sees no empty mailbox outside
+ *         HostPort_CanRefillTx(), so every frame takes the software
+ *         queue and the TX interrupt, as when the mailboxes are busy.
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  attached: true = transmit through the simulated bus
+ * @retval None
+ */
+void HostPort_CanAttach(uint8_t bus, bool attached)
+{
+    if (bus >= HOST_CAN_BUS_COUNT) return;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    
+    can_attached[bus] = attached;
+    for (uint8_t mailbox = 0; mailbox < HOST_TX_MAILBOXES; mailbox++) {
+        can->sTxMailBox[mailbox].TIR &= ~CAN_TI0R_TXRQ;
+        tx_order[bus][mailbox] = 0;
+    }
+    can->TSR = attached ? 0 : HOST_TSR_EMPTY;
+}
+
+/**
+ * @brief  Run the TX interrupt for the empty mailboxes if the driver asks for it
+ * @note   Detached controllers send whatever the driver loads at once.
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @retval Number of mailboxes holding a transmit request
+ */
+uint8_t HostPort_CanRefillTx(uint8_t bus)
+{
+    if (bus >= HOST_CAN_BUS_COUNT) return 0;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    uint32_t empty = 0;
+    uint8_t pending = 0;
+    
+    for (uint8_t mailbox = 0; mailbox < HOST_TX_MAILBOXES; mailbox++) {
+        if (!can_attached[bus] || !(can->sTxMailBox[mailbox].TIR & CAN_TI0R_TXRQ)) {
+            empty |= CAN_TSR_TME0 << mailbox;
+        }
+    }
+    
+    if (empty != 0 && (can->IER & CAN_IER_TMEIE)) {
+        can->TSR = empty | ((uint32_t)(__builtin_ctz(empty) - CAN_TSR_TME0_Pos) << CAN_TSR_CODE_Pos);
+        CAN_TxIRQHandler((CanBus_t)bus);
+    }
+    
+    if (!can_attached[bus]) {
+        can->TSR = HOST_TSR_EMPTY;
+        return 0;
+    }
+    
+    /* Number new requests in the order the driver made them */
+    can->TSR = 0;
+    for (uint8_t mailbox = 0; mailbox < HOST_TX_MAILBOXES; mailbox++) {
+        if (can->sTxMailBox[mailbox].TIR & CAN_TI0R_TXRQ) {
+            if (tx_order[bus][mailbox] == 0) {
+                tx_order[bus][mailbox] = ++tx_sequence;
+            }
+            pending++;
+        }
+    }
+    
+    return pending;
+}
+
+/**
+ * @brief  Frame the controller transmits next (oldest request, TXFP order)
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code
+ * @param  data: 8 bytes, filled with the payload
+ * @retval true if a request is pending
+ */
+bool HostPort_CanPeekTx(uint8_t bus, uint32_t* id, uint8_t* dlc, uint8_t* data)
+{
+    int mailbox = HostPort_OldestTx(bus);
+    if (mailbox < 0) return false;
+    
+    CAN_TxMailBox_TypeDef* box = &((bus == 0) ? &host_can1 : &host_can2)->sTxMailBox[mailbox];
+    
+    if (box->TIR & CAN_TI0R_IDE) {
+        *id = ((box->TIR >> CAN_TI0R_EXID_Pos) & CAN_ID_EXT_MASK) | CAN_ID_EXT;
+    } else {
+        *id = (box->TIR >> CAN_TI0R_STID_Pos) & CAN_ID_STD_MASK;
+    }
+    *dlc = (uint8_t)(box->TDTR & CAN_TDT0R_DLC);
+    for (uint8_t i = 0; i < 8; i++) {
+        data[i] = (uint8_t)(((i < 4) ? box->TDLR : box->TDHR) >> ((i % 4) * 8));
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Release the mailbox of the oldest request (sent, or given up)
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @retval None
+ */
+void HostPort_CanCompleteTx(uint8_t bus)
+{
+    int mailbox = HostPort_OldestTx(bus);
+    if (mailbox < 0) return;
+    
+    ((bus == 0) ? &host_can1 : &host_can2)->sTxMailBox[mailbox].TIR &= ~CAN_TI0R_TXRQ;
+    tx_order[bus][mailbox] = 0;
+}
+
+/**
+ * @brief  State of the TX interrupt request of an attached controller
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @retval true if TMEIE is set and a mailbox is empty
+ */
+bool HostPort_CanTxRequest(uint8_t bus)
+{
+    if (bus >= HOST_CAN_BUS_COUNT || !can_attached[bus]) return false;
+    
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    if (!(can->IER & CAN_IER_TMEIE)) return false;
+    
+    for (uint8_t mailbox = 0; mailbox < HOST_TX_MAILBOXES; mailbox++) {
+        if (!(can->sTxMailBox[mailbox].TIR & CAN_TI0R_TXRQ)) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief  Shift bytes out of the USART3 transmitter
+ * @param  out: Buffer for transmitted bytes (NULL to discard)
+ * @param  max_bytes: Most bytes to transmit in this call
+ * @retval Number of bytes transmitted
+ */
+uint32_t HostPort_UartTransmit(uint8_t* out, uint32_t max_bytes)
+{
+    uint32_t count = 0;
+    uint8_t byte;
+    
+    while (count < max_bytes) {
+        /* A byte written by the driver (first byte of a burst or from TXE) */
+        if (HostPort_UartShift(&byte)) {
+            if (out != NULL) {
+                out[count] = byte;
+            }
+            count++;
+            continue;
+        }
+        
+        if (!HostPort_UartTxeRequest()) break;
+        
+        HostPort_UartIrq();
+    }
+    
+    return count;
+}
+
+/**
+ * @brief  Move the byte in the data register to the shift register
+ * @param  byte: Byte taken
+ * @retval true if the driver had written a byte
+ */
+bool HostPort_UartShift(uint8_t* byte)
+{
+    if (host_usart3.DR == HOST_UART_DR_IDLE) return false;
+    
+    *byte = (uint8_t)host_usart3.DR;
+    host_usart3.DR = HOST_UART_DR_IDLE;
+    
+    return true;
+}
+
+/**
+ * @brief  State of the USART3 TXE interrupt request
+ * @param  None
+ * @retval true if TXEIE is set and the data register is empty
+ */
+bool HostPort_UartTxeRequest(void)
+{
+    return (host_usart3.CR1 & USART_CR1_TXEIE) && host_usart3.DR == HOST_UART_DR_IDLE;
+}
+
+/**
+ * @brief  Run the USART3 interrupt handler for an empty data register
+ * @param  None
+ * @retval None
+ */
+void HostPort_UartIrq(void)
+{
+    host_usart3.SR = USART_SR_TXE;
+    UART_IRQHandler();
+}
+
+/**
+ * @brief  Receive one byte on USART3 and run the RXNE interrupt handler
+ * @note   The chip has separate receive and transmit data registers behind
+ *         DR, the host model one: a byte the transmitter has not taken yet
+ *         is set aside while the handler reads DR.
+ * @param  byte: Received byte
+ * @retval true if taken, false if the RXNE interrupt is disabled
+ */
+bool HostPort_UartReceive(uint8_t byte)
+{
+    uint32_t tx_data = host_usart3.DR;
+    uint32_t sr = host_usart3.SR;
+    
+    if (!(host_usart3.CR1 & USART_CR1_RXNEIE)) return false;
+    
+    host_usart3.DR = byte;
+    host_usart3.SR = USART_SR_RXNE;
+    UART_IRQHandler();
+    host_usart3.DR = tx_data;
+    host_usart3.SR = sr;
+    
+    return true;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Mailbox of the oldest pending transmit request
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @retval Mailbox number, -1 if none is pending
+ */
+static int HostPort_OldestTx(uint8_t bus)
+{
+    int oldest = -1;
+    
+    if (bus >= HOST_CAN_BUS_COUNT) return -1;
+    
+    for (int mailbox = 0; mailbox < HOST_TX_MAILBOXES; mailbox++) {
+        uint32_t order = tx_order[bus][mailbox];
+        if (order != 0 && (oldest < 0 || order < tx_order[bus][oldest])) {
+            oldest = mailbox;
+        }
+    }
+    
+    return oldest;
+}
+
+/**
+ * @brief  Find the FIFO 0 filter accepting a frame
+ * @note   FMI numbering and priority follow the bxCAN rules: filters are
+ *         numbered across the controller's FIFO 0 banks, active or not;
+ *         a 32-bit filter beats a 16-bit one, list beats mask at equal
+ *         scale, then the lower filter number wins.
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  rir: Frame identifier in RIR layout
+ * @retval Filter match index, or -1 if no filter accepts the frame
+ */
+static int HostPort_MatchFilter(uint8_t bus, uint32_t rir)
+{
+    uint32_t can2sb = (host_can1.FMR & CAN_FMR_CAN2SB) >> CAN_FMR_CAN2SB_Pos;
+    uint32_t bank = (bus == 0) ? 0 : can2sb;
+    uint32_t bank_end = (bus == 0) ? can2sb : CAN_FILTER_BANK_COUNT;
+    int fmi = 0;
+    int best_fmi = -1;
+    int best_rank = HOST_FILTER_RANK_NONE;
+    
+    /* 16-bit layout: STID[10:0] RTR IDE EXID[17:15] */
+    uint32_t id16 = ((rir >> CAN_RI0R_STID_Pos) << 5) | (((rir >> 1) & 1U) << 4) |
+                    (((rir >> 2) & 1U) << 3) | ((rir >> 18) & 7U);
+    uint32_t id32 = rir & ~1U;          /* Bit 0 (TXRQ) is not compared */
+    
+    for (; bank < bank_end; bank++) {
+        uint32_t bank_bit = 1UL << bank;
+        if (host_can1.FFA1R & bank_bit) continue;   /* FIFO 1 has its own numbering */
+        
+        bool scale32 = (host_can1.FS1R & bank_bit) != 0;
+        bool list = (host_can1.FM1R & bank_bit) != 0;
+        int filters = (scale32 ? 1 : 2) * (list ? 2 : 1);
+        int rank = (scale32 ? 2 : 0) + (list ? 1 : 0);
+        uint32_t fr1 = host_can1.sFilterRegister[bank].FR1;
+        uint32_t fr2 = host_can1.sFilterRegister[bank].FR2;
+        
+        if ((host_can1.FA1R & bank_bit) && rank > best_rank) {
+            for (int k = 0; k < filters; k++) {
+                bool match;
+                
+                if (scale32 && list) {
+                    match = (id32 == ((k == 0 ? fr1 : fr2) & ~1U));
+                } else if (scale32) {
+                    match = (((id32 ^ fr1) & fr2 & ~1U) == 0);
+                } else if (list) {
+                    uint32_t reg = (k < 2) ? fr1 : fr2;
+                    match = (id16 == ((k % 2) ? (reg >> 16) : (reg & 0xFFFFU)));
+                } else {
+                    uint32_t reg = (k == 0) ? fr1 : fr2;
+                    match = (((id16 ^ reg) & (reg >> 16) & 0xFFFFU) == 0);
+                }
+                
+                if (match) {
+                    best_fmi = fmi + k;
+                    best_rank = rank;
+                    break;
+                }
+            }
+        }
+        fmi += filters;
+    }
+    
+    return best_fmi;
+}
+
+/**
+ * @brief  Receive FIFO image of a frame that passes the filters
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code (0-8)
+ * @param  data: Data bytes (dlc bytes)
+ * @param  message: Filled with RIR, RDTR (with FMI), RDLR and RDHR
+ * @retval true if a filter accepted the frame
+ */
+static bool HostPort_EncodeRx(uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data, HostCanRxMessage_t* message)
+{
+    if (bus >= HOST_CAN_BUS_COUNT || dlc > 8) return false;
+    
+    uint32_t word[2] = { 0, 0 };
+    
+    if (id & CAN_ID_EXT) {
+        message->rir = ((id & CAN_ID_EXT_MASK) << CAN_RI0R_EXID_Pos) | CAN_RI0R_IDE;
+    } else {
+        message->rir = (id & CAN_ID_STD_MASK) << CAN_RI0R_STID_Pos;
+    }
+    
+    int fmi = HostPort_MatchFilter(bus, message->rir);
+    if (fmi < 0) return false;
+    
+    /* Mailbox data registers hold byte 0 in bits 7:0 */
+    for (uint8_t i = 0; i < dlc; i++) {
+        word[i / 4] |= (uint32_t)data[i] << ((i % 4) * 8);
+    }
+    
+    message->rdtr = dlc | ((uint32_t)fmi << CAN_RDT0R_FMI_Pos);
+    message->rdlr = word[0];
+    message->rdhr = word[1];
+    
+    return true;
+}
+
+/**
+ * @brief  Show the oldest FIFO message in the output mailbox, update FMP0
+ * @param  bus: Controller (0 = CAN1, 1 = CAN2)
+ * @retval None
+ */
+static void HostPort_PresentRx(uint8_t bus)
+{
+    CAN_TypeDef* can = (bus == 0) ? &host_can1 : &host_can2;
+    
+    if (rx_fifo_count[bus] > 0) {
+        can->sFIFOMailBox[0].RIR = rx_fifo[bus][0].rir;
+        can->sFIFOMailBox[0].RDTR = rx_fifo[bus][0].rdtr;
+        can->sFIFOMailBox[0].RDLR = rx_fifo[bus][0].rdlr;
+        can->sFIFOMailBox[0].RDHR = rx_fifo[bus][0].rdhr;
+    }
+    can->RF0R = (can->RF0R & ~CAN_RF0R_FMP0) | ((uint32_t)rx_fifo_count[bus] << CAN_RF0R_FMP0_Pos);
+}
@@ -0,0 +1,1259 @@
+/**
+ ******************************************************************************
+ * @file    irq_sim.c
+ * @brief   Interrupt preemption simulator for worst-case response times
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Runs the gateway main loop against randomized CAN traffic on a
+ *          virtual 168 MHz core. The Core modules are compiled with
+ *          -finstrument-functions: every function entry and exit is a
+ *          preemption point, and every entry charges the function's cycle
+ *          cost to the virtual clock (split into -g cycle steps, each
+ *          again a point). A function's cost inside its own critical
+ *          section is charged when it unmasks. At each point the
+ *          peripherals advance (frames arrive in the 3-deep bxCAN FIFO,
+ *          mailboxes finish sending, USART3 shifts bytes) and, unless
+ *          PRIMASK is set, the highest pending interrupt whose preemption
+ *          priority beats the running one is taken. Priorities come from
+ *          NVIC_Config() (system_config.c).
+ *
+ *          Reported per interrupt: latency (request to handler entry) and
+ *          response (request to handler exit, preemption included); per
+ *          route: frame arrival until the main loop has handled it (or a
+ *          newer frame of the same ID, when coalesced); the longest
+ *          masked window. Worst cases name the schedule seed; "-n 1
+ *          -S seed" replays its traffic. Schedules run back to back in
+ *          one process and the drivers' ring buffer positions carry over
+ *          (zeroed only at reset on target), so a replay can differ by a
+ *          few cycles.
+ *
+ *          Cost file (-C), one function per line, '#' comments; names
+ *          are looked up in the executable's symbol table (static
+ *          functions included):
+ *            <function>,<cycles>[,<cycles with interrupts masked>]
+ *          The built-in costs are estimates; the DWT figures of gw_bench
+ *          on the target are the better source.
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include -finstrument-functions
+ *                -finstrument-functions-exclude-file-list=Host/,Drivers/,/usr/
+ *                Host/Src/irq_sim.c Host/Src/can_bus.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/system_config.c
+ *                Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o irq_sim
+ *
+ *          Usage: irq_sim [-n schedules] [-d ms] [-S seed] [-j jitter%]
+ *                         [-B burst] [-g step] [-C costs] [-m event|snapshot]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "host_ecu.h"
+#include "can_bus.h"
+#include "can_drv.h"
+#include "uart_drv.h"
+#include "e2e.h"
+#include "system_config.h"
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Cycle cost of one function
+ */
+typedef struct {
+    char name[48];
+    uint32_t cycles;            /* Charged on entry */
+    uint32_t masked_cycles;     /* Charged when the function unmasks interrupts */
+} IrqSimCost_t;
+
+/**
+ * @brief Function symbol of the simulator executable
+ */
+typedef struct {
+    uintptr_t address;
+    const char* name;
+} IrqSimSymbol_t;
+
+/**
+ * @brief Interrupt source with its NVIC priority and statistics
+ */
+typedef struct {
+    const char* name;
+    IRQn_Type irqn;
+    int rx_bus;                 /* Receive FIFO of this bus, -1 for other sources */
+    bool (*request)(void);      /* Peripheral asserts the interrupt */
+    void (*handler)(void);
+    uint32_t priority;          /* Preemption priority (lower wins) */
+    uint32_t subpriority;
+    bool enabled;
+    bool active;                /* Handler running (or preempted) */
+    uint64_t since;             /* Request start, IRQSIM_NEVER if none */
+    uint64_t count;
+    uint64_t sum_response;
+    uint64_t max_latency;
+    uint64_t max_response;
+    uint32_t worst_seed;
+} IrqSimSource_t;
+
+/**
+ * @brief Frame arriving on a bus at end of frame
+ */
+typedef struct {
+    uint64_t cycle;
+    uint8_t bus;
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+} IrqSimArrival_t;
+
+/**
+ * @brief Periodic traffic stream of the randomized schedules
+ */
+typedef struct {
+    uint8_t bus;
+    uint32_t id;
+    uint32_t period_ms;
+    uint8_t dlc;
+} IrqSimStream_t;
+
+/**
+ * @brief Arrival-to-handled statistics of one received ID
+ */
+typedef struct {
+    uint8_t bus;
+    uint32_t id;
+    uint64_t since;             /* Oldest arrival not yet handled */
+    uint64_t count;
+    uint64_t sum_cycles;
+    uint64_t max_cycles;
+    uint64_t overruns;          /* Lost to a full hardware FIFO */
+    uint32_t worst_seed;
+} IrqSimRoute_t;
+
+/**
+ * @brief Simulation options
+ */
+typedef struct {
+    uint32_t schedules;
+    uint32_t duration_ms;
+    uint32_t seed;
+    uint32_t jitter_pct;        /* Period jitter, +/- percent */
+    uint32_t burst;             /* Back-to-back frames once per schedule */
+    uint32_t step;              /* Cycles between preemption points inside a cost */
+    const char* cost_path;
+    RouterOutputMode_t mode;
+} IrqSimOptions_t;
+
+/* Private define ------------------------------------------------------------*/
+#define IRQSIM_CORE_HZ          168000000U
+#define IRQSIM_CYCLES_PER_MS    (IRQSIM_CORE_HZ / 1000U)
+#define IRQSIM_CYCLES_PER_BIT   (IRQSIM_CORE_HZ / HOST_ECU_CAN_BAUDRATE)
+#define IRQSIM_UART_BYTE_CYCLES (IRQSIM_CORE_HZ * 10U / HOST_ECU_UART_BAUDRATE)    /* 8N1 */
+#define IRQSIM_ENTRY_CYCLES     12      /* Exception entry: stacking, vector fetch */
+#define IRQSIM_EXIT_CYCLES      10      /* Exception return: unstacking */
+#define IRQSIM_LOOP_CYCLES      20      /* Main loop overhead per pass */
+#define IRQSIM_DEFAULT_COST     25      /* Functions without a cost entry */
+#define IRQSIM_SCHEDULES        32
+#define IRQSIM_DURATION_MS      200
+#define IRQSIM_JITTER_PCT       10
+#define IRQSIM_BURST_FRAMES     12
+#define IRQSIM_STEP_CYCLES      32
+#define IRQSIM_MAX_ARRIVALS     8192
+#define IRQSIM_MAX_ROUTES       32
+#define IRQSIM_MAX_COSTS        128
+#define IRQSIM_COST_SLOTS       1024    /* Address to cost cache (power of two) */
+#define IRQSIM_STACK_DEPTH      64
+#define IRQSIM_THREAD_PRIORITY  0x100U  /* Below every interrupt */
+#define IRQSIM_NEVER            UINT64_MAX
+#define IRQSIM_LINE_LENGTH      128
+
+/* Private macro -------------------------------------------------------------*/
+#define IRQSIM_TO_US(cycles)    ((double)(cycles) / (IRQSIM_CORE_HZ / 1e6))
+#define IRQSIM_NO_INSTRUMENT    __attribute__((no_instrument_function))
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Estimates for -O2 on the Cortex-M4 at 168 MHz, zero wait states (ART) */
+static IrqSimCost_t costs[IRQSIM_MAX_COSTS] = {
+    { "CAN_IRQHandler",             8,   0   },
+    { "CAN_RxIRQHandler",           4,   0   },
+    { "CAN_ServiceRx",              116, 0   },
+    { "CAN_TxIRQHandler",           4,   0   },
+    { "CAN_ServiceTx",              16,  60  },
+    { "CAN_Transmit",               4,   0   },
+    { "CAN_ChannelTransmit",        4,   0   },
+    { "CAN_QueueTx",                26,  50  },
+    { "CAN_Receive",                4,   0   },
+    { "CAN_DequeueRx",              26,  60  },
+    { "CAN_LoadMailbox",            30,  0   },
+    { "CAN_RecordTxLatency",        15,  0   },
+    { "CAN_FindCoalesceEntry",      20,  0   },
+    { "CanGateway_ForwardFromIsr",  60,  20  },
+    { "UART_IRQHandler",            4,   0   },
+    { "UART_ServiceIrq",            36,  0   },
+    { "UART_WriteData",             4,   0   },
+    { "UART_WriteBytes",            26,  250 },
+    { "UART_StartTransmission",     20,  0   },
+    { "Router_ProcessCanFrame",     4,   0   },
+    { "RouteFrame",                 146, 0   },
+    { "Router_Poll",                40,  0   },
+    { "FormatAndSendSignal",        900, 0   },
+    { "SendSnapshotRecord",         1200, 0  },
+    { "SendErrorMessage",           600, 0   },
+    { "ExtractSignalValue",         40,  0   },
+    { "ScaleSignalValue",           30,  0   },
+    { "RouteSignal",                30,  0   },
+    { "RouteMuxFrame",              60,  0   },
+    { "E2E_Check",                  60,  0   },
+    { "E2E_ComputeCrc",             20,  0   },
+    { "E2E_ComputeCrcSoftware",     180, 0   },
+    { "SignalStore_Write",          30,  0   },
+    { "PduTx_Process",              40,  0   },
+    { "PduTx_Repack",               80,  0   },
+    { "CycleMonitor_Process",       60,  0   },
+    { "J1939_ProcessCanFrame",      60,  0   },
+    { "J1939_HandleEec1",           80,  0   },
+    { "J1939_HandleCcvs",           80,  0   },
+    { "Uds_ProcessCanFrame",        40,  0   },
+    { "Uds_OnRequest",              80,  0   },
+    { "IsoTp_OnFrame",              60,  0   },
+};
+static uint32_t cost_count = 42;
+
+/* CAN1 powertrain (routed, E2E, J1939, UDS, unrouted) and CAN2 body traffic */
+static const IrqSimStream_t streams[] = {
+    { CAN_BUS_1, 0x100,                     10,  8 },
+    { CAN_BUS_1, 0x101,                     100, 8 },
+    { CAN_BUS_1, 0x102,                     20,  8 },
+    { CAN_BUS_1, 0x103,                     50,  8 },
+    { CAN_BUS_1, 0x104,                     10,  8 },
+    { CAN_BUS_1, 0x105,                     20,  8 },
+    { CAN_BUS_1, 0x0CF00400U | CAN_ID_EXT,  10,  8 },
+    { CAN_BUS_1, 0x18FEF100U | CAN_ID_EXT,  100, 8 },
+    { CAN_BUS_1, CAN_FILTER_ID_DIAG_REQ,    100, 8 },
+    { CAN_BUS_2, 0x200,                     20,  4 },
+};
+
+static IrqSimSource_t sources[] = {
+    { .name = "CAN1_RX0", .irqn = CAN1_RX0_IRQn, .rx_bus = CAN_BUS_1 },
+    { .name = "CAN1_TX",  .irqn = CAN1_TX_IRQn,  .rx_bus = -1        },
+    { .name = "CAN2_TX",  .irqn = CAN2_TX_IRQn,  .rx_bus = -1        },
+    { .name = "USART3",   .irqn = USART3_IRQn,   .rx_bus = -1        },
+    { .name = "CAN2_RX0", .irqn = CAN2_RX0_IRQn, .rx_bus = CAN_BUS_2 },
+};
+#define IRQSIM_SOURCE_COUNT     (sizeof(sources) / sizeof(sources[0]))
+
+static IrqSimSymbol_t* symbols = NULL;
+static size_t symbol_count = 0;
+static char* symbol_names = NULL;
+static uintptr_t cost_keys[IRQSIM_COST_SLOTS];
+static const IrqSimCost_t* cost_values[IRQSIM_COST_SLOTS];
+static IrqSimCost_t default_cost = { "", IRQSIM_DEFAULT_COST, 0 };
+
+static IrqSimArrival_t arrivals[IRQSIM_MAX_ARRIVALS];
+static uint32_t arrival_count;
+static uint32_t arrival_next;
+static IrqSimRoute_t routes[IRQSIM_MAX_ROUTES];
+static uint32_t route_count = 0;
+
+/* Virtual machine state of the running schedule */
+static bool sim_running = false;
+static uint32_t sim_seed;
+static uint32_t sim_step;
+static uint64_t now;
+static uint64_t last_point;
+static uint32_t running_priority;
+static void* call_stack[IRQSIM_STACK_DEPTH];
+static uint32_t call_depth;
+static uint64_t masked_since;
+static uint64_t tx_end[HOST_CAN_BUS_COUNT];
+static uint64_t uart_free;
+static uint64_t rx_arrival[HOST_CAN_BUS_COUNT][HOST_CAN_RX_FIFO_DEPTH];
+static uint8_t rx_arrival_count[HOST_CAN_BUS_COUNT];
+static uint32_t random_state;
+
+/* Totals over all schedules */
+static uint64_t total_cycles = 0;
+static uint64_t total_tx_frames = 0;
+static uint64_t total_uart_bytes = 0;
+static uint64_t total_rx_dropped = 0;
+static uint64_t max_masked = 0;
+static void* max_masked_function = NULL;
+static uint32_t max_masked_seed = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool IrqSim_ParseOptions(int argc, char** argv, IrqSimOptions_t* options);
+static bool IrqSim_LoadSymbols(void);
+static uintptr_t IrqSim_FindSymbol(const char* name);
+static const char* IrqSim_SymbolName(const void* function);
+static bool IrqSim_LoadCosts(const char* path);
+static bool IrqSim_BuildCostCache(void);
+static const IrqSimCost_t* IrqSim_Cost(const void* function);
+static void IrqSim_GenerateSchedule(const IrqSimOptions_t* options);
+static int IrqSim_CompareArrivals(const void* a, const void* b);
+static bool IrqSim_RunSchedule(const IrqSimOptions_t* options);
+static void IrqSim_Advance(uint64_t cycles);
+static void IrqSim_Point(void);
+static void IrqSim_UpdateDevices(void);
+static void IrqSim_Sample(uint64_t cycle);
+static void IrqSim_Dispatch(void);
+static void IrqSim_OnPrimask(uint32_t primask);
+static void IrqSim_OnFrame(const CanFrame_t* frame);
+static IrqSimRoute_t* IrqSim_FindRoute(uint8_t bus, uint32_t id, bool create);
+static uint32_t IrqSim_Random(void);
+static void IrqSim_Report(const IrqSimOptions_t* options);
+static void IrqSim_Usage(const char* name);
+
+static bool IrqSim_Can1RxRequest(void);
+static bool IrqSim_Can2RxRequest(void);
+static bool IrqSim_Can1TxRequest(void);
+static bool IrqSim_Can2TxRequest(void);
+static void IrqSim_Can1RxHandler(void);
+static void IrqSim_Can2RxHandler(void);
+static void IrqSim_Can1TxHandler(void);
+static void IrqSim_Can2TxHandler(void);
+
+void __cyg_profile_func_enter(void* function, void* call_site) IRQSIM_NO_INSTRUMENT;
+void __cyg_profile_func_exit(void* function, void* call_site) IRQSIM_NO_INSTRUMENT;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Interrupt simulator entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if successful, 1 on usage, cost or initialization errors
+ */
+int main(int argc, char** argv)
+{
+    IrqSimOptions_t options;
+    
+    if (!IrqSim_ParseOptions(argc, argv, &options)) {
+        IrqSim_Usage(argv[0]);
+        return 1;
+    }
+    
+    if (!IrqSim_LoadSymbols()) {
+        fprintf(stderr, "irq_sim: no symbol table (executable stripped?)\n");
+        return 1;
+    }
+    if (options.cost_path != NULL && !IrqSim_LoadCosts(options.cost_path)) return 1;
+    if (!IrqSim_BuildCostCache()) return 1;
+    
+    sources[0].request = IrqSim_Can1RxRequest;
+    sources[0].handler = IrqSim_Can1RxHandler;
+    sources[1].request = IrqSim_Can1TxRequest;
+    sources[1].handler = IrqSim_Can1TxHandler;
+    sources[2].request = IrqSim_Can2TxRequest;
+    sources[2].handler = IrqSim_Can2TxHandler;
+    sources[3].request = HostPort_UartTxeRequest;
+    sources[3].handler = HostPort_UartIrq;
+    sources[4].request = IrqSim_Can2RxRequest;
+    sources[4].handler = IrqSim_Can2RxHandler;
+    
+    HostPort_SetIrqHook(IrqSim_OnPrimask);
+    HostEcu_SetFrameHook(IrqSim_OnFrame);
+    
+    for (uint32_t k = 0; k < options.schedules; k++) {
+        sim_seed = options.seed + k;
+        IrqSim_GenerateSchedule(&options);
+        if (!IrqSim_RunSchedule(&options)) {
+            fprintf(stderr, "irq_sim: gateway initialization failed\n");
+            return 1;
+        }
+    }
+    
+    IrqSim_Report(&options);
+    
+    return 0;
+}
+
+/**
+ * @brief  Instrumentation hook: function entry (preemption point, cost)
+ * @param  function: Entered function
+ * @param  call_site: Return address
+ * @retval None
+ */
+void __cyg_profile_func_enter(void* function, void* call_site)
+{
+    (void)call_site;
+    if (!sim_running) return;
+    
+    if (call_depth < IRQSIM_STACK_DEPTH) {
+        call_stack[call_depth] = function;
+    }
+    call_depth++;
+    
+    IrqSim_Advance(IrqSim_Cost(function)->cycles);
+}
+
+/**
+ * @brief  Instrumentation hook: function exit (preemption point)
+ * @param  function: Left function
+ * @param  call_site: Return address
+ * @retval None
+ */
+void __cyg_profile_func_exit(void* function, void* call_site)
+{
+    (void)function;
+    (void)call_site;
+    if (!sim_running) return;
+    
+    if (call_depth > 0) {
+        call_depth--;
+    }
+    IrqSim_Point();
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Parse command line
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @param  options: Parsed options
+ * @retval true if valid
+ */
+static bool IrqSim_ParseOptions(int argc, char** argv, IrqSimOptions_t* options)
+{
+    int opt;
+    
+    options->schedules = IRQSIM_SCHEDULES;
+    options->duration_ms = IRQSIM_DURATION_MS;
+    options->seed = 1;
+    options->jitter_pct = IRQSIM_JITTER_PCT;
+    options->burst = IRQSIM_BURST_FRAMES;
+    options->step = IRQSIM_STEP_CYCLES;
+    options->cost_path = NULL;
+    options->mode = ROUTER_OUTPUT_EVENT;
+    
+    while ((opt = getopt(argc, argv, "n:d:S:j:B:g:C:m:")) != -1) {
+        switch (opt) {
+            case 'n':
+                options->schedules = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->schedules == 0) return false;
+                break;
+            case 'd':
+                options->duration_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->duration_ms == 0) return false;
+                break;
+            case 'S':
+                options->seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'j':
+                options->jitter_pct = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->jitter_pct > 50) return false;
+                break;
+            case 'B':
+                options->burst = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'g':
+                options->step = (uint32_t)strtoul(optarg, NULL, 0);
+                if (options->step == 0) return false;
+                break;
+            case 'C':
+                options->cost_path = optarg;
+                break;
+            case 'm':
+                if (strcmp(optarg, "event") == 0) {
+                    options->mode = ROUTER_OUTPUT_EVENT;
+                } else if (strcmp(optarg, "snapshot") == 0) {
+                    options->mode = ROUTER_OUTPUT_SNAPSHOT;
+                } else {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    return optind == argc;
+}
+
+/**
+ * @brief  Read the function symbols of this executable (ELF .symtab)
+ * @note   Addresses are rebased with main() for position independent builds.
+ * @param  None
+ * @retval true if the symbol table was found
+ */
+static bool IrqSim_LoadSymbols(void)
+{
+    FILE* file = fopen("/proc/self/exe", "rb");
+    Elf64_Ehdr header;
+    Elf64_Shdr* sections = NULL;
+    Elf64_Sym* table = NULL;
+    bool ok = false;
+    
+    if (file == NULL) return false;
+    
+    if (fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.e_ident, ELFMAG, SELFMAG) == 0 &&
+        header.e_ident[EI_CLASS] == ELFCLASS64 && header.e_shentsize == sizeof(Elf64_Shdr)) {
+        sections = calloc(header.e_shnum, sizeof(Elf64_Shdr));
+        if (sections != NULL && fseek(file, (long)header.e_shoff, SEEK_SET) == 0 &&
+            fread(sections, sizeof(Elf64_Shdr), header.e_shnum, file) == header.e_shnum) {
+            for (uint16_t i = 0; i < header.e_shnum && !ok; i++) {
+                if (sections[i].sh_type != SHT_SYMTAB || sections[i].sh_link >= header.e_shnum) continue;
+                
+                const Elf64_Shdr* strings = &sections[sections[i].sh_link];
+                size_t count = sections[i].sh_size / sizeof(Elf64_Sym);
+                
+                table = malloc(sections[i].sh_size);
+                symbol_names = malloc(strings->sh_size);
+                symbols = calloc(count, sizeof(IrqSimSymbol_t));
+                if (table == NULL || symbol_names == NULL || symbols == NULL ||
+                    fseek(file, (long)sections[i].sh_offset, SEEK_SET) != 0 ||
+                    fread(table, sizeof(Elf64_Sym), count, file) != count ||
+                    fseek(file, (long)strings->sh_offset, SEEK_SET) != 0 ||
+                    fread(symbol_names, 1, strings->sh_size, file) != strings->sh_size) {
+                    break;
+                }
+                
+                for (size_t k = 0; k < count; k++) {
+                    if (ELF64_ST_TYPE(table[k].st_info) == STT_FUNC && table[k].st_value != 0 &&
+                        table[k].st_name < strings->sh_size) {
+                        symbols[symbol_count].address = (uintptr_t)table[k].st_value;
+                        symbols[symbol_count].name = &symbol_names[table[k].st_name];
+                        symbol_count++;
+                    }
+                }
+                ok = true;
+            }
+        }
+    }
+    
+    free(table);
+    free(sections);
+    fclose(file);
+    
+    /* Load bias of a PIE executable */
+    uintptr_t main_symbol = ok ? IrqSim_FindSymbol("main") : 0;
+    if (main_symbol == 0) return false;
+    
+    uintptr_t bias = (uintptr_t)&main - main_symbol;
+    for (size_t k = 0; k < symbol_count; k++) {
+        symbols[k].address += bias;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Address of a function symbol
+ * @param  name: Function name
+ * @retval Address (not rebased before IrqSim_LoadSymbols() finishes), 0 if unknown
+ */
+static uintptr_t IrqSim_FindSymbol(const char* name)
+{
+    for (size_t k = 0; k < symbol_count; k++) {
+        if (strcmp(symbols[k].name, name) == 0) return symbols[k].address;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Name of a function
+ * @param  function: Function address
+ * @retval Symbol name, "?" if unknown
+ */
+static const char* IrqSim_SymbolName(const void* function)
+{
+    for (size_t k = 0; k < symbol_count; k++) {
+        if (symbols[k].address == (uintptr_t)function) return symbols[k].name;
+    }
+    return "?";
+}
+
+/**
+ * @brief  Read a cost file; entries replace or extend the built-in table
+ * @param  path: Cost file
+ * @retval true if every line was valid
+ */
+static bool IrqSim_LoadCosts(const char* path)
+{
+    char line[IRQSIM_LINE_LENGTH];
+    uint32_t line_number = 0;
+    FILE* file = fopen(path, "r");
+    
+    if (file == NULL) {
+        fprintf(stderr, "irq_sim: cannot open %s\n", path);
+        return false;
+    }
+    
+    while (fgets(line, sizeof(line), file) != NULL) {
+        IrqSimCost_t entry = { "", 0, 0 };
+        unsigned long cycles = 0;
+        unsigned long masked = 0;
+        
+        line_number++;
+        if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#') continue;
+        
+        int fields = sscanf(line, " %47[^, \t] , %lu , %lu", entry.name, &cycles, &masked);
+        if (fields < 2) {
+            fprintf(stderr, "irq_sim: %s:%lu: expected <function>,<cycles>[,<masked>]\n",
+                    path, (unsigned long)line_number);
+            fclose(file);
+            return false;
+        }
+        entry.cycles = (uint32_t)cycles;
+        entry.masked_cycles = (uint32_t)masked;
+        
+        uint32_t i = 0;
+        while (i < cost_count && strcmp(costs[i].name, entry.name) != 0) {
+            i++;
+        }
+        if (i == IRQSIM_MAX_COSTS) {
+            fprintf(stderr, "irq_sim: %s: more than %u functions\n", path, IRQSIM_MAX_COSTS);
+            fclose(file);
+            return false;
+        }
+        costs[i] = entry;
+        if (i == cost_count) cost_count++;
+    }
+    
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief  Resolve the cost table to function addresses
+ * @param  None
+ * @retval true if every function exists in the executable
+ */
+static bool IrqSim_BuildCostCache(void)
+{
+    memset(cost_keys, 0, sizeof(cost_keys));
+    
+    for (uint32_t i = 0; i < cost_count; i++) {
+        uintptr_t address = IrqSim_FindSymbol(costs[i].name);
+        if (address == 0) {
+            fprintf(stderr, "irq_sim: unknown function %s\n", costs[i].name);
+            return false;
+        }
+        
+        uint32_t slot = (uint32_t)(address >> 4) & (IRQSIM_COST_SLOTS - 1);
+        while (cost_keys[slot] != 0) {
+            slot = (slot + 1) & (IRQSIM_COST_SLOTS - 1);
+        }
+        cost_keys[slot] = address;
+        cost_values[slot] = &costs[i];
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Cost entry of a function (the default for functions not listed)
+ * @param  function: Function address
+ * @retval Cost entry
+ */
+static const IrqSimCost_t* IrqSim_Cost(const void* function)
+{
+    uint32_t slot = (uint32_t)((uintptr_t)function >> 4) & (IRQSIM_COST_SLOTS - 1);
+    
+    while (cost_keys[slot] != 0) {
+        if (cost_keys[slot] == (uintptr_t)function) return cost_values[slot];
+        slot = (slot + 1) & (IRQSIM_COST_SLOTS - 1);
+    }
+    return &default_cost;
+}
+
+/**
+ * @brief  Random arrivals of one schedule: periodic streams with random
+ *         phase and jitter plus one back-to-back burst on CAN1
+ * @note   Frames on one bus are serialized by their exact length.
+ * @param  options: Simulation options
+ * @retval None
+ */
+static void IrqSim_GenerateSchedule(const IrqSimOptions_t* options)
+{
+    uint64_t end = (uint64_t)options->duration_ms * IRQSIM_CYCLES_PER_MS;
+    uint8_t counter = 0;
+    
+    random_state = (sim_seed != 0) ? sim_seed : 1;
+    arrival_count = 0;
+    
+    for (size_t s = 0; s < sizeof(streams) / sizeof(streams[0]); s++) {
+        const IrqSimStream_t* stream = &streams[s];
+        uint64_t period = (uint64_t)stream->period_ms * IRQSIM_CYCLES_PER_MS;
+        uint64_t jitter = period * options->jitter_pct / 100U;
+        uint64_t t = IrqSim_Random() % period;
+        
+        while (t < end && arrival_count < IRQSIM_MAX_ARRIVALS) {
+            IrqSimArrival_t* arrival = &arrivals[arrival_count++];
+            arrival->cycle = t;
+            arrival->bus = stream->bus;
+            arrival->id = stream->id;
+            arrival->dlc = stream->dlc;
+            for (uint8_t i = 0; i < 8; i++) {
+                arrival->data[i] = (uint8_t)IrqSim_Random();
+            }
+            if (stream->id == CAN_FILTER_ID_DIAG_REQ) {
+                memcpy(arrival->data, "\x02\x3E\x00\x00\x00\x00\x00\x00", 8);   /* TesterPresent */
+            } else if (stream->id == 0x104) {
+                counter = (counter + 1) & 0x0F;
+                arrival->data[1] = counter;
+                arrival->data[0] = E2E_ComputeCrcSoftware(arrival->data, 0x104);
+            }
+            
+            t += period;
+            if (jitter > 0) {
+                t = t - jitter + IrqSim_Random() % (2 * jitter + 1);
+            }
+        }
+    }
+    
+    /* Highest rate routed IDs back to back */
+    uint64_t burst_at = IrqSim_Random() % end;
+    for (uint32_t i = 0; i < options->burst && arrival_count < IRQSIM_MAX_ARRIVALS; i++) {
+        IrqSimArrival_t* arrival = &arrivals[arrival_count++];
+        arrival->cycle = burst_at;
+        arrival->bus = CAN_BUS_1;
+        arrival->id = CAN_FILTER_ID_ENGINE + (i % 4);
+        arrival->dlc = 8;
+        for (uint8_t k = 0; k < 8; k++) {
+            arrival->data[k] = (uint8_t)IrqSim_Random();
+        }
+    }
+    
+    qsort(arrivals, arrival_count, sizeof(arrivals[0]), IrqSim_CompareArrivals);
+    
+    /* A bus carries one frame at a time: push collisions back */
+    uint64_t bus_free[HOST_CAN_BUS_COUNT] = { 0, 0 };
+    for (uint32_t i = 0; i < arrival_count; i++) {
+        CanBusFrameTiming_t timing;
+        IrqSimArrival_t* arrival = &arrivals[i];
+        
+        CanBus_FrameTiming(arrival->id, arrival->dlc, arrival->data, &timing);
+        uint64_t length = (uint64_t)timing.bits * IRQSIM_CYCLES_PER_BIT;
+        if (arrival->cycle < bus_free[arrival->bus] + length) {
+            arrival->cycle = bus_free[arrival->bus] + length;
+        }
+        bus_free[arrival->bus] = arrival->cycle;
+    }
+    qsort(arrivals, arrival_count, sizeof(arrivals[0]), IrqSim_CompareArrivals);
+}
+
+/**
+ * @brief  qsort() order of arrivals: time, then bus
+ * @param  a: Arrival
+ * @param  b: Arrival
+ * @retval Negative, zero or positive
+ */
+static int IrqSim_CompareArrivals(const void* a, const void* b)
+{
+    const IrqSimArrival_t* x = a;
+    const IrqSimArrival_t* y = b;
+    
+    if (x->cycle != y->cycle) return (x->cycle < y->cycle) ? -1 : 1;
+    return (int)x->bus - (int)y->bus;
+}
+
+/**
+ * @brief  Run the gateway through one schedule
+ * @param  options: Simulation options
+ * @retval true if successful, false if the gateway failed to initialize
+ */
+static bool IrqSim_RunSchedule(const IrqSimOptions_t* options)
+{
+    CanRxStats_t rx;
+    uint64_t end = (uint64_t)options->duration_ms * IRQSIM_CYCLES_PER_MS;
+    
+    if (!HostEcu_Init(options->mode)) return false;
+    NVIC_Config();
+    
+    for (size_t s = 0; s < IRQSIM_SOURCE_COUNT; s++) {
+        IrqSimSource_t* source = &sources[s];
+        NVIC_DecodePriority(NVIC_GetPriority(source->irqn), NVIC_GetPriorityGrouping(),
+                            &source->priority, &source->subpriority);
+        source->enabled = NVIC_GetEnableIRQ(source->irqn) != 0;
+        source->active = false;
+        source->since = IRQSIM_NEVER;
+    }
+    
+    HostPort_CanAttach(CAN_BUS_1, true);
+    HostPort_CanAttach(CAN_BUS_2, true);
+    HostPort_UartTransmit(NULL, UINT32_MAX);    /* Startup banner */
+    
+    for (uint32_t r = 0; r < route_count; r++) {
+        routes[r].since = IRQSIM_NEVER;
+    }
+    sim_step = options->step;
+    now = 0;
+    last_point = 0;
+    arrival_next = 0;
+    running_priority = IRQSIM_THREAD_PRIORITY;
+    call_depth = 0;
+    masked_since = IRQSIM_NEVER;
+    tx_end[0] = tx_end[1] = IRQSIM_NEVER;
+    uart_free = 0;
+    memset(rx_arrival_count, 0, sizeof(rx_arrival_count));
+    
+    sim_running = true;
+    while (now < end) {
+        IrqSim_Advance(IRQSIM_LOOP_CYCLES);
+        HostEcu_Poll();
+    }
+    sim_running = false;
+    
+    /* UART_Init() keeps the ring buffer (zeroed at reset on target) */
+    HostPort_UartTransmit(NULL, UINT32_MAX);
+    
+    CAN_GetRxStats(&rx);
+    total_rx_dropped += rx.frames_dropped;
+    total_cycles += now;
+    
+    return true;
+}
+
+/**
+ * @brief  Let time pass on the running context, one preemption point per step
+ * @param  cycles: Cycles to add
+ * @retval None
+ */
+static void IrqSim_Advance(uint64_t cycles)
+{
+    while (cycles > 0) {
+        uint64_t step = (cycles < sim_step) ? cycles : sim_step;
+        now += step;
+        cycles -= step;
+        IrqSim_Point();
+    }
+}
+
+/**
+ * @brief  Preemption point: advance the peripherals, take interrupts
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_Point(void)
+{
+    HostPort_SetTick((uint32_t)(now / IRQSIM_CYCLES_PER_MS));
+    DWT->CYCCNT = (uint32_t)now;
+    
+    IrqSim_UpdateDevices();
+    last_point = now;
+    IrqSim_Dispatch();
+}
+
+/**
+ * @brief  Apply every peripheral event due by now, in time order
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_UpdateDevices(void)
+{
+    for (;;) {
+        uint64_t t = IRQSIM_NEVER;
+        int event = -1;         /* 0 = arrival, 1/2 = CAN1/CAN2 sent, 3 = UART shift */
+        
+        if (arrival_next < arrival_count && arrivals[arrival_next].cycle <= now) {
+            t = arrivals[arrival_next].cycle;
+            event = 0;
+        }
+        for (uint8_t bus = 0; bus < HOST_CAN_BUS_COUNT; bus++) {
+            if (tx_end[bus] <= now && tx_end[bus] < t) {
+                t = tx_end[bus];
+                event = 1 + bus;
+            }
+        }
+        if (uart_free <= now && (USART3->CR1 & USART_CR1_TXEIE) && !HostPort_UartTxeRequest()) {
+            /* Data register full (the driver sets TXEIE right after writing
+               it): the byte moves to the shifter once that is free */
+            uint64_t shift = (uart_free > last_point) ? uart_free : last_point;
+            if (shift < t) {
+                t = shift;
+                event = 3;
+            }
+        }
+        if (event < 0) break;
+        
+        if (event == 0) {
+            const IrqSimArrival_t* arrival = &arrivals[arrival_next++];
+            HostCanRx_t result = HostPort_CanArrive(arrival->bus, arrival->id, arrival->dlc, arrival->data);
+            if (result != HOST_CAN_RX_FILTERED) {
+                IrqSimRoute_t* route = IrqSim_FindRoute(arrival->bus, arrival->id, true);
+                if (result == HOST_CAN_RX_OVERRUN) {
+                    if (route != NULL) route->overruns++;
+                } else {
+                    rx_arrival[arrival->bus][rx_arrival_count[arrival->bus]++] = t;
+                    if (route != NULL && route->since == IRQSIM_NEVER) {
+                        route->since = t;
+                    }
+                }
+            }
+        } else if (event < 3) {
+            HostPort_CanCompleteTx((uint8_t)(event - 1));
+            tx_end[event - 1] = IRQSIM_NEVER;
+            total_tx_frames++;
+        } else {
+            uint8_t byte;
+            if (HostPort_UartShift(&byte)) {
+                total_uart_bytes++;
+            }
+            uart_free = t + IRQSIM_UART_BYTE_CYCLES;
+        }
+        
+        /* A controller with a request starts sending when its bus is idle */
+        for (uint8_t bus = 0; bus < HOST_CAN_BUS_COUNT; bus++) {
+            CanBusFrameTiming_t timing;
+            uint32_t id;
+            uint8_t dlc;
+            uint8_t data[8];
+            if (tx_end[bus] == IRQSIM_NEVER && HostPort_CanPeekTx(bus, &id, &dlc, data)) {
+                CanBus_FrameTiming(id, dlc, data, &timing);
+                tx_end[bus] = t + (uint64_t)timing.bits * IRQSIM_CYCLES_PER_BIT;
+            }
+        }
+        IrqSim_Sample(t);
+    }
+    
+    /* Requests the driver loaded since the last point */
+    for (uint8_t bus = 0; bus < HOST_CAN_BUS_COUNT; bus++) {
+        CanBusFrameTiming_t timing;
+        uint32_t id;
+        uint8_t dlc;
+        uint8_t data[8];
+        if (tx_end[bus] == IRQSIM_NEVER && HostPort_CanPeekTx(bus, &id, &dlc, data)) {
+            CanBus_FrameTiming(id, dlc, data, &timing);
+            tx_end[bus] = now + (uint64_t)timing.bits * IRQSIM_CYCLES_PER_BIT;
+        }
+    }
+    IrqSim_Sample(now);
+}
+
+/**
+ * @brief  Start the request time of newly asserted interrupt lines
+ * @param  cycle: Time of the event that may have asserted them
+ * @retval None
+ */
+static void IrqSim_Sample(uint64_t cycle)
+{
+    for (size_t s = 0; s < IRQSIM_SOURCE_COUNT; s++) {
+        IrqSimSource_t* source = &sources[s];
+        if (source->rx_bus < 0 && !source->active && source->since == IRQSIM_NEVER && source->request()) {
+            source->since = cycle;
+        }
+    }
+}
+
+/**
+ * @brief  Take pending interrupts that may preempt the running context
+ * @note   Lower preemption priority value wins; ties go to the lower
+ *         subpriority, then the lower IRQ number. Handlers run nested
+ *         here, so their own points can be preempted in turn.
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_Dispatch(void)
+{
+    while (HostPort_GetPrimask() == 0) {
+        IrqSimSource_t* next = NULL;
+        
+        for (size_t s = 0; s < IRQSIM_SOURCE_COUNT; s++) {
+            IrqSimSource_t* source = &sources[s];
+            if (!source->enabled || source->active || source->priority >= running_priority ||
+                !source->request()) {
+                continue;
+            }
+            if (next == NULL || source->priority < next->priority ||
+                (source->priority == next->priority &&
+                 (source->subpriority < next->subpriority ||
+                  (source->subpriority == next->subpriority && source->irqn < next->irqn)))) {
+                next = source;
+            }
+        }
+        if (next == NULL) return;
+        
+        /* Receive: the frame at the head of the FIFO; others: the line */
+        uint64_t origin;
+        if (next->rx_bus >= 0) {
+            origin = (rx_arrival_count[next->rx_bus] > 0) ? rx_arrival[next->rx_bus][0] : now;
+        } else {
+            origin = (next->since != IRQSIM_NEVER) ? next->since : now;
+        }
+        next->since = IRQSIM_NEVER;
+        
+        uint32_t preempted = running_priority;
+        uint32_t depth = call_depth;
+        uint64_t latency = now - origin;
+        
+        now += IRQSIM_ENTRY_CYCLES;
+        running_priority = next->priority;
+        next->active = true;
+        
+        next->handler();
+        
+        now += IRQSIM_EXIT_CYCLES;
+        next->active = false;
+        running_priority = preempted;
+        call_depth = depth;
+        
+        uint64_t response = now - origin;
+        next->count++;
+        next->sum_response += response;
+        if (latency > next->max_latency) {
+            next->max_latency = latency;
+        }
+        if (response > next->max_response) {
+            next->max_response = response;
+            next->worst_seed = sim_seed;
+        }
+        
+        IrqSim_UpdateDevices();
+    }
+}
+
+/**
+ * @brief  PRIMASK hook: masked window bookkeeping and the unmask point
+ * @param  primask: New PRIMASK value
+ * @retval None
+ */
+static void IrqSim_OnPrimask(uint32_t primask)
+{
+    if (!sim_running) return;
+    
+    if (primask != 0) {
+        masked_since = now;
+        return;
+    }
+    
+    /* Critical section body of the innermost function, still masked */
+    void* function = (call_depth > 0 && call_depth <= IRQSIM_STACK_DEPTH) ? call_stack[call_depth - 1] : NULL;
+    uint64_t cycles = (function != NULL) ? IrqSim_Cost(function)->masked_cycles : 0;
+    now += cycles;
+    
+    if (masked_since != IRQSIM_NEVER && now - masked_since > max_masked) {
+        max_masked = now - masked_since;
+        max_masked_function = function;
+        max_masked_seed = sim_seed;
+    }
+    masked_since = IRQSIM_NEVER;
+    
+    IrqSim_Point();
+}
+
+/**
+ * @brief  Main loop hook: a received frame has been handled
+ * @param  frame: Handled frame
+ * @retval None
+ */
+static void IrqSim_OnFrame(const CanFrame_t* frame)
+{
+    if (!sim_running) return;
+    
+    IrqSimRoute_t* route = IrqSim_FindRoute(frame->bus, frame->id, false);
+    if (route == NULL || route->since == IRQSIM_NEVER) return;
+    
+    uint64_t cycles = now - route->since;
+    route->since = IRQSIM_NEVER;
+    route->count++;
+    route->sum_cycles += cycles;
+    if (cycles > route->max_cycles) {
+        route->max_cycles = cycles;
+        route->worst_seed = sim_seed;
+    }
+}
+
+/**
+ * @brief  Route statistics of a received ID
+ * @param  bus: Receiving controller
+ * @param  id: Identifier
+ * @param  create: Add the route if it is not known yet
+ * @retval Route, NULL if unknown (or the table is full)
+ */
+static IrqSimRoute_t* IrqSim_FindRoute(uint8_t bus, uint32_t id, bool create)
+{
+    for (uint32_t r = 0; r < route_count; r++) {
+        if (routes[r].bus == bus && routes[r].id == id) return &routes[r];
+    }
+    if (!create || route_count >= IRQSIM_MAX_ROUTES) return NULL;
+    
+    IrqSimRoute_t* route = &routes[route_count++];
+    memset(route, 0, sizeof(*route));
+    route->bus = bus;
+    route->id = id;
+    route->since = IRQSIM_NEVER;
+    
+    return route;
+}
+
+/**
+ * @brief  Next value of the schedule PRNG (xorshift32)
+ * @param  None
+ * @retval Pseudo-random value
+ */
+static uint32_t IrqSim_Random(void)
+{
+    uint32_t x = random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    random_state = x;
+    return x;
+}
+
+/**
+ * @brief  Print worst cases over all schedules, one record per line
+ * @param  options: Simulation options
+ * @retval None
+ */
+static void IrqSim_Report(const IrqSimOptions_t* options)
+{
+    printf("IRQSIM,Schedules:%lu,DurationMs:%lu,Seed:%lu,StepCycles:%lu,TxFrames:%llu,UartBytes:%llu,RxDropped:%llu\n",
+           (unsigned long)options->schedules, (unsigned long)options->duration_ms,
+           (unsigned long)options->seed, (unsigned long)options->step,
+           (unsigned long long)total_tx_frames, (unsigned long long)total_uart_bytes,
+           (unsigned long long)total_rx_dropped);
+    
+    for (size_t s = 0; s < IRQSIM_SOURCE_COUNT; s++) {
+        const IrqSimSource_t* source = &sources[s];
+        printf("IRQ,%s,Priority:%lu,Count:%llu,MaxLatencyCyc:%llu,MaxResponseCyc:%llu,AvgResponseCyc:%.0f,MaxResponseUs:%.2f,WorstSeed:%lu\n",
+               source->name, (unsigned long)source->priority, (unsigned long long)source->count,
+               (unsigned long long)source->max_latency, (unsigned long long)source->max_response,
+               (source->count > 0) ? (double)source->sum_response / (double)source->count : 0.0,
+               IRQSIM_TO_US(source->max_response), (unsigned long)source->worst_seed);
+    }
+    
+    for (uint32_t r = 0; r < route_count; r++) {
+        const IrqSimRoute_t* route = &routes[r];
+        printf("ROUTE,CAN%u,0x%lX,Count:%llu,AvgUs:%.1f,MaxUs:%.1f,Overruns:%llu,WorstSeed:%lu\n",
+               route->bus + 1U, (unsigned long)(route->id & ~CAN_ID_EXT), (unsigned long long)route->count,
+               (route->count > 0) ? IRQSIM_TO_US((double)route->sum_cycles / (double)route->count) : 0.0,
+               IRQSIM_TO_US(route->max_cycles), (unsigned long long)route->overruns,
+               (unsigned long)route->worst_seed);
+    }
+    
+    printf("MASKED,MaxCyc:%llu,MaxUs:%.2f,Function:%s,Seed:%lu\n",
+           (unsigned long long)max_masked, IRQSIM_TO_US(max_masked),
+           (max_masked_function != NULL) ? IrqSim_SymbolName(max_masked_function) : "-",
+           (unsigned long)max_masked_seed);
+}
+
+/**
+ * @brief  Print command line help
+ * @param  name: Program name
+ * @retval None
+ */
+static void IrqSim_Usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [-n schedules] [-d ms] [-S seed] [-j jitter%%] [-B burst]\n"
+            "          [-g step] [-C costs] [-m event|snapshot]\n"
+            "  -n  randomized schedules (default %u), seeds seed .. seed+n-1\n"
+            "  -d  simulated time per schedule in ms (default %u)\n"
+            "  -j  period jitter in percent (default %u)\n"
+            "  -B  back-to-back CAN1 frames once per schedule (default %u)\n"
+            "  -g  cycles between preemption points inside a function cost (default %u)\n"
+            "  -C  cost file: <function>,<cycles>[,<masked cycles>]\n",
+            name, IRQSIM_SCHEDULES, IRQSIM_DURATION_MS, IRQSIM_JITTER_PCT,
+            IRQSIM_BURST_FRAMES, IRQSIM_STEP_CYCLES);
+}
+
+/**
+ * @brief  CAN1 RX0 interrupt request (FIFO 0 pending, FMPIE0)
+ * @param  None
+ * @retval true if asserted
+ */
+static bool IrqSim_Can1RxRequest(void)
+{
+    return (CAN1->RF0R & CAN_RF0R_FMP0) && (CAN1->IER & CAN_IER_FMPIE0);
+}
+
+/**
+ * @brief  CAN2 RX0 interrupt request (FIFO 0 pending, FMPIE0)
+ * @param  None
+ * @retval true if asserted
+ */
+static bool IrqSim_Can2RxRequest(void)
+{
+    return (CAN2->RF0R & CAN_RF0R_FMP0) && (CAN2->IER & CAN_IER_FMPIE0);
+}
+
+/**
+ * @brief  CAN1 TX interrupt request (mailbox empty, TMEIE)
+ * @param  None
+ * @retval true if asserted
+ */
+static bool IrqSim_Can1TxRequest(void)
+{
+    return HostPort_CanTxRequest(CAN_BUS_1);
+}
+
+/**
+ * @brief  CAN2 TX interrupt request (mailbox empty, TMEIE)
+ * @param  None
+ * @retval true if asserted
+ */
+static bool IrqSim_Can2TxRequest(void)
+{
+    return HostPort_CanTxRequest(CAN_BUS_2);
+}
+
+/**
+ * @brief  CAN1_RX0_IRQHandler() body, then the FIFO release
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_Can1RxHandler(void)
+{
+    uint8_t pending = rx_arrival_count[CAN_BUS_1];
+    
+    CAN_IRQHandler();
+    HostPort_CanReleaseRx(CAN_BUS_1);
+    if (((CAN1->RF0R & CAN_RF0R_FMP0) >> CAN_RF0R_FMP0_Pos) < pending) {
+        rx_arrival_count[CAN_BUS_1]--;
+        memmove(&rx_arrival[CAN_BUS_1][0], &rx_arrival[CAN_BUS_1][1], rx_arrival_count[CAN_BUS_1] * sizeof(uint64_t));
+    }
+}
+
+/**
+ * @brief  CAN2_RX0_IRQHandler() body, then the FIFO release
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_Can2RxHandler(void)
+{
+    uint8_t pending = rx_arrival_count[CAN_BUS_2];
+    
+    CAN_RxIRQHandler(CAN_BUS_2);
+    HostPort_CanReleaseRx(CAN_BUS_2);
+    if (((CAN2->RF0R & CAN_RF0R_FMP0) >> CAN_RF0R_FMP0_Pos) < pending) {
+        rx_arrival_count[CAN_BUS_2]--;
+        memmove(&rx_arrival[CAN_BUS_2][0], &rx_arrival[CAN_BUS_2][1], rx_arrival_count[CAN_BUS_2] * sizeof(uint64_t));
+    }
+}
+
+/**
+ * @brief  CAN1_TX_IRQHandler() body
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_Can1TxHandler(void)
+{
+    HostPort_CanRefillTx(CAN_BUS_1);
+}
+
+/**
+ * @brief  CAN2_TX_IRQHandler() body
+ * @param  None
+ * @retval None
+ */
+static void IrqSim_Can2TxHandler(void)
+{
+    HostPort_CanRefillTx(CAN_BUS_2);
+}
@@ -0,0 +1,482 @@
+/**
+ ******************************************************************************
+ * @file    isotp_sim.c
+ * @brief   Host ISO-TP throughput simulation, two endpoints back to back
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Connects two IsoTpLink_t (Core/Src/isotp.c) through their send
+ *          functions to one simulated CAN bus in virtual bit time. The
+ *          tester (0x7E0) sends messages to the ECU (0x7E8), which answers
+ *          with the block size and STmin under test in its flow control.
+ *          Each endpoint has a TX queue as deep as the driver's (software
+ *          queue plus 3 mailboxes) and an RX queue of CAN_RX_BUFFER_SIZE;
+ *          heads are arbitrated by identifier, every frame takes its exact
+ *          length on the wire (can_bus.c, stuff bits included), and the
+ *          endpoints run their main loop once or several times per 1 ms
+ *          tick, evenly spread: received frames to IsoTp_OnFrame(), then
+ *          IsoTp_Poll(). Received messages are compared with the payload
+ *          sent, and the bus gap between consecutive frames of the tester
+ *          (end of one, start of the next, no flow control in between) is
+ *          checked against the STmin of the ECU. One line per setting, then
+ *          a summary:
+ *            ISOTP,Bitrate:<bps>,Length:<n>,BS:<n>,STmin:<hex>,Passes:<n>,
+ *              Messages:<n>,Ms:<ms>,BytesPerSec:<n>,Frames:<n>,
+ *              BusLoad:<pct>%,MinGapUs:<us>,TxRetries:<n>,RxDropped:<n>,
+ *              Timeouts:<n>,StMinViolations:<n>,Errors:<n>
+ *            ISOTP,Settings:<n>,Failed:<n>
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/isotp_sim.c Host/Src/can_bus.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o isotp_sim
+ *
+ *          Usage: isotp_sim [-b bitrate] [-l length] [-n messages]
+ *                           [-B block_size] [-S st_min] [-p passes]
+ *          -B, -S and -p limit the sweep to one block size, STmin (ISO
+ *          encoding, e.g. 0x05 = 5 ms, 0xF5 = 500 us) or number of
+ *          main-loop passes per tick. Exit code 1 if a setting lost or
+ *          corrupted a message or sent consecutive frames closer than STmin.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_bus.h"
+#include "host_port.h"
+#include "can_drv.h"
+#include "isotp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Frame waiting in a queue (RX: with the bit its transmission ended)
+ */
+typedef struct {
+    CanFrame_t frame;
+    uint64_t done_bit;
+} IsoTpSimFrame_t;
+
+/**
+ * @brief Frame queue of an endpoint
+ */
+typedef struct {
+    IsoTpSimFrame_t slots[CAN_TX_QUEUE_SIZE + 3];   /* Deeper of the TX and RX queues */
+    uint8_t head;
+    uint8_t count;
+    uint8_t depth;
+} IsoTpSimQueue_t;
+
+/**
+ * @brief One ISO-TP endpoint with its controller queues
+ */
+typedef struct IsoTpSimEndpoint {
+    IsoTpLink_t link;
+    IsoTpSimQueue_t tx;
+    IsoTpSimQueue_t rx;
+    struct IsoTpSimEndpoint* peer;
+    uint32_t tx_retries;        /* Frames refused by a full TX queue */
+    uint32_t rx_dropped;        /* Frames lost to a full RX queue */
+} IsoTpSimEndpoint_t;
+
+/**
+ * @brief One simulated setting and its results
+ */
+typedef struct {
+    uint32_t bitrate;
+    uint16_t length;
+    uint32_t messages;
+    uint8_t block_size;
+    uint8_t st_min;
+    uint8_t passes;             /* Main-loop passes per 1 ms tick */
+    /* Results */
+    uint32_t received;          /* Messages received intact */
+    uint32_t errors;            /* Messages received with wrong length or data */
+    uint64_t first_bit;         /* First message handed to IsoTp_Send() */
+    uint64_t last_bit;          /* Last message reassembled */
+    uint64_t busy_bits;
+    uint32_t frames;
+    uint32_t st_min_violations; /* Tester frame gaps shorter than STmin */
+    uint64_t min_gap_bits;      /* Shortest checked gap, UINT64_MAX if none */
+} IsoTpSim_t;
+
+/* Private define ------------------------------------------------------------*/
+#define ISOTP_SIM_TESTER_ID     0x7E0
+#define ISOTP_SIM_ECU_ID        0x7E8
+#define ISOTP_SIM_BITRATE       500000
+#define ISOTP_SIM_MESSAGES      4
+#define ISOTP_SIM_TICK_LIMIT    600000  /* Give up after 10 simulated minutes */
+#define ISOTP_SIM_NO_FRAME      UINT64_MAX
+#define ISOTP_SIM_PCI_CF        0x2     /* Consecutive frame */
+#define ISOTP_SIM_PCI_FC        0x3     /* Flow control */
+#define ISOTP_ARRAY_SIZE(a)     (sizeof(a) / sizeof((a)[0]))
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const uint8_t sim_block_sizes[] = { 0, 1, 4, 8, 16 };
+static const uint8_t sim_st_mins[] = { 0x00, 0xF5, 0x01, 0x02, 0x05, 0x0A };
+static const uint8_t sim_passes[] = { 1, 4 };   /* 4: frames also leave late in a tick */
+
+static uint8_t sim_payload[ISOTP_MAX_PAYLOAD];
+static IsoTpSimEndpoint_t sim_tester;
+static IsoTpSimEndpoint_t sim_ecu;
+static IsoTpSim_t* sim_current;
+static uint64_t sim_now_bit;           /* End of the last frame on the bus */
+static uint64_t sim_tick_bit;          /* Main-loop pass being run */
+static uint64_t sim_cf_end_bit;        /* End of the tester's last frame since a flow control */
+static uint64_t sim_st_min_bits;       /* STmin of the ECU in bit times */
+
+/* Private function prototypes -----------------------------------------------*/
+static bool IsoTpSim_Run(IsoTpSim_t* sim);
+static void IsoTpSim_Bus(uint64_t until_bit);
+static void IsoTpSim_MainLoop(IsoTpSimEndpoint_t* endpoint, uint64_t tick_bit, uint32_t now);
+static bool IsoTpSim_Send(void* context, uint32_t id, const uint8_t* data, uint8_t dlc);
+static void IsoTpSim_Receive(void* context, const uint8_t* data, uint16_t length);
+static bool IsoTpSim_Push(IsoTpSimQueue_t* queue, const CanFrame_t* frame, uint64_t done_bit);
+static void IsoTpSim_CheckGap(const IsoTpSimEndpoint_t* sender, const CanFrame_t* frame, uint64_t start_bit);
+static uint32_t IsoTpSim_StMinUs(uint8_t st_min);
+static void IsoTpSim_Print(const IsoTpSim_t* sim, bool pass);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  ISO-TP simulation entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if every setting delivered all messages intact, 1 otherwise
+ */
+int main(int argc, char** argv)
+{
+    uint32_t bitrate = ISOTP_SIM_BITRATE;
+    uint32_t length = ISOTP_MAX_PAYLOAD;
+    uint32_t messages = ISOTP_SIM_MESSAGES;
+    int only_bs = -1;
+    int only_st = -1;
+    int only_passes = -1;
+    uint32_t settings = 0, failed = 0;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "b:l:n:B:S:p:")) != -1) {
+        switch (opt) {
+        case 'b': bitrate = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'l': length = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'n': messages = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'B': only_bs = (int)(strtoul(optarg, NULL, 0) & 0xFF); break;
+        case 'S': only_st = (int)(strtoul(optarg, NULL, 0) & 0xFF); break;
+        case 'p': only_passes = (int)strtoul(optarg, NULL, 0); break;
+        default:
+            messages = 0;
+            break;
+        }
+    }
+    if (!CanBus_IsValidBitrate(bitrate) || length == 0 || length > ISOTP_MAX_PAYLOAD || messages == 0 ||
+        only_passes == 0 || only_passes > 100) {
+        fprintf(stderr, "usage: %s [-b bitrate] [-l length (1-%u)] [-n messages] "
+                "[-B block_size] [-S st_min] [-p passes (1-100)]\n", argv[0], ISOTP_MAX_PAYLOAD);
+        return 1;
+    }
+    
+    for (uint32_t i = 0; i < ISOTP_MAX_PAYLOAD; i++) {
+        sim_payload[i] = (uint8_t)(i * 7U + (i >> 8));
+    }
+    
+    uint32_t bs_count = (only_bs >= 0) ? 1 : ISOTP_ARRAY_SIZE(sim_block_sizes);
+    uint32_t st_count = (only_st >= 0) ? 1 : ISOTP_ARRAY_SIZE(sim_st_mins);
+    uint32_t passes_count = (only_passes > 0) ? 1 : ISOTP_ARRAY_SIZE(sim_passes);
+    
+    for (uint32_t p = 0; p < passes_count; p++) {
+        for (uint32_t b = 0; b < bs_count; b++) {
+            for (uint32_t s = 0; s < st_count; s++) {
+                IsoTpSim_t sim = {
+                    .bitrate = bitrate,
+                    .length = (uint16_t)length,
+                    .messages = messages,
+                    .block_size = (only_bs >= 0) ? (uint8_t)only_bs : sim_block_sizes[b],
+                    .st_min = (only_st >= 0) ? (uint8_t)only_st : sim_st_mins[s],
+                    .passes = (only_passes > 0) ? (uint8_t)only_passes : sim_passes[p],
+                    .min_gap_bits = ISOTP_SIM_NO_FRAME
+                };
+                
+                settings++;
+                if (!IsoTpSim_Run(&sim)) failed++;
+            }
+        }
+    }
+    
+    printf("ISOTP,Settings:%u,Failed:%u\n", settings, failed);
+    
+    return (failed == 0) ? 0 : 1;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Transfer the messages of one setting
+ * @param  sim: Setting, filled with the results
+ * @retval true if every message arrived intact
+ */
+static bool IsoTpSim_Run(IsoTpSim_t* sim)
+{
+    IsoTpConfig_t tester_config = {
+        .tx_id = ISOTP_SIM_TESTER_ID, .rx_id = ISOTP_SIM_ECU_ID,
+        .block_size = 0, .st_min = 0, .timeout_ms = ISOTP_DEFAULT_TIMEOUT, .padding = true
+    };
+    IsoTpConfig_t ecu_config = {
+        .tx_id = ISOTP_SIM_ECU_ID, .rx_id = ISOTP_SIM_TESTER_ID,
+        .block_size = sim->block_size, .st_min = sim->st_min,
+        .timeout_ms = ISOTP_DEFAULT_TIMEOUT, .padding = true
+    };
+    uint32_t started = 0;
+    uint32_t tick;
+    
+    memset(&sim_tester, 0, sizeof(sim_tester));
+    memset(&sim_ecu, 0, sizeof(sim_ecu));
+    sim_tester.tx.depth = sim_ecu.tx.depth = CAN_TX_QUEUE_SIZE + 3;
+    sim_tester.rx.depth = sim_ecu.rx.depth = CAN_RX_BUFFER_SIZE;
+    sim_tester.peer = &sim_ecu;
+    sim_ecu.peer = &sim_tester;
+    IsoTp_Init(&sim_tester.link, &tester_config, IsoTpSim_Send, NULL, &sim_tester);
+    IsoTp_Init(&sim_ecu.link, &ecu_config, IsoTpSim_Send, IsoTpSim_Receive, &sim_ecu);
+    
+    sim_current = sim;
+    sim_now_bit = 0;
+    sim_cf_end_bit = ISOTP_SIM_NO_FRAME;
+    sim_st_min_bits = (uint64_t)IsoTpSim_StMinUs(sim->st_min) * sim->bitrate / 1000000U;
+    
+    for (tick = 0; tick < ISOTP_SIM_TICK_LIMIT; tick++) {
+        /* Passes within one tick see the same HAL_GetTick() value */
+        for (uint32_t pass = 0; pass < sim->passes; pass++) {
+            uint64_t pass_bit = ((uint64_t)tick * sim->passes + pass) * sim->bitrate /
+                                (1000U * sim->passes);
+            
+            IsoTpSim_Bus(pass_bit);
+            
+            IsoTpSim_MainLoop(&sim_ecu, pass_bit, tick);
+            IsoTpSim_MainLoop(&sim_tester, pass_bit, tick);
+        }
+        
+        uint64_t tick_bit = (uint64_t)tick * sim->bitrate / 1000U;
+        
+        if (sim->received + sim->errors >= sim->messages) break;
+        
+        /* Next message once the previous one has left the tester */
+        if (started < sim->messages && !IsoTp_IsBusy(&sim_tester.link) &&
+            started == sim->received + sim->errors) {
+            if (IsoTp_Send(&sim_tester.link, sim_payload, sim->length, tick)) {
+                if (started++ == 0) sim->first_bit = tick_bit;
+            }
+        }
+    }
+    
+    bool pass = (sim->received == sim->messages) && sim->errors == 0 && sim->st_min_violations == 0 &&
+                sim_tester.link.stats.timeouts == 0 && sim_ecu.link.stats.timeouts == 0;
+    IsoTpSim_Print(sim, pass);
+    
+    return pass;
+}
+
+/**
+ * @brief  Let the bus send queued frames until a point in time
+ * @note   A frame that starts before until_bit is sent completely; its
+ *         receiver sees it from the first main-loop pass after it ended.
+ * @param  until_bit: Bit time of the next main-loop pass
+ * @retval None
+ */
+static void IsoTpSim_Bus(uint64_t until_bit)
+{
+    while (sim_now_bit < until_bit) {
+        IsoTpSimEndpoint_t* sender = NULL;
+        
+        /* Arbitration between the queue heads: lower identifier wins */
+        if (sim_tester.tx.count > 0) sender = &sim_tester;
+        if (sim_ecu.tx.count > 0 &&
+            (sender == NULL || sim_ecu.tx.slots[sim_ecu.tx.head].frame.id <
+                               sender->tx.slots[sender->tx.head].frame.id)) {
+            sender = &sim_ecu;
+        }
+        if (sender == NULL) {
+            sim_now_bit = until_bit;
+            return;
+        }
+        
+        IsoTpSimQueue_t* tx = &sender->tx;
+        const CanFrame_t* frame = &tx->slots[tx->head].frame;
+        CanBusFrameTiming_t timing;
+        
+        CanBus_FrameTiming(frame->id, frame->dlc, frame->data, &timing);
+        IsoTpSim_CheckGap(sender, frame, sim_now_bit);
+        sim_now_bit += timing.bits;
+        sim_current->busy_bits += timing.bits;
+        sim_current->frames++;
+        
+        if (!IsoTpSim_Push(&sender->peer->rx, frame, sim_now_bit)) {
+            sender->peer->rx_dropped++;
+        }
+        tx->head = (uint8_t)((tx->head + 1) % tx->depth);
+        tx->count--;
+    }
+}
+
+/**
+ * @brief  One main-loop pass of an endpoint: received frames, then timers
+ * @param  endpoint: Endpoint
+ * @param  tick_bit: Bit time of this pass
+ * @param  now: Tick (ms)
+ * @retval None
+ */
+static void IsoTpSim_MainLoop(IsoTpSimEndpoint_t* endpoint, uint64_t tick_bit, uint32_t now)
+{
+    IsoTpSimQueue_t* rx = &endpoint->rx;
+    
+    sim_tick_bit = tick_bit;
+    while (rx->count > 0 && rx->slots[rx->head].done_bit <= tick_bit) {
+        CanFrame_t frame = rx->slots[rx->head].frame;
+        
+        rx->head = (uint8_t)((rx->head + 1) % rx->depth);
+        rx->count--;
+        IsoTp_OnFrame(&endpoint->link, &frame, now);
+    }
+    
+    IsoTp_Poll(&endpoint->link, now);
+}
+
+/**
+ * @brief  Send function of both links: queue the frame for the bus
+ * @param  context: Endpoint
+ * @param  id: Identifier
+ * @param  data: Data bytes
+ * @param  dlc: Data length code
+ * @retval true if queued, false if the TX queue is full
+ */
+static bool IsoTpSim_Send(void* context, uint32_t id, const uint8_t* data, uint8_t dlc)
+{
+    IsoTpSimEndpoint_t* endpoint = (IsoTpSimEndpoint_t*)context;
+    CanFrame_t frame = { .id = id, .dlc = dlc };
+    
+    memcpy(frame.data, data, dlc);
+    if (!IsoTpSim_Push(&endpoint->tx, &frame, 0)) {
+        endpoint->tx_retries++;
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief  Message reception callback of the ECU link
+ * @param  context: Endpoint
+ * @param  data: Reassembled message
+ * @param  length: Message length
+ * @retval None
+ */
+static void IsoTpSim_Receive(void* context, const uint8_t* data, uint16_t length)
+{
+    (void)context;
+    
+    if (length == sim_current->length && memcmp(data, sim_payload, length) == 0) {
+        sim_current->received++;
+    } else {
+        sim_current->errors++;
+    }
+    sim_current->last_bit = sim_tick_bit;
+}
+
+/**
+ * @brief  Append a frame to a queue
+ * @param  queue: Queue
+ * @param  frame: Frame
+ * @param  done_bit: End of transmission (RX queues)
+ * @retval true if appended, false if the queue is full
+ */
+static bool IsoTpSim_Push(IsoTpSimQueue_t* queue, const CanFrame_t* frame, uint64_t done_bit)
+{
+    if (queue->count >= queue->depth) return false;
+    
+    IsoTpSimFrame_t* slot = &queue->slots[(queue->head + queue->count) % queue->depth];
+    slot->frame = *frame;
+    slot->done_bit = done_bit;
+    queue->count++;
+    
+    return true;
+}
+
+/**
+ * @brief  Check the bus gap before a frame against the receiver's STmin
+ * @note   Consecutive frames of the tester must start at least STmin after
+ *         the end of its previous frame; a flow control of the ECU starts
+ *         a new sequence.
+ * @param  sender: Endpoint sending the frame
+ * @param  frame: Frame about to go on the bus
+ * @param  start_bit: Bit time the frame starts
+ * @retval None
+ */
+static void IsoTpSim_CheckGap(const IsoTpSimEndpoint_t* sender, const CanFrame_t* frame, uint64_t start_bit)
+{
+    uint8_t pci_type = frame->data[0] >> 4;
+    CanBusFrameTiming_t timing;
+    
+    if (sender != &sim_tester) {
+        if (pci_type == ISOTP_SIM_PCI_FC) sim_cf_end_bit = ISOTP_SIM_NO_FRAME;
+        return;
+    }
+    
+    if (pci_type == ISOTP_SIM_PCI_CF && sim_cf_end_bit != ISOTP_SIM_NO_FRAME) {
+        uint64_t gap = start_bit - sim_cf_end_bit;
+        
+        if (gap < sim_current->min_gap_bits) sim_current->min_gap_bits = gap;
+        if (gap < sim_st_min_bits) sim_current->st_min_violations++;
+    }
+    
+    CanBus_FrameTiming(frame->id, frame->dlc, frame->data, &timing);
+    sim_cf_end_bit = start_bit + timing.bits;
+}
+
+/**
+ * @brief  Convert STmin from ISO encoding to microseconds
+ * @param  st_min: 0x00-0x7F = ms, 0xF1-0xF9 = 100-900 us, others reserved
+ * @retval Separation time in us (reserved values map to 127 ms)
+ */
+static uint32_t IsoTpSim_StMinUs(uint8_t st_min)
+{
+    if (st_min <= 0x7F) return st_min * 1000U;
+    if (st_min >= 0xF1 && st_min <= 0xF9) return (st_min - 0xF0U) * 100U;
+    return 127000U;
+}
+
+/**
+ * @brief  Print the result line of a setting
+ * @param  sim: Setting and results
+ * @param  pass: All messages arrived intact
+ * @retval None
+ */
+static void IsoTpSim_Print(const IsoTpSim_t* sim, bool pass)
+{
+    uint64_t elapsed = (sim->last_bit > sim->first_bit) ? sim->last_bit - sim->first_bit : 0;
+    uint64_t bytes = (uint64_t)sim->received * sim->length;
+    uint64_t bytes_per_sec = (elapsed > 0) ? bytes * sim->bitrate / elapsed : 0;
+    uint32_t load = (elapsed > 0) ? (uint32_t)(sim->busy_bits * 1000U / elapsed) : 0;
+    uint64_t min_gap_us = (sim->min_gap_bits != ISOTP_SIM_NO_FRAME) ?
+                          sim->min_gap_bits * 1000000U / sim->bitrate : 0;
+    
+    printf("ISOTP,Bitrate:%u,Length:%u,BS:%u,STmin:0x%02X,Passes:%u,Messages:%u,Ms:%llu,BytesPerSec:%llu,"
+           "Frames:%u,BusLoad:%u.%u%%,MinGapUs:%llu,TxRetries:%u,RxDropped:%u,Timeouts:%u,"
+           "StMinViolations:%u,Errors:%u%s\n",
+           sim->bitrate, sim->length, sim->block_size, sim->st_min, sim->passes, sim->received,
+           (unsigned long long)(elapsed * 1000U / sim->bitrate), (unsigned long long)bytes_per_sec,
+           sim->frames, load / 10U, load % 10U, (unsigned long long)min_gap_us,
+           sim_tester.tx_retries + sim_ecu.tx_retries, sim_tester.rx_dropped + sim_ecu.rx_dropped,
+           sim_tester.link.stats.timeouts + sim_ecu.link.stats.timeouts, sim->st_min_violations,
+           sim->errors, pass ? "" : ",FAIL");
+}
@@ -0,0 +1,805 @@
+/**
+ ******************************************************************************
+ * @file    uart_cmd_sim.c
+ * @brief   Host check of the binary UART command channel
+ * @author  Automotive Firmware Engineer
+ * @date    August 2025
+ ******************************************************************************
+ * @note    Runs the gateway (host_ecu.c) and feeds COBS-encoded command
+ *          packets (uart_cmd.h) into USART3 RX at the line rate, one main
+ *          loop pass per ms. Both controllers are attached, so every frame
+ *          the channel injects waits in a mailbox until it is collected
+ *          after the pass; the UART output is scanned for the 0x00-framed
+ *          ACK packets between the text lines. Each case checks:
+ *          - the injected frames per controller and identifier: payload,
+ *            order and count (a range for periodic slots)
+ *          - the sum of ok and failed over all ACKs and the sequence
+ *            number of the last one
+ *          - the packets the channel counted as bad
+ *          One line per case, then a summary:
+ *            UARTCMD,Case:<name>,Packets:<n>,Frames:<n>,Acks:<n>,AckOk:<n>,
+ *              AckFailed:<n>,LastSeq:<n>,Bad:<n>,Check:<OK|FAIL>
+ *            UARTCMD,Cases:<n>,Failed:<n>
+ *
+ *          Build (from the repository root):
+ *            gcc -std=gnu11 -O2 -funsigned-char -DSTM32F407xx -DUSE_HAL_DRIVER
+ *                -DE2E_CRC_HW=0 -include Host/Inc/host_port.h -IHost/Inc
+ *                -ICore/Inc -isystem Drivers/STM32F4xx_HAL_Driver/Inc
+ *                -isystem Drivers/CMSIS/Device/ST/STM32F4xx/Include
+ *                -isystem Drivers/CMSIS/Include
+ *                Host/Src/uart_cmd_sim.c Host/Src/host_ecu.c
+ *                Host/Src/host_port.c Core/Src/can_drv.c Core/Src/can_gateway.c
+ *                Core/Src/cycle_monitor.c Core/Src/e2e.c Core/Src/isotp.c
+ *                Core/Src/j1939.c Core/Src/pdu_router.c Core/Src/pdu_tx.c
+ *                Core/Src/signal_store.c Core/Src/uart_cmd.c
+ *                Core/Src/uart_drv.c Core/Src/uds_server.c -o uart_cmd_sim
+ *
+ *          Usage: uart_cmd_sim [-r bytes_per_second] [-c case]
+ *          -r sets the RX rate (default 11520 = 115200 baud 8N1), -c runs
+ *          one case. Exit code 1 if a case fails.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "host_port.h"
+#include "host_ecu.h"
+#include "can_drv.h"
+#include "uart_cmd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define CMDSIM_STREAM_SIZE      4096    /* RX bytes of one case */
+#define CMDSIM_MAX_PAUSES       8
+#define CMDSIM_MAX_EXPECTED     16
+#define CMDSIM_MAX_FRAMES       512     /* Frames collected per case */
+#define CMDSIM_LINE_RATE        11520   /* Bytes/s at 115200 baud, 8N1 */
+#define CMDSIM_SETTLE_MS        (2 * UART_CMD_ACK_INTERVAL_MS + 10)
+#define CMDSIM_ACK_LENGTH       7       /* cmd, last_seq, ok(2), failed(2), chk */
+#define CMDSIM_SEGMENT_SIZE     64      /* Longest UART segment between 0x00 kept */
+#define CMDSIM_ARRAY_SIZE(a)    (sizeof(a) / sizeof((a)[0]))
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Expected injected frame, repeated min_count..max_count times in a row
+ */
+typedef struct {
+    uint8_t bus;
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+    uint16_t min_count;
+    uint16_t max_count;
+} CmdSimFrame_t;
+
+/**
+ * @brief Pause of the RX stream before a byte offset
+ */
+typedef struct {
+    uint32_t at_byte;
+    uint32_t ms;
+} CmdSimPause_t;
+
+/**
+ * @brief One case: the bytes sent and what the gateway must do with them
+ */
+typedef struct {
+    uint8_t stream[CMDSIM_STREAM_SIZE];
+    uint32_t length;
+    CmdSimPause_t pauses[CMDSIM_MAX_PAUSES];
+    uint8_t pause_count;
+    CmdSimFrame_t expected[CMDSIM_MAX_EXPECTED];
+    uint8_t expected_count;
+    uint32_t packets;           /* Packets put in the stream, valid or not */
+    uint32_t ack_ok;            /* Expected sums over all ACKs */
+    uint32_t ack_failed;
+    uint8_t last_seq;           /* Expected sequence number of the last ACK */
+    uint32_t bad;               /* Expected packets_bad */
+} CmdSimCase_t;
+
+/**
+ * @brief What the gateway did in a case
+ */
+typedef struct {
+    CanFrame_t frames[CMDSIM_MAX_FRAMES];   /* Injected frames, bus set */
+    uint32_t frame_count;
+    uint32_t acks;
+    uint32_t ack_ok;
+    uint32_t ack_failed;
+    uint32_t ack_bad;           /* 8-byte segments starting like an ACK but invalid */
+    uint8_t last_seq;
+    uint8_t segment[CMDSIM_SEGMENT_SIZE];   /* UART bytes since the last 0x00 */
+    uint32_t segment_length;
+} CmdSimResult_t;
+
+/**
+ * @brief Case table entry
+ */
+typedef struct {
+    const char* name;
+    void (*build)(CmdSimCase_t* c);
+} CmdSimEntry_t;
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static CmdSimCase_t sim_case;
+static CmdSimResult_t sim_result;
+
+/* Private function prototypes -----------------------------------------------*/
+static void CmdSim_BuildFrame(CmdSimCase_t* c);
+static void CmdSim_BuildBurst(CmdSimCase_t* c);
+static void CmdSim_BuildBurstMalformed(CmdSimCase_t* c);
+static void CmdSim_BuildInvalid(CmdSimCase_t* c);
+static void CmdSim_BuildCorrupt(CmdSimCase_t* c);
+static void CmdSim_BuildPeriodic(CmdSimCase_t* c);
+static void CmdSim_BuildBatch(CmdSimCase_t* c);
+static bool CmdSim_Run(const char* name, const CmdSimCase_t* c, uint32_t rate);
+static void CmdSim_Collect(CmdSimResult_t* result);
+static void CmdSim_ScanUart(CmdSimResult_t* result, const uint8_t* data, uint32_t length);
+static bool CmdSim_CheckFrames(const CmdSimCase_t* c, const CmdSimResult_t* result);
+static void CmdSim_Packet(CmdSimCase_t* c, uint8_t cmd, uint8_t seq, const uint8_t* payload, uint16_t length);
+static void CmdSim_Raw(CmdSimCase_t* c, const uint8_t* data, uint32_t length);
+static void CmdSim_Pause(CmdSimCase_t* c, uint32_t ms);
+static void CmdSim_Expect(CmdSimCase_t* c, uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data,
+                          uint16_t min_count, uint16_t max_count);
+static uint16_t CmdSim_Record(uint8_t* out, uint32_t id, uint8_t dlc, const uint8_t* data);
+static uint32_t CmdSim_Cobs(const uint8_t* data, uint32_t length, uint8_t* out);
+
+static const CmdSimEntry_t sim_cases[] = {
+    { "frame",          CmdSim_BuildFrame },
+    { "burst",          CmdSim_BuildBurst },
+    { "burst_malformed", CmdSim_BuildBurstMalformed },
+    { "invalid",        CmdSim_BuildInvalid },
+    { "corrupt",        CmdSim_BuildCorrupt },
+    { "periodic",       CmdSim_BuildPeriodic },
+    { "batch",          CmdSim_BuildBatch }
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Command channel check entry point
+ * @param  argc: Argument count
+ * @param  argv: Arguments
+ * @retval 0 if every case passed, 1 on failures or usage errors
+ */
+int main(int argc, char** argv)
+{
+    uint32_t rate = CMDSIM_LINE_RATE;
+    const char* only = NULL;
+    uint32_t cases = 0, failed = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:c:")) != -1) {
+        switch (opt) {
+        case 'r': rate = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'c': only = optarg; break;
+        default:
+            rate = 0;
+            break;
+        }
+    }
+    if (rate < 1000 || optind != argc) {
+        fprintf(stderr, "usage: %s [-r bytes_per_second (>= 1000)] [-c case]\n", argv[0]);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < CMDSIM_ARRAY_SIZE(sim_cases); i++) {
+        if (only != NULL && strcmp(only, sim_cases[i].name) != 0) continue;
+
+        memset(&sim_case, 0, sizeof(sim_case));
+        sim_cases[i].build(&sim_case);
+
+        cases++;
+        if (!CmdSim_Run(sim_cases[i].name, &sim_case, rate)) failed++;
+    }
+    if (cases == 0) {
+        fprintf(stderr, "uart_cmd_sim: unknown case %s\n", only);
+        return 1;
+    }
+
+    printf("UARTCMD,Cases:%u,Failed:%u\n", cases, failed);
+
+    return (failed == 0) ? 0 : 1;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Single frames on both controllers, payload with zero bytes
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildFrame(CmdSimCase_t* c)
+{
+    static const uint8_t data1[8] = { 0x11, 0x00, 0x22, 0x00, 0x00, 0x33, 0x44, 0x00 };
+    static const uint8_t data2[3] = { 0xA0, 0xA1, 0xA2 };
+    uint8_t payload[16];
+    uint16_t length;
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x5A1, 8, data1);
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 1, payload, length);
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A1, 8, data1, 1, 1);
+
+    payload[0] = CAN_BUS_2;
+    length = 1 + CmdSim_Record(&payload[1], 0x18FF5A01 | CAN_ID_EXT, 3, data2);
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 2, payload, length);
+    CmdSim_Expect(c, CAN_BUS_2, 0x18FF5A01 | CAN_ID_EXT, 3, data2, 1, 1);
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x5A2, 0, NULL);
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 3, payload, length);
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A2, 0, NULL, 1, 1);
+
+    c->ack_ok = 3;
+    c->last_seq = 3;
+}
+
+/**
+ * @brief  One burst of four frames
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildBurst(CmdSimCase_t* c)
+{
+    uint8_t payload[64];
+    uint16_t length = 2;
+
+    payload[0] = CAN_BUS_1;
+    payload[1] = 4;
+    for (uint8_t n = 0; n < 4; n++) {
+        uint8_t data[8] = { n, 0x00, (uint8_t)(0xB0 + n), 0x00, 0x00, 0x00, 0x00, 0xFF };
+        uint8_t dlc = (uint8_t)(2 + 2 * n);
+
+        length += CmdSim_Record(&payload[length], 0x5A3 + n, dlc, data);
+        CmdSim_Expect(c, CAN_BUS_1, 0x5A3 + n, dlc, data, 1, 1);
+    }
+    CmdSim_Packet(c, UART_CMD_TX_BURST, 7, payload, length);
+
+    c->ack_ok = 1;
+    c->last_seq = 7;
+}
+
+/**
+ * @brief  Bursts with a trailing byte and with a missing record: nothing
+ *         of either is injected, the channel keeps working
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildBurstMalformed(CmdSimCase_t* c)
+{
+    static const uint8_t data[2] = { 0xC0, 0xC1 };
+    uint8_t payload[64];
+    uint16_t length = 2;
+
+    /* Two records and a trailing byte */
+    payload[0] = CAN_BUS_1;
+    payload[1] = 2;
+    length += CmdSim_Record(&payload[length], 0x5A3, 2, data);
+    length += CmdSim_Record(&payload[length], 0x5A4, 2, data);
+    payload[length++] = 0x55;
+    CmdSim_Packet(c, UART_CMD_TX_BURST, 10, payload, length);
+
+    /* Count 3, two records */
+    payload[1] = 3;
+    CmdSim_Packet(c, UART_CMD_TX_BURST, 11, payload, (uint16_t)(length - 1));
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x5A7, 2, data);
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 12, payload, length);
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A3, 2, data, 0, 0);
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A4, 2, data, 0, 0);
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A7, 2, data, 1, 1);
+
+    c->ack_ok = 1;
+    c->ack_failed = 2;
+    c->last_seq = 12;
+}
+
+/**
+ * @brief  Well-formed packets the gateway must refuse (bus, identifier, DLC)
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildInvalid(CmdSimCase_t* c)
+{
+    static const uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t payload[16];
+    uint16_t length;
+
+    payload[0] = CAN_BUS_COUNT;
+    length = 1 + CmdSim_Record(&payload[1], 0x5A1, 8, data);
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 20, payload, length);
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x800, 8, data);    /* 12-bit standard ID */
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 21, payload, length);
+
+    length = 1 + CmdSim_Record(&payload[1], 0x5A1, 8, data);
+    payload[5] = 9;                                             /* DLC above 8 */
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 22, payload, length);
+
+    payload[0] = 0;                                             /* Slot 0 */
+    payload[1] = CAN_BUS_COUNT;
+    length = 2 + CmdSim_Record(&payload[2], 0x5A1, 1, data);
+    payload[length++] = 10;
+    payload[length++] = 0;
+    CmdSim_Packet(c, UART_CMD_PERIODIC, 23, payload, length);
+
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A1, 8, data, 0, 0);
+    CmdSim_Expect(c, CAN_BUS_2, 0x5A1, 8, data, 0, 0);
+
+    c->ack_failed = 4;
+    c->last_seq = 23;
+}
+
+/**
+ * @brief  Damaged packets: checksum, COBS block overrun, unknown command,
+ *         oversize; stray delimiters are ignored
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildCorrupt(CmdSimCase_t* c)
+{
+    static const uint8_t delimiters[3] = { 0x00, 0x00, 0x00 };
+    static const uint8_t overrun[4] = { 0x06, UART_CMD_TX_FRAME, 0x01, 0x00 };   /* Block ends early */
+    static const uint8_t data[4] = { 0xD0, 0xD1, 0xD2, 0xD3 };
+    uint8_t payload[UART_CMD_MAX_PACKET + 8];
+    uint8_t packet[UART_CMD_MAX_PACKET + 8];
+    uint8_t encoded[UART_CMD_MAX_PACKET + 16];
+    uint16_t length;
+    uint32_t encoded_length;
+
+    CmdSim_Raw(c, delimiters, sizeof(delimiters));
+
+    /* Checksum off by one */
+    packet[0] = UART_CMD_TX_FRAME;
+    packet[1] = 30;
+    packet[2] = CAN_BUS_1;
+    length = 3 + CmdSim_Record(&packet[3], 0x5A1, 4, data);
+    packet[length] = 0;
+    for (uint16_t i = 0; i < length; i++) packet[length] -= packet[i];
+    packet[length++]++;
+    encoded_length = CmdSim_Cobs(packet, length, encoded);
+    encoded[encoded_length++] = 0x00;
+    CmdSim_Raw(c, encoded, encoded_length);
+    c->packets++;
+    c->bad++;
+
+    CmdSim_Raw(c, overrun, sizeof(overrun));
+    c->packets++;
+    c->bad++;
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x5A1, 4, data);
+    CmdSim_Packet(c, 0x07, 31, payload, length);                /* Unknown command */
+    c->bad++;
+
+    memset(payload, 0x5A, sizeof(payload));                     /* Longer than a packet */
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 32, payload, UART_CMD_MAX_PACKET);
+    c->bad++;
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x5A1, 4, data);
+    CmdSim_Packet(c, UART_CMD_TX_FRAME, 33, payload, length);
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A1, 4, data, 1, 1);
+
+    c->ack_ok = 1;
+    c->last_seq = 33;
+}
+
+/**
+ * @brief  Two periodic slots on both controllers, started and stopped
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildPeriodic(CmdSimCase_t* c)
+{
+    static const uint8_t data1[2] = { 0xE0, 0x00 };
+    static const uint8_t data2[8] = { 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8 };
+    uint8_t payload[24];
+    uint16_t length;
+
+    /* Slot 0: CAN1 every 10 ms, slot 1: CAN2 every 25 ms */
+    payload[0] = 0;
+    payload[1] = CAN_BUS_1;
+    length = 2 + CmdSim_Record(&payload[2], 0x5A8, 2, data1);
+    payload[length++] = 10;
+    payload[length++] = 0;
+    CmdSim_Packet(c, UART_CMD_PERIODIC, 40, payload, length);
+
+    payload[0] = 1;
+    payload[1] = CAN_BUS_2;
+    length = 2 + CmdSim_Record(&payload[2], 0x5A9, 8, data2);
+    payload[length++] = 25;
+    payload[length++] = 0;
+    CmdSim_Packet(c, UART_CMD_PERIODIC, 41, payload, length);
+
+    CmdSim_Pause(c, 100);
+
+    /* Period 0 stops a slot */
+    payload[0] = 0;
+    payload[1] = CAN_BUS_1;
+    length = 2 + CmdSim_Record(&payload[2], 0x5A8, 2, data1);
+    payload[length++] = 0;
+    payload[length++] = 0;
+    CmdSim_Packet(c, UART_CMD_PERIODIC, 42, payload, length);
+
+    payload[0] = 1;
+    payload[1] = CAN_BUS_2;
+    length = 2 + CmdSim_Record(&payload[2], 0x5A9, 8, data2);
+    payload[length++] = 0;
+    payload[length++] = 0;
+    CmdSim_Packet(c, UART_CMD_PERIODIC, 43, payload, length);
+
+    /* About 105 ms active: one frame at start, then one per period */
+    CmdSim_Expect(c, CAN_BUS_1, 0x5A8, 2, data1, 10, 12);
+    CmdSim_Expect(c, CAN_BUS_2, 0x5A9, 8, data2, 4, 6);
+
+    c->ack_ok = 4;
+    c->last_seq = 43;
+}
+
+/**
+ * @brief  More commands than one ACK batch holds
+ * @param  c: Case to fill
+ * @retval None
+ */
+static void CmdSim_BuildBatch(CmdSimCase_t* c)
+{
+    static const uint8_t data[1] = { 0xA5 };
+    uint8_t payload[8];
+    uint16_t length;
+    uint32_t count = UART_CMD_ACK_BATCH + UART_CMD_ACK_BATCH / 4;
+
+    payload[0] = CAN_BUS_1;
+    length = 1 + CmdSim_Record(&payload[1], 0x5AA, 1, data);
+    for (uint32_t n = 0; n < count; n++) {
+        CmdSim_Packet(c, UART_CMD_TX_FRAME, (uint8_t)(100 + n), payload, length);
+    }
+    CmdSim_Expect(c, CAN_BUS_1, 0x5AA, 1, data, (uint16_t)count, (uint16_t)count);
+
+    c->ack_ok = count;
+    c->last_seq = (uint8_t)(100 + count - 1);
+}
+
+/**
+ * @brief  Feed a case to a fresh gateway and check the outcome
+ * @param  name: Case name
+ * @param  c: Case
+ * @param  rate: RX rate in bytes/s
+ * @retval true if the case passed
+ */
+static bool CmdSim_Run(const char* name, const CmdSimCase_t* c, uint32_t rate)
+{
+    CmdSimResult_t* result = &sim_result;
+    uint32_t sent = 0;
+    uint32_t pause = 0;
+    uint32_t paused_ms = 0;
+    uint32_t idle_ms = 0;
+    uint64_t due = 0;
+    uint8_t uart[256];
+
+    memset(result, 0, sizeof(*result));
+
+    if (!HostEcu_Init(ROUTER_OUTPUT_EVENT)) {
+        fprintf(stderr, "uart_cmd_sim: gateway initialization failed\n");
+        return false;
+    }
+    HostPort_CanAttach(CAN_BUS_1, true);
+    HostPort_CanAttach(CAN_BUS_2, true);
+
+    for (uint32_t tick = 1; idle_ms < CMDSIM_SETTLE_MS; tick++) {
+        HostPort_SetTick(tick);
+
+        /* Bytes that arrived during the last ms, pauses excluded */
+        if (pause < c->pause_count && sent == c->pauses[pause].at_byte) {
+            if (++paused_ms >= c->pauses[pause].ms) {
+                pause++;
+                paused_ms = 0;
+            }
+        } else {
+            due += rate;
+            while (sent < c->length && due >= 1000U &&
+                   !(pause < c->pause_count && sent == c->pauses[pause].at_byte)) {
+                HostPort_UartReceive(c->stream[sent++]);
+                due -= 1000U;
+            }
+        }
+        if (sent >= c->length && pause >= c->pause_count) idle_ms++;
+
+        HostEcu_Poll();
+        CmdSim_Collect(result);
+
+        uint32_t length;
+        while ((length = HostPort_UartTransmit(uart, sizeof(uart))) > 0) {
+            CmdSim_ScanUart(result, uart, length);
+        }
+    }
+
+    UartCmdStats_t stats;
+    UartCmd_GetStatistics(&stats);
+
+    bool pass = CmdSim_CheckFrames(c, result) &&
+                result->ack_ok == c->ack_ok && result->ack_failed == c->ack_failed &&
+                result->ack_bad == 0 && result->acks > 0 && result->last_seq == c->last_seq &&
+                stats.packets_bad == c->bad && stats.packets_ok == c->packets - c->bad;
+
+    printf("UARTCMD,Case:%s,Packets:%u,Frames:%u,Acks:%u,AckOk:%u,AckFailed:%u,LastSeq:%u,Bad:%u,Check:%s\n",
+           name, c->packets, result->frame_count, result->acks, result->ack_ok, result->ack_failed,
+           result->last_seq, stats.packets_bad, pass ? "OK" : "FAIL");
+
+    return pass;
+}
+
+/**
+ * @brief  Take the frames the gateway loaded into the mailboxes
+ * @param  result: Collected frames
+ * @retval None
+ */
+static void CmdSim_Collect(CmdSimResult_t* result)
+{
+    for (uint8_t bus = 0; bus < HOST_CAN_BUS_COUNT; bus++) {
+        CanFrame_t frame = { .bus = bus };
+
+        HostPort_CanRefillTx(bus);
+        while (HostPort_CanPeekTx(bus, &frame.id, &frame.dlc, frame.data)) {
+            if (result->frame_count < CMDSIM_MAX_FRAMES) {
+                result->frames[result->frame_count++] = frame;
+            }
+            HostPort_CanCompleteTx(bus);
+            HostPort_CanRefillTx(bus);
+        }
+    }
+}
+
+/**
+ * @brief  Find ACK packets in the UART output
+ * @note   ACKs are COBS packets between two 0x00; an encoded ACK is 8
+ *         bytes and decodes to cmd 0x80, which text output never holds.
+ * @param  result: ACK sums
+ * @param  data: UART bytes
+ * @param  length: Number of bytes
+ * @retval None
+ */
+static void CmdSim_ScanUart(CmdSimResult_t* result, const uint8_t* data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++) {
+        if (data[i] != 0x00) {
+            if (result->segment_length < CMDSIM_SEGMENT_SIZE) {
+                result->segment[result->segment_length] = data[i];
+            }
+            result->segment_length++;
+            continue;
+        }
+
+        if (result->segment_length == CMDSIM_ACK_LENGTH + 1) {
+            uint8_t ack[CMDSIM_ACK_LENGTH + 1];
+            uint32_t in = 0, out = 0;
+            bool valid = true;
+
+            /* COBS decode */
+            while (in < CMDSIM_ACK_LENGTH + 1 && valid) {
+                uint8_t code = result->segment[in++];
+                for (uint8_t k = 1; k < code; k++) {
+                    if (in >= CMDSIM_ACK_LENGTH + 1) {
+                        valid = false;
+                        break;
+                    }
+                    ack[out++] = result->segment[in++];
+                }
+                if (code != 0xFF && in < CMDSIM_ACK_LENGTH + 1) ack[out++] = 0x00;
+            }
+
+            if (out == CMDSIM_ACK_LENGTH && ack[0] == UART_CMD_ACK) {
+                uint8_t sum = 0;
+                for (uint32_t k = 0; k < CMDSIM_ACK_LENGTH; k++) sum += ack[k];
+                valid = valid && sum == 0;
+            } else if (out > 0 && ack[0] == UART_CMD_ACK) {
+                valid = false;
+            } else {
+                result->segment_length = 0;
+                continue;   /* Text */
+            }
+
+            if (valid) {
+                result->acks++;
+                result->last_seq = ack[1];
+                result->ack_ok += ack[2] | (ack[3] << 8);
+                result->ack_failed += ack[4] | (ack[5] << 8);
+            } else {
+                result->ack_bad++;
+            }
+        }
+        result->segment_length = 0;
+    }
+}
+
+/**
+ * @brief  Compare the collected frames with the expected ones
+ * @note   Per controller and identifier the frames must match the expected
+ *         entries in order, each repeated min_count..max_count times;
+ *         frames of other identifiers (gateway traffic) are ignored.
+ * @param  c: Case
+ * @param  result: Collected frames
+ * @retval true if they match
+ */
+static bool CmdSim_CheckFrames(const CmdSimCase_t* c, const CmdSimResult_t* result)
+{
+    if (result->frame_count >= CMDSIM_MAX_FRAMES) return false;
+
+    for (uint8_t e = 0; e < c->expected_count; e++) {
+        const CmdSimFrame_t* key = &c->expected[e];
+        bool first = true;
+
+        for (uint8_t k = 0; k < e; k++) {
+            if (c->expected[k].bus == key->bus && c->expected[k].id == key->id) first = false;
+        }
+        if (!first) continue;
+
+        /* Walk the frames of this identifier against its entries */
+        uint32_t f = 0;
+        for (uint8_t x = e; x < c->expected_count; x++) {
+            const CmdSimFrame_t* entry = &c->expected[x];
+            uint16_t count = 0;
+
+            if (entry->bus != key->bus || entry->id != key->id) continue;
+
+            for (; f < result->frame_count; f++) {
+                const CanFrame_t* frame = &result->frames[f];
+
+                if (frame->bus != key->bus || frame->id != key->id) continue;
+                if (frame->dlc != entry->dlc || memcmp(frame->data, entry->data, entry->dlc) != 0) break;
+                count++;
+            }
+            if (count < entry->min_count || count > entry->max_count) return false;
+        }
+        for (; f < result->frame_count; f++) {
+            if (result->frames[f].bus == key->bus && result->frames[f].id == key->id) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief  Append a command packet: checksum, COBS, 0x00 delimiter
+ * @param  c: Case
+ * @param  cmd: Command code
+ * @param  seq: Sequence number
+ * @param  payload: Payload bytes
+ * @param  length: Payload length
+ * @retval None
+ */
+static void CmdSim_Packet(CmdSimCase_t* c, uint8_t cmd, uint8_t seq, const uint8_t* payload, uint16_t length)
+{
+    uint8_t packet[UART_CMD_MAX_PACKET + 8];
+    uint8_t encoded[UART_CMD_MAX_PACKET + 16];
+    uint8_t sum = 0;
+
+    packet[0] = cmd;
+    packet[1] = seq;
+    memcpy(&packet[2], payload, length);
+    for (uint16_t i = 0; i < length + 2U; i++) sum += packet[i];
+    packet[length + 2] = (uint8_t)(0U - sum);
+
+    uint32_t encoded_length = CmdSim_Cobs(packet, length + 3U, encoded);
+    encoded[encoded_length++] = 0x00;
+    CmdSim_Raw(c, encoded, encoded_length);
+    c->packets++;
+}
+
+/**
+ * @brief  Append raw bytes to the RX stream
+ * @param  c: Case
+ * @param  data: Bytes
+ * @param  length: Number of bytes
+ * @retval None
+ */
+static void CmdSim_Raw(CmdSimCase_t* c, const uint8_t* data, uint32_t length)
+{
+    if (c->length + length > CMDSIM_STREAM_SIZE) {
+        fprintf(stderr, "uart_cmd_sim: case stream too long\n");
+        exit(1);
+    }
+    memcpy(&c->stream[c->length], data, length);
+    c->length += length;
+}
+
+/**
+ * @brief  Stop the RX stream for a while at the current position
+ * @param  c: Case
+ * @param  ms: Pause length
+ * @retval None
+ */
+static void CmdSim_Pause(CmdSimCase_t* c, uint32_t ms)
+{
+    if (c->pause_count < CMDSIM_MAX_PAUSES) {
+        c->pauses[c->pause_count].at_byte = c->length;
+        c->pauses[c->pause_count].ms = ms;
+        c->pause_count++;
+    }
+}
+
+/**
+ * @brief  Add an expected frame
+ * @param  c: Case
+ * @param  bus: Controller
+ * @param  id: Identifier (CAN_ID_EXT set for 29-bit)
+ * @param  dlc: Data length code
+ * @param  data: Payload (NULL for dlc 0)
+ * @param  min_count: Fewest copies in a row
+ * @param  max_count: Most copies in a row (0 = frame must not appear)
+ * @retval None
+ */
+static void CmdSim_Expect(CmdSimCase_t* c, uint8_t bus, uint32_t id, uint8_t dlc, const uint8_t* data,
+                          uint16_t min_count, uint16_t max_count)
+{
+    if (c->expected_count >= CMDSIM_MAX_EXPECTED) return;
+
+    CmdSimFrame_t* entry = &c->expected[c->expected_count++];
+    entry->bus = bus;
+    entry->id = id;
+    entry->dlc = dlc;
+    memset(entry->data, 0, sizeof(entry->data));
+    if (data != NULL) memcpy(entry->data, data, dlc);
+    entry->min_count = min_count;
+    entry->max_count = max_count;
+}
+
+/**
+ * @brief  Write a frame record { id(4), dlc, data[dlc] }
+ * @param  out: Record buffer
+ * @param  id: Identifier (bit 31 = 29-bit)
+ * @param  dlc: Data length code
+ * @param  data: Payload (NULL for dlc 0)
+ * @retval Record length
+ */
+static uint16_t CmdSim_Record(uint8_t* out, uint32_t id, uint8_t dlc, const uint8_t* data)
+{
+    out[0] = (uint8_t)id;
+    out[1] = (uint8_t)(id >> 8);
+    out[2] = (uint8_t)(id >> 16);
+    out[3] = (uint8_t)(id >> 24);
+    out[4] = dlc;
+    if (data != NULL && dlc <= 8) memcpy(&out[5], data, dlc);
+
+    return (uint16_t)(5U + ((dlc <= 8) ? dlc : 0U));
+}
+
+/**
+ * @brief  COBS-encode a packet (no delimiter)
+ * @param  data: Packet
+ * @param  length: Packet length
+ * @param  out: Encoded bytes, length + length / 254 + 1
+ * @retval Encoded length
+ */
+static uint32_t CmdSim_Cobs(const uint8_t* data, uint32_t length, uint8_t* out)
+{
+    uint32_t code_pos = 0;
+    uint32_t out_len = 1;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < length; i++) {
+        if (data[i] == 0x00) {
+            out[code_pos] = code;
+            code_pos = out_len++;
+            code = 1;
+        } else {
+            out[out_len++] = data[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = out_len++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+
+    return out_len;
+}